@@ -3,8 +3,22 @@
 #include "src/core/sdcard.h"
 #include "src/core/router.h"
 #include "src/pages/pages.h" // Includes base Page and factory declarations
+#include "src/pages/benchmark_page.h" // Benchmark runner (serial "bench" command)
 #include "src/core/touch.h"   // Include the new Touch class header
 #include "src/core/font.h"    // Include Font class header
+#include "src/core/scheduler.h" // Cooperative scheduler (timers / idle work / event wait)
+#include "src/core/jobs.h"      // Dual-core job system (background SD reads / font prefetch)
+#include "src/core/memory_budget.h" // Shared memory budget for caches and transient buffers
+#include "src/core/mem_stats.h"     // Heap accounting per subsystem / page
+#include "src/core/serial_console.h" // Serial diagnostic commands
+#include "src/core/trace.h"          // Span tracing (Chrome trace export)
+#include "src/core/compositor.h"     // Dirty-rect compositor (one repaint per frame)
+#include "src/core/widget_cache.h"   // Pre-rendered widget sprites (buttons, icons, menu tiles)
+#include "src/core/touch_trace.h"    // Touch trace record / replay (end-to-end latency)
+#include "src/core/sd_read_profile.h" // SD read latency/throughput probe (comic strip read size)
+#if NAV_SOAK_TEST
+#include "src/core/nav_soak.h"  // Navigation soak test (heap fragmentation diagnostic)
+#endif
 #include <SPI.h>              // Re-add for direct access
 #include <XPT2046_Touchscreen.h> // Re-add for direct access (needed by Touch class indirectly)
 #include <TFT_eSPI.h>         // Re-add for direct access
@@ -21,11 +35,20 @@ Router& router = Router::getInstance();
 Display& display = Display::getInstance();
 SDCard &sd = SDCard::getInstance();
 Touch& touch = Touch::getInstance(); // Get Touch instance
+Scheduler& scheduler = Scheduler::getInstance();
+
+// IO0 按键中断：只负责唤醒主循环，按键逻辑仍在 loop() 中处理
+void IRAM_ATTR onButtonChange() {
+    Scheduler::wakeFromISR();
+}
 
 void setup() {
     Serial.begin(115200);
     Serial.println("Starting Novel/Comic Reader...");
 
+    // 调度器需要在主循环任务上初始化 (记录任务句柄，供中断唤醒)
+    scheduler.begin();
+
     // Initialize Touch Screen (now uses Touch class)
     touch.begin();
 
@@ -47,6 +70,9 @@ void setup() {
         while (1) delay(100);  // 停止执行
     }
 
+    // 屏幕和 SD 卡初始化完成后测量剩余内存，为各缓存分配预算 (必须在加载字体缓存之前)
+    MemoryBudget::getInstance().begin();
+
     // Display loading message and load fast font cache
     display.clear();
     display.drawCenteredText("Loading Font Cache...", 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT,1); // Changed text
@@ -60,6 +86,56 @@ void setup() {
          // delay(500); // Show message briefly
     }
     display.clear(); // Clear loading message/progress bar
+
+    // 启动后台工作线程 (快速缓存加载完成后再启动，避免与加载争用 SD 卡)
+    JobSystem::getInstance().begin();
+
+    // 串口诊断命令
+    SerialConsole &console = SerialConsole::getInstance();
+    console.registerCommand("mem", "内存统计 (按子系统/页面) 和缓存预算", [](void *, const char *) {
+        MemStats::getInstance().dump();
+        MemoryBudget::getInstance().printStats();
+        WidgetCache::getInstance().printStats();
+    });
+    console.registerCommand("jobs", "后台任务统计", [](void *, const char *) {
+        JobSystem::getInstance().printStats();
+    });
+    console.registerCommand("sd", "SD 卡读取特性 (延迟、吞吐量、选择的读取大小) 和对齐读取统计", [](void *, const char *) {
+        SdReadProfile::getInstance().printStats();
+    });
+    console.registerCommand("frames", "脏矩形合成统计 (帧数、区域数、每帧绘制面积)", [](void *, const char *) {
+        Compositor::getInstance().printStats();
+    });
+    console.registerCommand("trace", "导出区间跟踪 (Chrome trace JSON)；trace clear 清空", [](void *, const char *args) {
+        if (strcmp(args, "clear") == 0) {
+            Trace::getInstance().clear();
+            Serial.println("Trace 已清空。");
+        } else {
+            Trace::getInstance().dumpChromeJson();
+        }
+    });
+    console.registerCommand("bench", "运行基准测试 (结果以 BENCH,... 行输出)", [](void *, const char *) {
+        BenchmarkRunner::getInstance().start();
+    });
+    console.registerCommand("touchrec", "录制触摸轨迹 (从菜单开始)；touchrec stop 保存到 SD", [](void *, const char *args) {
+        TouchTrace &touchTrace = TouchTrace::getInstance();
+        if (strcmp(args, "stop") == 0) {
+            touchTrace.stopRecording(TOUCH_TRACE_PATH);
+        } else if (touchTrace.getState() == TouchTrace::State::IDLE) {
+            router.navigateTo("menu"); // 录制和回放都从同一个页面开始
+            touchTrace.startRecording(millis());
+        }
+    });
+    console.registerCommand("touchplay", "回放触摸轨迹并测量延迟 (REPLAY,... 行)；touchplay stop 中止", [](void *, const char *args) {
+        TouchTrace &touchTrace = TouchTrace::getInstance();
+        if (strcmp(args, "stop") == 0) {
+            touchTrace.stop();
+        } else if (touchTrace.getState() == TouchTrace::State::IDLE) {
+            router.navigateTo("menu");
+            touchTrace.startReplay(TOUCH_TRACE_PATH, millis());
+        }
+    });
+    console.begin();
     
     // 注册页面路由 (使用函数指针)
     router.registerPage("browser", createFileBrowserPage);
@@ -67,9 +143,17 @@ void setup() {
     router.registerPage("comic", createComicViewerPage);
     router.registerPage("text", createTextViewerPage); // Register TextViewerPage using function pointer
     router.registerPage("menu", createMenuPage);       // Register MenuPage using function pointer
+    router.registerPage("benchmark", createBenchmarkPage);
     
     // 导航到菜单页面 (设置为默认启动页面)
     router.navigateTo("menu");
+
+    // 按键按下/松开时唤醒主循环
+    attachInterrupt(digitalPinToInterrupt(BUTTON_IO0), onButtonChange, CHANGE);
+
+#if NAV_SOAK_TEST
+    NavSoak::getInstance().begin(); // 反复导航并记录最大空闲块
+#endif
     
     Serial.println("Initialization complete!");
 }
@@ -113,27 +197,31 @@ void loop() {
     }
     if (!isScreenOn)
     {
-        delay(100); // 如果屏幕关闭，延时避免过度占用CPU
+        // 屏幕关闭：只处理定时器 (例如字体缓存保存)，然后休眠到按键或下一个定时器
+        scheduler.runDueTimers();
+        uint32_t waitMs = scheduler.msUntilNextTimer();
+        if (pressStartTime > 0)
+        {
+            waitMs = std::min<uint32_t>(waitMs, BUTTON_POLL_INTERVAL_MS); // 按住期间继续检测长按
+        }
+        scheduler.waitForEvent(waitMs);
         return;
     }
 
     // Check for touch input using the Touch class
+    // While a touch trace is replaying, its events replace the touch screen (real touches are ignored)
     uint16_t touchX, touchY;
-    if (touch.getPoint(touchX, touchY)) { // getPoint now returns true if touched and provides mapped coordinates
+    TouchTrace &touchTrace = TouchTrace::getInstance();
+    bool replayed = touchTrace.nextDue(millis(), touchX, touchY);
+    unsigned long eventStartUs = micros();
+    bool touched = replayed || (!touchTrace.isReplaying() && touch.getPoint(touchX, touchY)); // getPoint now returns true if touched and provides mapped coordinates
+    if (touched) {
         Serial.println("Touch detected: (" + String(touchX) + ", " + String(touchY) + ")");
         Page *currentPage = router.getCurrentPage();
         if (currentPage)
         {
             currentPage->handleTouch(touchX, touchY);
         }
-        // Optional: Add debounce or touch release logic here if needed
-        // delay(50); // Simple debounce
-
-        // 等待触摸释放
-        //while (touch.isTouched()) {
-        //    touch.update();
-        //    delay(10);
-        //}
     }
 
     // Handle periodic tasks for the current page
@@ -141,7 +229,42 @@ void loop() {
     if (currentPage) {
         currentPage->handleLoop();
     }
+    // 一帧结束：重绘本轮标记的脏矩形 (每个区域只绘制一次)
+    router.composeFrame();
+    if (replayed) {
+        // Pages draw synchronously in handleTouch()/handleLoop(): the last pixel has been pushed
+        touchTrace.eventHandled(micros() - eventStartUs);
+    }
 
-    // 其他系统任务
-    delay(10);  // 防止过度占用CPU
+    // 执行到期的定时器
+    scheduler.runDueTimers();
+    // 定时器中的导航和重绘 (串口命令、触摸回放、基准测试、导航压力测试) 在本轮绘制，不等到下一次唤醒
+    router.composeFrame();
+
+    // 计算可以休眠多久：默认休眠到下一个定时器，由触摸/按键中断提前唤醒
+    uint32_t waitMs = scheduler.msUntilNextTimer();
+    if (Compositor::getInstance().isDirty())
+    {
+        waitMs = 0; // 绘制过程中又标记了区域：下一轮立即绘制
+    }
+    if (touched)
+    {
+        waitMs = std::min<uint32_t>(waitMs, TOUCH_POLL_INTERVAL_MS); // 手指按住时保持原来的轮询节奏
+    }
+    if (pressStartTime > 0)
+    {
+        waitMs = std::min<uint32_t>(waitMs, BUTTON_POLL_INTERVAL_MS); // 按住 IO0 时检测长按
+    }
+    waitMs = std::min<uint32_t>(waitMs, touchTrace.msUntilNextEvent(millis())); // 回放时按时注入下一个事件
+
+    if (scheduler.hasIdleWork())
+    {
+        // 有后台工作 (预取、建索引等)：把原本用于休眠的时间交给空闲任务，
+        // 有触摸/按键中断时空闲任务会立即让出
+        scheduler.runIdle(std::min<uint32_t>(waitMs * 1000UL, IDLE_WINDOW_US));
+    }
+    else
+    {
+        scheduler.waitForEvent(waitMs);
+    }
 }
@@ -1,6 +1,8 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include "panel.h" // 屏幕面板描述 (PANEL)
+
 // 字体设置
 #define TEXT_FONT 2     // 使用Font2作为默认字体
 
@@ -49,9 +51,9 @@
 #define SD_MISO 19    // SD卡SPI读数据
 #define SD_SCK  18    // SD卡SPI时钟
 
-// 屏幕尺寸
-#define SCREEN_WIDTH  320
-#define SCREEN_HEIGHT 240
+// 屏幕尺寸 (由 panel.h 中选择的面板决定)
+#define SCREEN_WIDTH  ((int)PANEL.width) // int：与原来的字面量常量类型相同 (std::min 等)
+#define SCREEN_HEIGHT ((int)PANEL.height)
 
 // 触摸屏校准参数
 #define TOUCH_MIN_X 200
@@ -61,10 +63,116 @@
 
 // 界面常量
 #define MAX_ITEMS_PER_PAGE 4    // 每页显示的最大项目数
-#define ITEM_HEIGHT 40          // 每个项目的高度
+#define ITEM_HEIGHT (PANEL.scaleY(40)) // 每个项目的高度
 #define ITEM_PADDING 5          // 项目间距
 
 // 文件系统常量
 #define INFO_FILE ".info"       // 漫画目录标识文件
 
+// 主循环 / 调度器常量
+#define LOOP_MAX_SLEEP_MS 1000            // 无事件时主循环的最长休眠时间 (兜底，防止漏掉中断)
+#define TOUCH_POLL_INTERVAL_MS 10         // 手指按住期间的触摸轮询间隔
+#define BUTTON_POLL_INTERVAL_MS 50        // IO0 按住期间的轮询间隔 (用于长按检测)
+#define IDLE_WINDOW_US 8000               // 每轮主循环最多分给空闲任务的时间 (微秒)
+#define IDLE_TASK_DEFAULT_BUDGET_US 2000  // 单个空闲任务每次调用的默认时间预算 (微秒)
+#define SCHEDULER_POST_QUEUE_LENGTH 16    // 其他任务投递到主循环的回调队列长度
+
+// 双核任务系统 (JobSystem) 常量
+#define JOB_QUEUE_LENGTH 16               // 每个工作队列的最大待处理任务数
+#define JOB_WORKER_STACK_SIZE 8192        // 工作线程栈大小 (字节)
+#define JOB_WORKER_PRIORITY 1             // 工作线程优先级 (与 Arduino loopTask 相同)
+#define JOB_IO_CORE 0                     // I/O 工作线程 (SD 读取、字体预取) 所在核心
+#define JOB_CPU_CORE 1                    // 计算工作线程 (解码、排版) 所在核心
+#define TEXT_PREFETCH_MAX_BYTES 2048      // 文本阅读器预取下一页字形时最多读取的字节数
+
+// 内存预算 (MemoryBudget) 常量
+#define MEMORY_TRANSIENT_RESERVE_BYTES 18432 // 启动时预留的临时缓冲区 (用作页面 arena 的后备内存，不小于最大的页面 arena)
+#define MEMORY_INTERNAL_HEADROOM_BYTES 65536 // 计算缓存池时为栈、SD/SPI 缓冲区等保留的内部 RAM
+#define MEMORY_CACHE_POOL_PERCENT 50         // 没有 PSRAM 时，剩余内部 RAM 中分给缓存的百分比
+#define MEMORY_PSRAM_CACHE_PERCENT 50        // 有 PSRAM 时，空闲 PSRAM 中分给缓存的百分比
+#define MEMORY_PSRAM_CACHE_SCALE 4           // 有 PSRAM 时缓存期望预算的放大倍数
+#define MEMORY_LOW_WATERMARK_BYTES 24576     // 空闲内部 RAM 低于此值时触发内存压力
+#define MEMORY_PRESSURE_SLACK_BYTES 4096     // 触发内存压力时额外释放的余量
+#define MEMORY_CHECK_INTERVAL_MS 2000        // 检查空闲内存的周期
+
+// SD 卡读取特性 (SdReadProfile：第一次打开漫画时测量，决定漫画条带和页面解码每次读取的大小)
+#define SD_SECTOR_BYTES 512                  // 扇区大小 (读取的起点和大小都对齐到扇区)
+#define SD_READ_PROBE_BYTES 16384            // 探测时大块读取的大小 (小块为一个扇区；缓冲区来自预留的临时内存)
+#define SD_READ_PROBE_ROUNDS 3               // 每种大小读取几次 (取最快的一次)
+#define SD_READ_OVERHEAD_PERCENT 10          // 每次读取的固定开销最多占读取时间的百分比
+#define SD_READ_DEFAULT_BYTES 15360          // 探测之前的读取大小 (320 宽 24 位图片 16 行，与固定条带时相同)
+#define SD_READ_MIN_BYTES 4096               // 读取大小的下限 (整屏宽度 24 位图片至少两行)
+#define SD_READ_MAX_BYTES 32768              // 读取大小的上限 (超过预留临时内存的部分来自空闲内部 RAM)
+
+// 页面 arena 大小 (每种页面一块，导航时整块释放)
+#define PAGE_ARENA_COMIC_BYTES 18432         // 漫画: 条带缓冲区 (默认读取 15 KB + 扇区对齐余量 1 KB + 1 行 RGB565；更大的读取来自临时缓冲区) + 绘制时的图片位置数组
+#define PAGE_ARENA_TEXT_BYTES 8192           // 文本: 行索引节点 (超出部分退回到堆)
+
+// 漫画翻页模式 (.info 中 "mode": "page"，每张图片缩放到一屏)
+#define COMIC_PAGE_SLOTS 3                   // 整屏页面缓冲区数 (当前页、下一页、上一页；每个 320 x 240 x 2 = 150 KB，只在有 PSRAM 时分配)
+#define COMIC_PAGE_BAND_ROWS 16              // 没有 PSRAM 时逐条带解码并推送的行数 (320 x 16 x 2 = 10 KB，来自页面 arena)
+#define COMIC_PAGE_WAIT_MS 3000              // 翻到正在后台解码的页面时最多等待的时间
+
+// 漫画缩略图网格 (点击漫画中间打开，点击缩略图跳转到该图片)
+#define COMIC_THUMB_FILE ".thumbs"           // 漫画目录下的缩略图文件 (所有缩略图打包为 RGB565 + 偏移表)
+#define COMIC_THUMB_WIDTH (PANEL.scaleX(64)) // 缩略图尺寸 (64 x 52 x 2 = 6.5 KB)
+#define COMIC_THUMB_HEIGHT (PANEL.scaleY(52))
+#define COMIC_GRID_COLUMNS 4                 // 网格每屏 4 x 3 = 12 张 (有 PSRAM 时一次读取整屏，没有时每次读取页面 arena 放得下的张数)
+#define COMIC_GRID_ROWS 3
+
+// 漫画章节连读 (同一父目录中并列的漫画目录按自然顺序衔接成一个画布)
+#define COMIC_CHAPTER_PREFETCH_SCREENS 2     // 离末尾不到 2 屏 (翻页模式为 2 页) 时在后台读取下一章的图片列表和高度
+
+// 漫画空白边距 (Q565 文件头中的内容框和空白行段表，由 tools/q565_encode.py 生成；空白行段总是跳过，不读取也不推送)
+#define COMIC_CROP_MARGINS 1                 // 1: 裁掉内容框外的空白 (滚动模式裁上下边距，太宽的图片取以内容为中心的一屏宽；翻页模式和缩略图四边都裁)；0: 按原尺寸显示
+#define COMIC_CROP_KEEP_PIXELS 8             // 裁剪时在内容框外保留的空白 (图片像素，相邻图片之间不至于紧贴)
+
+// 漫画阅读位置 (离开漫画时保存，再次打开时从同一位置继续)
+#define COMIC_POSITION_FILE ".position"      // 漫画目录下的阅读位置 (JSON：图片索引、图片内的行)
+
+// 脏矩形合成器 (Page::invalidate -> 每帧合并后重绘)
+#define COMPOSITOR_MAX_RECTS 8               // 每帧最多保留的独立区域 (超出时合并到增长最小的一个)
+#define COMPOSITOR_MERGE_WASTE_PX 1024       // 合并两个区域时允许多绘制的像素数 (每多一个区域要多走一遍绘制回调)
+#define INDEXED_CANVAS_BAND_ROWS 48          // 没有 PSRAM 时 8 位界面画布的条带行数 (320 x 48 = 15 KB；有 PSRAM 时为整屏 77 KB)
+#define INDEXED_CANVAS_FLUSH_ROWS 16         // 界面画布每次推送的行数 (展开缓冲区 320 x 16 x 2 = 10 KB，来自临时缓冲区)
+
+// 控件缓存 (WidgetCache：按钮、图标、菜单方块预渲染为 RGB565 精灵)
+#define WIDGET_CACHE_MIN_BYTES 8192          // 最少预算 (工具栏的几个按钮)
+#define WIDGET_CACHE_PREFERRED_BYTES 32768   // 期望预算 (一页菜单方块约 6 KB 一个；有 PSRAM 时按 MEMORY_PSRAM_CACHE_SCALE 放大)
+#define WIDGET_CACHE_MAX_ENTRY_BYTES 8192    // 大于此值的控件不缓存，直接绘制
+
+// 区间跟踪 (Trace)
+#define TRACE_ENABLED 1                      // 0 时 TRACE_SPAN 不产生代码
+#define TRACE_BUFFER_SIZE 512                // 环形缓冲区中的区间数 (每个 12 字节)
+
+// 串口命令台
+#define SERIAL_CONSOLE_LINE_LENGTH 64        // 命令行最大长度
+
+// 导航压力测试 (长时间反复进出页面，记录最大空闲块，检查碎片)。正常固件保持 0
+#define NAV_SOAK_TEST 0
+#define NAV_SOAK_INTERVAL_MS 1500            // 每一步导航之间的间隔
+#define NAV_SOAK_CYCLES 500                  // 循环次数 (每次循环进出每个页面一次)
+#define NAV_SOAK_MAX_DRIFT_BYTES 4096        // 最大空闲块相对第一轮下降超过此值视为失败
+#define NAV_SOAK_TEXT_PATH "/soak/soak.txt"  // 测试用文本文件 (不存在时跳过文本页面)
+#define NAV_SOAK_COMIC_PATH "/soak/comic"    // 测试用漫画目录 (不存在时跳过漫画页面)
+
+// 触摸轨迹录制/回放 (串口 touchrec / touchplay 命令)。录制和回放都从菜单页面开始
+#define TOUCH_TRACE_PATH "/trace/touch.csv"   // 轨迹文件 (每行 "时间ms,x,y"，时间相对录制开始)
+#define TOUCH_TRACE_MAX_EVENTS 2048           // 最多录制的触摸事件数 (每个 8 字节)
+
+// 基准测试 (菜单中的“基准测试”页面 / 串口 bench 命令)。参考文件不存在时跳过对应项目
+#define BENCH_REFERENCE_BOOK "/bench/book.txt" // 参考文本: SD 读取、排版吞吐量和翻页测试
+#define BENCH_REFERENCE_COMIC "/bench/comic"   // 参考漫画目录: 整屏重绘测试
+#define BENCH_SD_READ_BYTES (256 * 1024)       // 每种块大小顺序读取的字节数 (不超过文件大小)
+#define BENCH_SD_RANDOM_READS 64               // 每种块大小随机读取的次数
+#define BENCH_FONT_SAMPLE "的一是在不了有和人这中大为上个国我以要他时来用们生到作地于出就分对成会可主发年动同工也能下过子说产种面而方后多定行学法所民得经十" // 字体查找测试的字符 (64 个常用字)
+#define BENCH_FONT_HIT_REPEAT 20               // 每个字符重复命中查找的次数 (命中太快，单次测不准)
+#define BENCH_BLIT_GLYPHS 300                  // 字形绘制测试绘制的字数
+#define BENCH_LAYOUT_BYTES 8192                // 排版测试使用的文本字节数 (参考文本开头，或内置样例)
+#define BENCH_LAYOUT_PASSES 8                  // 排版测试重复次数
+#define BENCH_CONVERT_ROWS 2000               // 像素转换测试每种内核转换的整屏宽度行数
+#define BENCH_COMIC_REDRAWS 10                 // 漫画整屏重绘次数
+#define BENCH_PAGE_TURNS 20                    // 翻页脚本的翻页次数
+#define BENCH_STEP_INTERVAL_MS 300             // 导航/翻页步骤之间的间隔 (让后台预取有时间运行)
+
 #endif // CONFIG_H
@@ -0,0 +1,47 @@
+#ifndef PANEL_H // 防止头文件被重复包含
+#define PANEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 屏幕面板描述 (编译期常量)。
+ * width/height 是旋转之后的逻辑尺寸 (页面坐标系)；rotation 同时用于显示和触摸；
+ * colorOrder 和 busWidth 必须与 TFT_eSPI 的 User_Setup 一致 (tft_backend.cpp 中有编译期检查)。
+ * 页面布局以 320x240 为设计基准，scaleX()/scaleY() 把基准像素值按面板尺寸换算，
+ * 换用更大的屏幕时只需选择另一个描述，不必逐个修改页面里的像素常量。
+ */
+struct PanelDescriptor
+{
+    enum ColorOrder : uint8_t
+    {
+        RGB = 0,
+        BGR = 1
+    };
+
+    uint16_t width;        // 逻辑宽度 (旋转后)
+    uint16_t height;       // 逻辑高度 (旋转后)
+    uint8_t rotation;      // TFT_eSPI / XPT2046 的 setRotation() 参数
+    ColorOrder colorOrder; // 面板像素的颜色顺序
+    uint8_t busWidth;      // 数据总线宽度：1 = SPI，8/16 = 并口
+
+    static constexpr uint16_t REFERENCE_WIDTH = 320;  // 布局设计基准
+    static constexpr uint16_t REFERENCE_HEIGHT = 240;
+
+    // 把基准布局中的水平/垂直像素值换算到本面板
+    constexpr int scaleX(int px) const { return px * width / REFERENCE_WIDTH; }
+    constexpr int scaleY(int px) const { return px * height / REFERENCE_HEIGHT; }
+
+    // 一行整屏宽度的 BMP 数据所占字节数 (按 4 字节对齐)
+    constexpr size_t bmpRowBytes(size_t bytesPerPixel) const { return (width * bytesPerPixel + 3) & ~(size_t)3; }
+};
+
+// 编译时选择面板：默认是 ESP32-2432S028 (CYD) 板上的 2.8 寸 ILI9341；
+// 使用 3.5 寸 ILI9488 时在编译选项中定义 PANEL_ILI9488_480X320 (并相应配置 TFT_eSPI)
+#if defined(PANEL_ILI9488_480X320)
+constexpr PanelDescriptor PANEL = {480, 320, 1, PanelDescriptor::BGR, 1};
+#else
+constexpr PanelDescriptor PANEL = {320, 240, 1, PanelDescriptor::RGB, 1};
+#endif
+
+#endif // PANEL_H
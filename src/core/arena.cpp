@@ -0,0 +1,76 @@
+#include "arena.h"          // 包含 Arena 类的头文件
+#include "memory_budget.h"  // 后备内存来自 MemoryBudget 的预留临时缓冲区
+#include "mem_stats.h"      // 统计页面 arena 占用
+
+Arena::Arena() : base(nullptr), capacityBytes(0), usedBytes(0), peakBytes(0), failedCount(0)
+{
+}
+
+Arena::~Arena()
+{
+    release();
+}
+
+// 申请后备内存
+bool Arena::begin(size_t bytes)
+{
+    release();
+    if (bytes == 0)
+    {
+        return true;
+    }
+    // 页面在任意时刻只有一个，启动时预留的块通常正好空闲，因此导航不会在堆上留下新的碎片。
+    // 预留块被占用时从堆中分配同类内存 (内部 RAM，可用于 DMA)：漫画页面把 SD 读取缓冲区放在 arena 中
+    base = static_cast<uint8_t *>(MemoryBudget::getInstance().acquireTransient(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA | MALLOC_CAP_8BIT));
+    if (!base)
+    {
+        Serial.printf("Arena：申请 %u 字节失败\n", bytes);
+        return false;
+    }
+    capacityBytes = bytes;
+    MemStats::getInstance().recordAlloc(MemTag::PAGE_ARENA, bytes);
+    return true;
+}
+
+// 释放后备内存
+void Arena::release()
+{
+    if (base)
+    {
+        MemoryBudget::getInstance().releaseTransient(base);
+        MemStats::getInstance().recordFree(MemTag::PAGE_ARENA, capacityBytes);
+    }
+    base = nullptr;
+    capacityBytes = 0;
+    usedBytes = 0;
+}
+
+// 常数时间分配
+void *Arena::allocate(size_t bytes, size_t align)
+{
+    if (!base)
+    {
+        return nullptr;
+    }
+    size_t start = (usedBytes + align - 1) & ~(align - 1);
+    if (start + bytes > capacityBytes)
+    {
+        failedCount++;
+        return nullptr;
+    }
+    usedBytes = start + bytes;
+    if (usedBytes > peakBytes)
+    {
+        peakBytes = usedBytes;
+    }
+    return base + start;
+}
+
+// 回卷到之前记录的位置
+void Arena::rewind(Marker marker)
+{
+    if (marker < usedBytes)
+    {
+        usedBytes = marker;
+    }
+}
@@ -0,0 +1,144 @@
+#ifndef ARENA_H // 防止头文件被重复包含
+#define ARENA_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <new>     // ::operator new / delete (ArenaAllocator 的堆回退)
+#include "mem_stats.h" // ArenaAllocator 按标签统计容器占用
+
+/**
+ * @brief 页面级 bump (线性) 分配器。
+ * 每个 Page 持有一个 Arena，由 Router 在页面显示前按 Page::arenaSize() 申请一整块内存，
+ * 在页面销毁时整体释放。页面内部的短期对象 (绘制用的行缓冲区、索引节点等) 从中分配：
+ *  - 分配是常数时间 (指针前移 + 对齐)，单个对象不能单独释放；
+ *  - 同一页面内的碎片不会带到下一个页面，整块内存在导航时一次性归还；
+ *  - 每次绘制的临时内存用 Arena::Scope 包住，作用域结束时回卷到进入时的位置。
+ * 线程安全：只能在主循环任务中使用 (和页面本身一样)。
+ */
+class Arena
+{
+public:
+    using Marker = size_t; // 回卷位置
+
+    Arena();
+    ~Arena();
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     * @brief 申请后备内存。由 Router 在销毁旧页面之后调用，以便复用旧页面归还的内存块。
+     * @param bytes 容量 (字节)，0 表示不使用 arena。
+     * @return 申请成功 (或 bytes 为 0) 返回 true。失败时 allocate() 总是返回 nullptr。
+     */
+    bool begin(size_t bytes);
+
+    /**
+     * @brief 释放后备内存 (arena 中的所有对象同时失效)。
+     */
+    void release();
+
+    /**
+     * @brief 分配内存 (常数时间)。
+     * @param bytes 字节数。
+     * @param align 对齐 (必须是 2 的幂)。
+     * @return 内存指针；空间不足时返回 nullptr (调用方自行退回到堆分配或放弃本次操作)。
+     */
+    void *allocate(size_t bytes, size_t align = alignof(max_align_t));
+
+    /**
+     * @brief 分配 count 个 T 的数组 (不调用构造函数，适用于基本类型缓冲区)。
+     */
+    template <typename T>
+    T *allocArray(size_t count)
+    {
+        return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * @brief 判断指针是否位于本 arena 的内存块中。
+     */
+    bool owns(const void *ptr) const
+    {
+        return base && ptr >= base && ptr < base + capacityBytes;
+    }
+
+    Marker mark() const { return usedBytes; }
+    void rewind(Marker marker);
+    void reset() { rewind(0); }
+
+    size_t capacity() const { return capacityBytes; }
+    size_t used() const { return usedBytes; }
+    size_t peak() const { return peakBytes; }
+    uint32_t failedAllocations() const { return failedCount; }
+
+    /**
+     * @brief 作用域内的临时内存：构造时记录位置，析构时回卷。
+     * 用法：在 drawContent() 开头声明 `Arena::Scope scratch(arena());`。
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(Arena &arena) : owner(arena), marker(arena.mark()) {}
+        ~Scope() { owner.rewind(marker); }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Arena &owner;
+        Marker marker;
+    };
+
+private:
+    uint8_t *base;
+    size_t capacityBytes;
+    size_t usedBytes;
+    size_t peakBytes;
+    uint32_t failedCount;
+};
+
+/**
+ * @brief 让标准容器从 Arena 分配节点的分配器。
+ * arena 未启用或已满时退回到堆分配；释放 arena 中的节点是空操作 (页面销毁时整体回收)。
+ * 适合在页面生命周期内只增不减的容器，例如文本阅读器的行索引。
+ * 分配和释放按 tag 计入 MemStats (无论内存来自 arena 还是堆)。
+ */
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    ArenaAllocator(Arena *arena, MemTag tag) : arena(arena), tag(tag) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena), tag(other.tag) {}
+
+    T *allocate(size_t n)
+    {
+        MemStats::getInstance().recordAlloc(tag, n * sizeof(T));
+        void *ptr = arena ? arena->allocate(n * sizeof(T), alignof(T)) : nullptr;
+        if (!ptr)
+        {
+            ptr = ::operator new(n * sizeof(T)); // arena 已满：退回到堆
+        }
+        return static_cast<T *>(ptr);
+    }
+
+    void deallocate(T *ptr, size_t n)
+    {
+        MemStats::getInstance().recordFree(tag, n * sizeof(T));
+        if (!arena || !arena->owns(ptr))
+        {
+            ::operator delete(ptr);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+
+    Arena *arena;
+    MemTag tag;
+};
+
+#endif // ARENA_H
@@ -0,0 +1,253 @@
+#ifndef BMP_DECODER_H // 防止头文件被重复包含
+#define BMP_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "pixel_convert.h"    // BGR888 -> RGB565
+#include "../config/panel.h"  // PANEL.width (整屏宽度的行使用特化的转换)
+
+/**
+ * @brief BMP 行解码器 (只有头文件，不依赖 Arduino，主机端可直接编译)。
+ * 漫画阅读器按条带读取 BMP 的若干行，再逐行解码为 RGB565 推送到屏幕。支持的格式：
+ * - 24 位 BGR888 (BI_RGB)；
+ * - 16 位 RGB565 (BI_BITFIELDS，掩码 F800/07E0/001F)：不需要转换，直接推送文件中的数据；
+ * - 16 位 RGB555 (BI_RGB 或对应掩码的 BI_BITFIELDS)：按像素扩展为 RGB565；
+ * - 8 位和 4 位调色板 (BI_RGB)：打开图片时把调色板转换为 RGB565 表，之后每个像素查一次表。
+ * 高度为负数的 BMP 是自上而下存储的，rowOffset()/rowInChunk() 负责两种行顺序。
+ * 使用方法：parseHeader() -> (needsMasks() 时 setMasks()) -> (paletteEntries() > 0 时 setPalette()) -> decodeRow()。
+ * 假定小端 CPU (ESP32 和主机)，16 位像素可以直接按 uint16_t 读取。
+ */
+class BmpRowDecoder
+{
+public:
+    static constexpr size_t HEADER_BYTES = 54;     // 文件头 (14) + BITMAPINFOHEADER (40)
+    static constexpr uint32_t MASKS_OFFSET = 54;   // BI_BITFIELDS 的颜色掩码 (紧跟 BITMAPINFOHEADER，V4/V5 头中位置相同)
+    static constexpr size_t MASKS_BYTES = 12;
+    static constexpr size_t MAX_PALETTE_ENTRIES = 256;
+
+    enum Format : uint8_t
+    {
+        UNSUPPORTED = 0,
+        BGR888,
+        RGB565,
+        RGB555,
+        INDEXED8,
+        INDEXED4
+    };
+
+private:
+    static constexpr uint32_t BI_RGB = 0;
+    static constexpr uint32_t BI_BITFIELDS = 3;
+
+    Format format = UNSUPPORTED;
+    int32_t imageWidth = 0;
+    int32_t imageHeight = 0; // 绝对值
+    bool topDown = false;
+    uint16_t bitsPerPixel = 0;
+    uint32_t dataOffset = 0;
+    uint32_t stride = 0;        // 一行的字节数 (含 4 字节对齐填充)
+    uint32_t paletteOffset = 0; // 调色板在文件中的位置
+    uint16_t paletteCount = 0;  // 调色板项数 (非调色板格式为 0)
+    uint16_t palette565[MAX_PALETTE_ENTRIES];
+
+    static int32_t readLe32(const uint8_t *p) { return (int32_t)(p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24)); }
+    static uint16_t readLe16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+public:
+    /**
+     * @brief 解析文件开头的 HEADER_BYTES 字节。
+     * @return 签名正确且格式受支持时返回 true (BI_BITFIELDS 的 16 位图片在 setMasks() 之后才确定是 565 还是 555)。
+     */
+    bool parseHeader(const uint8_t *header)
+    {
+        format = UNSUPPORTED;
+        paletteCount = 0;
+        if (header[0] != 'B' || header[1] != 'M')
+        {
+            return false;
+        }
+        dataOffset = (uint32_t)readLe32(header + 10);
+        uint32_t infoSize = (uint32_t)readLe32(header + 14);
+        imageWidth = readLe32(header + 18);
+        int32_t height = readLe32(header + 22);
+        topDown = height < 0;
+        imageHeight = topDown ? -height : height;
+        bitsPerPixel = readLe16(header + 28);
+        uint32_t compression = (uint32_t)readLe32(header + 30);
+        uint32_t colorsUsed = (uint32_t)readLe32(header + 46);
+        if (imageWidth <= 0 || imageHeight <= 0)
+        {
+            return false;
+        }
+        stride = ((uint32_t)imageWidth * bitsPerPixel + 31) / 32 * 4;
+
+        if (bitsPerPixel == 24 && compression == BI_RGB)
+        {
+            format = BGR888;
+        }
+        else if (bitsPerPixel == 16 && compression == BI_RGB)
+        {
+            format = RGB555; // BI_RGB 的 16 位图片按定义是 X1R5G5B5
+        }
+        else if (bitsPerPixel == 16 && compression == BI_BITFIELDS)
+        {
+            format = RGB565; // 暂定，setMasks() 检查
+        }
+        else if ((bitsPerPixel == 8 || bitsPerPixel == 4) && compression == BI_RGB)
+        {
+            format = bitsPerPixel == 8 ? INDEXED8 : INDEXED4;
+            uint32_t maxEntries = 1u << bitsPerPixel;
+            paletteCount = (uint16_t)((colorsUsed == 0 || colorsUsed > maxEntries) ? maxEntries : colorsUsed);
+            paletteOffset = 14 + infoSize;
+        }
+        return format != UNSUPPORTED;
+    }
+
+    // 16 位 BI_BITFIELDS 图片需要读取 MASKS_OFFSET 处的 MASKS_BYTES 字节
+    bool needsMasks() const { return bitsPerPixel == 16 && format == RGB565; }
+
+    /**
+     * @brief 设置颜色掩码 (R, G, B 各 4 字节)；只接受 565 和 555 两种布局。
+     */
+    bool setMasks(const uint8_t *masks)
+    {
+        uint32_t red = (uint32_t)readLe32(masks);
+        uint32_t green = (uint32_t)readLe32(masks + 4);
+        uint32_t blue = (uint32_t)readLe32(masks + 8);
+        if (red == 0xF800 && green == 0x07E0 && blue == 0x001F)
+        {
+            format = RGB565;
+        }
+        else if (red == 0x7C00 && green == 0x03E0 && blue == 0x001F)
+        {
+            format = RGB555;
+        }
+        else
+        {
+            format = UNSUPPORTED;
+        }
+        return format != UNSUPPORTED;
+    }
+
+    // 调色板格式需要从 getPaletteOffset() 读取 paletteEntries() * 4 字节 (B, G, R, 保留)
+    uint16_t paletteEntries() const { return paletteCount; }
+    uint32_t getPaletteOffset() const { return paletteOffset; }
+
+    /**
+     * @brief 把 BMP 调色板转换为 RGB565 表 (每张图片一次)；缺少的项为黑色。
+     */
+    void setPalette(const uint8_t *bgra, size_t entries)
+    {
+        size_t count = entries < MAX_PALETTE_ENTRIES ? entries : MAX_PALETTE_ENTRIES;
+        for (size_t i = 0; i < count; i++, bgra += 4)
+        {
+            palette565[i] = PixelConvert::rgb565(bgra[2], bgra[1], bgra[0]);
+        }
+        for (size_t i = count; i < MAX_PALETTE_ENTRIES; i++)
+        {
+            palette565[i] = 0;
+        }
+    }
+
+    Format getFormat() const { return format; }
+    int width() const { return imageWidth; }
+    int height() const { return imageHeight; }
+    uint16_t getBitsPerPixel() const { return bitsPerPixel; }
+    uint32_t rowBytes() const { return stride; }
+
+    /**
+     * @brief 一次读取图片第 [firstRow, firstRow + rows) 行的连续数据时，数据在文件中的起始位置。
+     * 自下而上存储时这段数据的第一行是 firstRow + rows - 1。
+     */
+    uint32_t chunkOffset(int firstRow, int rows) const
+    {
+        int fileRow = topDown ? firstRow : imageHeight - (firstRow + rows);
+        return dataOffset + (uint32_t)fileRow * stride;
+    }
+
+    // 上述数据块中，图片第 firstRow + index 行位于块内第几行
+    int rowInChunk(int index, int rows) const { return topDown ? index : rows - 1 - index; }
+
+    /**
+     * @brief 解码一行像素。
+     * @param src 行数据起点 (至少 2 字节对齐：按扇区对齐读取时行起点与文件中的位置同余，常见的 54 字节文件头使 24 位图片的行起点只有 2 字节对齐)。
+     * @param dst 输出缓冲区，至少 width() 个像素。
+     * @return 要推送的 RGB565 像素：通常是 dst；RGB565 图片直接返回 src (不复制)。
+     */
+    const uint16_t *decodeRow(const uint8_t *src, uint16_t *dst) const
+    {
+        switch (format)
+        {
+        case BGR888:
+            if (imageWidth == PANEL.width)
+            {
+                PixelConvert::bgr888RowToRgb565<PANEL.width>(src, dst);
+            }
+            else
+            {
+                PixelConvert::bgr888RowToRgb565(src, dst, imageWidth);
+            }
+            return dst;
+        case RGB565:
+            return reinterpret_cast<const uint16_t *>(src);
+        case RGB555:
+        {
+            const uint16_t *in = reinterpret_cast<const uint16_t *>(src);
+            for (int32_t col = 0; col < imageWidth; col++)
+            {
+                uint16_t v = in[col];
+                dst[col] = (uint16_t)(((v & 0x7FE0) << 1) | ((v >> 4) & 0x0020) | (v & 0x001F)); // 绿色最低位复制最高位
+            }
+            return dst;
+        }
+        case INDEXED8:
+            for (int32_t col = 0; col < imageWidth; col++)
+            {
+                dst[col] = palette565[src[col]];
+            }
+            return dst;
+        case INDEXED4:
+            for (int32_t col = 0; col + 1 < imageWidth; col += 2)
+            {
+                uint8_t pair = src[col >> 1];
+                dst[col] = palette565[pair >> 4];
+                dst[col + 1] = palette565[pair & 0x0F];
+            }
+            if (imageWidth & 1)
+            {
+                dst[imageWidth - 1] = palette565[src[imageWidth >> 1] >> 4];
+            }
+            return dst;
+        default:
+            memset(dst, 0, (size_t)imageWidth * sizeof(uint16_t));
+            return dst;
+        }
+    }
+
+    // decodePanelRow() 的输出是否已是面板字节顺序 (推送时 setSwapBytes(!rowsInPanelOrder()))
+    bool rowsInPanelOrder() const { return format == BGR888; }
+
+    /**
+     * @brief 解码一行像素，直接推送到屏幕时使用：24 位图片输出面板字节顺序 (高字节在前)，
+     * 省去 TFT_eSPI 推送时逐像素交换字节；其他格式与 decodeRow() 相同 (内存顺序)。
+     */
+    const uint16_t *decodePanelRow(const uint8_t *src, uint16_t *dst) const
+    {
+        if (format != BGR888)
+        {
+            return decodeRow(src, dst);
+        }
+        if (imageWidth == PANEL.width)
+        {
+            PixelConvert::bgr888RowToPanel565<PANEL.width>(src, dst);
+        }
+        else
+        {
+            PixelConvert::bgr888RowToPanel565(src, dst, imageWidth);
+        }
+        return dst;
+    }
+};
+
+#endif // BMP_DECODER_H
@@ -0,0 +1,202 @@
+#include "bmp_scaler.h"
+#include <algorithm>        // std::min, std::max, std::fill
+#include "sdcard.h"         // 打开图片文件
+#include "jobs.h"           // JobFuture::isCancelled
+#include "memory_budget.h"  // 读取缓冲区来自启动时预留的临时内存
+#include "sd_read_profile.h" // 每次读取的大小和扇区对齐的读取
+#include "mem_stats.h"      // 按子系统统计内存
+#include "trace.h"          // 区间跟踪
+#include "../config/config.h"
+
+bool BmpScaler::decode(Request &request, JobFuture *job)
+{
+    TRACE_SPAN(TraceName::COMIC_PAGE_DECODE);
+    File file = SDCard::getInstance().openFile(request.path);
+    if (!file)
+    {
+        return false;
+    }
+    BmpRowDecoder &decoder = request.decoder;
+    // Q565 图片按行顺序解码 (缩小时跨过的整组从下一个重启点开始)，解码状态在工作线程的栈上
+    const bool coded = request.path.endsWith(Q565Decoder::FILE_EXTENSION);
+    Q565Decoder q565;
+    if (coded)
+    {
+        uint8_t header[Q565Decoder::HEADER_BYTES];
+        if (file.read(header, sizeof(header)) != sizeof(header) || !q565.parseHeader(header))
+        {
+            file.close();
+            return false;
+        }
+    }
+    else
+    {
+        uint8_t header[BmpRowDecoder::HEADER_BYTES];
+        if (file.read(header, sizeof(header)) != sizeof(header) || !decoder.parseHeader(header))
+        {
+            file.close();
+            return false;
+        }
+    }
+    if (!coded && decoder.needsMasks())
+    {
+        uint8_t masks[BmpRowDecoder::MASKS_BYTES];
+        if (!file.seek(BmpRowDecoder::MASKS_OFFSET) || file.read(masks, sizeof(masks)) != sizeof(masks) || !decoder.setMasks(masks))
+        {
+            file.close();
+            return false;
+        }
+    }
+
+    // Q565 图片裁掉内容框外的空白边距 (COMIC_CROP_MARGINS)，缩放的是裁剪后的区域
+    Q565Decoder::Window view{0, 0, q565.width(), q565.height()};
+#if COMIC_CROP_MARGINS
+    if (coded)
+    {
+        view = q565.contentWindow(COMIC_CROP_KEEP_PIXELS);
+    }
+#endif
+    const int srcWidth = coded ? view.width : decoder.width();
+    const int srcHeight = coded ? view.height : decoder.height();
+    const size_t rowBytes = coded ? 0 : decoder.rowBytes();
+    // 一次最多读取的行数：SD 卡的有效读取大小 (宽图片少读几行，缓冲区大小有上限)；Q565 按这个大小读取编码数据
+    SdReadProfile &sdProfile = SdReadProfile::getInstance();
+    const size_t readBytes = std::max(sdProfile.readBytes(srcWidth * sizeof(uint16_t)), rowBytes);
+    const int chunkRowsMax = coded ? 0 : (int)(readBytes / rowBytes);
+    const size_t rawBytes = coded ? SdReadProfile::alignedBytes(readBytes)
+                                  : std::max(SdReadProfile::alignedBytes(rowBytes * chunkRowsMax), (size_t)BmpRowDecoder::MAX_PALETTE_ENTRIES * 4);
+    const size_t workBytes = rawBytes + srcWidth * sizeof(uint16_t);
+    // 读取缓冲区在内部 RAM 中 (readBytes() 按内部 RAM 的空闲块计算大小)，不使用缓存偏好的 PSRAM
+    uint8_t *work = (uint8_t *)MemoryBudget::getInstance().acquireTransient(workBytes, SdReadProfile::BUFFER_CAPS);
+    if (!work)
+    {
+        file.close();
+        return false;
+    }
+    MemStats::Scoped workStats(MemTag::COMIC_BUFFERS, workBytes);
+    uint8_t *raw = work;
+    const uint8_t *chunk = raw; // 当前数据块的第一行 (扇区对齐读取时不在 raw 的起点)
+    uint16_t *decodedRow = (uint16_t *)(work + rawBytes); // rawBytes 是 4 的倍数
+
+    bool ok = true;
+    SdReadProfile::AlignedSource source{&file, raw};
+    int decodedSrcRow = -1; // Q565：decodedRow 中是哪一行 (放大时同一行用于多个目标行)
+    if (coded)
+    {
+        q565.setSource(SdReadProfile::fetchAligned, &source, readBytes, file.size());
+        ok = q565.readBlankRuns();
+    }
+    else if (decoder.paletteEntries() > 0)
+    {
+        size_t paletteBytes = decoder.paletteEntries() * 4;
+        ok = file.seek(decoder.getPaletteOffset()) && file.read(raw, paletteBytes) == paletteBytes;
+        if (ok)
+        {
+            decoder.setPalette(raw, decoder.paletteEntries());
+        }
+    }
+
+    // 等比例缩放到输出矩形：先按高度，放不下再按宽度
+    const int outWidth = request.width;
+    const int outHeight = request.height;
+    const uint16_t background = request.background;
+    int fitWidth, fitHeight;
+    if ((long)srcWidth * outHeight <= (long)srcHeight * outWidth)
+    {
+        fitHeight = outHeight;
+        fitWidth = std::max(1, (int)((long)srcWidth * outHeight / srcHeight));
+    }
+    else
+    {
+        fitWidth = outWidth;
+        fitHeight = std::max(1, (int)((long)srcHeight * outWidth / srcWidth));
+    }
+    const int fitX = (outWidth - fitWidth) / 2;
+    const int fitY = (outHeight - fitHeight) / 2;
+
+    int chunkFirst = -1; // raw 中数据块的第一行 (源图片行号)
+    int chunkRows = 0;
+    for (int bandY = 0; ok && bandY < outHeight; bandY += request.bandRows)
+    {
+        int rows = std::min(request.bandRows, outHeight - bandY);
+        for (int r = 0; r < rows; r++)
+        {
+            if (job && job->isCancelled())
+            {
+                ok = false;
+                break;
+            }
+            uint16_t *out = request.pixels + r * outWidth;
+            int dy = bandY + r - fitY;
+            if (dy < 0 || dy >= fitHeight)
+            {
+                std::fill(out, out + outWidth, background); // 上下留白
+                continue;
+            }
+
+            int srcRow = (int)((long)dy * srcHeight / fitHeight);
+            const uint16_t *src;
+            if (coded && q565.blankRowsFrom(view.y + srcRow) > 0)
+            {
+                // 空白行：不解码，直接填背景色
+                std::fill(out, out + fitX, background);
+                std::fill(out + fitX, out + fitX + fitWidth, q565.background());
+                std::fill(out + fitX + fitWidth, out + outWidth, background);
+                continue;
+            }
+            if (coded)
+            {
+                if (srcRow != decodedSrcRow)
+                {
+                    if (!q565.seekRow(view.y + srcRow) || !q565.decodeRow(decodedRow, view.x, view.width))
+                    {
+                        ok = false;
+                        break;
+                    }
+                    decodedSrcRow = srcRow;
+                }
+                src = decodedRow;
+            }
+            else
+            {
+                if (srcRow < chunkFirst || srcRow >= chunkFirst + chunkRows)
+                {
+                    // 读取从 srcRow 开始、覆盖后续目标行的一段连续源行 (缩小时中间跳过的行也在这一段内)
+                    int lastRow = srcRow;
+                    for (int next = dy + 1; next < fitHeight; next++)
+                    {
+                        int row = (int)((long)next * srcHeight / fitHeight);
+                        if (row - srcRow >= chunkRowsMax)
+                        {
+                            break;
+                        }
+                        lastRow = row;
+                    }
+                    chunkFirst = srcRow;
+                    chunkRows = lastRow - srcRow + 1;
+                    chunk = sdProfile.readAligned(file, decoder.chunkOffset(chunkFirst, chunkRows), chunkRows * rowBytes, raw);
+                    if (!chunk)
+                    {
+                        ok = false;
+                        break;
+                    }
+                }
+                src = decoder.decodeRow(chunk + decoder.rowInChunk(srcRow - chunkFirst, chunkRows) * rowBytes, decodedRow);
+            }
+            std::fill(out, out + fitX, background);
+            for (int dx = 0; dx < fitWidth; dx++)
+            {
+                out[fitX + dx] = src[(long)dx * srcWidth / fitWidth];
+            }
+            std::fill(out + fitX + fitWidth, out + outWidth, background);
+        }
+        if (ok && request.bandDone)
+        {
+            request.bandDone(request.ctx, bandY, rows, request.pixels);
+        }
+    }
+
+    MemoryBudget::getInstance().releaseTransient(work);
+    file.close();
+    return ok;
+}
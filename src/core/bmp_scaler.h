@@ -0,0 +1,51 @@
+#ifndef BMP_SCALER_H // 防止头文件被重复包含
+#define BMP_SCALER_H
+
+#include <Arduino.h>
+#include "bmp_decoder.h" // 行解码 (各种 BMP 格式)
+#include "q565.h"        // Q565 图片 (按扩展名区分)
+
+class JobFuture;
+
+/**
+ * @brief 把一张 BMP 或 Q565 图片等比例缩放 (最近邻) 到指定大小的矩形中，居中并用背景色填充四周。
+ * 翻页模式用它生成整屏页面，缩略图网格用它生成缩略图。
+ * 只读取实际用到的源图片行：每次从 SD 连续读取覆盖后续若干目标行的一段 (不超过 SdReadProfile 选择的读取大小，起点对齐到扇区)。
+ * Q565 图片逐行解码，缩小时跨过的整组直接从下一个重启点开始；空白行段不解码，内容框外的边距按 COMIC_CROP_MARGINS 裁掉。
+ * 可在 JobSystem 工作线程上执行 (不调用 Display；job 不为空时定期检查取消)。
+ */
+class BmpScaler
+{
+public:
+    /**
+     * @brief 一次缩放的参数。后台任务拥有它 (由任务的释放函数 delete)；直接绘制时在堆上创建。
+     */
+    struct Request
+    {
+        String path;       // 工作线程打开自己的 File (File 对象不能跨任务共享)
+        uint16_t *pixels;  // 输出：bandRows 行，每行 width 个 RGB565 像素
+        int width;         // 输出尺寸
+        int height;
+        int bandRows;      // 整幅缓冲区时等于 height
+        uint16_t background; // 留白颜色
+        // 每解码完一个条带调用一次 (直接绘制时推送到屏幕；整幅缓冲区时为 nullptr)
+        void (*bandDone)(void *ctx, int y, int rows, const uint16_t *pixels);
+        void *ctx;
+        BmpRowDecoder decoder; // 每个请求一个解码器 (调色板表在后台任务中建立)
+
+        Request(const String &path, uint16_t *pixels, int width, int height)
+            : path(path), pixels(pixels), width(width), height(height), bandRows(height), background(0xFFFF),
+              bandDone(nullptr), ctx(nullptr)
+        {
+        }
+    };
+
+    /**
+     * @brief 按 request 缩放解码一张图片，逐条带写入 request.pixels。
+     * @param job 在工作线程上执行时为当前任务 (用于检查取消)，直接调用时为 nullptr。
+     * @return 完整解码返回 true；文件错误、内存不足或被取消返回 false。
+     */
+    static bool decode(Request &request, JobFuture *job);
+};
+
+#endif // BMP_SCALER_H
@@ -0,0 +1,201 @@
+#include "compositor.h"
+#include <algorithm> // std::min / std::max
+#include "display.h"        // 裁剪区 (Display::setClip)
+#include "indexed_canvas.h" // 界面页面的 8 位画布
+#include "memory_budget.h"  // 是否有 PSRAM (决定画布是整屏还是条带)
+#include "trace.h"          // 区间跟踪
+
+Compositor *Compositor::instance = nullptr;
+
+DirtyRect DirtyRect::unite(const DirtyRect &a, const DirtyRect &b)
+{
+    int16_t x0 = std::min(a.x, b.x);
+    int16_t y0 = std::min(a.y, b.y);
+    int16_t x1 = std::max(a.right(), b.right());
+    int16_t y1 = std::max(a.bottom(), b.bottom());
+    return {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+}
+
+DirtyRect DirtyRect::intersect(const DirtyRect &a, const DirtyRect &b)
+{
+    int16_t x0 = std::max(a.x, b.x);
+    int16_t y0 = std::max(a.y, b.y);
+    int16_t x1 = std::min(a.right(), b.right());
+    int16_t y1 = std::min(a.bottom(), b.bottom());
+    if (x1 <= x0 || y1 <= y0)
+    {
+        return {0, 0, 0, 0};
+    }
+    return {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+}
+
+Compositor::Compositor()
+    : rectCount(0), indexedCanvas(nullptr), framesComposed(0), rectsPainted(0), pixelsPainted(0), bandsFlushed(0)
+{
+}
+
+Compositor &Compositor::getInstance()
+{
+    if (!instance)
+    {
+        instance = new Compositor();
+    }
+    return *instance;
+}
+
+void Compositor::invalidate(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    static const DirtyRect screen = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+    DirtyRect rect = DirtyRect::intersect({x, y, w, h}, screen);
+    if (!rect.isEmpty())
+    {
+        add(rect);
+    }
+}
+
+void Compositor::add(DirtyRect rect)
+{
+    // 与已有区域合并：外包矩形中两者都不覆盖的面积 (多绘制的像素) 不超过阈值时合并，
+    // 合并后的矩形可能又能与其他区域合并，所以从头再找一遍
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (uint8_t i = 0; i < rectCount; i++)
+        {
+            DirtyRect united = DirtyRect::unite(rects[i], rect);
+            int32_t covered = rects[i].area() + rect.area() - DirtyRect::intersect(rects[i], rect).area();
+            if (united.area() - covered <= COMPOSITOR_MERGE_WASTE_PX)
+            {
+                rect = united;
+                rects[i] = rects[--rectCount]; // 移除旧区域，合并结果重新参与合并
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    if (rectCount < COMPOSITOR_MAX_RECTS)
+    {
+        rects[rectCount++] = rect;
+        return;
+    }
+
+    // 列表已满：合并到外包矩形面积增长最小的区域
+    uint8_t best = 0;
+    int32_t bestGrowth = INT32_MAX;
+    for (uint8_t i = 0; i < rectCount; i++)
+    {
+        int32_t growth = DirtyRect::unite(rects[i], rect).area() - rects[i].area();
+        if (growth < bestGrowth)
+        {
+            best = i;
+            bestGrowth = growth;
+        }
+    }
+    DirtyRect united = DirtyRect::unite(rects[best], rect);
+    rects[best] = rects[--rectCount];
+    add(united); // 外包矩形变大后可能覆盖其他区域
+}
+
+void Compositor::compose(PaintCallback paint, void *ctx, bool indexed)
+{
+    if (!indexed && indexedCanvas)
+    {
+        releaseIndexedCanvas(); // 切换到了不使用画布的页面 (阅读器)，把内存还给缓存
+    }
+    if (rectCount == 0)
+    {
+        return;
+    }
+    TRACE_SPAN(TraceName::COMPOSE_FRAME);
+
+    // 先取出本帧的区域：绘制回调中新标记的区域留到下一帧
+    DirtyRect frame[COMPOSITOR_MAX_RECTS];
+    uint8_t count = rectCount;
+    std::copy(rects, rects + count, frame);
+    rectCount = 0;
+
+    Display &display = Display::getInstance();
+    bool useCanvas = indexed && ensureIndexedCanvas();
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (useCanvas)
+        {
+            composeIndexed(frame[i], paint, ctx);
+        }
+        else
+        {
+            display.setClip(frame[i].x, frame[i].y, frame[i].w, frame[i].h);
+            paint(ctx, frame[i]);
+        }
+        pixelsPainted += frame[i].area();
+    }
+    if (!useCanvas)
+    {
+        display.clearClip();
+    }
+    framesComposed++;
+    rectsPainted += count;
+}
+
+bool Compositor::ensureIndexedCanvas()
+{
+    if (indexedCanvas)
+    {
+        return true;
+    }
+    int16_t rows = MemoryBudget::getInstance().hasPsram() ? SCREEN_HEIGHT : INDEXED_CANVAS_BAND_ROWS;
+    indexedCanvas = new IndexedCanvas(Display::getInstance().getTFT(), SCREEN_WIDTH, rows);
+    if (!indexedCanvas->create())
+    {
+        Serial.println("Compositor：8 位画布分配失败，直接绘制到屏幕。");
+        delete indexedCanvas;
+        indexedCanvas = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void Compositor::releaseIndexedCanvas()
+{
+    delete indexedCanvas;
+    indexedCanvas = nullptr;
+}
+
+void Compositor::composeIndexed(const DirtyRect &rect, PaintCallback paint, void *ctx)
+{
+    Display &display = Display::getInstance();
+    IndexedCanvas &canvas = *indexedCanvas;
+    canvas.setSwapBytes(display.getTFT()->getSwapBytes()); // 自定义字体按屏幕的字节序推送
+    int16_t rows = canvas.getBandRows();
+
+    // 条带从 rows 的整数倍开始，区域按条带切开，每个条带绘制一次、推送一次
+    for (int16_t bandY = rect.y / rows * rows; bandY < rect.bottom(); bandY += rows)
+    {
+        DirtyRect part = DirtyRect::intersect(rect, {0, bandY, SCREEN_WIDTH, rows});
+        if (part.isEmpty())
+        {
+            continue;
+        }
+        canvas.setBand(bandY);
+        if (!display.beginOffscreen(&canvas))
+        {
+            continue;
+        }
+        display.setClip(part.x, part.y, part.w, part.h);
+        paint(ctx, part);
+        display.clearClip();
+        display.endOffscreen();
+        canvas.flush();
+        bandsFlushed++;
+    }
+}
+
+void Compositor::printStats() const
+{
+    Serial.printf("Compositor：%lu 帧，%lu 个区域，平均每帧 %lu 像素；8 位画布推送 %lu 个条带 (%s)\n",
+                  (unsigned long)framesComposed, (unsigned long)rectsPainted,
+                  (unsigned long)(framesComposed ? pixelsPainted / framesComposed : 0), (unsigned long)bandsFlushed,
+                  indexedCanvas ? "已分配" : "未分配");
+}
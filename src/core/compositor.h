@@ -0,0 +1,124 @@
+#ifndef COMPOSITOR_H // 防止头文件被重复包含
+#define COMPOSITOR_H
+
+#include <Arduino.h>
+#include "../config/config.h" // COMPOSITOR_MAX_RECTS, COMPOSITOR_MERGE_WASTE_PX, 屏幕尺寸
+
+class IndexedCanvas;
+
+/**
+ * @brief 屏幕上的矩形区域 (像素)。
+ */
+struct DirtyRect
+{
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+
+    int16_t right() const { return x + w; }   // 右边界 (不含)
+    int16_t bottom() const { return y + h; }  // 下边界 (不含)
+    int32_t area() const { return (int32_t)w * h; }
+    bool isEmpty() const { return w <= 0 || h <= 0; }
+
+    // 是否与 (rx, ry, rw, rh) 相交
+    bool intersects(int16_t rx, int16_t ry, int16_t rw, int16_t rh) const
+    {
+        return rx < right() && rx + rw > x && ry < bottom() && ry + rh > y;
+    }
+    bool intersects(const DirtyRect &other) const { return intersects(other.x, other.y, other.w, other.h); }
+    bool contains(const DirtyRect &other) const
+    {
+        return other.x >= x && other.y >= y && other.right() <= right() && other.bottom() <= bottom();
+    }
+    // 同时包含两个矩形的最小矩形
+    static DirtyRect unite(const DirtyRect &a, const DirtyRect &b);
+    // 两个矩形的交集 (不相交时为空)
+    static DirtyRect intersect(const DirtyRect &a, const DirtyRect &b);
+};
+
+/**
+ * @brief 脏矩形合成器单例类。
+ * 页面不再在状态变化时直接清屏重绘，而是调用 Page::invalidate() 标记需要重绘的区域；
+ * 主循环每一轮 (一帧) 结束时由 Router::composeFrame() 调用 compose()，把合并后的每个区域
+ * 设置为裁剪区 (Display::setClip) 后交给页面的绘制回调，每个区域只绘制一次。
+ * 合并规则：两个矩形的外包矩形多出的面积不超过 COMPOSITOR_MERGE_WASTE_PX 时合并 (相邻的列表行、
+ * 内容区和旁边的滚动条等)，否则分开绘制；区域数达到 COMPOSITOR_MAX_RECTS 时合并到外包矩形增长最小的一个。
+ * 界面页面 (Page::usesIndexedCanvas()) 的区域先画到 8 位调色板画布 (IndexedCanvas) 中再整块推送：
+ * 屏幕上看不到先清空再绘制的中间状态，每个区域只有几次大的推送。没有 PSRAM 时画布只有
+ * INDEXED_CANVAS_BAND_ROWS 行，区域按条带切开，每个条带调用一次绘制回调；画布分配失败时直接绘制到屏幕。
+ * 线程安全：只能在主循环任务中调用 (与 Display 相同)。
+ */
+class Compositor
+{
+public:
+    /**
+     * @brief 绘制回调类型。调用时绘图已被裁剪到 clip，回调只需绘制与 clip 相交的元素 (先用背景色填充 clip)。
+     * @param ctx 调用 compose() 时传入的上下文指针。
+     * @param clip 需要重绘的区域。
+     */
+    using PaintCallback = void (*)(void *ctx, const DirtyRect &clip);
+
+private:
+    static Compositor *instance;
+    DirtyRect rects[COMPOSITOR_MAX_RECTS]; // 本帧待重绘的区域 (互不满足合并条件)
+    uint8_t rectCount;
+
+    IndexedCanvas *indexedCanvas; // 界面页面的 8 位画布 (第一次使用时创建)
+
+    // 统计信息
+    uint32_t framesComposed;   // 有重绘区域的帧数
+    uint32_t rectsPainted;     // 绘制的区域数
+    uint64_t pixelsPainted;    // 绘制的区域总面积
+    uint32_t bandsFlushed;     // 经 8 位画布推送的条带数
+
+    Compositor();
+
+    // 把 rect 加入列表，并与可以合并的区域反复合并
+    void add(DirtyRect rect);
+
+    // 创建 8 位画布 (有 PSRAM 时整屏，否则一个条带)，失败返回 false
+    bool ensureIndexedCanvas();
+
+    // 在 8 位画布上逐条带绘制一个区域并推送
+    void composeIndexed(const DirtyRect &rect, PaintCallback paint, void *ctx);
+
+public:
+    Compositor(const Compositor &) = delete;
+    Compositor &operator=(const Compositor &) = delete;
+
+    static Compositor &getInstance();
+
+    /**
+     * @brief 标记一个区域需要在本帧结束时重绘 (超出屏幕的部分被裁掉)。
+     */
+    void invalidate(int16_t x, int16_t y, int16_t w, int16_t h);
+
+    // 标记整个屏幕需要重绘
+    void invalidateAll() { invalidate(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT); }
+
+    /**
+     * @brief 丢弃所有待重绘的区域 (Router 切换页面时调用，旧页面的区域不再有意义)。
+     */
+    void discard() { rectCount = 0; }
+
+    // 本帧是否有待重绘的区域
+    bool isDirty() const { return rectCount > 0; }
+
+    /**
+     * @brief 合成一帧：依次把每个待重绘区域设为裁剪区并调用 paint。
+     * 先清空列表再绘制，所以绘制过程中新标记的区域留到下一帧。
+     * @param indexed 为 true 时经 8 位画布绘制；为 false 时释放之前创建的画布 (页面不再需要它)。
+     */
+    void compose(PaintCallback paint, void *ctx, bool indexed = false);
+
+    // 释放 8 位画布
+    void releaseIndexedCanvas();
+
+    /**
+     * @brief 通过串口输出统计信息 (帧数、区域数、平均每帧绘制面积)。
+     */
+    void printStats() const;
+};
+
+#endif // COMPOSITOR_H
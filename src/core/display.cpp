@@ -1,15 +1,28 @@
 #include <Arduino.h> // 引入 Arduino 核心库
 #include "display.h" // 引入显示头文件
+#include "trace.h"   // 区间跟踪
+#ifdef ARDUINO
+#include "tft_backend.h" // 设备：TFT_eSPI 屏幕
+#else
+#include "framebuffer_backend.h" // 主机：内存帧缓冲
+#endif
 
 // 静态成员初始化
 Display *Display::instance = nullptr;
 
 // 构造函数（私有，单例模式）
-Display::Display()
+Display::Display() : clipX(0), clipY(0), clipW(0), clipH(0), offscreenDepth(0)
 {
-    // 初始化 TFT 屏幕
+#ifdef ARDUINO
+    backend = new TftBackend();
+#else
+    backend = new FramebufferBackend(SCREEN_WIDTH, SCREEN_HEIGHT);
+#endif
+    DisplayBackend &tft = *backend;
+
+    // 初始化 TFT 屏幕 (同时打开背光)
     tft.init();
-    tft.setRotation(1);        // 设置屏幕为横屏模式
+    tft.setRotation(PANEL.rotation); // 设置屏幕方向 (横屏，见 panel.h)
     tft.fillScreen(TFT_BLACK); // 全屏填充黑色，清屏
 
     // 文本颜色配置：白色文字，黑色背景
@@ -17,10 +30,6 @@ Display::Display()
     tft.setTextSize(1);         // 设置基础字体大小（缩放因子）
     tft.setTextFont(2);         // 设置字体为 Font2（16 像素高）
     tft.setTextDatum(MC_DATUM); // 设置文本居中对齐（用于居中绘制）
-
-    // 设置背光引脚为输出，并打开背光
-    pinMode(TFT_BL, OUTPUT);
-    digitalWrite(TFT_BL, HIGH); // 打开背光
 }
 
 // 获取单例实例
@@ -42,15 +51,69 @@ void Display::begin()
 // 清除屏幕内容（填充黑色）
 void Display::clear()
 {
-    tft.fillScreen(TFT_BLACK);
+    backend->fillScreen(TFT_BLACK);
+}
+
+// 设置裁剪区
+void Display::setClip(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    clipX = x;
+    clipY = y;
+    clipW = w;
+    clipH = h;
+    backend->setClipRect(x, y, w, h);
+}
+
+// 取消裁剪区
+void Display::clearClip()
+{
+    clipW = 0;
+    backend->clearClipRect();
+}
+
+// 把绘图重定向到离屏画布
+bool Display::beginOffscreen(DisplayBackend *canvas)
+{
+    if (!canvas || offscreenDepth >= OFFSCREEN_MAX_DEPTH)
+    {
+        return false;
+    }
+    offscreenStack[offscreenDepth++] = {backend, clipX, clipY, clipW, clipH};
+    backend = canvas;
+    clipW = 0;
+    return true;
+}
+
+// 恢复之前的后端和裁剪区 (之前后端的裁剪区在离屏期间没有改变)
+void Display::endOffscreen()
+{
+    if (offscreenDepth == 0)
+    {
+        return;
+    }
+    const OffscreenState &saved = offscreenStack[--offscreenDepth];
+    backend = saved.backend;
+    clipX = saved.clipX;
+    clipY = saved.clipY;
+    clipW = saved.clipW;
+    clipH = saved.clipH;
 }
 
 // 绘制单个字符（根据是否 ASCII 决定使用内建字体或自定义点阵）
 void Display::drawCharacter(const char *character, uint16_t x, uint16_t y, uint8_t size, bool useCustomFont)
 {
-    if (!useCustomFont || Font::isAscii(character))
+    bool builtIn = !useCustomFont || Font::isAscii(character);
+    // 字符格完全在裁剪区外：跳过 (省去字形查找)。内建 Font2 是比例字体，宽度按不超过 16 像素估计
+    uint16_t cell = 16 * size;
+    if (clipW > 0 && (x >= clipX + clipW || x + cell <= clipX || y >= clipY + clipH || y + cell <= clipY))
+    {
+        return;
+    }
+
+    if (builtIn)
     {
         // ASCII 字符使用 TFT 内建字体绘制
+        DisplayBackend &tft = *backend;
         tft.setTextFont(TEXT_FONT);
         tft.setTextSize(size);
         tft.setTextColor(TFT_WHITE, TFT_BLACK);
@@ -61,38 +124,44 @@ void Display::drawCharacter(const char *character, uint16_t x, uint16_t y, uint8
 
     // 使用自定义字体渲染非 ASCII 字符（如中文）
     Font &font = Font::getInstance();
-    uint8_t *bitmap = font.getCharacterBitmap(character, size * 16); // 获取字符点阵（单位像素）
-    if (!bitmap)
+    Font::Guard fontGuard; // 持锁直到点阵转换完成，防止工作线程的预取覆盖或淘汰该点阵
+    size_t recordBytes = 0;
+    uint8_t *record = font.getCharacterBitmap(character, size * 16, &recordBytes); // 获取字形记录（单位像素）
+    GlyphBitmap glyph;
+    if (!record || !glyph.parse(record, recordBytes, size * 16))
     {
         return; // 获取失败则跳过绘制
     }
 
-    // 字符宽高均为 size * 16（保证统一比例）
-    uint16_t fontWidth = size * 16;
-    uint16_t fontHeight = size * 16;
-    uint16_t byteWidth = (fontWidth + 7) / 8; // 每行占用的字节数（按位对齐）
+    // 只推送墨迹的外接矩形 (字符格中其余部分是空白)；空白字形 (例如全角空格) 不推送
+    if (glyph.width == 0)
+    {
+        return;
+    }
+    uint16_t glyphWidth = glyph.width;
+    uint16_t glyphHeight = glyph.height;
 
     // 创建颜色位图缓冲区（用于存储转换后的 RGB565 数据）
-    uint16_t *colorBitmap = new uint16_t[fontWidth * fontHeight];
+    uint16_t *colorBitmap = new uint16_t[glyphWidth * glyphHeight];
     if (!colorBitmap)
     {
         return; // 内存分配失败
     }
 
-    // 将黑白点阵数据转换为彩色位图（RGB565）
-    for (uint16_t py = 0; py < fontHeight; py++)
+    // 将黑白点阵数据转换为彩色位图（RGB565）：位流中矩形的每行相隔 stride 位 (裁剪后的记录中行与行紧挨着)
+    uint16_t *out = colorBitmap;
+    for (uint16_t py = 0; py < glyphHeight; py++)
     {
-        for (uint16_t px = 0; px < fontWidth; px++)
+        size_t bit = glyph.firstBit + (size_t)py * glyph.stride;
+        for (uint16_t px = 0; px < glyphWidth; px++, bit++)
         {
-            uint16_t byteIndex = (py * byteWidth) + (px / 8);                      // 获取对应字节
-            uint8_t bitIndex = px % 8;                                             // 获取在该字节中的位位置
-            bool isPixelSet = (bitmap[byteIndex] & (1 << bitIndex));               // 判断该像素是否为前景色
-            colorBitmap[py * fontWidth + px] = isPixelSet ? TFT_WHITE : TFT_BLACK; // 白字黑底
+            bool isPixelSet = (glyph.bits[bit >> 3] >> (bit & 7)) & 1; // 判断该像素是否为前景色
+            *out++ = isPixelSet ? TFT_WHITE : TFT_BLACK;               // 白字黑底
         }
     }
 
-    // 将整块字符图像一次性绘制到屏幕上（优化性能）
-    tft.pushImage(x, y, fontWidth, fontHeight, colorBitmap);
+    // 将墨迹矩形一次性绘制到字符格中的位置（优化性能）
+    backend->pushImage(x + glyph.x, y + glyph.y, glyphWidth, glyphHeight, colorBitmap);
 
     // 释放动态分配的内存
     delete[] colorBitmap;
@@ -101,6 +170,7 @@ void Display::drawCharacter(const char *character, uint16_t x, uint16_t y, uint8
 // 绘制整段文字，支持自定义字体与 ASCII 判断
 void Display::drawText(const char *text, uint16_t x, uint16_t y, uint8_t size, bool useCustomFont)
 {
+    TRACE_SPAN(TraceName::DISPLAY_DRAW_TEXT);
     size_t offset = 0;
     uint16_t curX = x;
 
@@ -152,10 +222,10 @@ void Display::drawCenteredText(const char *text, uint16_t x, uint16_t y, uint16_
         totalWidth += charWidth - size / 4;
     }
 
-    // 根据区域和总宽度计算起始坐标，实现居中效果
+    // 根据区域和总宽度计算起始坐标，实现居中效果 (文本比区域大时从区域左上角开始，不会画到区域上方或左侧)
     uint16_t charHeight = size * 16;
-    uint16_t startX = x + (w - totalWidth) / 2;
-    uint16_t startY = y + (h - charHeight) / 2;
+    uint16_t startX = totalWidth < w ? x + (w - totalWidth) / 2 : x;
+    uint16_t startY = charHeight < h ? y + (h - charHeight) / 2 : y;
 
     drawText(text, startX, startY, size, useCustomFont); // 实际绘制
 }
@@ -167,6 +237,8 @@ void Display::drawProgressBar(uint16_t x, uint16_t y, uint16_t w, uint16_t h, ui
     if (progress > 100)
         progress = 100;
 
+    DisplayBackend &tft = *backend;
+
     // 绘制边框
     tft.drawRect(x, y, w, h, outlineColor);
 
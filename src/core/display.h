@@ -1,21 +1,35 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
-#include <TFT_eSPI.h>         // 主图形库，用于驱动 TFT 屏幕
-#include <SPI.h>              // TFT_eSPI 依赖的 SPI 通信库
+#include <TFT_eSPI.h>         // 颜色常量 (TFT_WHITE 等)
 #include "../config/config.h" // 包含屏幕尺寸和引脚定义（通过 User_Setup.h 间接配置）
 #include "font.h"             // 自定义字体渲染支持
+#include "display_backend.h"  // 显示后端接口 (TFT 屏幕或内存帧缓冲)
 
 /**
  * @brief 单例类，用于管理 TFT 显示屏。
- * 提供基础的绘图功能和对底层 TFT_eSPI 对象的访问。
+ * 提供基础的绘图功能和对底层显示后端 (DisplayBackend) 的访问。
+ * 设备上后端为 TftBackend (TFT_eSPI)；主机上 (未定义 ARDUINO) 默认为 FramebufferBackend，可用 setBackend() 替换。
  * UI 相关的绘图（如按钮、图标）应由 Page 类处理。
+ * 线程安全：屏幕 SPI 总线只属于主循环，所有方法只能在主循环任务中调用，
+ * JobSystem 的任务不能绘图 (只能准备数据，由主循环在 handleLoop 中推送到屏幕)。
  */
 class Display
 {
 private:
     static Display *instance; // 单例指针实例
-    TFT_eSPI tft;             // TFT_eSPI 显示对象，用于所有图形操作
+    DisplayBackend *backend;  // 显示后端，用于所有图形操作
+    // 当前裁剪区 (Compositor 绘制脏矩形时设置)；clipW 为 0 表示没有裁剪
+    int16_t clipX, clipY, clipW, clipH;
+    // beginOffscreen() 保存的后端和裁剪区 (合成画布中还会再渲染控件精灵，所以最多嵌套两层)
+    struct OffscreenState
+    {
+        DisplayBackend *backend;
+        int16_t clipX, clipY, clipW, clipH;
+    };
+    static constexpr uint8_t OFFSCREEN_MAX_DEPTH = 2;
+    OffscreenState offscreenStack[OFFSCREEN_MAX_DEPTH];
+    uint8_t offscreenDepth;
 
     Display(); // 构造函数私有化，确保单例模式
 
@@ -41,8 +55,36 @@ public:
     // 绘制进度条（含边框、填充和背景）
     void drawProgressBar(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t progress, uint16_t outlineColor = TFT_WHITE, uint16_t barColor = TFT_GREEN, uint16_t bgColor = TFT_BLACK);
 
-    // 获取底层的 TFT_eSPI 对象，用于更复杂的绘图操作
-    TFT_eSPI *getTFT() { return &tft; }
+    /**
+     * @brief 设置裁剪区：之后的绘图只修改该矩形内的像素。
+     * 完全落在裁剪区外的字符直接跳过 (不查找字形，也不读取 SD 卡)。
+     */
+    void setClip(int16_t x, int16_t y, int16_t w, int16_t h);
+
+    // 取消裁剪区
+    void clearClip();
+
+    // 获取底层的显示后端 (接口与 TFT_eSPI 相同)，用于更复杂的绘图操作
+    DisplayBackend *getTFT() { return backend; }
+
+    /**
+     * @brief 替换显示后端 (例如主机端渲染到指定的帧缓冲)。不接管所有权，也不释放原后端。
+     * 新后端需要已经初始化；之后的绘图都发送到新后端。
+     */
+    void setBackend(DisplayBackend *newBackend) { backend = newBackend; }
+
+    /**
+     * @brief 把之后的绘图 (包括 drawText 和 getTFT() 返回的后端) 重定向到离屏画布 (DisplayBackend::createCanvas())。
+     * 开始时没有裁剪区。成功时必须调用 endOffscreen() 恢复，最多嵌套 OFFSCREEN_MAX_DEPTH 层。
+     * @return 嵌套过深或 canvas 为 nullptr 时返回 false (绘图仍然发送到原来的后端)。
+     */
+    bool beginOffscreen(DisplayBackend *canvas);
+
+    // 结束离屏绘制，恢复之前的后端和裁剪区
+    void endOffscreen();
+
+    // 是否正在绘制到离屏画布
+    bool isOffscreen() const { return offscreenDepth > 0; }
 
     // 获取屏幕宽度
     uint16_t width() const { return SCREEN_WIDTH; }
@@ -0,0 +1,76 @@
+#ifndef DISPLAY_BACKEND_H
+#define DISPLAY_BACKEND_H
+
+#include <Arduino.h> // String
+#include <cstdint>
+
+/**
+ * @brief 显示后端接口：Display 和各页面的所有绘图都通过它完成。
+ * 实现：
+ *  - TftBackend：设备上的 TFT_eSPI 屏幕 (SPI)，只在 ARDUINO 下编译。
+ *  - FramebufferBackend：内存中的 RGB565 帧缓冲，统计推送的像素/SPI 事务/窗口数并能导出 PNG，
+ *    用于主机端渲染页面 (tools/host_bench 的黄金图像检查和每次翻页的绘制量)。
+ * 方法名、参数和语义与 TFT_eSPI 相同 (颜色为 RGB565，文本使用内建字体编号和对齐方式 *_DATUM)，
+ * 所以页面代码通过 Display::getTFT() 绘图时不依赖具体后端。
+ * 线程安全：与 Display 相同，只能在主循环任务中调用。
+ */
+class DisplayBackend
+{
+public:
+    virtual ~DisplayBackend() {}
+
+    // 初始化硬件 (帧缓冲为空操作)
+    virtual void init() = 0;
+    // 屏幕方向 (0-3，与 TFT_eSPI 相同)
+    virtual void setRotation(uint8_t rotation) = 0;
+
+    virtual int16_t width() const = 0;
+    virtual int16_t height() const = 0;
+
+    // 裁剪区：之后的所有绘图 (包括 pushImage 和文本) 只修改该矩形内的像素，坐标仍然是屏幕坐标
+    // (TFT_eSPI 的 setViewport(x, y, w, h, false))
+    virtual void setClipRect(int32_t x, int32_t y, int32_t w, int32_t h) = 0;
+    // 取消裁剪区 (恢复为整个屏幕)
+    virtual void clearClipRect() = 0;
+
+    /**
+     * @brief 创建一块 w x h 的离屏画布：绘图调用相同 (包括内建字体)，但画到内存中，用 readRect() 取出像素。
+     * 设备上为 TFT_eSprite (有 PSRAM 时分配在 PSRAM)，帧缓冲后端为另一块帧缓冲 (不计入屏幕的统计)。
+     * @return 画布，由调用者 delete；内存不足时返回 nullptr。
+     */
+    virtual DisplayBackend *createCanvas(int16_t w, int16_t h) = 0;
+
+    // --- 图形 ---
+    virtual void fillScreen(uint32_t color) = 0;
+    virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) = 0;
+    virtual void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) = 0;
+    virtual void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color) = 0;
+    virtual void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color) = 0;
+    virtual void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) = 0;
+    virtual void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) = 0;
+    virtual void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) = 0;
+    virtual void drawPixel(int32_t x, int32_t y, uint32_t color) = 0;
+
+    /**
+     * @brief 推送一块 RGB565 图像。setSwapBytes(true) 时 data 为本机字节序的颜色值
+     * (例如 PixelConvert 的输出)；false 时按内存字节顺序直接发送 (高字节在前的颜色值)。
+     */
+    virtual void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) = 0;
+    // 读回一块屏幕内容 (与 pushImage(swap = true) 的格式相同)
+    virtual void readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data) = 0;
+    virtual void setSwapBytes(bool swap) = 0;
+    virtual bool getSwapBytes() const = 0;
+
+    // --- 内建字体文本 (ASCII) ---
+    // 只有前景色：背景透明
+    virtual void setTextColor(uint16_t color) = 0;
+    virtual void setTextColor(uint16_t foreground, uint16_t background) = 0;
+    virtual void setTextSize(uint8_t size) = 0;
+    virtual void setTextFont(uint8_t font) = 0;
+    virtual void setTextDatum(uint8_t datum) = 0;
+    // 按当前对齐方式绘制字符串，返回宽度 (像素)
+    virtual int16_t drawString(const char *text, int32_t x, int32_t y) = 0;
+    int16_t drawString(const String &text, int32_t x, int32_t y) { return drawString(text.c_str(), x, y); }
+};
+
+#endif // DISPLAY_BACKEND_H
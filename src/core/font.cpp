@@ -10,9 +10,14 @@
 #include <cstring>  // 包含 C 字符串函数，如 memcpy
 #include "font.h"   // 包含 Font 类的头文件
 #include "display.h" // 包含 Display 头文件，用于显示加载进度条
+#include "jobs.h"    // JobFuture，预取时检查取消请求
+#include "mem_stats.h" // 按子系统统计内存
+#include "trace.h"     // 区间跟踪
 
-// 定义内存缓存的最大大小 (例如 25KB)。根据设备的 RAM 进行调整。
+// 定义内存缓存的期望大小 (例如 25KB)。实际预算由 MemoryBudget 根据设备的 RAM 决定。
 #define FONT_CACHE_MAX_SIZE_BYTES (40 * 1024)
+// 内存紧张时至少保留的缓存大小 (约 250 个 16x16 字符，够一屏文本)
+#define FONT_CACHE_MIN_SIZE_BYTES (8 * 1024)
 // 备注：50KB 缓存大约可存储: 1600 个 16x16 字符, 711 个 24x24 字符, 400 个 32x32 字符 (或混合)。
 // 这应能通过减少 SD 卡访问显著提高性能。
 
@@ -20,16 +25,33 @@
 Font *Font::instance = nullptr;
 
 // --- 快速缓存文件路径 (定义) ---
-const char* Font::FAST_CACHE_BIN_PATH = "/font_data/fast.font"; // 快速缓存二进制数据文件
-const char* Font::FAST_CACHE_JSON_PATH = "/font_data/fast.json"; // 快速缓存 JSON 索引文件
+// 保存的是第 2 版字形记录 (GlyphBitmap::FORMAT_VERSION)；旧版本的 fast.font/fast.json (完整方块) 和
+// fast.glyph/fast_glyph.json (按行对齐、带步进的记录) 不再读取
+const char* Font::FAST_CACHE_BIN_PATH = "/font_data/fast.glyph2"; // 快速缓存二进制数据文件
+const char* Font::FAST_CACHE_JSON_PATH = "/font_data/fast_glyph2.json"; // 快速缓存 JSON 索引文件
 // --- 快速缓存文件路径结束 ---
 
 // Font 类构造函数
-Font::Font() : maxCacheSizeInBytes(FONT_CACHE_MAX_SIZE_BYTES), currentCacheSizeInBytes(0) {
+Font::Font() : glyphCache(allocateCacheBitmap, this), maxCacheSizeInBytes(FONT_CACHE_MAX_SIZE_BYTES) {
     fontBuffer = nullptr; // 初始化临时字体缓冲区指针为空
     currentSize = 0;      // 初始化当前缓冲区字体大小为 0
     bufferSize = 0;       // 初始化缓冲区大小为 0
-    // cacheMap 和 cacheLRUList 会自动初始化
+    glyphBytes = 0;       // 初始化字形记录大小为 0
+    mutex = xSemaphoreCreateRecursiveMutex(); // 主循环与工作线程共享缓存，需要加锁
+    // 字体缓存重新加载需要读 SD 卡，内存压力时最后收缩
+    budgetId = MemoryBudget::getInstance().registerCache("font", MemoryBudget::PRIORITY_HIGH,
+                                                         FONT_CACHE_MIN_SIZE_BYTES, FONT_CACHE_MAX_SIZE_BYTES,
+                                                         onMemoryPressure, this);
+}
+
+// 获取 Font 的递归互斥锁 (同一任务可重复获取，例如 loadFastFontCache 中绘制字形)
+Font::Guard::Guard() {
+    xSemaphoreTakeRecursive(Font::getInstance().mutex, portMAX_DELAY);
+}
+
+// 释放 Font 的递归互斥锁
+Font::Guard::~Guard() {
+    xSemaphoreGiveRecursive(Font::getInstance().mutex);
 }
 
 // Font 类析构函数
@@ -40,97 +62,41 @@ Font::~Font() {
 
 // --- 内存缓存实现 ---
 
+// GlyphCache 的分配函数：位图内存计入字体缓存的预算
+void* Font::allocateCacheBitmap(void *ctx, size_t bytes) {
+    Font* self = static_cast<Font*>(ctx);
+    return MemoryBudget::getInstance().allocate(bytes, self->budgetId);
+}
+
 // 清空内存缓存，释放所有分配的位图内存
 void Font::clearMemoryCache() {
-    // 遍历缓存 map
-    for (auto const& [key, val] : cacheMap) {
-        free(val.first.bitmap); // 释放缓存条目中位图数据占用的内存
-    }
-    cacheMap.clear();       // 清空 map
-    cacheLRUList.clear();   // 清空 LRU 链表
-    currentCacheSizeInBytes = 0; // 重置当前缓存大小计数
+    glyphCache.clear();
+    MemoryBudget::getInstance().reportUsage(budgetId, 0);
 }
 
-// 尝试从缓存中检索条目。如果找到则返回指针，否则返回 nullptr。
-// 将找到的条目移动到 LRU 链表的前端。
-Font::CacheEntry* Font::cacheGet(const CacheKey& key) {
-    // 在 map 中查找键
-    auto it = cacheMap.find(key);
-    // 如果未找到
-    if (it == cacheMap.end()) {
-        return nullptr; // 不在缓存中
-    }
-
-    // 将访问到的条目移动到 LRU 链表的前端 (表示最近使用)
-    // splice 操作将元素从其当前位置移动到链表的开头
-    cacheLRUList.splice(cacheLRUList.begin(), cacheLRUList, it->second.second);
-
-    // 返回指向缓存条目数据的指针
-    return &(it->second.first);
+// 根据 LRU 策略淘汰最少使用的条目，直到缓存大小不超过 targetBytes
+size_t Font::cacheEvict(size_t targetBytes) {
+    size_t freed = glyphCache.evict(targetBytes);
+    MemoryBudget::getInstance().reportUsage(budgetId, glyphCache.bytes());
+    return freed;
 }
 
-// 根据 LRU 策略淘汰最少使用的条目，直到缓存大小低于最大限制
-void Font::cacheEvict() {
-    // 当缓存大小超过限制且 LRU 链表不为空时循环
-    while (currentCacheSizeInBytes > maxCacheSizeInBytes && !cacheLRUList.empty()) {
-        // 获取 LRU 链表末尾的键 (最少使用的)
-        CacheKey lruKey = cacheLRUList.back();
-
-        // 在 map 中查找对应的条目
-        auto it = cacheMap.find(lruKey);
-        if (it != cacheMap.end()) {
-            // 释放位图内存
-            free(it->second.first.bitmap);
-            // 更新当前缓存大小
-            currentCacheSizeInBytes -= it->second.first.dataSize;
-            // 从 map 中移除
-            cacheMap.erase(it);
-        }
-        // 从 LRU 链表中移除 (无论是否在 map 中找到，都应移除)
-        cacheLRUList.pop_back();
-    }
+// 内存压力回调 (可能在任意任务中调用)
+size_t Font::onMemoryPressure(void *ctx, size_t bytesToFree) {
+    Font* self = static_cast<Font*>(ctx);
+    Guard guard;
+    size_t used = self->glyphCache.bytes();
+    return self->cacheEvict(used > bytesToFree ? used - bytesToFree : 0);
 }
 
 // 将新的位图数据添加到缓存中
 void Font::cachePut(const CacheKey& key, const uint8_t* data, uint16_t charSize, size_t dataSize) {
-    // 如果条目已存在于缓存中，则不执行任何操作 (或者可以更新，但 cacheGet 已处理 LRU 更新)
-    if (cacheMap.count(key)) {
-        // 可选：也可以在此处更新 LRU 位置，但 cacheGet 已经做了。
-        return;
-    }
-
-    // 检查添加此条目是否会超过缓存大小限制
-    if (currentCacheSizeInBytes + dataSize > maxCacheSizeInBytes) {
-        cacheEvict(); // 淘汰旧条目以腾出空间
-        // 再次检查淘汰后是否有足够空间
-        if (currentCacheSizeInBytes + dataSize > maxCacheSizeInBytes) {
-             // 即使淘汰后空间仍然不足 (可能条目本身太大?)
-             // 在这种情况下，我们不缓存此条目。
-             return;
-        }
-    }
-
-    // 为缓存中的位图副本分配内存
-    uint8_t* cachedBitmap = (uint8_t*)malloc(dataSize);
-    if (!cachedBitmap) {
-        return; // 内存分配失败
+    // 预算可能在 MemoryBudget::begin() 之后发生变化
+    maxCacheSizeInBytes = MemoryBudget::getInstance().budgetOf(budgetId);
+    // 超出预算时 GlyphCache 先淘汰旧条目；条目本身太大或分配失败时不缓存
+    if (glyphCache.put(key, data, charSize, dataSize, maxCacheSizeInBytes)) {
+        MemoryBudget::getInstance().reportUsage(budgetId, glyphCache.bytes());
     }
-    memcpy(cachedBitmap, data, dataSize); // 复制位图数据
-
-    // 将新条目的键添加到 LRU 链表的前端
-    cacheLRUList.push_front(key);
-
-    // 创建缓存条目
-    CacheEntry entry;
-    entry.bitmap = cachedBitmap; // 指向新分配的内存
-    entry.size = charSize;
-    entry.dataSize = dataSize;
-
-    // 将条目添加到 map 中，存储条目数据和指向其在 LRU 链表中位置的迭代器
-    cacheMap[key] = {entry, cacheLRUList.begin()};
-
-    // 更新当前缓存大小
-    currentCacheSizeInBytes += dataSize;
 }
 
 // --- 内存缓存实现结束 ---
@@ -140,6 +106,7 @@ void Font::cachePut(const CacheKey& key, const uint8_t* data, uint16_t charSize,
 
 // 将当前内存缓存保存到 SD 卡上的快速缓存文件
 bool Font::saveFastFontCache() {
+    Guard guard; // 遍历缓存期间不允许工作线程修改
     Serial.println("正在保存快速字体缓存..."); // 调试信息
 
     // 确保 /font_data 目录存在
@@ -153,14 +120,14 @@ bool Font::saveFastFontCache() {
     // 1. 打开 JSON 文件用于写入元数据
     File jsonFile = SD.open(FAST_CACHE_JSON_PATH, FILE_WRITE);
     if (!jsonFile) {
-        Serial.println("打开 fast.json 进行写入失败。");
+        Serial.println("打开 fast_glyph2.json 进行写入失败。");
         return false;
     }
 
     // 2. 打开二进制文件用于写入位图数据
     File binFile = SD.open(FAST_CACHE_BIN_PATH, FILE_WRITE);
      if (!binFile) {
-        Serial.println("打开 fast.font 进行写入失败。");
+        Serial.println("打开 fast.glyph2 进行写入失败。");
         jsonFile.close(); // 关闭已打开的 json 文件
         return false;
     }
@@ -175,15 +142,15 @@ bool Font::saveFastFontCache() {
     size_t currentOffset = 0; // 当前在二进制文件中的偏移量
 
     // 4. 遍历内存缓存 map
-    for (const auto& [key, valuePair] : cacheMap) {
+    for (const auto& [key, valuePair] : glyphCache.all()) {
         const std::string& character = key.first; // 获取字符 (std::string)
         uint16_t size = key.second;               // 获取大小
-        const CacheEntry& entry = valuePair.first; // 获取缓存条目数据
+        const GlyphCache::Entry& entry = valuePair.first; // 获取缓存条目数据
 
         // 将位图数据写入二进制文件
         size_t written = binFile.write(entry.bitmap, entry.dataSize);
         if (written != entry.dataSize) {
-            Serial.printf("将 %s (%d) 的位图写入 fast.font 时出错\n", character.c_str(), size);
+            Serial.printf("将 %s (%d) 的位图写入 fast.glyph2 时出错\n", character.c_str(), size);
             binFile.close();
             jsonFile.close();
             SD.remove(FAST_CACHE_BIN_PATH); // 清理可能损坏的文件
@@ -203,7 +170,7 @@ bool Font::saveFastFontCache() {
 
     // 5. 将 JSON 文档序列化到文件
     if (serializeJson(doc, jsonFile) == 0) {
-        Serial.println("写入 fast.json 失败。");
+        Serial.println("写入 fast_glyph2.json 失败。");
         binFile.close();
         jsonFile.close();
         SD.remove(FAST_CACHE_BIN_PATH); // 清理可能损坏的文件
@@ -215,13 +182,39 @@ bool Font::saveFastFontCache() {
     jsonFile.close();
     binFile.close();
 
-    Serial.printf("快速字体缓存保存成功。%d 个条目，%d 字节。\n", cacheMap.size(), currentOffset);
+    Serial.printf("快速字体缓存保存成功。%d 个条目，%d 字节。\n", glyphCache.count(), currentOffset);
     return true;
 }
 
 
+// 安排快速缓存保存 (防抖)：已有待执行的定时器时只把它往后推
+void Font::scheduleFastCacheSave() {
+    Scheduler& scheduler = Scheduler::getInstance();
+    if (scheduler.rescheduleTimer(saveCacheTimer, SAVE_CACHE_DELAY_MS)) {
+        return; // 已安排，推迟即可
+    }
+    Serial.printf("达到 SD 读取阈值 (%d)，%lu ms 无新加载后保存快速缓存\n",
+                  SAVE_CACHE_INTERVAL, (unsigned long)SAVE_CACHE_DELAY_MS);
+    saveCacheTimer = scheduler.addTimer(SAVE_CACHE_DELAY_MS, onSaveCacheTimer, this);
+}
+
+// 快速缓存保存定时器回调 (在主循环中执行)
+void Font::onSaveCacheTimer(void *ctx) {
+    Font* self = static_cast<Font*>(ctx);
+    Guard guard;
+    self->saveCacheTimer = Scheduler::INVALID_TASK;
+    self->saveFastFontCache(); // 尝试保存快速缓存
+    self->fontsReadFromSDCounter = 0; // 无论保存是否成功，都重置计数器
+}
+
+// 工作线程中达到保存阈值时，经 Scheduler::post() 转到主循环再安排保存
+void Font::onSaveCacheRequested(void *ctx) {
+    static_cast<Font*>(ctx)->scheduleFastCacheSave();
+}
+
 // 从 SD 卡加载快速字体缓存到内存缓存
 bool Font::loadFastFontCache() {
+    Guard guard;
     Serial.println("正在加载快速字体缓存...");
 
     // 1. 检查缓存文件是否存在
@@ -233,7 +226,7 @@ bool Font::loadFastFontCache() {
     // 2. 打开 JSON 文件进行读取
     File jsonFile = SD.open(FAST_CACHE_JSON_PATH, FILE_READ);
     if (!jsonFile) {
-        Serial.println("打开 fast.json 进行读取失败。");
+        Serial.println("打开 fast_glyph2.json 进行读取失败。");
         return false;
     }
 
@@ -245,7 +238,7 @@ bool Font::loadFastFontCache() {
     jsonFile.close(); // 读取后关闭 JSON 文件
 
     if (error) {
-        Serial.print("解析 fast.json 失败: ");
+        Serial.print("解析 fast_glyph2.json 失败: ");
         Serial.println(error.c_str());
         SD.remove(FAST_CACHE_BIN_PATH); // 清理可能损坏的缓存
         SD.remove(FAST_CACHE_JSON_PATH);
@@ -255,13 +248,14 @@ bool Font::loadFastFontCache() {
     // 4. 打开二进制文件以读取位图数据
     File binFile = SD.open(FAST_CACHE_BIN_PATH, FILE_READ);
      if (!binFile) {
-        Serial.println("打开 fast.font 进行读取失败。");
+        Serial.println("打开 fast.glyph2 进行读取失败。");
         SD.remove(FAST_CACHE_JSON_PATH); // JSON 正常，但 bin 文件丢失/损坏
         return false;
     }
 
-    // 5. 加载前清除现有的内存缓存
+    // 5. 加载前清除现有的内存缓存，并按当前预算加载
     clearMemoryCache();
+    maxCacheSizeInBytes = MemoryBudget::getInstance().budgetOf(budgetId);
 
     // 6. 遍历 JSON 条目并加载数据
     JsonArrayConst entries = doc.as<JsonArrayConst>(); // 使用 const 视图
@@ -318,7 +312,7 @@ bool Font::loadFastFontCache() {
 
         // 检查条目有效性
         if (!character_cstr || size == 0 || dataSize == 0) {
-            Serial.println("跳过 fast.json 中的无效条目");
+            Serial.println("跳过 fast_glyph2.json 中的无效条目");
             continue;
         }
 
@@ -326,19 +320,19 @@ bool Font::loadFastFontCache() {
         CacheKey key = {character, size};      // 创建缓存键
 
         // 检查是否已加载 (理论上不应发生，因为 clearMemoryCache 已调用)
-        if (cacheMap.count(key)) {
+        if (glyphCache.contains(key)) {
             continue;
         }
 
         // 检查添加此条目是否会超出缓存限制
-        if (currentCacheSizeInBytes + dataSize > maxCacheSizeInBytes) {
+        if (glyphCache.bytes() + dataSize > maxCacheSizeInBytes) {
              Serial.printf("快速缓存加载超出内存限制 (%d + %d > %d)。停止加载。\n",
-                           currentCacheSizeInBytes, dataSize, maxCacheSizeInBytes);
+                           glyphCache.bytes(), dataSize, maxCacheSizeInBytes);
              break; // 停止加载更多条目
         }
 
         // 为位图分配内存
-        uint8_t* bitmapData = (uint8_t*)malloc(dataSize);
+        uint8_t* bitmapData = glyphCache.allocate(dataSize);
         if (!bitmapData) {
             Serial.printf("在快速缓存加载期间为 %s (%d) 分配内存失败。\n", character.c_str(), size);
             continue; // 跳过此条目，尝试其他条目
@@ -346,25 +340,26 @@ bool Font::loadFastFontCache() {
 
         // 在二进制文件中定位并读取位图数据
         if (!binFile.seek(offset)) {
-             Serial.printf("在 fast.font 中为 %s (%d) 定位偏移量 %d 失败。\n", character.c_str(), size, offset);
+             Serial.printf("在 fast.glyph2 中为 %s (%d) 定位偏移量 %d 失败。\n", character.c_str(), size, offset);
              free(bitmapData); // 释放已分配的内存
              continue; // 跳过此条目
         }
         size_t bytesRead = binFile.read(bitmapData, dataSize); // 读取数据
         if (bytesRead != dataSize) {
-            Serial.printf("在 fast.font 中为 %s (%d) 读取失败。预期 %d，得到 %d。\n", character.c_str(), size, dataSize, bytesRead);
+            Serial.printf("在 fast.glyph2 中为 %s (%d) 读取失败。预期 %d，得到 %d。\n", character.c_str(), size, dataSize, bytesRead);
             free(bitmapData); // 释放已分配的内存
             continue; // 跳过此条目
         }
 
-        // 手动添加到内存缓存 (类似于 cachePut 但避免检查/淘汰)
-        cacheLRUList.push_front(key); // 添加到 LRU 链表前端 (最近使用)
-        CacheEntry entry;
-        entry.bitmap = bitmapData;
-        entry.size = size;
-        entry.dataSize = dataSize;
-        cacheMap[key] = {entry, cacheLRUList.begin()}; // 添加到 map
-        currentCacheSizeInBytes += dataSize; // 更新缓存大小
+        GlyphBitmap glyph;
+        if (!glyph.parse(bitmapData, dataSize, size)) {
+            Serial.printf("fast.glyph2 中 %s (%d) 的字形记录无效。\n", character.c_str(), size);
+            free(bitmapData);
+            continue;
+        }
+
+        // 直接接管位图 (类似于 cachePut 但避免复制/淘汰)
+        glyphCache.adopt(key, bitmapData, size, dataSize);
         loadedCount++; // 增加已加载计数
         totalBytesRead += dataSize; // 增加总读取字节数
 
@@ -428,6 +423,7 @@ bool Font::loadFastFontCache() {
     // 7. 关闭二进制文件
     binFile.close();
 
+    MemoryBudget::getInstance().reportUsage(budgetId, glyphCache.bytes());
     Serial.printf("快速字体缓存加载成功。%d 个条目，%d 字节。\n", loadedCount, totalBytesRead);
     return true;
 }
@@ -447,6 +443,7 @@ Font& Font::getInstance() {
 void Font::clearBuffer() {
     if (fontBuffer) {
         free(fontBuffer); // 释放缓冲区内存
+        MemStats::getInstance().recordFree(MemTag::FONT_BUFFER, bufferSize);
         fontBuffer = nullptr; // 将指针置空
     }
     if (currentFontFile) { // 如果当前字体文件已打开
@@ -497,25 +494,37 @@ String Font::findIndexFile(const char* character) {
 
 // 从 SD 卡加载字符数据 (先检查 SD 缓存，再检查主索引/字体文件)
 bool Font::loadCharacter(const char* character, uint16_t size) {
+    TRACE_SPAN(TraceName::FONT_SD_LOAD);
     clearBuffer(); // 清理之前的临时缓冲区和文件句柄
 
     // --- 步骤 1: 尝试从 SD 卡上的单个字符缓存文件加载 ---
-    // 构建缓存文件名: /font_data/cache/字符_大小.font
-    String cacheFilename = "/font_data/cache/" + String(character) + "_" + String(size) + ".font";
+    // 构建缓存文件名: /font_data/cache/字符_大小.glyph2 (一个第 2 版字形记录；旧版本的 .font 和 .glyph 缓存不再读取)
+    String cacheFilename = "/font_data/cache/" + String(character) + "_" + String(size) + ".glyph2";
     File cacheFile = SD.open(cacheFilename, FILE_READ); // 尝试直接以读取模式打开缓存文件
 
-    if (cacheFile) { // 如果文件成功打开 (存在且可读)
-        // 计算所需的缓冲区大小 (字节) = (宽度 * 高度 + 7) / 8
-        bufferSize = (size * size + 7) / 8;
+    if (cacheFile && cacheFile.size() > GlyphBitmap::maxRecordBytes(size)) {
+        cacheFile.close(); // 比最大的字形记录还大：不是有效的缓存，从主文件重新加载 (之后覆盖它)
+    } else if (cacheFile) { // 如果文件成功打开 (存在且可读)
+        // 缓冲区按最大的字形记录分配，读取文件中的实际大小
+        bufferSize = GlyphBitmap::maxRecordBytes(size);
+        glyphBytes = cacheFile.size();
         fontBuffer = (uint8_t*)malloc(bufferSize); // 分配内存
         if (!fontBuffer) {
             cacheFile.close(); // 关闭文件
             Serial.println("为 SD 缓存分配内存失败");
             return false; // 内存分配失败
         }
+        MemStats::getInstance().recordAlloc(MemTag::FONT_BUFFER, bufferSize);
 
         // 从缓存文件读取数据到缓冲区
-        if (cacheFile.read(fontBuffer, bufferSize) == bufferSize) {
+        bool readOk;
+        {
+            TRACE_SPAN(TraceName::SD_READ);
+            readOk = cacheFile.read(fontBuffer, glyphBytes) == glyphBytes;
+        }
+        GlyphBitmap glyph;
+        readOk = readOk && glyph.parse(fontBuffer, glyphBytes, size);
+        if (readOk) {
             // 成功从缓存读取
             cacheFile.close(); // 关闭文件
             currentSize = size; // 更新当前缓冲区大小
@@ -581,9 +590,10 @@ bool Font::loadCharacter(const char* character, uint16_t size) {
         }
     }
 
-    // 从 JSON 中获取字体文件名和偏移量
+    // 从 JSON 中获取字体文件名和偏移量 ("bytes": 裁剪过的字形记录的大小；没有时是旧格式的方块)
     const char* fontFileName = doc[character][String(size)]["file"];
     size_t offset = doc[character][String(size)]["offset"];
+    size_t recordBytes = doc[character][String(size)]["bytes"]; // 没有这一项时为 0
 
     if (!fontFileName) {
         Serial.printf("索引 %s 中 '%s' (%d) 条目缺少 'file'\n", indexFileName.c_str(), character, size);
@@ -597,14 +607,17 @@ bool Font::loadCharacter(const char* character, uint16_t size) {
         return false;
     }
 
-    // 计算并分配临时缓冲区大小
-    bufferSize = (size * size + 7) / 8;  // 向上取整到字节
-    fontBuffer = (uint8_t*)malloc(bufferSize);
+    // 计算并分配临时缓冲区大小：字形记录在开头；旧格式的方块读到记录后面，再裁剪到开头
+    const size_t squareBytes = recordBytes ? 0 : GlyphBitmap::squareBytes(size);
+    const size_t readBytes = recordBytes ? recordBytes : squareBytes;
+    bufferSize = GlyphBitmap::maxRecordBytes(size) + squareBytes;
+    fontBuffer = recordBytes <= GlyphBitmap::maxRecordBytes(size) ? (uint8_t*)malloc(bufferSize) : nullptr;
     if (!fontBuffer) {
         Serial.println("为字体数据分配缓冲区失败");
         currentFontFile.close();
         return false;
     }
+    MemStats::getInstance().recordAlloc(MemTag::FONT_BUFFER, bufferSize);
 
     // 定位到文件中的偏移量并读取字体数据
     if (!currentFontFile.seek(offset)) {
@@ -612,11 +625,19 @@ bool Font::loadCharacter(const char* character, uint16_t size) {
         clearBuffer(); // 清理缓冲区和文件句柄
         return false;
     }
-    if (currentFontFile.read(fontBuffer, bufferSize) != bufferSize) {
+    uint8_t* readTarget = recordBytes ? fontBuffer : fontBuffer + GlyphBitmap::maxRecordBytes(size);
+    size_t glyphBytesRead;
+    {
+        TRACE_SPAN(TraceName::SD_READ);
+        glyphBytesRead = currentFontFile.read(readTarget, readBytes);
+    }
+    GlyphBitmap glyph;
+    if (glyphBytesRead != readBytes || (recordBytes && !glyph.parse(fontBuffer, recordBytes, size))) {
         Serial.printf("从字体文件 %s 读取数据失败\n", fontFileName);
         clearBuffer(); // 清理缓冲区和文件句柄
         return false;
     }
+    glyphBytes = recordBytes ? recordBytes : GlyphBitmap::cropSquare(readTarget, size, fontBuffer);
 
     // 成功从主文件加载
     currentFontFile.close(); // 关闭字体文件
@@ -635,7 +656,7 @@ bool Font::loadCharacter(const char* character, uint16_t size) {
     cacheFile = SD.open(cacheFilename, FILE_WRITE); // 重新赋值给现有的 cacheFile 变量
 
     if (cacheFile) { // 检查写入模式打开是否成功
-        cacheFile.write(fontBuffer, bufferSize); // 将缓冲区内容写入缓存文件
+        cacheFile.write(fontBuffer, glyphBytes); // 将字形记录写入缓存文件
         cacheFile.close(); // 关闭缓存文件
         // Serial.printf("已写入 SD 缓存: %s\n", cacheFilename.c_str()); // 调试信息
     } else {
@@ -647,15 +668,20 @@ bool Font::loadCharacter(const char* character, uint16_t size) {
 }
 
 // 获取字符位图的主函数。首先检查内存缓存，然后检查 SD 卡。
-uint8_t* Font::getCharacterBitmap(const char* character, uint16_t size) {
+uint8_t* Font::getCharacterBitmap(const char* character, uint16_t size, size_t* recordBytes) {
+    TRACE_SPAN(TraceName::FONT_GET_BITMAP);
+    Guard guard; // 调用方应已持有 Guard (以保证返回指针有效)，这里递归加锁保护内部状态
     // 创建用于缓存查找的键
     CacheKey key = {std::string(character), size};
 
     // 1. 首先检查内存缓存
-    CacheEntry* cachedEntry = cacheGet(key);
+    const GlyphCache::Entry* cachedEntry = glyphCache.get(key);
     if (cachedEntry) {
         // 内存缓存命中！直接返回缓存的位图。
         // Serial.printf("内存缓存命中: %s (%d)\n", character, size); // 调试信息
+        if (recordBytes) {
+            *recordBytes = cachedEntry->dataSize;
+        }
         return cachedEntry->bitmap;
     }
 
@@ -672,81 +698,90 @@ uint8_t* Font::getCharacterBitmap(const char* character, uint16_t size) {
     // --- 触发快速缓存保存 ---
     // 因为我们从 SD 加载了数据 (无论是 SD 缓存文件还是主文件)，增加计数器
     fontsReadFromSDCounter++;
-    // 如果计数器达到阈值
+    // 如果计数器达到阈值，安排 (或推迟) 一次保存，实际写卡在阅读停顿时由调度器执行
     if (fontsReadFromSDCounter >= SAVE_CACHE_INTERVAL) {
-        Serial.printf("达到 SD 读取阈值 (%d)，尝试保存快速缓存...\n", SAVE_CACHE_INTERVAL);
-        saveFastFontCache(); // 尝试保存快速缓存
-        fontsReadFromSDCounter = 0; // 无论保存是否成功，都重置计数器
+        if (Scheduler::isLoopTask()) {
+            scheduleFastCacheSave();
+        } else {
+            Scheduler::getInstance().post(onSaveCacheRequested, this); // 调度器只能在主循环中操作
+        }
     }
     // --- 触发快速缓存保存结束 ---
 
 
     // 3. 成功从 SD 加载到 fontBuffer。现在将其添加到内存缓存。
-    //    'bufferSize' 保存了加载到 fontBuffer 的数据大小。
-    if (fontBuffer && bufferSize > 0) {
+    //    'glyphBytes' 保存了加载到 fontBuffer 的字形记录大小。
+    if (fontBuffer && glyphBytes > 0) {
         // Serial.printf("将从 SD 加载的 %s (%d) 添加到内存缓存\n", character, size); // 调试信息
-        cachePut(key, fontBuffer, size, bufferSize);
+        cachePut(key, fontBuffer, size, glyphBytes);
     } else {
-         Serial.printf("警告：从 SD 加载后 fontBuffer 为空或 bufferSize 为 0 (%s, %d)\n", character, size);
+         Serial.printf("警告：从 SD 加载后 fontBuffer 为空或 glyphBytes 为 0 (%s, %d)\n", character, size);
     }
 
     // 4. 返回指向 fontBuffer 中数据的指针 (刚刚加载的)。
     //    注意：数据现在也存在于内存缓存中，但我们返回临时缓冲区的指针
     //    以保持与旧逻辑流程的一致性。
     //    后续对相同字符/大小的调用应该会命中内存缓存。
+    if (recordBytes) {
+        *recordBytes = glyphBytes;
+    }
     return fontBuffer;
 }
 
+// 预取单个字符到内存缓存
+bool Font::prefetchCharacter(const char* character, uint16_t size) {
+    Guard guard;
+    if (glyphCache.contains({std::string(character), size})) {
+        return true; // 已在内存缓存中 (不调整 LRU 顺序，预取不算一次使用)
+    }
+    return getCharacterBitmap(character, size) != nullptr;
+}
+
+// 从内存缓存中移除单个字符
+bool Font::evictCharacter(const char* character, uint16_t size) {
+    Guard guard;
+    if (!glyphCache.erase({std::string(character), size})) {
+        return false;
+    }
+    MemoryBudget::getInstance().reportUsage(budgetId, glyphCache.bytes());
+    return true;
+}
+
+// 预取一段文本中的所有非 ASCII 字符
+size_t Font::prefetchText(const char* text, size_t length, uint16_t size, const JobFuture* job) {
+    size_t prefetched = 0;
+    size_t offset = 0;
+    char character[5];
+    while (offset < length) {
+        if (job && job->isCancelled()) {
+            break; // 页面已翻走或关闭，放弃剩余预取
+        }
+        size_t charLen = Utf8::sequenceLength((uint8_t)text[offset]);
+        if (offset + charLen > length) {
+            break; // 末尾被截断的字符
+        }
+        if (charLen > 1) { // ASCII 使用内建字体，跳过
+            memcpy(character, text + offset, charLen);
+            character[charLen] = '\0';
+            if (prefetchCharacter(character, size)) {
+                prefetched++;
+            }
+        }
+        offset += charLen;
+    }
+    return prefetched;
+}
+
 // 辅助函数：将 UTF-8 字符字符串转换为其 Unicode 码点
 // 如果输入为 null 或无效的 UTF-8 起始字节，则返回 0
 uint32_t Font::utf8ToUnicode(const char* utf8_char) {
-    if (!utf8_char || *utf8_char == '\0') {
-        return 0; // 无效输入
-    }
-
-    uint32_t unicode_val = 0; // 初始化 Unicode 值
-    unsigned char c1 = utf8_char[0]; // 获取第一个字节
-
-    if (c1 < 0x80) { // 1 字节序列 (ASCII)
-        unicode_val = c1;
-    } else if ((c1 & 0xE0) == 0xC0) { // 2 字节序列 (以 110xxxxx 开头)
-        // 检查第二个字节是否为 10xxxxxx
-        if ((utf8_char[1] & 0xC0) == 0x80) {
-            // 计算 Unicode 值
-            unicode_val = ((c1 & 0x1F) << 6) | (utf8_char[1] & 0x3F);
-        } else return 0; // 无效序列
-    } else if ((c1 & 0xF0) == 0xE0) { // 3 字节序列 (以 1110xxxx 开头)
-        // 检查第二和第三个字节是否为 10xxxxxx
-        if (((utf8_char[1] & 0xC0) == 0x80) && ((utf8_char[2] & 0xC0) == 0x80)) {
-            // 计算 Unicode 值
-            unicode_val = ((c1 & 0x0F) << 12) | ((utf8_char[1] & 0x3F) << 6) | (utf8_char[2] & 0x3F);
-        } else return 0; // 无效序列
-    } else if ((c1 & 0xF8) == 0xF0) { // 4 字节序列 (以 11110xxx 开头)
-        // 检查第二、三、四个字节是否为 10xxxxxx
-        if (((utf8_char[1] & 0xC0) == 0x80) && ((utf8_char[2] & 0xC0) == 0x80) && ((utf8_char[3] & 0xC0) == 0x80)) {
-            // 计算 Unicode 值
-            unicode_val = ((c1 & 0x07) << 18) | ((utf8_char[1] & 0x3F) << 12) | ((utf8_char[2] & 0x3F) << 6) | (utf8_char[3] & 0x3F);
-        } else return 0; // 无效序列
-    } else {
-        return 0; // 无效的 UTF-8 起始字节
-    }
-
-    return unicode_val; // 返回计算出的 Unicode 码点
+    return Utf8::decode(utf8_char);
 }
 
 
 // 计算 UTF-8 字符串的实际字符长度 (而不是字节长度)
 size_t Font::utf8Length(const char* str) {
-    size_t len = 0; // 初始化字符计数
-    while (*str) { // 遍历字符串直到空终止符
-        // UTF-8 字符的后续字节以 10xxxxxx 开头 (& 0xC0 结果为 0x80)
-        // 只有字符的第一个字节不满足这个条件
-        if ((*str & 0xC0) != 0x80) {
-            len++; // 遇到非后续字节，增加字符计数
-        }
-        str++; // 移动到下一个字节
-    }
-    return len; // 返回字符总数
+    return Utf8::length(str);
 }
 
 // 从 UTF-8 字符串中获取下一个字符，并更新偏移量
@@ -757,21 +792,8 @@ String Font::getNextCharacter(const char* str, size_t& offset) {
     }
 
     size_t start = offset; // 记录当前字符的起始字节位置
-    uint8_t first = str[offset]; // 获取第一个字节
-
-    // 根据第一个字节判断 UTF-8 字符的字节数
-    if (first < 0x80) { // ASCII 字符 (1 字节)
-        offset += 1;
-    } else if ((first & 0xE0) == 0xC0) { // 2 字节字符
-        offset += 2;
-    } else if ((first & 0xF0) == 0xE0) { // 3 字节字符
-        offset += 3;
-    } else if ((first & 0xF8) == 0xF0) { // 4 字节字符
-        offset += 4;
-    } else {
-        // 无效的 UTF-8 起始字节，当作单字节处理以避免死循环
-        offset += 1;
-    }
+    // 无效的 UTF-8 起始字节按单字节处理以避免死循环
+    offset += Utf8::sequenceLength((uint8_t)str[offset]);
 
     // 从原始字符串中提取从 start 到新 offset 的子字符串
     return String(str).substring(start, offset);
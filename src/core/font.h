@@ -5,59 +5,64 @@
 #include <SD.h>           // 包含 SD 卡库
 #include <FS.h>           // 包含文件系统库 (SD 库依赖)
 #include <ArduinoJson.h>  // 包含 ArduinoJson 库，用于处理 JSON 格式的快速缓存索引
-#include <map>            // 包含 C++ 标准库 map，用于内存缓存
-#include <list>           // 包含 C++ 标准库 list，用于 LRU (最近最少使用) 缓存淘汰策略
-#include <string>         // 包含 C++ 标准库 string，用于 map 的键 (字符部分)
-#include <utility>        // 包含 C++ 标准库 utility，用于 std::pair (map 的键)
+#include <string>         // 包含 C++ 标准库 string，用于缓存键 (字符部分)
 #include "../config/config.h" // 包含项目配置文件 (调整了路径)
+#include "scheduler.h"        // 用于延迟 (防抖) 保存快速缓存
+#include "memory_budget.h"    // 内存缓存的预算和内存压力回调
+#include "glyph_cache.h"      // 内存 LRU 缓存
+#include "glyph_bitmap.h"     // 裁剪后的字形记录
+#include "utf8.h"             // UTF-8 辅助函数
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>  // 递归互斥锁，保护缓存在两个核心之间的访问
+
+class JobFuture; // 前向声明 (jobs.h)，用于预取时检查取消请求
 
 /**
  * @brief 管理字体加载和缓存的单例类。
  * 支持从 SD 卡加载自定义点阵字体，并使用内存缓存和快速缓存 (SD 卡) 提高性能。
+ *
+ * 线程安全：
+ *  - 静态 UTF-8 辅助函数 (isAscii, utf8Length, getNextCharacter, utf8ToUnicode) 无状态，任意任务可调用。
+ *  - 其余成员函数会修改内存缓存和临时缓冲区，调用时必须持有 Font::Guard。
+ *    getCharacterBitmap() 返回的指针只在持有 Guard 期间有效 (可能被另一个核心上的加载覆盖或淘汰)。
+ *  - 主循环 (Display 绘制字形) 和 JobSystem 的 I/O 工作线程 (FONT_PREFETCH) 都会访问 Font。
+ *  - 快速缓存保存由 Scheduler 定时器在主循环中执行；工作线程中触发的保存请求通过 Scheduler::post() 转交。
  */
 class Font
 {
 private:
     static Font *instance;      // 指向 Font 类单例实例的指针
+    SemaphoreHandle_t mutex;    // 递归互斥锁，由 Guard 持有
     File currentFontFile;       // 当前打开的字体文件对象 (用于从 SD 卡读取)
-    uint8_t *fontBuffer;        // 用于从 SD 卡读取字体数据的临时缓冲区
+    uint8_t *fontBuffer;        // 用于从 SD 卡读取字体数据的临时缓冲区 (开头是加载的字形记录)
     uint16_t currentSize;       // 当前加载到 fontBuffer 中的字体大小 (像素)
     uint16_t bufferSize;        // fontBuffer 的大小 (字节)
+    uint16_t glyphBytes;        // fontBuffer 中字形记录的字节数
 
     // --- 快速缓存 (持久化到 SD 卡) ---
-    static const int SAVE_CACHE_INTERVAL = 10; // 每从 SD 读取 10 次字体后，保存一次快速缓存
+    static const int SAVE_CACHE_INTERVAL = 10; // 每从 SD 读取 10 次字体后，安排一次快速缓存保存
+    static const uint32_t SAVE_CACHE_DELAY_MS = 3000; // 最后一次 SD 读取后静默多久才真正写卡 (防抖)
     static const char* FAST_CACHE_BIN_PATH;    // 快速缓存二进制数据文件路径 (在 .cpp 文件中定义)
     static const char* FAST_CACHE_JSON_PATH;   // 快速缓存 JSON 索引文件路径 (在 .cpp 文件中定义)
     int fontsReadFromSDCounter = 0;            // 从 SD 卡读取字体的计数器，用于触发快速缓存保存
+    Scheduler::TaskId saveCacheTimer = Scheduler::INVALID_TASK; // 待执行的快速缓存保存定时器
     // --- 快速缓存结束 ---
 
     // --- 内存缓存 (LRU) ---
-    /**
-     * @brief 内存缓存条目结构体。
-     */
-    struct CacheEntry
-    {
-        uint8_t *bitmap; // 指向 RAM 中缓存的字体位图数据的指针
-        uint16_t size;   // 字符的像素大小 (例如 16 表示 16x16)
-        size_t dataSize; // 位图数据占用的字节数
-    };
+    using CacheKey = GlyphCache::Key; // (UTF-8 字符, 像素大小)
+    GlyphCache glyphCache;            // 字形位图的 LRU 缓存 (位图内存从 MemoryBudget 分配)
 
-    // 内存缓存的键类型：一个包含 (UTF8 字符的 std::string, 字符像素大小 uint16_t) 的 pair
-    using CacheKey = std::pair<std::string, uint16_t>;
-    // LRU 链表的迭代器类型
-    using CacheIterator = std::list<CacheKey>::iterator;
+    size_t maxCacheSizeInBytes;     // 内存缓存允许占用的最大总字节数 (由 MemoryBudget 分配)
+    MemoryBudget::ClientId budgetId; // 在 MemoryBudget 中注册的句柄
 
-    // 内存缓存 map：键 (CacheKey) 映射到 {缓存条目数据 (CacheEntry), 指向 LRU 链表中对应键的迭代器}
-    std::map<CacheKey, std::pair<CacheEntry, CacheIterator>> cacheMap;
-    // LRU 链表：存储缓存键，按照最近最少使用的顺序排列 (最近使用的在链表前端)
-    std::list<CacheKey> cacheLRUList;
-
-    size_t maxCacheSizeInBytes;     // 内存缓存允许占用的最大总字节数
-    size_t currentCacheSizeInBytes; // 当前内存缓存已占用的总字节数
+    /**
+     * @brief GlyphCache 的分配函数：从 MemoryBudget 分配 (有 PSRAM 时放在 PSRAM；失败时先让其他缓存释放内存)。
+     * @param ctx 指向 Font 实例的指针。
+     */
+    static void *allocateCacheBitmap(void *ctx, size_t bytes);
 
-    // 内存缓存辅助方法
     /**
-     * @brief 将字体数据放入内存缓存。
+     * @brief 将字体数据放入内存缓存 (按当前预算淘汰旧条目) 并上报占用。
      * @param key 缓存键 (字符和大小)。
      * @param data 指向字体位图数据的指针。
      * @param charSize 字符的像素大小。
@@ -66,16 +71,19 @@ private:
     void cachePut(const CacheKey &key, const uint8_t *data, uint16_t charSize, size_t dataSize);
 
     /**
-     * @brief 从内存缓存中获取字体数据。
-     * @param key 缓存键 (字符和大小)。
-     * @return 如果找到，返回指向 CacheEntry 的指针；否则返回 nullptr。
+     * @brief 根据 LRU 策略淘汰最少使用的条目，直到缓存占用不超过 targetBytes，并上报占用。
+     * @param targetBytes 淘汰后允许的最大占用字节数。
+     * @return 释放的字节数。
      */
-    CacheEntry *cacheGet(const CacheKey &key); // Returns pointer to entry if found, nullptr otherwise
+    size_t cacheEvict(size_t targetBytes);
 
     /**
-     * @brief 当缓存满时，根据 LRU 策略淘汰最少使用的条目。
+     * @brief MemoryBudget 的收缩回调：内存压力时淘汰 LRU 条目。
+     * @param ctx 指向 Font 实例的指针。
+     * @param bytesToFree 希望释放的字节数。
+     * @return 实际释放的字节数。
      */
-    void cacheEvict();                         // Evicts the least recently used item(s) if cache is full
+    static size_t onMemoryPressure(void *ctx, size_t bytesToFree);
 
     /**
      * @brief 清空整个内存缓存，释放所有缓存的位图数据。
@@ -89,6 +97,25 @@ private:
      * @return 如果保存成功返回 true，否则返回 false。
      */
     bool saveFastFontCache(); // Saves the current in-memory cache to SD
+
+    /**
+     * @brief 安排一次快速缓存保存。
+     * 保存不再在渲染路径中同步执行，而是交给调度器：连续加载字形时不断推迟，
+     * 直到阅读停顿 SAVE_CACHE_DELAY_MS 后才写入 SD 卡。
+     */
+    void scheduleFastCacheSave();
+
+    /**
+     * @brief 快速缓存保存定时器回调。
+     * @param ctx 指向 Font 实例的指针。
+     */
+    static void onSaveCacheTimer(void *ctx);
+
+    /**
+     * @brief 工作线程请求保存快速缓存时，由 Scheduler::post() 在主循环中调用。
+     * @param ctx 指向 Font 实例的指针。
+     */
+    static void onSaveCacheRequested(void *ctx);
     // --- 快速缓存方法结束 ---
 
 
@@ -102,8 +129,10 @@ private:
     ~Font(); // Destructor: Clean up cache memory
 
     /**
-     * @brief 从 SD 卡加载指定字符和大小的字体数据到 fontBuffer。
+     * @brief 从 SD 卡加载指定字符和大小的字形记录到 fontBuffer。
      * 会先尝试从快速缓存加载，如果失败则从原始字体文件加载。
+     * 字体文件的索引项带 "bytes" 时是裁剪过的字形记录，直接读取这么多字节；
+     * 否则是旧格式的 size x size 方块，读取后用 GlyphBitmap::cropSquare() 裁剪。
      * @param character 要加载的 UTF-8 字符。
      * @param size 字体像素大小。
      * @return 如果加载成功返回 true，否则返回 false。
@@ -127,6 +156,19 @@ public:
     Font(const Font&) = delete;
     Font& operator=(const Font&) = delete;
 
+    /**
+     * @brief 作用域锁：构造时获取 Font 的递归互斥锁，析构时释放。
+     * 使用 getCharacterBitmap() 返回的指针期间必须一直持有。
+     */
+    class Guard
+    {
+    public:
+        Guard();
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
     /**
      * @brief 获取 Font 类的单例实例。
      * @return Font 类的引用。
@@ -148,15 +190,44 @@ public:
     bool loadFastFontCache(); // Loads the fast cache from SD into memory
 
     /**
-     * @brief 获取指定字符和大小的点阵位图数据。
+     * @brief 获取指定字符和大小的字形记录 (用 GlyphBitmap::parse() 和记录长度解析出墨迹矩形和位图)。
      * 优先从内存缓存获取，其次尝试从 SD 卡加载 (可能触发快速缓存加载或原始文件加载)。
      * @param character 要获取位图的 UTF-8 字符。
      * @param size 字体像素大小。
-     * @return 如果成功获取，返回指向位图数据的指针 (可能指向内存缓存或临时 fontBuffer)；否则返回 nullptr。
+     * @param recordBytes (可选) 输出字形记录的字节数 (解析记录需要)。
+     * @return 如果成功获取，返回指向字形记录的指针 (可能指向内存缓存或临时 fontBuffer)；否则返回 nullptr。
      * @note 返回的指针指向的数据可能在下次调用或缓存淘汰时失效，特别是当它指向 fontBuffer 时。
      *       如果需要持久保留，应复制数据。
      */
-    uint8_t *getCharacterBitmap(const char *character, uint16_t size);
+    uint8_t *getCharacterBitmap(const char *character, uint16_t size, size_t *recordBytes = nullptr);
+
+    /**
+     * @brief 预取单个字符到内存缓存 (已缓存时立即返回)。内部自行加锁。
+     * @param character 要预取的 UTF-8 字符。
+     * @param size 字体像素大小。
+     * @return 如果字符已在 (或已加载到) 内存缓存中返回 true。
+     */
+    bool prefetchCharacter(const char *character, uint16_t size);
+
+    /**
+     * @brief 预取一段文本中所有非 ASCII 字符 (ASCII 使用 TFT 内建字体，无需预取)。
+     * 供 JobSystem 的 FONT_PREFETCH 任务在工作线程中调用；每个字符单独加锁，
+     * 因此主循环的绘制最多只会等待一个字符的加载。
+     * @param text UTF-8 文本 (不要求以 '\0' 结尾)。
+     * @param length 文本字节数；末尾不完整的 UTF-8 字符会被忽略。
+     * @param size 字体像素大小。
+     * @param job (可选) 所属任务，取消时提前返回。
+     * @return 预取 (命中或加载) 的字符数量。
+     */
+    size_t prefetchText(const char *text, size_t length, uint16_t size, const JobFuture *job = nullptr);
+
+    /**
+     * @brief 从内存缓存中移除一个字符 (基准测试用它测量缓存未命中时的加载时间)。内部自行加锁。
+     * @param character 单个 UTF-8 字符。
+     * @param size 字体大小 (像素)。
+     * @return 字符原本在内存缓存中返回 true。
+     */
+    bool evictCharacter(const char *character, uint16_t size);
 
     /**
      * @brief 获取指定像素大小的字符宽度。
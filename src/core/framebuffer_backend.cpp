@@ -0,0 +1,458 @@
+#include "framebuffer_backend.h" // 包含 FramebufferBackend 类的头文件
+#include <algorithm>             // std::min / std::max / std::swap
+#include <cmath>                 // sqrt
+#include <cstdio>                // PNG 使用 stdio 写入
+#include <cstdlib>               // abs
+#include <new>                   // std::nothrow
+
+FramebufferBackend::FramebufferBackend(int16_t width, int16_t height)
+    : screenWidth(width), screenHeight(height), pixels((size_t)width * height, 0), counters(), clipX0(0),
+      clipY0(0), clipX1(width), clipY1(height), windowsAtCallStart(0), swapBytes(false), textForeground(0xFFFF), textBackground(0xFFFF), textSize(1),
+      textFont(1), textDatum(0)
+{
+}
+
+// --- 内部工具 ---
+
+void FramebufferBackend::fillWindow(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+{
+    int32_t x0 = std::max<int32_t>(x, clipX0);
+    int32_t y0 = std::max<int32_t>(y, clipY0);
+    int32_t x1 = std::min<int32_t>(x + w, clipX1);
+    int32_t y1 = std::min<int32_t>(y + h, clipY1);
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return; // 与 TFT_eSPI 相同：完全裁剪掉时不设置窗口
+    }
+    for (int32_t row = y0; row < y1; row++)
+    {
+        std::fill(pixels.begin() + (size_t)row * screenWidth + x0, pixels.begin() + (size_t)row * screenWidth + x1, color);
+    }
+    counters.windows++;
+    counters.pixels += (uint64_t)(x1 - x0) * (y1 - y0);
+}
+
+int32_t FramebufferBackend::cornerInset(int32_t radius, int32_t row)
+{
+    // 以行中心到圆心的距离计算圆上该行的半宽
+    double dy = radius - row - 0.5;
+    double half = sqrt(std::max(0.0, (double)radius * radius - dy * dy));
+    return radius - (int32_t)(half + 0.5);
+}
+
+void FramebufferBackend::charCell(int32_t &cellWidth, int32_t &cellHeight) const
+{
+    switch (textFont)
+    {
+    case 1: // GLCD 5x7 (含间距 6x8)
+        cellWidth = 6;
+        cellHeight = 8;
+        break;
+    case 4: // Font4：26 像素高
+        cellWidth = 14;
+        cellHeight = 26;
+        break;
+    default: // Font2：16 像素高 (比例字体，取平均宽度；Display::drawText 也按 8 像素前进)
+        cellWidth = 8;
+        cellHeight = 16;
+        break;
+    }
+    cellWidth *= textSize;
+    cellHeight *= textSize;
+}
+
+// --- 裁剪区 ---
+
+void FramebufferBackend::setClipRect(int32_t x, int32_t y, int32_t w, int32_t h)
+{
+    clipX0 = std::max<int32_t>(x, 0);
+    clipY0 = std::max<int32_t>(y, 0);
+    clipX1 = std::min<int32_t>(x + w, screenWidth);
+    clipY1 = std::min<int32_t>(y + h, screenHeight);
+}
+
+void FramebufferBackend::clearClipRect()
+{
+    clipX0 = 0;
+    clipY0 = 0;
+    clipX1 = screenWidth;
+    clipY1 = screenHeight;
+}
+
+DisplayBackend *FramebufferBackend::createCanvas(int16_t w, int16_t h)
+{
+    if (w <= 0 || h <= 0)
+    {
+        return nullptr;
+    }
+    return new (std::nothrow) FramebufferBackend(w, h);
+}
+
+// --- 图形 ---
+
+void FramebufferBackend::fillScreen(uint32_t color)
+{
+    beginCall();
+    fillWindow(0, 0, screenWidth, screenHeight, color);
+    endCall();
+}
+
+void FramebufferBackend::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    beginCall();
+    fillWindow(x, y, w, h, color);
+    endCall();
+}
+
+void FramebufferBackend::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    // TFT_eSPI：两条水平线 + 两条垂直线，在一个事务内
+    beginCall();
+    fillWindow(x, y, w, 1, color);
+    fillWindow(x, y + h - 1, w, 1, color);
+    fillWindow(x, y + 1, 1, h - 2, color);
+    fillWindow(x + w - 1, y + 1, 1, h - 2, color);
+    endCall();
+}
+
+void FramebufferBackend::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color)
+{
+    radius = std::min(radius, std::min(w, h) / 2);
+    beginCall();
+    fillWindow(x, y + radius, w, h - 2 * radius, color);
+    for (int32_t row = 0; row < radius; row++)
+    {
+        int32_t inset = cornerInset(radius, row);
+        fillWindow(x + inset, y + row, w - 2 * inset, 1, color);         // 上圆角
+        fillWindow(x + inset, y + h - 1 - row, w - 2 * inset, 1, color); // 下圆角
+    }
+    endCall();
+}
+
+void FramebufferBackend::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color)
+{
+    radius = std::min(radius, std::min(w, h) / 2);
+    beginCall();
+    fillWindow(x + radius, y, w - 2 * radius, 1, color);
+    fillWindow(x + radius, y + h - 1, w - 2 * radius, 1, color);
+    fillWindow(x, y + radius, 1, h - 2 * radius, color);
+    fillWindow(x + w - 1, y + radius, 1, h - 2 * radius, color);
+    // 圆角逐点绘制 (TFT_eSPI 的 drawCircleHelper 也是逐点)
+    int32_t previous = radius;
+    for (int32_t row = 0; row < radius; row++)
+    {
+        int32_t inset = cornerInset(radius, row);
+        int32_t last = std::max(inset, (row == 0 ? radius : previous) - 1);
+        for (int32_t px = inset; px <= last && px < radius; px++)
+        {
+            fillWindow(x + px, y + row, 1, 1, color);
+            fillWindow(x + w - 1 - px, y + row, 1, 1, color);
+            fillWindow(x + px, y + h - 1 - row, 1, 1, color);
+            fillWindow(x + w - 1 - px, y + h - 1 - row, 1, 1, color);
+        }
+        previous = inset;
+    }
+    endCall();
+}
+
+void FramebufferBackend::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
+{
+    beginCall();
+    fillWindow(x, y, w, 1, color);
+    endCall();
+}
+
+void FramebufferBackend::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
+{
+    beginCall();
+    fillWindow(x, y, 1, h, color);
+    endCall();
+}
+
+void FramebufferBackend::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+    // Bresenham；与 TFT_eSPI 相同，沿主方向的连续像素合并为一个窗口
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep)
+    {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    int32_t dx = x1 - x0;
+    int32_t dy = abs(y1 - y0);
+    int32_t err = dx / 2;
+    int32_t step = y0 < y1 ? 1 : -1;
+    int32_t runStart = x0;
+
+    beginCall();
+    for (int32_t x = x0; x <= x1; x++)
+    {
+        err -= dy;
+        if (err < 0 || x == x1)
+        {
+            int32_t length = x - runStart + 1;
+            if (steep)
+            {
+                fillWindow(y0, runStart, 1, length, color);
+            }
+            else
+            {
+                fillWindow(runStart, y0, length, 1, color);
+            }
+            if (err < 0)
+            {
+                y0 += step;
+                err += dx;
+            }
+            runStart = x + 1;
+        }
+    }
+    endCall();
+}
+
+void FramebufferBackend::drawPixel(int32_t x, int32_t y, uint32_t color)
+{
+    beginCall();
+    fillWindow(x, y, 1, 1, color);
+    endCall();
+}
+
+void FramebufferBackend::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data)
+{
+    int32_t x0 = std::max<int32_t>(x, clipX0);
+    int32_t y0 = std::max<int32_t>(y, clipY0);
+    int32_t x1 = std::min<int32_t>(x + w, clipX1);
+    int32_t y1 = std::min<int32_t>(y + h, clipY1);
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+    for (int32_t row = y0; row < y1; row++)
+    {
+        const uint16_t *src = data + (size_t)(row - y) * w + (x0 - x);
+        uint16_t *dst = &pixels[(size_t)row * screenWidth + x0];
+        for (int32_t col = x0; col < x1; col++)
+        {
+            uint16_t value = *src++;
+            // swapBytes = false 时屏幕收到的是内存中的字节顺序 (小端机器上即高低字节互换)
+            *dst++ = swapBytes ? value : (uint16_t)((value >> 8) | (value << 8));
+        }
+    }
+    counters.windows++;
+    counters.pixels += (uint64_t)(x1 - x0) * (y1 - y0);
+    counters.transactions++;
+}
+
+void FramebufferBackend::readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data)
+{
+    for (int32_t row = 0; row < h; row++)
+    {
+        for (int32_t col = 0; col < w; col++)
+        {
+            *data++ = getPixel(x + col, y + row);
+        }
+    }
+}
+
+// --- 内建字体文本 ---
+
+void FramebufferBackend::setTextColor(uint16_t color)
+{
+    textForeground = color;
+    textBackground = color; // 与 TFT_eSPI 相同：前景色等于背景色表示背景透明
+}
+
+void FramebufferBackend::setTextColor(uint16_t foreground, uint16_t background)
+{
+    textForeground = foreground;
+    textBackground = background;
+}
+
+int16_t FramebufferBackend::drawString(const char *text, int32_t x, int32_t y)
+{
+    int32_t cellWidth, cellHeight;
+    charCell(cellWidth, cellHeight);
+    int32_t length = 0;
+    for (const char *p = text; *p; p++)
+    {
+        length++;
+    }
+    int32_t totalWidth = length * cellWidth;
+
+    // 对齐方式：0-8 为 上/中/下 x 左/中/右 (TL_DATUM ... BR_DATUM)，9-11 为基线 (按底部处理)
+    uint8_t column = textDatum < 9 ? textDatum % 3 : textDatum - 9;
+    uint8_t row = textDatum < 9 ? textDatum / 3 : 2;
+    x -= column * totalWidth / 2;
+    y -= row * cellHeight / 2;
+
+    bool opaque = textForeground != textBackground;
+    int32_t boxInsetX = std::max<int32_t>(1, cellWidth / 6);
+    int32_t boxInsetY = std::max<int32_t>(1, cellHeight / 5);
+    beginCall();
+    for (int32_t i = 0; i < length; i++)
+    {
+        int32_t cellX = x + i * cellWidth;
+        bool blank = text[i] == ' ';
+        if (opaque)
+        {
+            // 有背景色：整个字符格一个窗口
+            fillWindow(cellX, y, cellWidth, cellHeight, textBackground);
+            if (!blank)
+            {
+                // 方块画在同一个窗口内，不另计窗口和像素
+                Counters saved = counters;
+                fillWindow(cellX + boxInsetX, y + boxInsetY, cellWidth - 2 * boxInsetX, cellHeight - 2 * boxInsetY, textForeground);
+                counters = saved;
+            }
+        }
+        else if (!blank)
+        {
+            // 透明背景：只绘制前景像素，每行一段
+            for (int32_t line = boxInsetY; line < cellHeight - boxInsetY; line++)
+            {
+                fillWindow(cellX + boxInsetX, y + line, cellWidth - 2 * boxInsetX, 1, textForeground);
+            }
+        }
+    }
+    endCall();
+    return (int16_t)totalWidth;
+}
+
+// --- 检查 ---
+
+uint16_t FramebufferBackend::getPixel(int32_t x, int32_t y) const
+{
+    if (x < 0 || y < 0 || x >= screenWidth || y >= screenHeight)
+    {
+        return 0;
+    }
+    return pixels[(size_t)y * screenWidth + x];
+}
+
+uint32_t FramebufferBackend::hash() const
+{
+    uint32_t value = 2166136261u;
+    for (uint16_t pixel : pixels)
+    {
+        value = (value ^ (pixel & 0xFF)) * 16777619u;
+        value = (value ^ (pixel >> 8)) * 16777619u;
+    }
+    return value;
+}
+
+// --- PNG ---
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t length)
+{
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady)
+    {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+            {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static void putBigEndian(std::vector<uint8_t> &out, uint32_t value)
+{
+    out.push_back(value >> 24);
+    out.push_back(value >> 16);
+    out.push_back(value >> 8);
+    out.push_back(value);
+}
+
+// 写一个 PNG 块：长度、类型、数据、CRC (覆盖类型和数据)
+static bool writeChunk(FILE *file, const char *type, const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> chunk;
+    putBigEndian(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    uint32_t crc = crc32Update(0xFFFFFFFFu, chunk.data() + 4, chunk.size() - 4) ^ 0xFFFFFFFFu;
+    putBigEndian(chunk, crc);
+    return fwrite(chunk.data(), 1, chunk.size(), file) == chunk.size();
+}
+
+bool FramebufferBackend::savePng(const char *path) const
+{
+    // 原始扫描线：每行一个过滤类型字节 (0 = None) + RGB888
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t)screenHeight * (1 + screenWidth * 3));
+    for (int32_t y = 0; y < screenHeight; y++)
+    {
+        raw.push_back(0);
+        for (int32_t x = 0; x < screenWidth; x++)
+        {
+            uint16_t c = pixels[(size_t)y * screenWidth + x];
+            uint8_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+            raw.push_back((r << 3) | (r >> 2));
+            raw.push_back((g << 2) | (g >> 4));
+            raw.push_back((b << 3) | (b >> 2));
+        }
+    }
+
+    // zlib 流：头 + 不压缩的 deflate 块 (每块最多 65535 字节) + Adler-32
+    std::vector<uint8_t> idat = {0x78, 0x01};
+    for (size_t offset = 0; offset < raw.size() || offset == 0;)
+    {
+        size_t length = std::min<size_t>(65535, raw.size() - offset);
+        bool last = offset + length == raw.size();
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(length & 0xFF);
+        idat.push_back(length >> 8);
+        idat.push_back(~length & 0xFF);
+        idat.push_back((~length >> 8) & 0xFF);
+        idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + length);
+        offset += length;
+        if (last)
+        {
+            break;
+        }
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBigEndian(idat, (b << 16) | a);
+
+    std::vector<uint8_t> header;
+    putBigEndian(header, screenWidth);
+    putBigEndian(header, screenHeight);
+    header.push_back(8); // 位深
+    header.push_back(2); // 颜色类型：RGB
+    header.push_back(0); // 压缩方式
+    header.push_back(0); // 过滤方式
+    header.push_back(0); // 不隔行
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    bool ok = fwrite(signature, 1, sizeof(signature), file) == sizeof(signature) &&
+              writeChunk(file, "IHDR", header) && writeChunk(file, "IDAT", idat) &&
+              writeChunk(file, "IEND", std::vector<uint8_t>());
+    fclose(file);
+    return ok;
+}
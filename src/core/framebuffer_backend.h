@@ -0,0 +1,119 @@
+#ifndef FRAMEBUFFER_BACKEND_H
+#define FRAMEBUFFER_BACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "display_backend.h"
+
+/**
+ * @brief 内存中的 RGB565 帧缓冲显示后端。
+ * 绘图结果与屏幕相同 (像素按逻辑颜色保存，pushImage 按 setSwapBytes 的语义解释数据)，
+ * 同时按 TFT_eSPI 驱动屏幕的方式统计开销：
+ *  - pixels：推送的像素数 (裁剪后)；
+ *  - windows：设置地址窗口的次数 (每个矩形/线段一次，圆角和透明文本逐段或逐点)；
+ *  - transactions：SPI 事务数 (每个实际绘制了内容的调用一次)。
+ * 用于主机端渲染页面 (tools/host_bench/render.cpp)：比较帧缓冲哈希 (黄金图像) 和每次翻页推送的像素，发现过度绘制回归。
+ * 内建字体的 ASCII 文本没有字形数据 (属于 TFT_eSPI)，每个非空格字符画成一个前景色方块，
+ * 字符格大小与 Font1/Font2/Font4 相同，所以布局和绘制量仍然准确。
+ * 不支持旋转：缓冲区就是旋转后的逻辑屏幕。
+ */
+class FramebufferBackend : public DisplayBackend
+{
+public:
+    struct Counters
+    {
+        uint64_t pixels;       // 推送的像素数
+        uint32_t windows;      // 设置地址窗口的次数
+        uint32_t transactions; // SPI 事务数
+    };
+
+private:
+    int16_t screenWidth;
+    int16_t screenHeight;
+    std::vector<uint16_t> pixels; // 逻辑颜色 (RGB565)，逐行存放
+    Counters counters;
+    int32_t clipX0, clipY0, clipX1, clipY1; // 裁剪区 (右/下边界不含)
+    uint32_t windowsAtCallStart; // 用于判断本次调用是否绘制了内容 (计为一个事务)
+    bool swapBytes;
+    uint16_t textForeground;
+    uint16_t textBackground;
+    uint8_t textSize;
+    uint8_t textFont;
+    uint8_t textDatum;
+
+    // 开始/结束一个绘图调用 (结束时若设置过窗口则计一个事务)
+    void beginCall() { windowsAtCallStart = counters.windows; }
+    void endCall()
+    {
+        if (counters.windows != windowsAtCallStart)
+        {
+            counters.transactions++;
+        }
+    }
+
+    // 裁剪并填充一个窗口 (计一个窗口)；完全在裁剪区外时不计
+    void fillWindow(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+    // 当前内建字体的字符格大小
+    void charCell(int32_t &cellWidth, int32_t &cellHeight) const;
+
+public:
+    FramebufferBackend(int16_t width, int16_t height);
+
+    // 圆角第 row 行 (0 为最外一行) 相对矩形边缘的缩进 (IndexedCanvas 使用同样的圆角)
+    static int32_t cornerInset(int32_t radius, int32_t row);
+
+    void init() override {}
+    void setRotation(uint8_t rotation) override { (void)rotation; }
+
+    int16_t width() const override { return screenWidth; }
+    int16_t height() const override { return screenHeight; }
+
+    void setClipRect(int32_t x, int32_t y, int32_t w, int32_t h) override;
+    void clearClipRect() override;
+    DisplayBackend *createCanvas(int16_t w, int16_t h) override;
+
+    void fillScreen(uint32_t color) override;
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override;
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override;
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color) override;
+    void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color) override;
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) override;
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) override;
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) override;
+    void drawPixel(int32_t x, int32_t y, uint32_t color) override;
+
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) override;
+    void readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data) override;
+    void setSwapBytes(bool swap) override { swapBytes = swap; }
+    bool getSwapBytes() const override { return swapBytes; }
+
+    void setTextColor(uint16_t color) override;
+    void setTextColor(uint16_t foreground, uint16_t background) override;
+    void setTextSize(uint8_t size) override { textSize = size ? size : 1; }
+    void setTextFont(uint8_t font) override { textFont = font; }
+    void setTextDatum(uint8_t datum) override { textDatum = datum; }
+    int16_t drawString(const char *text, int32_t x, int32_t y) override;
+    using DisplayBackend::drawString;
+
+    // --- 检查 ---
+
+    const Counters &getCounters() const { return counters; }
+    void resetCounters() { counters = Counters(); }
+
+    // 读取一个像素的逻辑颜色 (RGB565)；屏幕外返回 0
+    uint16_t getPixel(int32_t x, int32_t y) const;
+
+    /**
+     * @brief 帧缓冲内容的 FNV-1a 哈希，用作黄金图像的指纹。
+     */
+    uint32_t hash() const;
+
+    /**
+     * @brief 把帧缓冲保存为 24 位 PNG (未压缩的 deflate 块，不依赖 zlib)，使用 stdio。
+     * @return 写入成功返回 true。
+     */
+    bool savePng(const char *path) const;
+};
+
+#endif // FRAMEBUFFER_BACKEND_H
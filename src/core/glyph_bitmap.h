@@ -0,0 +1,198 @@
+#ifndef GLYPH_BITMAP_H // 防止头文件被重复包含
+#define GLYPH_BITMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief 裁剪后的字形记录 (只有头文件，不依赖 Arduino，主机端可直接编译)。
+ * 点阵字体原来把每个字形存成完整的 size x size 方块，标点和窄字符大部分是空白。
+ * 字形记录只保存墨迹的外接矩形：
+ * - 头：矩形在 size x size 字符格中的位置 x、y 和宽、高。
+ *   字符格不超过 16 像素时 2 字节 (x | y << 4、(宽 - 1) | (高 - 1) << 4)，否则 4 字节 (x、y、宽、高，字符格不超过 255 像素)；
+ * - 位图：宽 x 高 位的连续位流 (不按行对齐)，像素 i 在第 i 位，低位在前 (与原来的方块格式相同)。
+ * 只有头、没有位图的记录是空白字形 (例如全角空格)。
+ * 裁剪不能让记录比方块小时直接保存原来的方块 (squareBytes() 字节)，因此记录的类型由它的长度区分：
+ * 长度等于 squareBytes() 的是方块，其余是裁剪后的记录。解析时必须知道记录的长度 (索引项的 "bytes"、缓存条目的大小)。
+ * 方块在解析时求出墨迹的外接矩形，绘制同样只推送矩形 (矩形中的行在方块的位流中相隔 size 位)。
+ * 字符格固定宽度排版，步进就是字符格宽度，不保存在记录中。
+ * tools/font_generator.py 直接生成字形记录；旧的方块字体在加载时用 cropSquare() 转换，
+ * 所以内存缓存、快速缓存和绘制都只处理字形记录。
+ */
+struct GlyphBitmap
+{
+    // 字形记录格式的版本：SD 卡上的快速缓存和单字缓存文件名带这个版本，旧版本的缓存不再读取
+    static constexpr int FORMAT_VERSION = 2;
+    // 字符格不超过这个大小时，头的位置和尺寸各用 4 位
+    static constexpr uint16_t NIBBLE_HEADER_MAX_SIZE = 16;
+
+    uint8_t x = 0;
+    uint8_t y = 0;
+    uint8_t width = 0;
+    uint8_t height = 0;
+    const uint8_t *bits = nullptr;
+    uint16_t stride = 0;    // 位流中相邻两行相隔的位数 (裁剪后的记录为宽，方块为 size)
+    size_t firstBit = 0;    // 矩形左上角像素在位流中的位置
+
+    // size x size 字符格的记录头的字节数
+    static size_t headerBytes(uint16_t size) { return size <= NIBBLE_HEADER_MAX_SIZE ? 2 : 4; }
+
+    // 宽 x 高 的位流的字节数
+    static size_t bitBytes(uint16_t width, uint16_t height) { return ((size_t)width * height + 7) / 8; }
+
+    // 方块位图的字节数 (旧格式，也是裁剪不划算时保存的记录)
+    static size_t squareBytes(uint16_t size) { return bitBytes(size, size); }
+
+    // size x size 字符格中最大的字形记录：裁剪后的记录总是比方块小，否则保存方块
+    static size_t maxRecordBytes(uint16_t size) { return squareBytes(size); }
+
+    /**
+     * @brief 解析字形记录。
+     * @param record 记录。
+     * @param bytes 记录的字节数 (区分方块和裁剪后的记录，必须是真实长度)。
+     * @param size 字符格大小。
+     * @return 头合理且长度一致时返回 true。
+     */
+    bool parse(const uint8_t *record, size_t bytes, uint16_t size)
+    {
+        if (bytes == squareBytes(size))
+        {
+            int left, top, right, bottom;
+            inkBox(record, size, left, top, right, bottom);
+            x = (uint8_t)left;
+            y = (uint8_t)top;
+            width = (uint8_t)(right - left);
+            height = (uint8_t)(bottom - top);
+            bits = record;
+            stride = size;
+            firstBit = (size_t)top * size + left;
+            return size <= 255;
+        }
+        const size_t header = headerBytes(size);
+        if (bytes < header)
+        {
+            return false;
+        }
+        bits = record + header;
+        firstBit = 0;
+        if (bytes == header)
+        {
+            x = y = width = height = 0; // 空白字形
+            stride = 0;
+            return true;
+        }
+        if (header == 2)
+        {
+            x = record[0] & 0x0F;
+            y = record[0] >> 4;
+            width = (record[1] & 0x0F) + 1;
+            height = (record[1] >> 4) + 1;
+        }
+        else
+        {
+            x = record[0];
+            y = record[1];
+            width = record[2];
+            height = record[3];
+        }
+        stride = width;
+        return width > 0 && height > 0 && x + width <= size && y + height <= size &&
+               bytes == header + bitBytes(width, height);
+    }
+
+    // 矩形内 (px, py) 处是否有墨迹
+    bool pixel(int px, int py) const
+    {
+        size_t bit = firstBit + (size_t)py * stride + px;
+        return (bits[bit >> 3] >> (bit & 7)) & 1;
+    }
+
+    /**
+     * @brief 方块位图中墨迹的外接矩形 [left, right) x [top, bottom)；空白方块的矩形为空 (全部为 0)。
+     */
+    static void inkBox(const uint8_t *square, uint16_t size, int &left, int &top, int &right, int &bottom)
+    {
+        left = size;
+        top = size;
+        right = 0;
+        bottom = 0;
+        for (int py = 0; py < size; py++)
+        {
+            for (int px = 0; px < size; px++)
+            {
+                size_t bit = (size_t)py * size + px;
+                if ((square[bit >> 3] >> (bit & 7)) & 1)
+                {
+                    left = px < left ? px : left;
+                    right = px + 1 > right ? px + 1 : right;
+                    top = py < top ? py : top;
+                    bottom = py + 1;
+                }
+            }
+        }
+        if (right == 0)
+        {
+            left = top = bottom = 0;
+        }
+    }
+
+    /**
+     * @brief 把旧格式的 size x size 方块位图 (像素 i 在第 i 位，低位在前) 裁剪为字形记录。
+     * 裁剪后不比方块小时输出原来的方块。
+     * @param square 方块位图 (squareBytes(size) 字节)。
+     * @param record 输出 (至少 maxRecordBytes(size) 字节，不能与 square 重叠)。
+     * @return 记录的字节数。
+     */
+    static size_t cropSquare(const uint8_t *square, uint16_t size, uint8_t *record)
+    {
+        auto inked = [square, size](int px, int py) {
+            size_t bit = (size_t)py * size + px;
+            return (square[bit >> 3] >> (bit & 7)) & 1;
+        };
+        int left, top, right, bottom;
+        inkBox(square, size, left, top, right, bottom);
+        const size_t header = headerBytes(size);
+        const int width = right - left; // 0：空白字形
+        const int height = bottom - top;
+        const size_t bytes = header + (width ? bitBytes(width, height) : 0);
+        if (bytes >= squareBytes(size))
+        {
+            memcpy(record, square, squareBytes(size));
+            return squareBytes(size);
+        }
+        if (width == 0)
+        {
+            memset(record, 0, header); // 只有头：空白字形
+            return header;
+        }
+        if (header == 2)
+        {
+            record[0] = (uint8_t)(left | top << 4);
+            record[1] = (uint8_t)((width - 1) | (height - 1) << 4);
+        }
+        else
+        {
+            record[0] = (uint8_t)left;
+            record[1] = (uint8_t)top;
+            record[2] = (uint8_t)width;
+            record[3] = (uint8_t)height;
+        }
+        uint8_t *out = record + header;
+        memset(out, 0, bytes - header);
+        size_t bit = 0;
+        for (int py = 0; py < height; py++)
+        {
+            for (int px = 0; px < width; px++, bit++)
+            {
+                if (inked(left + px, top + py))
+                {
+                    out[bit >> 3] |= (uint8_t)(1 << (bit & 7));
+                }
+            }
+        }
+        return bytes;
+    }
+};
+
+#endif // GLYPH_BITMAP_H
@@ -0,0 +1,133 @@
+#include "glyph_cache.h" // 包含 GlyphCache 类的头文件
+#include "mem_stats.h"   // 按子系统统计内存
+#include <cstdlib>       // malloc, free
+#include <cstring>       // memcpy
+
+// 默认分配函数
+static void *defaultAlloc(void *ctx, size_t bytes)
+{
+    (void)ctx;
+    return malloc(bytes);
+}
+
+GlyphCache::GlyphCache(AllocFn alloc, void *allocCtx)
+    : alloc(alloc ? alloc : defaultAlloc), allocCtx(allocCtx), totalBytes(0)
+{
+}
+
+GlyphCache::~GlyphCache()
+{
+    clear();
+}
+
+// 查找条目并移动到 LRU 链表前端
+const GlyphCache::Entry *GlyphCache::get(const Key &key)
+{
+    auto it = entries.find(key);
+    if (it == entries.end())
+    {
+        return nullptr;
+    }
+    // splice 只移动链表节点，不分配内存
+    lru.splice(lru.begin(), lru, it->second.second);
+    return &it->second.first;
+}
+
+// 复制位图放入缓存 (必要时先淘汰)
+bool GlyphCache::put(const Key &key, const uint8_t *data, uint16_t charSize, size_t dataSize, size_t capacity)
+{
+    if (entries.count(key))
+    {
+        return false; // 已存在，LRU 位置由 get() 维护
+    }
+    if (dataSize > capacity)
+    {
+        return false; // 条目本身比整个缓存还大
+    }
+    if (totalBytes + dataSize > capacity)
+    {
+        evict(capacity - dataSize);
+    }
+
+    uint8_t *bitmap = allocate(dataSize);
+    if (!bitmap)
+    {
+        return false; // 内存分配失败
+    }
+    memcpy(bitmap, data, dataSize);
+    if (!adopt(key, bitmap, charSize, dataSize))
+    {
+        free(bitmap);
+        return false;
+    }
+    return true;
+}
+
+// 接管已分配的位图
+bool GlyphCache::adopt(const Key &key, uint8_t *bitmap, uint16_t charSize, size_t dataSize)
+{
+    if (entries.count(key))
+    {
+        return false;
+    }
+    lru.push_front(key);
+    Entry entry;
+    entry.bitmap = bitmap;
+    entry.size = charSize;
+    entry.dataSize = dataSize;
+    entries[key] = {entry, lru.begin()};
+    totalBytes += dataSize;
+    MemStats::getInstance().recordAlloc(MemTag::FONT_CACHE, dataSize);
+    return true;
+}
+
+// 释放一个条目的位图并从 map 中移除
+void GlyphCache::release(Map::iterator it)
+{
+    free(it->second.first.bitmap);
+    MemStats::getInstance().recordFree(MemTag::FONT_CACHE, it->second.first.dataSize);
+    totalBytes -= it->second.first.dataSize;
+    entries.erase(it);
+}
+
+// 从 LRU 链表末尾 (最少使用) 开始淘汰
+size_t GlyphCache::evict(size_t targetBytes)
+{
+    size_t sizeBefore = totalBytes;
+    while (totalBytes > targetBytes && !lru.empty())
+    {
+        auto it = entries.find(lru.back());
+        if (it != entries.end())
+        {
+            release(it);
+        }
+        lru.pop_back();
+    }
+    return sizeBefore - totalBytes;
+}
+
+// 移除单个条目
+bool GlyphCache::erase(const Key &key)
+{
+    auto it = entries.find(key);
+    if (it == entries.end())
+    {
+        return false;
+    }
+    lru.erase(it->second.second);
+    release(it);
+    return true;
+}
+
+// 清空缓存
+void GlyphCache::clear()
+{
+    for (auto const &item : entries)
+    {
+        free(item.second.first.bitmap);
+        MemStats::getInstance().recordFree(MemTag::FONT_CACHE, item.second.first.dataSize);
+    }
+    entries.clear();
+    lru.clear();
+    totalBytes = 0;
+}
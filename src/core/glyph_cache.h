@@ -0,0 +1,118 @@
+#ifndef GLYPH_CACHE_H // 防止头文件被重复包含
+#define GLYPH_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>     // 键 -> 条目
+#include <list>    // LRU 顺序
+#include <string>  // 键中的 UTF-8 字符
+#include <utility> // std::pair
+
+/**
+ * @brief 字形位图的内存 LRU 缓存 (键为 UTF-8 字符 + 像素大小)。
+ * 只负责查找、LRU 顺序、淘汰和字节计数；位图内存通过 AllocFn 分配 (Font 传入 MemoryBudget::allocate)，
+ * 用 free() 释放，并计入 MemStats 的 FONT_CACHE 标签。预算上报和加锁由使用者 (Font) 负责。
+ * 不依赖 Arduino、SD 和 FreeRTOS，主机端基准测试 (tools/host_bench) 直接编译它。
+ */
+class GlyphCache
+{
+public:
+    /**
+     * @brief 缓存条目。
+     */
+    struct Entry
+    {
+        uint8_t *bitmap; // 缓存拥有的字形记录副本 (格式见 glyph_bitmap.h)
+        uint16_t size;   // 字符的像素大小 (例如 16 表示 16x16)
+        size_t dataSize; // 字形记录占用的字节数
+    };
+
+    // 键：(UTF-8 字符, 像素大小)
+    using Key = std::pair<std::string, uint16_t>;
+    using LruIterator = std::list<Key>::iterator;
+    // 键映射到 {条目, 在 LRU 链表中的位置}
+    using Map = std::map<Key, std::pair<Entry, LruIterator>>;
+
+    /**
+     * @brief 位图内存分配函数。
+     * @param ctx 构造时传入的上下文。
+     * @param bytes 需要的字节数。
+     * @return 可以用 free() 释放的内存；失败返回 nullptr。
+     */
+    typedef void *(*AllocFn)(void *ctx, size_t bytes);
+
+    /**
+     * @param alloc 分配函数 (nullptr 使用 malloc)。
+     * @param allocCtx 分配函数的上下文。
+     */
+    explicit GlyphCache(AllocFn alloc = nullptr, void *allocCtx = nullptr);
+    ~GlyphCache();
+
+    GlyphCache(const GlyphCache &) = delete;
+    GlyphCache &operator=(const GlyphCache &) = delete;
+
+    /**
+     * @brief 查找条目，找到时移动到 LRU 链表前端。
+     * @return 条目指针 (在下一次修改缓存之前有效)；未找到返回 nullptr。
+     */
+    const Entry *get(const Key &key);
+
+    /**
+     * @brief 是否已缓存 (不调整 LRU 顺序)。
+     */
+    bool contains(const Key &key) const { return entries.count(key) != 0; }
+
+    /**
+     * @brief 复制一份位图放入缓存；超出 capacity 时先淘汰最少使用的条目。
+     * @param capacity 放入后允许的最大总字节数。
+     * @return 放入成功返回 true；已存在、条目比 capacity 还大或分配失败返回 false。
+     */
+    bool put(const Key &key, const uint8_t *data, uint16_t charSize, size_t dataSize, size_t capacity);
+
+    /**
+     * @brief 接管一块已分配好 (由 allocate() 得到) 的位图，放到 LRU 前端，不做容量检查 (加载快速缓存时使用)。
+     * @return 已存在时返回 false (调用方仍拥有 bitmap)。
+     */
+    bool adopt(const Key &key, uint8_t *bitmap, uint16_t charSize, size_t dataSize);
+
+    /**
+     * @brief 用构造时的分配函数分配位图内存 (配合 adopt() 使用)。
+     */
+    uint8_t *allocate(size_t bytes) { return (uint8_t *)alloc(allocCtx, bytes); }
+
+    /**
+     * @brief 按 LRU 顺序淘汰，直到总字节数不超过 targetBytes。
+     * @return 释放的字节数。
+     */
+    size_t evict(size_t targetBytes);
+
+    /**
+     * @brief 移除单个条目。
+     * @return 条目存在时返回 true。
+     */
+    bool erase(const Key &key);
+
+    /**
+     * @brief 清空缓存，释放所有位图。
+     */
+    void clear();
+
+    size_t bytes() const { return totalBytes; }
+    size_t count() const { return entries.size(); }
+
+    /**
+     * @brief 所有条目 (按键排序，只读)，用于保存快速缓存。
+     */
+    const Map &all() const { return entries; }
+
+private:
+    AllocFn alloc;
+    void *allocCtx;
+    Map entries;
+    std::list<Key> lru; // 最近使用的在前端
+    size_t totalBytes;
+
+    void release(Map::iterator it); // 释放位图并更新计数 (不修改 lru)
+};
+
+#endif // GLYPH_CACHE_H
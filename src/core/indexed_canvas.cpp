@@ -0,0 +1,441 @@
+#include "indexed_canvas.h"
+#include <algorithm>               // std::min / std::max / std::swap
+#include <cstdlib>                 // abs / free
+#include <cstring>                 // memset / strlen
+#include "framebuffer_backend.h"   // FramebufferBackend::cornerInset (相同的圆角)
+#include "memory_budget.h"         // 索引缓冲区和临时缓冲区
+#include "mem_stats.h"             // UI_CANVAS 标签
+#include "../config/config.h"      // INDEXED_CANVAS_FLUSH_ROWS
+
+IndexedCanvas::IndexedCanvas(DisplayBackend *screen, int16_t width, int16_t rows)
+    : screen(screen), canvasWidth(width), bandRows(rows), bandY(0), indices(nullptr), paletteSize(0), lastIndex(0),
+      clipX0(0), clipY0(0), clipX1(width), clipY1(screen->height()), dirtyX0(0), dirtyY0(0), dirtyX1(0), dirtyY1(0),
+      swapBytes(false), textForeground(0xFFFF), textBackground(0xFFFF), textSize(1), textFont(1), textDatum(0),
+      scratch(nullptr), scratchWidth(0), scratchHeight(0)
+{
+}
+
+IndexedCanvas::~IndexedCanvas()
+{
+    if (indices)
+    {
+        free(indices);
+        MemStats::getInstance().recordFree(MemTag::UI_CANVAS, (size_t)canvasWidth * bandRows);
+    }
+    delete scratch;
+}
+
+bool IndexedCanvas::create()
+{
+    size_t bytes = (size_t)canvasWidth * bandRows;
+    indices = (uint8_t *)MemoryBudget::getInstance().allocate(bytes);
+    if (!indices)
+    {
+        return false;
+    }
+    MemStats::getInstance().recordAlloc(MemTag::UI_CANVAS, bytes);
+    memset(indices, 0, bytes);
+    resetPalette();
+    return true;
+}
+
+void IndexedCanvas::setBand(int16_t y)
+{
+    bandY = y;
+    dirtyX0 = dirtyX1 = 0;
+}
+
+void IndexedCanvas::resetPalette()
+{
+    palette[0] = 0x0000; // 索引 0 为黑色 (新分配的缓冲区全为 0)
+    paletteSize = 1;
+    lastIndex = 0;
+}
+
+// --- 内部工具 ---
+
+uint8_t IndexedCanvas::colorIndex(uint16_t color)
+{
+    if (palette[lastIndex] == color)
+    {
+        return lastIndex;
+    }
+    for (uint16_t i = 0; i < paletteSize; i++)
+    {
+        if (palette[i] == color)
+        {
+            lastIndex = (uint8_t)i;
+            return lastIndex;
+        }
+    }
+    if (paletteSize < 256)
+    {
+        palette[paletteSize] = color;
+        lastIndex = (uint8_t)paletteSize++;
+        return lastIndex;
+    }
+
+    // 调色板已满：取 RGB 距离最小的颜色 (界面页面只有十几种颜色，正常不会走到这里)
+    int32_t r = color >> 11, g = (color >> 5) & 0x3F, b = color & 0x1F;
+    int32_t bestDistance = INT32_MAX;
+    for (uint16_t i = 0; i < paletteSize; i++)
+    {
+        int32_t dr = (palette[i] >> 11) - r, dg = ((palette[i] >> 5) & 0x3F) - g, db = (palette[i] & 0x1F) - b;
+        int32_t distance = 4 * dr * dr + dg * dg + 4 * db * db; // 红/蓝 5 位，绿 6 位
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            lastIndex = (uint8_t)i;
+        }
+    }
+    return lastIndex;
+}
+
+void IndexedCanvas::fillIndex(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t index)
+{
+    int32_t x0 = std::max<int32_t>(x, clipX0);
+    int32_t x1 = std::min<int32_t>(x + w, clipX1);
+    int32_t y0 = std::max<int32_t>(std::max<int32_t>(y, clipY0), bandY);
+    int32_t y1 = std::min<int32_t>(std::min<int32_t>(y + h, clipY1), bandY + bandRows);
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+    for (int32_t row = y0; row < y1; row++)
+    {
+        memset(indices + (size_t)(row - bandY) * canvasWidth + x0, index, x1 - x0);
+    }
+    markDirty(x0, y0, x1, y1);
+}
+
+void IndexedCanvas::markDirty(int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+{
+    if (dirtyX0 >= dirtyX1)
+    {
+        dirtyX0 = x0;
+        dirtyY0 = y0;
+        dirtyX1 = x1;
+        dirtyY1 = y1;
+        return;
+    }
+    dirtyX0 = std::min(dirtyX0, x0);
+    dirtyY0 = std::min(dirtyY0, y0);
+    dirtyX1 = std::max(dirtyX1, x1);
+    dirtyY1 = std::max(dirtyY1, y1);
+}
+
+void IndexedCanvas::writePixels(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, bool logical)
+{
+    int32_t x0 = std::max<int32_t>(x, clipX0);
+    int32_t x1 = std::min<int32_t>(x + w, clipX1);
+    int32_t y0 = std::max<int32_t>(std::max<int32_t>(y, clipY0), bandY);
+    int32_t y1 = std::min<int32_t>(std::min<int32_t>(y + h, clipY1), bandY + bandRows);
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+    for (int32_t row = y0; row < y1; row++)
+    {
+        const uint16_t *src = data + (size_t)(row - y) * w + (x0 - x);
+        uint8_t *dst = indices + (size_t)(row - bandY) * canvasWidth + x0;
+        for (int32_t col = x0; col < x1; col++)
+        {
+            uint16_t value = *src++;
+            // 与 FramebufferBackend 相同：swapBytes = false 时数据是内存中的字节顺序
+            *dst++ = colorIndex(logical ? value : (uint16_t)((value >> 8) | (value << 8)));
+        }
+    }
+    markDirty(x0, y0, x1, y1);
+}
+
+void IndexedCanvas::textCell(int32_t &cellWidth, int32_t &cellHeight) const
+{
+    switch (textFont)
+    {
+    case 1: // GLCD 5x7 (含间距 6x8)
+        cellWidth = 6;
+        cellHeight = 8;
+        break;
+    case 4: // Font4：26 像素高，最宽的字形约 26 像素
+        cellWidth = 26;
+        cellHeight = 26;
+        break;
+    default: // Font2：16 像素高，最宽的字形不超过 16 像素
+        cellWidth = 16;
+        cellHeight = 16;
+        break;
+    }
+    cellWidth *= textSize;
+    cellHeight *= textSize;
+}
+
+bool IndexedCanvas::ensureScratch(int16_t w, int16_t h)
+{
+    if (scratch && w <= scratchWidth && h <= scratchHeight)
+    {
+        return true;
+    }
+    delete scratch;
+    scratchWidth = std::max(w, scratchWidth);
+    scratchHeight = std::max(h, scratchHeight);
+    scratch = screen->createCanvas(scratchWidth, scratchHeight);
+    if (!scratch)
+    {
+        scratchWidth = scratchHeight = 0;
+        return false;
+    }
+    return true;
+}
+
+// --- 裁剪区 ---
+
+void IndexedCanvas::setClipRect(int32_t x, int32_t y, int32_t w, int32_t h)
+{
+    clipX0 = std::max<int32_t>(x, 0);
+    clipY0 = std::max<int32_t>(y, 0);
+    clipX1 = std::min<int32_t>(x + w, canvasWidth);
+    clipY1 = std::min<int32_t>(y + h, screen->height());
+}
+
+void IndexedCanvas::clearClipRect()
+{
+    clipX0 = 0;
+    clipY0 = 0;
+    clipX1 = canvasWidth;
+    clipY1 = screen->height();
+}
+
+// --- 图形 (与 FramebufferBackend 相同的分解方式) ---
+
+void IndexedCanvas::fillScreen(uint32_t color)
+{
+    fillIndex(0, bandY, canvasWidth, bandRows, colorIndex(color));
+}
+
+void IndexedCanvas::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    fillIndex(x, y, w, h, colorIndex(color));
+}
+
+void IndexedCanvas::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    uint8_t index = colorIndex(color);
+    fillIndex(x, y, w, 1, index);
+    fillIndex(x, y + h - 1, w, 1, index);
+    fillIndex(x, y + 1, 1, h - 2, index);
+    fillIndex(x + w - 1, y + 1, 1, h - 2, index);
+}
+
+void IndexedCanvas::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color)
+{
+    uint8_t index = colorIndex(color);
+    radius = std::min(radius, std::min(w, h) / 2);
+    fillIndex(x, y + radius, w, h - 2 * radius, index);
+    for (int32_t row = 0; row < radius; row++)
+    {
+        int32_t inset = FramebufferBackend::cornerInset(radius, row);
+        fillIndex(x + inset, y + row, w - 2 * inset, 1, index);         // 上圆角
+        fillIndex(x + inset, y + h - 1 - row, w - 2 * inset, 1, index); // 下圆角
+    }
+}
+
+void IndexedCanvas::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color)
+{
+    uint8_t index = colorIndex(color);
+    radius = std::min(radius, std::min(w, h) / 2);
+    fillIndex(x + radius, y, w - 2 * radius, 1, index);
+    fillIndex(x + radius, y + h - 1, w - 2 * radius, 1, index);
+    fillIndex(x, y + radius, 1, h - 2 * radius, index);
+    fillIndex(x + w - 1, y + radius, 1, h - 2 * radius, index);
+    int32_t previous = radius;
+    for (int32_t row = 0; row < radius; row++)
+    {
+        int32_t inset = FramebufferBackend::cornerInset(radius, row);
+        int32_t last = std::max(inset, (row == 0 ? radius : previous) - 1);
+        for (int32_t px = inset; px <= last && px < radius; px++)
+        {
+            fillIndex(x + px, y + row, 1, 1, index);
+            fillIndex(x + w - 1 - px, y + row, 1, 1, index);
+            fillIndex(x + px, y + h - 1 - row, 1, 1, index);
+            fillIndex(x + w - 1 - px, y + h - 1 - row, 1, 1, index);
+        }
+        previous = inset;
+    }
+}
+
+void IndexedCanvas::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
+{
+    fillIndex(x, y, w, 1, colorIndex(color));
+}
+
+void IndexedCanvas::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
+{
+    fillIndex(x, y, 1, h, colorIndex(color));
+}
+
+void IndexedCanvas::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+    uint8_t index = colorIndex(color);
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep)
+    {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    int32_t dx = x1 - x0;
+    int32_t dy = abs(y1 - y0);
+    int32_t err = dx / 2;
+    int32_t step = y0 < y1 ? 1 : -1;
+    int32_t runStart = x0;
+    for (int32_t x = x0; x <= x1; x++)
+    {
+        err -= dy;
+        if (err < 0 || x == x1)
+        {
+            int32_t length = x - runStart + 1;
+            if (steep)
+            {
+                fillIndex(y0, runStart, 1, length, index);
+            }
+            else
+            {
+                fillIndex(runStart, y0, length, 1, index);
+            }
+            if (err < 0)
+            {
+                y0 += step;
+                err += dx;
+            }
+            runStart = x + 1;
+        }
+    }
+}
+
+void IndexedCanvas::drawPixel(int32_t x, int32_t y, uint32_t color)
+{
+    fillIndex(x, y, 1, 1, colorIndex(color));
+}
+
+void IndexedCanvas::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data)
+{
+    writePixels(x, y, w, h, data, swapBytes);
+}
+
+void IndexedCanvas::readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data)
+{
+    for (int32_t row = y; row < y + h; row++)
+    {
+        bool inBand = row >= bandY && row < bandY + bandRows;
+        for (int32_t col = x; col < x + w; col++)
+        {
+            *data++ = inBand && col >= 0 && col < canvasWidth ? palette[indices[(size_t)(row - bandY) * canvasWidth + col]] : 0;
+        }
+    }
+}
+
+// --- 内建字体文本 ---
+
+void IndexedCanvas::setTextColor(uint16_t color)
+{
+    textForeground = color;
+    textBackground = color; // 与 TFT_eSPI 相同：前景色等于背景色表示背景透明
+}
+
+void IndexedCanvas::setTextColor(uint16_t foreground, uint16_t background)
+{
+    textForeground = foreground;
+    textBackground = background;
+}
+
+int16_t IndexedCanvas::drawString(const char *text, int32_t x, int32_t y)
+{
+    // 估计文本占用的矩形 (按对齐方式)，与裁剪区和条带求交
+    int32_t cellWidth, cellHeight;
+    textCell(cellWidth, cellHeight);
+    int32_t boxWidth = (int32_t)strlen(text) * cellWidth;
+    int32_t boxHeight = cellHeight + cellHeight / 4; // 基线对齐时下伸部分在基线之下
+    uint8_t column = textDatum < 9 ? textDatum % 3 : textDatum - 9;
+    uint8_t row = textDatum < 9 ? textDatum / 3 : 2;
+    int32_t boxX = x - column * boxWidth / 2;
+    int32_t boxY = textDatum < 9 ? y - row * cellHeight / 2 : y - cellHeight;
+    int32_t x0 = std::max<int32_t>(boxX, clipX0);
+    int32_t x1 = std::min<int32_t>(boxX + boxWidth, clipX1);
+    int32_t y0 = std::max<int32_t>(std::max<int32_t>(boxY, clipY0), bandY);
+    int32_t y1 = std::min<int32_t>(std::min<int32_t>(boxY + boxHeight, clipY1), bandY + bandRows);
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return (int16_t)boxWidth;
+    }
+    int32_t w = x1 - x0, h = y1 - y0;
+
+    MemoryBudget &budget = MemoryBudget::getInstance();
+    uint16_t *pixels = (uint16_t *)budget.acquireTransient((size_t)w * h * sizeof(uint16_t));
+    if (!pixels || !ensureScratch(w, h))
+    {
+        budget.releaseTransient(pixels);
+        return (int16_t)boxWidth;
+    }
+
+    // 临时画布上先展开当前像素 (透明背景的文本需要)，用屏幕后端的字体绘制后量化写回
+    readRect(x0, y0, w, h, pixels);
+    bool scratchSwap = scratch->getSwapBytes();
+    scratch->setSwapBytes(true);
+    scratch->pushImage(0, 0, w, h, pixels);
+    scratch->setSwapBytes(scratchSwap);
+    scratch->setTextFont(textFont);
+    scratch->setTextSize(textSize);
+    scratch->setTextColor(textForeground, textBackground);
+    scratch->setTextDatum(textDatum);
+    int16_t drawnWidth = scratch->drawString(text, x - x0, y - y0);
+    scratch->readRect(0, 0, w, h, pixels);
+    writePixels(x0, y0, w, h, pixels, true);
+    budget.releaseTransient(pixels);
+    return drawnWidth;
+}
+
+// --- 推送 ---
+
+uint32_t IndexedCanvas::flush()
+{
+    if (dirtyX0 >= dirtyX1)
+    {
+        return 0;
+    }
+    int32_t w = dirtyX1 - dirtyX0;
+    int32_t rowsPerPush = std::min<int32_t>(INDEXED_CANVAS_FLUSH_ROWS, dirtyY1 - dirtyY0);
+    MemoryBudget &budget = MemoryBudget::getInstance();
+    uint16_t *line = (uint16_t *)budget.acquireTransient((size_t)w * rowsPerPush * sizeof(uint16_t));
+    if (!line)
+    {
+        return 0; // 内存不足：保留脏区域，下一次 flush 再试
+    }
+
+    // 调色板展开为逻辑颜色，按 swapBytes = true 推送；每次推送 rowsPerPush 行 (一个地址窗口)
+    bool swap = screen->getSwapBytes();
+    screen->setSwapBytes(true);
+    uint32_t pushed = 0;
+    for (int32_t y = dirtyY0; y < dirtyY1; y += rowsPerPush)
+    {
+        int32_t rows = std::min(rowsPerPush, dirtyY1 - y);
+        uint16_t *dst = line;
+        for (int32_t row = y; row < y + rows; row++)
+        {
+            const uint8_t *src = indices + (size_t)(row - bandY) * canvasWidth + dirtyX0;
+            for (int32_t col = 0; col < w; col++)
+            {
+                *dst++ = palette[*src++];
+            }
+        }
+        screen->pushImage(dirtyX0, y, w, rows, line);
+        pushed += (uint32_t)w * rows;
+    }
+    screen->setSwapBytes(swap);
+    budget.releaseTransient(line);
+    dirtyX0 = dirtyX1 = 0;
+    return pushed;
+}
@@ -0,0 +1,115 @@
+#ifndef INDEXED_CANVAS_H
+#define INDEXED_CANVAS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "display_backend.h"
+
+/**
+ * @brief 8 位调色板离屏画布：每个像素 1 字节 (调色板索引)，推送时经调色板展开为 RGB565。
+ * 菜单、文件浏览器等界面只用少数几种颜色，整屏 16 位帧缓冲 (150 KB) 放不进内部 RAM，
+ * 8 位画布整屏为 77 KB；没有 PSRAM 时只分配 bandRows 行 (一个条带)，Compositor 逐条带绘制。
+ * 坐标为屏幕坐标：画布覆盖 [bandY, bandY + bandRows) 行，setBand() 移动条带，条带外的绘图被裁掉。
+ * 图元 (矩形、圆角、直线) 直接写索引，圆角与 FramebufferBackend 相同；
+ * pushImage 的 RGB565 像素按颜色查找/加入调色板 (满 256 色后取最接近的颜色)；
+ * 内建字体文本在屏幕后端创建的 16 位临时画布上绘制 (先展开当前像素作为背景)，再量化写回。
+ * flush() 只推送条带内被修改过的外包矩形 (脏区域)，每次推送 INDEXED_CANVAS_FLUSH_ROWS 行。
+ * 线程安全：与 Display 相同，只能在主循环任务中调用。
+ */
+class IndexedCanvas : public DisplayBackend
+{
+private:
+    DisplayBackend *screen; // 屏幕后端：创建临时画布和 flush() 的默认目标
+    int16_t canvasWidth;
+    int16_t bandRows;
+    int16_t bandY;            // 条带第一行的屏幕坐标
+    uint8_t *indices;         // bandRows 行，每行 canvasWidth 个索引
+    uint16_t palette[256];    // 逻辑颜色 (RGB565)
+    uint16_t paletteSize;
+    uint8_t lastIndex;        // 上一次查找的结果 (连续绘制同一种颜色时不用再搜索)
+    int32_t clipX0, clipY0, clipX1, clipY1;     // 裁剪区 (屏幕坐标，右/下边界不含)
+    int32_t dirtyX0, dirtyY0, dirtyX1, dirtyY1; // 本条带被修改过的外包矩形 (dirtyX0 >= dirtyX1 表示没有)
+    bool swapBytes;
+    uint16_t textForeground;
+    uint16_t textBackground;
+    uint8_t textSize;
+    uint8_t textFont;
+    uint8_t textDatum;
+    DisplayBackend *scratch;  // 绘制文本用的 16 位临时画布 (按需增大)
+    int16_t scratchWidth;
+    int16_t scratchHeight;
+
+    // 颜色对应的调色板索引 (不存在时加入调色板)
+    uint8_t colorIndex(uint16_t color);
+    // 裁剪后用一个索引填充矩形，并扩大脏区域
+    void fillIndex(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t index);
+    // 扩大脏区域 (屏幕坐标，右/下边界不含)
+    void markDirty(int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+    // 把像素量化后写入 (logical 为 false 时数据是内存中的字节顺序，与 pushImage 的 swapBytes 语义相同)
+    void writePixels(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, bool logical);
+    // 当前内建字体的字符格估计 (不小于实际字形，用来确定临时画布的大小)
+    void textCell(int32_t &cellWidth, int32_t &cellHeight) const;
+    bool ensureScratch(int16_t w, int16_t h);
+
+public:
+    /**
+     * @param screen 屏幕后端 (用于创建临时画布，flush() 推送到这里)。
+     * @param width 画布宽度 (通常为屏幕宽度)。
+     * @param rows 条带行数 (整屏时为屏幕高度)。
+     */
+    IndexedCanvas(DisplayBackend *screen, int16_t width, int16_t rows);
+    ~IndexedCanvas() override;
+
+    // 分配索引缓冲区 (MemoryBudget::allocate，有 PSRAM 时在 PSRAM 中)，失败返回 false
+    bool create();
+
+    // 把条带移动到从屏幕第 y 行开始 (清除脏区域，像素内容不变，需要重新绘制)
+    void setBand(int16_t y);
+    int16_t getBandY() const { return bandY; }
+    int16_t getBandRows() const { return bandRows; }
+
+    // 清空调色板 (不再需要以前的颜色时，例如换页面后)
+    void resetPalette();
+    uint16_t getPaletteSize() const { return paletteSize; }
+
+    /**
+     * @brief 把脏区域经调色板展开后推送到屏幕，然后清除脏区域。
+     * @return 推送的像素数。
+     */
+    uint32_t flush();
+
+    void init() override {}
+    void setRotation(uint8_t rotation) override { (void)rotation; }
+
+    int16_t width() const override { return canvasWidth; }
+    int16_t height() const override { return bandRows; }
+
+    void setClipRect(int32_t x, int32_t y, int32_t w, int32_t h) override;
+    void clearClipRect() override;
+    DisplayBackend *createCanvas(int16_t w, int16_t h) override { return screen->createCanvas(w, h); }
+
+    void fillScreen(uint32_t color) override;
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override;
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override;
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color) override;
+    void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color) override;
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) override;
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) override;
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) override;
+    void drawPixel(int32_t x, int32_t y, uint32_t color) override;
+
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) override;
+    void readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data) override;
+    void setSwapBytes(bool swap) override { swapBytes = swap; }
+    bool getSwapBytes() const override { return swapBytes; }
+
+    void setTextColor(uint16_t color) override;
+    void setTextColor(uint16_t foreground, uint16_t background) override;
+    void setTextSize(uint8_t size) override { textSize = size ? size : 1; }
+    void setTextFont(uint8_t font) override { textFont = font; }
+    void setTextDatum(uint8_t datum) override { textDatum = datum; }
+    int16_t drawString(const char *text, int32_t x, int32_t y) override;
+    using DisplayBackend::drawString;
+};
+
+#endif // INDEXED_CANVAS_H
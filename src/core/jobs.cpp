@@ -0,0 +1,221 @@
+#include "jobs.h" // 包含 JobSystem 类的头文件
+#include "mem_stats.h" // 统计 future 占用
+#include "scheduler.h" // 任务结束时唤醒主循环
+
+// 初始化静态单例实例指针
+JobSystem *JobSystem::instance = nullptr;
+
+// --- JobFuture ---
+
+JobFuture::JobFuture(JobType type, JobFunction function, void *arg, JobArgDeleter argDeleter)
+    : currentState(PENDING), cancelRequested(false), refCount(2), // 提交方 + 工作线程各一个引用
+      jobType(type), function(function), arg(arg), argDeleter(argDeleter),
+      submitUs(micros()), startUs(0), endUs(0)
+{
+    MemStats::getInstance().recordAlloc(MemTag::JOBS, sizeof(JobFuture));
+}
+
+// 最后一个引用释放时调用：如果参数归任务所有，在这里释放
+JobFuture::~JobFuture()
+{
+    MemStats::getInstance().recordFree(MemTag::JOBS, sizeof(JobFuture));
+    if (argDeleter && arg)
+    {
+        argDeleter(arg);
+    }
+}
+
+// 阻塞等待任务结束 (轮询，避免为每个任务创建信号量)
+bool JobFuture::wait(uint32_t timeoutMs)
+{
+    uint32_t start = millis();
+    while (!isReady())
+    {
+        if (millis() - start >= timeoutMs)
+        {
+            return false;
+        }
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+// 释放一个引用，最后一个引用释放时删除 future
+void JobFuture::release()
+{
+    if (refCount.fetch_sub(1) == 1)
+    {
+        delete this;
+    }
+}
+
+// --- JobSystem ---
+
+JobSystem::JobSystem() : ioQueue(nullptr), cpuQueue(nullptr), pendingJobs(nullptr), started(false)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        jobsCompleted[i] = 0;
+        jobsStolen[i] = 0;
+    }
+}
+
+// 获取单例实例
+JobSystem &JobSystem::getInstance()
+{
+    if (!instance)
+    {
+        instance = new JobSystem();
+    }
+    return *instance;
+}
+
+// 创建队列和工作线程
+bool JobSystem::begin()
+{
+    if (started)
+    {
+        return true;
+    }
+
+    ioQueue = xQueueCreate(JOB_QUEUE_LENGTH, sizeof(JobFuture *));
+    cpuQueue = xQueueCreate(JOB_QUEUE_LENGTH, sizeof(JobFuture *));
+    pendingJobs = xSemaphoreCreateCounting(JOB_QUEUE_LENGTH * 2, 0);
+    if (!ioQueue || !cpuQueue || !pendingJobs)
+    {
+        Serial.println("JobSystem：创建队列失败，任务将在调用方同步执行。");
+        return false;
+    }
+
+    workers[0] = {this, 0, ioQueue, cpuQueue};
+    workers[1] = {this, 1, cpuQueue, ioQueue};
+
+    BaseType_t ioOk = xTaskCreatePinnedToCore(workerMain, "jobs_io", JOB_WORKER_STACK_SIZE,
+                                              &workers[0], JOB_WORKER_PRIORITY, nullptr, JOB_IO_CORE);
+    BaseType_t cpuOk = xTaskCreatePinnedToCore(workerMain, "jobs_cpu", JOB_WORKER_STACK_SIZE,
+                                               &workers[1], JOB_WORKER_PRIORITY, nullptr, JOB_CPU_CORE);
+    if (ioOk != pdPASS || cpuOk != pdPASS)
+    {
+        // 至少一个线程启动成功时仍可工作 (另一个队列的任务会被窃取)
+        Serial.printf("JobSystem：工作线程启动失败 (io=%d, cpu=%d)\n", ioOk, cpuOk);
+        if (ioOk != pdPASS && cpuOk != pdPASS)
+        {
+            return false;
+        }
+    }
+
+    started = true;
+    Serial.printf("JobSystem 已启动：I/O 线程位于核心 %d，计算线程位于核心 %d\n", JOB_IO_CORE, JOB_CPU_CORE);
+    return true;
+}
+
+// 工作线程主函数
+void JobSystem::workerMain(void *param)
+{
+    WorkerContext *ctx = static_cast<WorkerContext *>(param);
+    JobSystem *system = ctx->system;
+
+    for (;;)
+    {
+        // 每个提交都会释放一次信号量，因此取得信号量后两个队列中至少有一个任务
+        if (xSemaphoreTake(system->pendingJobs, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+
+        JobFuture *job = nullptr;
+        if (xQueueReceive(ctx->ownQueue, &job, 0) != pdTRUE)
+        {
+            // 自己的队列为空：从另一个队列窃取
+            if (xQueueReceive(ctx->otherQueue, &job, 0) != pdTRUE)
+            {
+                continue;
+            }
+            system->jobsStolen[ctx->workerIndex]++;
+        }
+
+        system->execute(job, ctx->workerIndex);
+
+        // 让出一个 tick，避免连续的长任务饿死同核心的 IDLE 任务 (任务看门狗)
+        vTaskDelay(1);
+    }
+}
+
+// 在工作线程上执行单个任务
+void JobSystem::execute(JobFuture *job, uint8_t workerIndex)
+{
+    job->startUs = micros();
+    if (job->isCancelled())
+    {
+        job->endUs = job->startUs;
+        job->currentState.store(JobFuture::CANCELLED);
+    }
+    else
+    {
+        job->currentState.store(JobFuture::RUNNING);
+        bool ok = job->function(*job, job->arg);
+        job->endUs = micros();
+        job->currentState.store(ok ? JobFuture::DONE : JobFuture::FAILED);
+        Scheduler::wake(); // 提交方在下一次 handleLoop() 中收取结果，不必等到休眠超时
+    }
+    jobsCompleted[workerIndex]++;
+    job->release(); // 释放工作线程持有的引用
+}
+
+// 提交任务
+JobFuture *JobSystem::submit(JobType type, JobFunction function, void *arg, JobArgDeleter argDeleter)
+{
+    if (!function)
+    {
+        if (argDeleter && arg)
+        {
+            argDeleter(arg);
+        }
+        return nullptr;
+    }
+
+    JobFuture *job = new (std::nothrow) JobFuture(type, function, arg, argDeleter);
+    if (!job)
+    {
+        if (argDeleter && arg)
+        {
+            argDeleter(arg);
+        }
+        return nullptr;
+    }
+
+    if (!started)
+    {
+        // 没有工作线程：在调用方同步执行，保证调用方的轮询逻辑仍然成立
+        execute(job, (type == JobType::SD_READ || type == JobType::FONT_PREFETCH) ? 0 : 1);
+        return job;
+    }
+
+    QueueHandle_t queue = (type == JobType::SD_READ || type == JobType::FONT_PREFETCH) ? ioQueue : cpuQueue;
+    if (xQueueSend(queue, &job, 0) != pdTRUE)
+    {
+        delete job; // 队列已满 (参数随 future 一起释放)，调用方稍后重试或自行同步处理
+        return nullptr;
+    }
+    xSemaphoreGive(pendingJobs);
+    return job;
+}
+
+// 等待中的任务数量
+uint32_t JobSystem::pendingCount() const
+{
+    if (!started)
+    {
+        return 0;
+    }
+    return uxQueueMessagesWaiting(ioQueue) + uxQueueMessagesWaiting(cpuQueue);
+}
+
+// 输出统计信息
+void JobSystem::printStats() const
+{
+    Serial.printf("JobSystem: io 完成 %lu (窃取 %lu), cpu 完成 %lu (窃取 %lu), 等待 %lu\n",
+                  (unsigned long)jobsCompleted[0].load(), (unsigned long)jobsStolen[0].load(),
+                  (unsigned long)jobsCompleted[1].load(), (unsigned long)jobsStolen[1].load(),
+                  (unsigned long)pendingCount());
+}
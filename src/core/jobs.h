@@ -0,0 +1,203 @@
+#ifndef JOBS_H // 防止头文件被重复包含
+#define JOBS_H
+
+#include <Arduino.h>
+#include <atomic>               // 任务状态在两个核心之间共享，使用原子变量
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "../config/config.h"   // 工作线程的核心、栈大小、队列长度
+
+/**
+ * @brief 任务类型。
+ * 决定任务优先进入哪个工作队列：
+ *  - SD_READ / FONT_PREFETCH 进入 I/O 队列 (JOB_IO_CORE)，
+ *  - DECODE / LAYOUT 进入计算队列 (JOB_CPU_CORE)。
+ * 一个工作线程空闲时会从另一个队列“窃取”任务，因此类型只是亲和性提示，不是硬性绑定。
+ */
+enum class JobType : uint8_t
+{
+    SD_READ,       // 从 SD 卡读取数据 (例如预读下一张漫画图片)
+    DECODE,        // 解码 / 像素格式转换
+    LAYOUT,        // 文本排版 (换行计算)
+    FONT_PREFETCH  // 预先把字形加载到 Font 内存缓存
+};
+
+class JobFuture;
+
+/**
+ * @brief 任务函数类型。在工作线程上执行。
+ * 任务函数不能调用 Display (SPI 屏幕只属于主循环)，访问 Font 时需持有 Font::Guard。
+ * 长任务应定期检查 job.isCancelled() 并尽早返回。
+ * @param job 当前任务的 future，用于检查取消请求。
+ * @param arg 提交时传入的参数指针 (由提交方负责其生命周期，直到 future 就绪)。
+ * @return 成功返回 true，失败返回 false。
+ */
+using JobFunction = bool (*)(JobFuture &job, void *arg);
+
+/**
+ * @brief 任务参数释放函数类型 (可选)。
+ * 如果提交时提供，参数的所有权转移给任务：最后一个引用释放时 (任务结束且提交方已 release)
+ * 调用它来释放参数。这样提交方可以在 cleanup() 中直接 cancel() + release()，无需等待任务结束。
+ */
+using JobArgDeleter = void (*)(void *arg);
+
+/**
+ * @brief 任务完成状态 (future)。
+ * 由 JobSystem::submit() 创建，提交方在 Page::handleLoop() 中轮询 isReady() (任务结束时会唤醒主循环)，
+ * 使用完后必须调用 release()。future 使用引用计数，提交方和工作线程各持有一个引用，
+ * 因此即使提交方先释放，工作线程也能安全地写入完成状态。
+ */
+class JobFuture
+{
+public:
+    enum State : uint8_t
+    {
+        PENDING,   // 已进入队列，尚未开始
+        RUNNING,   // 正在工作线程上执行
+        DONE,      // 执行成功
+        FAILED,    // 任务函数返回 false
+        CANCELLED  // 开始前被取消
+    };
+
+    State state() const { return (State)currentState.load(); }
+
+    /**
+     * @brief 任务是否已结束 (成功、失败或被取消)。主循环中非阻塞轮询使用。
+     */
+    bool isReady() const
+    {
+        State s = state();
+        return s == DONE || s == FAILED || s == CANCELLED;
+    }
+
+    bool succeeded() const { return state() == DONE; }
+
+    /**
+     * @brief 是否已请求取消。任务函数内部用来提前退出。
+     */
+    bool isCancelled() const { return cancelRequested.load(); }
+
+    /**
+     * @brief 请求取消。尚未开始的任务不会再执行；正在执行的任务需要自己检查 isCancelled()。
+     */
+    void cancel() { cancelRequested.store(true); }
+
+    /**
+     * @brief 阻塞等待任务结束。只应在 cleanup() 等必须回收参数内存的场合使用。
+     * @param timeoutMs 最长等待时间 (毫秒)。
+     * @return 如果任务在超时前结束返回 true。
+     */
+    bool wait(uint32_t timeoutMs);
+
+    /**
+     * @brief 释放提交方持有的引用。调用后不能再访问该 future。
+     */
+    void release();
+
+    JobType type() const { return jobType; }
+
+    /**
+     * @brief 任务在工作线程上的执行耗时 (微秒)，仅在 isReady() 后有效。
+     */
+    uint32_t runTimeUs() const { return endUs - startUs; }
+
+    /**
+     * @brief 任务从提交到开始执行的排队时间 (微秒)，仅在 isReady() 后有效。
+     */
+    uint32_t queueTimeUs() const { return startUs - submitUs; }
+
+private:
+    friend class JobSystem;
+
+    JobFuture(JobType type, JobFunction function, void *arg, JobArgDeleter argDeleter);
+    ~JobFuture();
+
+    std::atomic<uint8_t> currentState;
+    std::atomic<bool> cancelRequested;
+    std::atomic<uint8_t> refCount;
+    JobType jobType;
+    JobFunction function;
+    void *arg;
+    JobArgDeleter argDeleter;
+    uint32_t submitUs;
+    uint32_t startUs;
+    uint32_t endUs;
+};
+
+/**
+ * @brief 双核任务系统单例类。
+ * 在两个固定核心上各运行一个工作线程：
+ *  - I/O 工作线程 (JOB_IO_CORE，Arduino loopTask 不在此核心) 负责 SD 读取和字体预取，
+ *    可以和主循环的 SPI 屏幕刷新并行；
+ *  - 计算工作线程 (JOB_CPU_CORE，与主循环同核) 负责解码和排版，利用主循环休眠的时间。
+ * 每个工作线程优先处理自己的队列，自己的队列为空时从另一个队列窃取任务。
+ * 线程安全：submit() 可以在任意任务中调用；future 的方法可以在任意任务中调用。
+ */
+class JobSystem
+{
+private:
+    static JobSystem *instance;
+    QueueHandle_t ioQueue;         // I/O 任务队列 (存放 JobFuture*)
+    QueueHandle_t cpuQueue;        // 计算任务队列 (存放 JobFuture*)
+    SemaphoreHandle_t pendingJobs; // 计数信号量：两个队列中的任务总数，用于唤醒工作线程
+    bool started;
+
+    // 统计信息 (工作线程写，主循环读，仅用于调试输出)
+    std::atomic<uint32_t> jobsCompleted[2];
+    std::atomic<uint32_t> jobsStolen[2];
+
+    // 工作线程启动参数
+    struct WorkerContext
+    {
+        JobSystem *system;
+        uint8_t workerIndex;  // 0 = I/O，1 = 计算
+        QueueHandle_t ownQueue;
+        QueueHandle_t otherQueue;
+    };
+    WorkerContext workers[2];
+
+    JobSystem();
+
+    static void workerMain(void *param);
+    void execute(JobFuture *job, uint8_t workerIndex);
+
+public:
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    /**
+     * @brief 获取 JobSystem 单例。
+     */
+    static JobSystem &getInstance();
+
+    /**
+     * @brief 创建队列并启动两个工作线程。在 setup() 中调用一次。
+     * @return 启动成功返回 true。失败时 submit() 会退化为在调用方同步执行。
+     */
+    bool begin();
+
+    /**
+     * @brief 提交一个任务。
+     * @param type 任务类型 (决定优先进入的队列)。
+     * @param function 任务函数。
+     * @param arg 任务参数 (没有 argDeleter 时，调用方保证在 future 就绪前一直有效)。
+     * @param argDeleter (可选) 参数释放函数，提供时参数归任务所有。
+     * @return 任务的 future，调用方负责 release()；队列已满时返回 nullptr (此时参数已被释放)。
+     *         如果 begin() 未成功，任务会在调用方同步执行并返回已就绪的 future。
+     */
+    JobFuture *submit(JobType type, JobFunction function, void *arg, JobArgDeleter argDeleter = nullptr);
+
+    /**
+     * @brief 当前两个队列中等待执行的任务数量。
+     */
+    uint32_t pendingCount() const;
+
+    /**
+     * @brief 通过串口输出各工作线程的统计信息。
+     */
+    void printStats() const;
+};
+
+#endif // JOBS_H
@@ -0,0 +1,170 @@
+#include "mem_stats.h" // 包含 MemStats 类的头文件
+#include <cstring>     // strncpy, strcmp
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_heap_caps.h> // 空闲堆和最大空闲块
+#define MEM_STATS_PRINTF(...) Serial.printf(__VA_ARGS__)
+#define MEM_STATS_NOW_MS() millis()
+#else
+#include <cstdio>
+#include <chrono>
+#define MEM_STATS_PRINTF(...) printf(__VA_ARGS__)
+#define MEM_STATS_NOW_MS() ((uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>( \
+    std::chrono::steady_clock::now().time_since_epoch()).count())
+#endif
+
+// 初始化静态单例实例指针
+MemStats *MemStats::instance = nullptr;
+
+MemStats::MemStats() : pageCount(0), historyNext(0), sampleCount(0)
+{
+    for (TagCounters &counter : tags)
+    {
+        counter.currentBytes = 0;
+        counter.peakBytes = 0;
+        counter.allocCount = 0;
+        counter.freeCount = 0;
+    }
+    memset(pages, 0, sizeof(pages));
+    memset(history, 0, sizeof(history));
+}
+
+MemStats &MemStats::getInstance()
+{
+    if (!instance)
+    {
+        instance = new MemStats();
+    }
+    return *instance;
+}
+
+// 记录一次分配
+void MemStats::recordAlloc(MemTag tag, size_t bytes)
+{
+    TagCounters &counter = tags[(size_t)tag];
+    size_t current = counter.currentBytes.fetch_add(bytes) + bytes;
+    size_t peak = counter.peakBytes.load();
+    while (current > peak && !counter.peakBytes.compare_exchange_weak(peak, current))
+    {
+        // compare_exchange 失败时 peak 会被更新为最新值，继续比较
+    }
+    counter.allocCount++;
+}
+
+// 记录一次释放
+void MemStats::recordFree(MemTag tag, size_t bytes)
+{
+    TagCounters &counter = tags[(size_t)tag];
+    counter.currentBytes.fetch_sub(bytes);
+    counter.freeCount++;
+}
+
+// 采样当前堆状态
+void MemStats::sampleNavigation(const char *pageName)
+{
+    HeapSample sample;
+    memset(&sample, 0, sizeof(sample));
+    strncpy(sample.page, pageName, sizeof(sample.page) - 1);
+    sample.timeMs = MEM_STATS_NOW_MS();
+#ifdef ARDUINO
+    sample.freeInternal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    sample.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    sample.freePsram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+#else
+    sample.freeInternal = 0; // 主机上没有可比较的堆信息
+    sample.largestBlock = 0;
+    sample.freePsram = 0;
+#endif
+    history[historyNext] = sample;
+    historyNext = (historyNext + 1) % HISTORY_LENGTH;
+    sampleCount++;
+
+    // 计入页面汇总
+    PageStats *stats = nullptr;
+    for (uint8_t i = 0; i < pageCount; i++)
+    {
+        if (strcmp(pages[i].name, pageName) == 0)
+        {
+            stats = &pages[i];
+            break;
+        }
+    }
+    if (!stats && pageCount < MAX_PAGES)
+    {
+        stats = &pages[pageCount++];
+        strncpy(stats->name, pageName, sizeof(stats->name) - 1);
+        stats->minFree = SIZE_MAX;
+        stats->minLargest = SIZE_MAX;
+    }
+    if (stats)
+    {
+        stats->visits++;
+        stats->lastFree = sample.freeInternal;
+        if (sample.freeInternal < stats->minFree)
+            stats->minFree = sample.freeInternal;
+        if (sample.largestBlock < stats->minLargest)
+            stats->minLargest = sample.largestBlock;
+    }
+}
+
+const char *MemStats::tagName(MemTag tag)
+{
+    switch (tag)
+    {
+    case MemTag::FONT_CACHE:
+        return "font_cache";
+    case MemTag::FONT_BUFFER:
+        return "font_buffer";
+    case MemTag::TEXT_INDEX:
+        return "text_index";
+    case MemTag::TEXT_CACHE_JSON:
+        return "text_json";
+    case MemTag::COMIC_BUFFERS:
+        return "comic_buffers";
+    case MemTag::PAGE_ARENA:
+        return "page_arena";
+    case MemTag::JOBS:
+        return "jobs";
+    case MemTag::WIDGET_CACHE:
+        return "widget_cache";
+    case MemTag::UI_CANVAS:
+        return "ui_canvas";
+    default:
+        return "?";
+    }
+}
+
+// 输出统计信息
+void MemStats::dump() const
+{
+    MEM_STATS_PRINTF("--- 内存统计 (按子系统) ---\n");
+    MEM_STATS_PRINTF("%-14s %10s %10s %8s %8s\n", "tag", "current", "peak", "allocs", "frees");
+    for (size_t i = 0; i < (size_t)MemTag::COUNT; i++)
+    {
+        const TagCounters &counter = tags[i];
+        MEM_STATS_PRINTF("%-14s %10u %10u %8lu %8lu\n", tagName((MemTag)i),
+                         (unsigned)counter.currentBytes.load(), (unsigned)counter.peakBytes.load(),
+                         (unsigned long)counter.allocCount.load(), (unsigned long)counter.freeCount.load());
+    }
+
+    MEM_STATS_PRINTF("--- 按页面 (进入时采样) ---\n");
+    MEM_STATS_PRINTF("%-14s %6s %10s %10s %10s\n", "page", "visits", "last_free", "min_free", "min_block");
+    for (uint8_t i = 0; i < pageCount; i++)
+    {
+        const PageStats &stats = pages[i];
+        MEM_STATS_PRINTF("%-14s %6lu %10u %10u %10u\n", stats.name, (unsigned long)stats.visits,
+                         (unsigned)stats.lastFree, (unsigned)stats.minFree, (unsigned)stats.minLargest);
+    }
+
+    MEM_STATS_PRINTF("--- 最近 %u 次导航 ---\n", (unsigned)(sampleCount < HISTORY_LENGTH ? sampleCount : HISTORY_LENGTH));
+    uint8_t count = sampleCount < HISTORY_LENGTH ? sampleCount : HISTORY_LENGTH;
+    uint8_t start = (historyNext + HISTORY_LENGTH - count) % HISTORY_LENGTH;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const HeapSample &sample = history[(start + i) % HISTORY_LENGTH];
+        MEM_STATS_PRINTF("%8lu ms  %-14s free %7u  block %7u  psram %8u\n", (unsigned long)sample.timeMs,
+                         sample.page, (unsigned)sample.freeInternal,
+                         (unsigned)sample.largestBlock, (unsigned)sample.freePsram);
+    }
+}
@@ -0,0 +1,130 @@
+#ifndef MEM_STATS_H // 防止头文件被重复包含
+#define MEM_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>   // 计数器会在工作线程中更新
+
+/**
+ * @brief 内存统计标签：按子系统归类的分配。
+ */
+enum class MemTag : uint8_t
+{
+    FONT_CACHE,      // Font 内存 LRU 缓存中的字形位图
+    FONT_BUFFER,     // Font 从 SD 卡读取字形的临时缓冲区
+    TEXT_INDEX,      // 文本阅读器的行索引
+    TEXT_CACHE_JSON, // 文本阅读器读写 .cacheinfo 时的 JSON 文档
+    COMIC_BUFFERS,   // 漫画阅读器的条带解码缓冲区
+    PAGE_ARENA,      // 页面 arena 的后备内存
+    JOBS,            // JobSystem 的 future 和任务参数
+    WIDGET_CACHE,    // WidgetCache 中预渲染的控件像素
+    UI_CANVAS,       // Compositor 的 8 位调色板画布 (IndexedCanvas)
+    COUNT
+};
+
+/**
+ * @brief 堆和碎片统计单例类。
+ * 记录每个标签的当前/峰值字节数和分配/释放次数，并在每次 Router 导航时采样
+ * 空闲堆、最大空闲块和 PSRAM 使用量 (按页面汇总)，通过 dump() 输出到串口。
+ * 计数部分不依赖 Arduino，主机构建 (非 ARDUINO) 中输出同样的计数器，堆采样为 0。
+ * 线程安全：recordAlloc/recordFree 使用原子操作，可在任意任务中调用；
+ * sampleNavigation() 和 dump() 只在主循环中调用。
+ */
+class MemStats
+{
+public:
+    struct TagCounters
+    {
+        std::atomic<size_t> currentBytes;
+        std::atomic<size_t> peakBytes;
+        std::atomic<uint32_t> allocCount;
+        std::atomic<uint32_t> freeCount;
+    };
+
+    // 一次导航时的堆快照
+    struct HeapSample
+    {
+        char page[16];        // 页面注册名称
+        uint32_t timeMs;
+        size_t freeInternal;  // 空闲内部 RAM
+        size_t largestBlock;  // 内部 RAM 最大空闲块
+        size_t freePsram;     // 空闲 PSRAM (没有 PSRAM 时为 0)
+    };
+
+    // 按页面汇总的堆信息
+    struct PageStats
+    {
+        char name[16];
+        uint32_t visits;
+        size_t minFree;       // 进入该页面时观察到的最小空闲堆
+        size_t minLargest;    // 进入该页面时观察到的最小最大空闲块
+        size_t lastFree;      // 最近一次进入时的空闲堆
+    };
+
+    static const uint8_t MAX_PAGES = 8;       // 最多汇总的页面种类
+    static const uint8_t HISTORY_LENGTH = 16; // 保留最近多少次导航采样
+
+private:
+    static MemStats *instance;
+    TagCounters tags[(size_t)MemTag::COUNT];
+    PageStats pages[MAX_PAGES];
+    uint8_t pageCount;
+    HeapSample history[HISTORY_LENGTH];
+    uint8_t historyNext;     // 环形缓冲区写入位置
+    uint32_t sampleCount;
+
+    MemStats();
+
+public:
+    MemStats(const MemStats &) = delete;
+    MemStats &operator=(const MemStats &) = delete;
+
+    /**
+     * @brief 获取 MemStats 单例。
+     */
+    static MemStats &getInstance();
+
+    /**
+     * @brief 记录一次分配。
+     */
+    void recordAlloc(MemTag tag, size_t bytes);
+
+    /**
+     * @brief 记录一次释放 (bytes 必须与对应分配一致)。
+     */
+    void recordFree(MemTag tag, size_t bytes);
+
+    const TagCounters &counters(MemTag tag) const { return tags[(size_t)tag]; }
+
+    /**
+     * @brief 采样当前堆状态并计入页面汇总。由 Router 在每次导航完成后调用。
+     * @param pageName 当前页面的注册名称。
+     */
+    void sampleNavigation(const char *pageName);
+
+    /**
+     * @brief 输出所有计数器、页面汇总和最近的导航采样。
+     */
+    void dump() const;
+
+    static const char *tagName(MemTag tag);
+
+    /**
+     * @brief 作用域内的分配记录：构造时 recordAlloc，析构时 recordFree。
+     * 用于生命周期与作用域一致的临时内存 (例如 JSON 文档、绘制缓冲区)。
+     */
+    class Scoped
+    {
+    public:
+        Scoped(MemTag tag, size_t bytes) : tag(tag), bytes(bytes) { MemStats::getInstance().recordAlloc(tag, bytes); }
+        ~Scoped() { MemStats::getInstance().recordFree(tag, bytes); }
+        Scoped(const Scoped &) = delete;
+        Scoped &operator=(const Scoped &) = delete;
+
+    private:
+        MemTag tag;
+        size_t bytes;
+    };
+};
+
+#endif // MEM_STATS_H
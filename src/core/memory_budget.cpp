@@ -0,0 +1,274 @@
+#include "memory_budget.h" // 包含 MemoryBudget 类的头文件
+#include <algorithm>       // std::min, std::sort
+
+// 初始化静态单例实例指针
+MemoryBudget *MemoryBudget::instance = nullptr;
+
+MemoryBudget::MemoryBudget()
+    : started(false), psramAvailable(false), cachePoolBytes(0), unassignedBytes(0),
+      transientReserve(nullptr), transientReserveSize(0), transientInUse(false),
+      checkTimer(Scheduler::INVALID_TASK), pressureEvents(0), bytesReclaimed(0), failedAllocations(0)
+{
+}
+
+// 获取单例实例
+MemoryBudget &MemoryBudget::getInstance()
+{
+    if (!instance)
+    {
+        instance = new MemoryBudget();
+    }
+    return *instance;
+}
+
+// 测量空闲内存并计算预算
+void MemoryBudget::begin()
+{
+    if (started)
+    {
+        return;
+    }
+
+    size_t freePsram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    psramAvailable = freePsram > 0;
+
+    // 先预留临时缓冲区：启动时堆还没有碎片，最容易拿到连续的大块内存
+    transientReserve = (uint8_t *)heap_caps_malloc(MEMORY_TRANSIENT_RESERVE_BYTES, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+    transientReserveSize = transientReserve ? MEMORY_TRANSIENT_RESERVE_BYTES : 0;
+    if (!transientReserve)
+    {
+        Serial.println("MemoryBudget：预留临时缓冲区失败，绘制时将从堆中分配。");
+    }
+
+    size_t freeInternal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (psramAvailable)
+    {
+        // 有 PSRAM 时缓存放到 PSRAM 中，内部 RAM 留给栈、SD/SPI 缓冲区和临时分配
+        cachePoolBytes = freePsram / 100 * MEMORY_PSRAM_CACHE_PERCENT;
+    }
+    else if (freeInternal > MEMORY_INTERNAL_HEADROOM_BYTES)
+    {
+        cachePoolBytes = (freeInternal - MEMORY_INTERNAL_HEADROOM_BYTES) / 100 * MEMORY_CACHE_POOL_PERCENT;
+    }
+    else
+    {
+        cachePoolBytes = 0; // 内存非常紧张：每个缓存只能拿到最小预算
+    }
+    unassignedBytes = cachePoolBytes;
+    started = true;
+
+    // 已经注册的缓存按优先级从高到低分配预算
+    std::vector<CacheClient *> byPriority(clients);
+    std::stable_sort(byPriority.begin(), byPriority.end(),
+                     [](const CacheClient *a, const CacheClient *b) { return a->priority > b->priority; });
+    for (CacheClient *client : byPriority)
+    {
+        assignBudget(client);
+    }
+
+    checkTimer = Scheduler::getInstance().addTimer(MEMORY_CHECK_INTERVAL_MS, onCheckTimer, this, MEMORY_CHECK_INTERVAL_MS);
+
+    Serial.printf("MemoryBudget：内部 RAM 空闲 %u，PSRAM 空闲 %u，缓存池 %u，临时预留 %u\n",
+                  freeInternal, freePsram, cachePoolBytes, transientReserveSize);
+    printStats();
+}
+
+// 从未分配的池中为缓存分配预算
+void MemoryBudget::assignBudget(CacheClient *client)
+{
+    size_t preferred = client->preferredBytes * (psramAvailable ? MEMORY_PSRAM_CACHE_SCALE : 1);
+    size_t grant = std::min(preferred, unassignedBytes);
+    if (grant < client->minBytes)
+    {
+        grant = client->minBytes; // 保证最小预算 (超出部分由内存压力处理)
+    }
+    unassignedBytes -= std::min(grant, unassignedBytes);
+    client->budgetBytes = grant;
+}
+
+// 注册缓存
+MemoryBudget::ClientId MemoryBudget::registerCache(const char *name, uint8_t priority, size_t minBytes, size_t preferredBytes,
+                                                   ShrinkCallback shrink, void *ctx)
+{
+    if (clients.size() >= INVALID_CLIENT)
+    {
+        return INVALID_CLIENT;
+    }
+
+    CacheClient *client = new CacheClient();
+    client->name = name;
+    client->priority = priority;
+    client->minBytes = minBytes;
+    client->preferredBytes = preferredBytes;
+    client->budgetBytes = preferredBytes; // begin() 之前先按期望值使用
+    client->usedBytes = 0;
+    client->shrink = shrink;
+    client->ctx = ctx;
+    if (started)
+    {
+        assignBudget(client);
+    }
+    clients.push_back(client);
+    return (ClientId)(clients.size() - 1);
+}
+
+// 获取缓存的预算
+size_t MemoryBudget::budgetOf(ClientId id) const
+{
+    if (id >= clients.size())
+    {
+        return 0;
+    }
+    return clients[id]->budgetBytes;
+}
+
+// 缓存上报当前占用
+void MemoryBudget::reportUsage(ClientId id, size_t bytes)
+{
+    if (id < clients.size())
+    {
+        clients[id]->usedBytes.store(bytes);
+    }
+}
+
+// 按优先级从低到高收缩缓存
+size_t MemoryBudget::relievePressure(size_t bytesNeeded, ClientId exclude)
+{
+    pressureEvents++;
+    size_t freed = 0;
+    for (int priority = PRIORITY_LOW; priority <= PRIORITY_HIGH && freed < bytesNeeded; priority++)
+    {
+        for (size_t i = 0; i < clients.size() && freed < bytesNeeded; i++)
+        {
+            CacheClient *client = clients[i];
+            if (i == exclude || client->priority != priority || !client->shrink || client->usedBytes.load() == 0)
+            {
+                continue;
+            }
+            size_t released = client->shrink(client->ctx, bytesNeeded - freed);
+            if (released > 0)
+            {
+                Serial.printf("MemoryBudget：内存压力，缓存 '%s' 释放 %u 字节\n", client->name, released);
+            }
+            freed += released;
+        }
+    }
+    bytesReclaimed += freed;
+    return freed;
+}
+
+// 为缓存数据分配内存
+void *MemoryBudget::allocate(size_t bytes, ClientId requester)
+{
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        void *ptr = nullptr;
+        if (psramAvailable)
+        {
+            ptr = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        }
+        if (!ptr)
+        {
+            ptr = malloc(bytes);
+        }
+        if (ptr)
+        {
+            return ptr;
+        }
+        if (attempt == 0)
+        {
+            relievePressure(bytes + MEMORY_PRESSURE_SLACK_BYTES, requester);
+        }
+    }
+    failedAllocations++;
+    return nullptr;
+}
+
+// 获取临时缓冲区
+void *MemoryBudget::acquireTransient(size_t bytes, uint32_t caps)
+{
+    if (transientReserve && bytes <= transientReserveSize && !transientInUse.exchange(true))
+    {
+        return transientReserve;
+    }
+
+    // 预留区不可用：按调用者要求的内存类型从堆中分配 (SD 读取缓冲区只能在内部 RAM 中)
+    void *ptr = heap_caps_malloc(bytes, caps);
+    if (!ptr)
+    {
+        relievePressure(bytes + MEMORY_PRESSURE_SLACK_BYTES);
+        ptr = heap_caps_malloc(bytes, caps);
+    }
+    if (!ptr)
+    {
+        failedAllocations++;
+        Serial.printf("MemoryBudget：临时缓冲区分配失败 (%u 字节)\n", bytes);
+    }
+    return ptr;
+}
+
+// 归还临时缓冲区
+void MemoryBudget::releaseTransient(void *buffer)
+{
+    if (!buffer)
+    {
+        return;
+    }
+    if (buffer == transientReserve)
+    {
+        transientInUse.store(false);
+    }
+    else
+    {
+        free(buffer);
+    }
+}
+
+// 为较大的临时分配确定可用容量
+size_t MemoryBudget::ensureAvailable(size_t desiredBytes, size_t minimumBytes)
+{
+    size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    if (largest < minimumBytes + MEMORY_PRESSURE_SLACK_BYTES)
+    {
+        relievePressure(minimumBytes + MEMORY_PRESSURE_SLACK_BYTES - largest);
+        largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    }
+
+    // 保留一些余量，不要拿走最后一块连续内存
+    size_t usable = largest > MEMORY_PRESSURE_SLACK_BYTES ? largest - MEMORY_PRESSURE_SLACK_BYTES : 0;
+    if (usable < minimumBytes)
+    {
+        failedAllocations++;
+        return 0;
+    }
+    return std::min(desiredBytes, usable);
+}
+
+// 检查空闲内部 RAM 是否低于水位线
+void MemoryBudget::checkPressure()
+{
+    size_t freeInternal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (freeInternal < MEMORY_LOW_WATERMARK_BYTES)
+    {
+        relievePressure(MEMORY_LOW_WATERMARK_BYTES - freeInternal + MEMORY_PRESSURE_SLACK_BYTES);
+    }
+}
+
+// 周期检查定时器回调 (在主循环中执行)
+void MemoryBudget::onCheckTimer(void *ctx)
+{
+    static_cast<MemoryBudget *>(ctx)->checkPressure();
+}
+
+// 输出统计信息
+void MemoryBudget::printStats() const
+{
+    Serial.printf("MemoryBudget：缓存池 %u (未分配 %u)，内存压力 %lu 次，回收 %lu 字节，分配失败 %lu 次\n",
+                  cachePoolBytes, unassignedBytes, (unsigned long)pressureEvents.load(),
+                  (unsigned long)bytesReclaimed.load(), (unsigned long)failedAllocations.load());
+    for (const CacheClient *client : clients)
+    {
+        Serial.printf("  - %s: 预算 %u，已用 %u，优先级 %d\n",
+                      client->name, client->budgetBytes, client->usedBytes.load(), client->priority);
+    }
+}
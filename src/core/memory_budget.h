@@ -0,0 +1,177 @@
+#ifndef MEMORY_BUDGET_H // 防止头文件被重复包含
+#define MEMORY_BUDGET_H
+
+#include <Arduino.h>
+#include <vector>            // 存储已注册的缓存
+#include <atomic>            // 统计计数器，工作线程也会分配内存
+#include <esp_heap_caps.h>   // heap_caps_*，区分内部 RAM 和 PSRAM
+#include "../config/config.h" // 预算相关常量
+#include "scheduler.h"        // 周期性检查空闲内存
+
+/**
+ * @brief 统一内存预算管理器单例类。
+ * 原来每个子系统各自决定占用多少内存 (字体 LRU 缓存、文本缓存 JSON 文档、漫画绘制缓冲区)，
+ * 运行时互相挤占导致 new (std::nothrow) 失败。本类负责：
+ *  - 预算：begin() 时根据空闲的内部 RAM 和 PSRAM 计算缓存总池，按优先级分配给注册的缓存。
+ *  - 预留：启动时预先分配一块临时缓冲区 (漫画条带解码等大块临时内存)，避免碎片化后分配失败。
+ *  - 压力处理：分配失败或空闲内存低于水位线时，按优先级从低到高调用缓存的收缩回调释放内存，
+ *    而不是让绘制失败。
+ *
+ * 线程安全：
+ *  - registerCache() 和 begin() 只能在主循环任务中调用 (通常在 setup() 中)。注册完成后缓存列表不再变化。
+ *  - allocate()、relievePressure()、acquireTransient()/releaseTransient()、reportUsage() 可在任意任务中调用。
+ *    调用收缩回调时不持有任何本类的锁，回调自己负责加锁 (例如 Font::Guard)，避免与缓存锁形成死锁。
+ */
+class MemoryBudget
+{
+public:
+    using ClientId = uint8_t;           // 缓存句柄
+    static const ClientId INVALID_CLIENT = 0xFF;
+
+    /**
+     * @brief 收缩回调类型。
+     * @param ctx 注册时传入的上下文指针。
+     * @param bytesToFree 希望释放的字节数 (可以少释放，也可以多释放)。
+     * @return 实际释放的字节数。
+     */
+    using ShrinkCallback = size_t (*)(void *ctx, size_t bytesToFree);
+
+    // 缓存优先级：内存紧张时优先级低的缓存先被收缩
+    enum Priority : uint8_t
+    {
+        PRIORITY_LOW = 0,    // 丢弃后代价很小 (例如可以重新生成的缩略图)
+        PRIORITY_NORMAL = 1, // 一般缓存
+        PRIORITY_HIGH = 2    // 丢弃后会明显变慢 (例如字体缓存，重新加载需要读 SD 卡)
+    };
+
+private:
+    struct CacheClient
+    {
+        const char *name;
+        uint8_t priority;
+        size_t minBytes;       // 最少保证的预算
+        size_t preferredBytes; // 期望的预算 (没有 PSRAM 时的典型值)
+        size_t budgetBytes;    // 实际分配的预算
+        std::atomic<size_t> usedBytes; // 缓存上报的当前占用 (用于统计和选择收缩对象)
+        ShrinkCallback shrink;
+        void *ctx;
+    };
+
+    static MemoryBudget *instance;
+    std::vector<CacheClient *> clients; // 按注册顺序存储 (指针，避免 vector 扩容移动 atomic)
+    bool started;
+    bool psramAvailable;
+    size_t cachePoolBytes;    // 所有缓存可用的总预算
+    size_t unassignedBytes;   // 缓存池中尚未分配的部分 (begin() 之后注册的缓存从这里获得预算)
+
+    // 预留的临时缓冲区
+    uint8_t *transientReserve;
+    size_t transientReserveSize;
+    std::atomic<bool> transientInUse;
+
+    Scheduler::TaskId checkTimer;
+
+    // 统计信息
+    std::atomic<uint32_t> pressureEvents;
+    std::atomic<uint32_t> bytesReclaimed;
+    std::atomic<uint32_t> failedAllocations;
+
+    MemoryBudget();
+
+    void assignBudget(CacheClient *client); // 从未分配的池中为缓存分配预算
+    static void onCheckTimer(void *ctx);
+
+public:
+    MemoryBudget(const MemoryBudget &) = delete;
+    MemoryBudget &operator=(const MemoryBudget &) = delete;
+
+    /**
+     * @brief 获取 MemoryBudget 单例。
+     */
+    static MemoryBudget &getInstance();
+
+    /**
+     * @brief 测量空闲内存，预留临时缓冲区，计算缓存预算并启动周期检查。
+     * 必须在 Scheduler::begin() 之后、加载字体缓存之前调用一次。
+     */
+    void begin();
+
+    /**
+     * @brief 注册一个缓存。
+     * @param name 名称 (调试输出用，必须是静态字符串)。
+     * @param priority 优先级，见 Priority。
+     * @param minBytes 最少需要的预算。
+     * @param preferredBytes 期望的预算。有 PSRAM 时会按 MEMORY_PSRAM_CACHE_SCALE 放大。
+     * @param shrink 收缩回调。
+     * @param ctx 回调上下文。
+     * @return 缓存句柄。
+     */
+    ClientId registerCache(const char *name, uint8_t priority, size_t minBytes, size_t preferredBytes,
+                           ShrinkCallback shrink, void *ctx);
+
+    /**
+     * @brief 获取缓存的预算 (字节)。begin() 之前返回 preferredBytes。
+     */
+    size_t budgetOf(ClientId id) const;
+
+    /**
+     * @brief 缓存上报当前占用的字节数。
+     */
+    void reportUsage(ClientId id, size_t bytes);
+
+    /**
+     * @brief 发生内存压力：按优先级从低到高收缩缓存，直到释放 bytesNeeded 字节。
+     * @param bytesNeeded 需要释放的字节数。
+     * @param exclude 不参与收缩的缓存 (通常是发起分配的缓存自己，它会自行淘汰)。
+     * @return 实际释放的字节数。
+     */
+    size_t relievePressure(size_t bytesNeeded, ClientId exclude = INVALID_CLIENT);
+
+    /**
+     * @brief 为缓存数据分配内存。有 PSRAM 时优先使用 PSRAM；分配失败时先触发内存压力再重试一次。
+     * 返回的内存使用 free() 释放。
+     * @param bytes 字节数。
+     * @param requester 发起分配的缓存 (不会收缩它自己)。
+     * @return 内存指针，失败返回 nullptr。
+     */
+    void *allocate(size_t bytes, ClientId requester = INVALID_CLIENT);
+
+    /**
+     * @brief 获取一块临时缓冲区 (用于单次绘制等短期使用)。
+     * 优先使用启动时预留的缓冲区 (内部 RAM，可用于 DMA)；预留区已被占用或不够大时按 caps 从堆分配
+     * (失败时触发内存压力后重试)。必须用 releaseTransient() 归还。
+     * @param bytes 需要的字节数。
+     * @param caps 堆分配的内存类型：默认任意内存 (有 PSRAM 时大块可能在 PSRAM 中)；
+     *             SD 读取缓冲区传入 SdReadProfile::BUFFER_CAPS，与 readBytes() 检查的内存一致。
+     * @return 缓冲区指针，失败返回 nullptr。
+     */
+    void *acquireTransient(size_t bytes, uint32_t caps = MALLOC_CAP_8BIT);
+
+    /**
+     * @brief 归还 acquireTransient() 得到的缓冲区。
+     */
+    void releaseTransient(void *buffer);
+
+    /**
+     * @brief 为一次较大的临时分配 (例如 DynamicJsonDocument) 确定可用容量。
+     * 如果最大空闲块小于 minimumBytes，先触发内存压力。
+     * @param desiredBytes 理想容量。
+     * @param minimumBytes 最小可接受容量。
+     * @return 建议使用的容量 (介于两者之间)；连最小容量都无法满足时返回 0。
+     */
+    size_t ensureAvailable(size_t desiredBytes, size_t minimumBytes);
+
+    /**
+     * @brief 检查空闲内部 RAM 是否低于水位线，低于时触发内存压力。由定时器周期调用。
+     */
+    void checkPressure();
+
+    bool hasPsram() const { return psramAvailable; }
+
+    /**
+     * @brief 通过串口输出预算和各缓存的占用情况。
+     */
+    void printStats() const;
+};
+
+#endif // MEMORY_BUDGET_H
@@ -0,0 +1,111 @@
+#include "nav_soak.h"          // 包含 NavSoak 类的头文件
+#include <esp_heap_caps.h>     // 最大空闲块
+#include "router.h"            // 驱动页面导航
+#include "sdcard.h"            // 检查测试文件是否存在
+
+// 初始化静态单例实例指针
+NavSoak *NavSoak::instance = nullptr;
+
+NavSoak::NavSoak()
+    : timer(Scheduler::INVALID_TASK), cycle(0), step(0), hasTextFile(false), hasComicDir(false),
+      baselineLargest(0), minLargest(SIZE_MAX), baselineFree(0)
+{
+}
+
+NavSoak &NavSoak::getInstance()
+{
+    if (!instance)
+    {
+        instance = new NavSoak();
+    }
+    return *instance;
+}
+
+void NavSoak::begin()
+{
+    hasTextFile = SDCard::getInstance().exists(NAV_SOAK_TEXT_PATH);
+    hasComicDir = SDCard::getInstance().exists(NAV_SOAK_COMIC_PATH);
+    Serial.printf("NavSoak：开始，%d 轮 (文本页面: %s，漫画页面: %s)\n", NAV_SOAK_CYCLES,
+                  hasTextFile ? "是" : "跳过", hasComicDir ? "是" : "跳过");
+    timer = Scheduler::getInstance().addTimer(NAV_SOAK_INTERVAL_MS, onStep, this, NAV_SOAK_INTERVAL_MS);
+}
+
+void NavSoak::onStep(void *ctx)
+{
+    static_cast<NavSoak *>(ctx)->runStep();
+}
+
+// 每一步：偶数步进入一个页面，奇数步返回
+void NavSoak::runStep()
+{
+    Router &router = Router::getInstance();
+    switch (step)
+    {
+    case 0:
+        router.navigateTo("browser");
+        break;
+    case 2:
+        if (hasTextFile)
+        {
+            router.navigateTo("text", new String(NAV_SOAK_TEXT_PATH)); // Router::goBack 负责删除参数
+        }
+        break;
+    case 4:
+        if (hasComicDir)
+        {
+            router.navigateTo("comic", new String(NAV_SOAK_COMIC_PATH));
+        }
+        break;
+    case 1:
+        router.goBack();
+        break;
+    case 3:
+        if (hasTextFile)
+        {
+            router.goBack();
+        }
+        break;
+    case 5:
+        if (hasComicDir)
+        {
+            router.goBack();
+        }
+        recordCycle();
+        break;
+    }
+    step = (step + 1) % 6;
+}
+
+// 记录一轮结束时的堆状态
+void NavSoak::recordCycle()
+{
+    cycle++;
+    size_t freeHeap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (cycle == 1)
+    {
+        baselineFree = freeHeap;
+        baselineLargest = largest;
+    }
+    if (largest < minLargest)
+    {
+        minLargest = largest;
+    }
+    Serial.printf("NavSoak：第 %lu 轮，空闲 %u (%+d)，最大空闲块 %u (%+d)，最小 %u\n",
+                  (unsigned long)cycle, freeHeap, (int)freeHeap - (int)baselineFree,
+                  largest, (int)largest - (int)baselineLargest, minLargest);
+    if (cycle >= NAV_SOAK_CYCLES)
+    {
+        finish();
+    }
+}
+
+void NavSoak::finish()
+{
+    Scheduler::getInstance().cancel(timer);
+    timer = Scheduler::INVALID_TASK;
+    size_t drift = baselineLargest > minLargest ? baselineLargest - minLargest : 0;
+    Serial.printf("NavSoak：%s — 最大空闲块基准 %u，最低 %u，下降 %u (允许 %u)\n",
+                  drift <= NAV_SOAK_MAX_DRIFT_BYTES ? "通过" : "失败",
+                  baselineLargest, minLargest, drift, (size_t)NAV_SOAK_MAX_DRIFT_BYTES);
+}
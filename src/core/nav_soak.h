@@ -0,0 +1,48 @@
+#ifndef NAV_SOAK_H // 防止头文件被重复包含
+#define NAV_SOAK_H
+
+#include <Arduino.h>
+#include "../config/config.h" // NAV_SOAK_* 常量
+#include "scheduler.h"        // 用定时器驱动每一步导航
+
+/**
+ * @brief 导航压力测试 (诊断工具，仅在 NAV_SOAK_TEST 为 1 时由 setup() 启动)。
+ * 通过 Scheduler 定时器反复执行“进入页面 -> 返回”，依次经过文件浏览器、文本阅读器和漫画阅读器
+ * (测试文件不存在时跳过对应页面)。每轮结束时记录空闲堆大小和最大空闲块，
+ * 以第一轮为基准输出漂移量；结束时如果最大空闲块的下降超过 NAV_SOAK_MAX_DRIFT_BYTES，
+ * 说明导航在堆上留下了碎片 (页面 arena 或 Router 的释放有问题)。
+ * 线程安全：只在主循环中运行。
+ */
+class NavSoak
+{
+private:
+    static NavSoak *instance;
+    Scheduler::TaskId timer;
+    uint32_t cycle;          // 已完成的轮数
+    uint8_t step;            // 当前轮中的步骤
+    bool hasTextFile;        // 测试文本文件是否存在
+    bool hasComicDir;        // 测试漫画目录是否存在
+    size_t baselineLargest;  // 第一轮结束时的最大空闲块
+    size_t minLargest;       // 测试期间观察到的最小的最大空闲块
+    size_t baselineFree;     // 第一轮结束时的空闲堆
+
+    NavSoak();
+
+    static void onStep(void *ctx);
+    void runStep();
+    void recordCycle();
+    void finish();
+
+public:
+    NavSoak(const NavSoak &) = delete;
+    NavSoak &operator=(const NavSoak &) = delete;
+
+    static NavSoak &getInstance();
+
+    /**
+     * @brief 开始测试。应在 setup() 中 Router 导航到初始页面之后调用。
+     */
+    void begin();
+};
+
+#endif // NAV_SOAK_H
@@ -0,0 +1,145 @@
+#ifndef PIXEL_CONVERT_H // 防止头文件被重复包含
+#define PIXEL_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 1: BGR888 行转换使用按字处理的内核 (默认)；0: 逐字节的参考实现 (对比性能或排查问题时在编译选项中定义)
+#ifndef PIXEL_CONVERT_WORDS
+#define PIXEL_CONVERT_WORDS 1
+#endif
+
+/**
+ * @brief 像素格式转换 (只有头文件，不依赖 Arduino 和 TFT_eSPI)。
+ * 漫画阅读器用它把 BMP 的一行 BGR888 转换为 RGB565 再推送到屏幕，
+ * 主机端基准测试 (tools/host_bench) 直接编译同一份代码，并逐位对比按字内核与参考实现。
+ *
+ * 按字内核：4 个像素 (12 字节) 用三次 32 位读取，位运算直接从字中取出各分量，
+ * 每两个像素用一次 32 位写入。输出有两种字节顺序：
+ * - 内存顺序 (bgr888RowToRgb565)：与 rgb565() 相同的 uint16_t，推送时需要 setSwapBytes(true)；
+ * - 面板顺序 (bgr888RowToPanel565)：高字节在前，即 SPI 上传输的顺序，推送时 setSwapBytes(false)，
+ *   TFT_eSPI 不必再逐像素交换字节。
+ * 32 位读取要求地址 4 字节对齐 (ESP32 不支持非对齐的字访问)：行起点不对齐时先逐像素转换几个像素，
+ * 行起点是奇数地址时整行使用参考实现。
+ */
+class PixelConvert
+{
+public:
+    /**
+     * @brief 与 TFT_eSPI::color565() 相同的 RGB888 -> RGB565 转换。
+     */
+    static uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b)
+    {
+        return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+    }
+
+    // 交换 RGB565 的高低字节 (内存顺序 <-> 面板顺序)
+    static uint16_t swap565(uint16_t color) { return (uint16_t)((color >> 8) | (color << 8)); }
+
+    /**
+     * @brief 逐像素的参考实现 (按字内核的对照，以及行起点不对齐时的退路)。
+     * @param src 行数据起点 (不含行尾填充)。
+     * @param dst 输出，至少 width 个像素。
+     * @param width 像素数。
+     */
+    template <bool PanelOrder = false>
+    static void bgr888RowReference(const uint8_t *src, uint16_t *dst, size_t width)
+    {
+        for (size_t col = 0; col < width; col++, src += 3)
+        {
+            uint16_t color = rgb565(src[2], src[1], src[0]);
+            dst[col] = PanelOrder ? swap565(color) : color;
+        }
+    }
+
+    /**
+     * @brief 按字内核。行起点必须 2 字节对齐才能走按字路径 (BMP 的行起点总是偶数地址)，否则使用参考实现。
+     * @tparam PanelOrder true 时输出面板字节顺序。
+     */
+    template <bool PanelOrder>
+    static void bgr888RowWords(const uint8_t *src, uint16_t *dst, size_t width)
+    {
+        // 先逐像素转换 head 个像素，使 src 对齐到 4 字节 (每个像素 3 字节：head 等于地址除以 4 的余数)
+        size_t head = (uintptr_t)src & 3;
+        if ((head & 1) || ((uintptr_t)dst & 3) || width < head + 4)
+        {
+            bgr888RowReference<PanelOrder>(src, dst, width); // 奇数地址、输出不对齐或行太短
+            return;
+        }
+        bgr888RowReference<PanelOrder>(src, dst, head);
+        src += head * 3;
+        dst += head;
+        width -= head;
+
+        const uint32_t *in = reinterpret_cast<const uint32_t *>(src);
+        uint32_t *out = reinterpret_cast<uint32_t *>(dst);
+        size_t blocks = width / 4;
+        for (size_t i = 0; i < blocks; i++, in += 3, out += 2)
+        {
+            // 小端：w0 = B0 G0 R0 B1，w1 = G1 R1 B2 G2，w2 = R2 B3 G3 R3 (低字节在前)
+            uint32_t w0 = in[0];
+            uint32_t w1 = in[1];
+            uint32_t w2 = in[2];
+            uint32_t p0 = ((w0 >> 8) & 0xF800) | ((w0 >> 5) & 0x07E0) | ((w0 >> 3) & 0x001F);
+            uint32_t p1 = (w1 & 0xF800) | ((w1 << 3) & 0x07E0) | (w0 >> 27);
+            uint32_t p2 = ((w2 << 8) & 0xF800) | ((w1 >> 21) & 0x07E0) | ((w1 >> 19) & 0x001F);
+            uint32_t p3 = ((w2 >> 16) & 0xF800) | ((w2 >> 13) & 0x07E0) | ((w2 >> 11) & 0x001F);
+            uint32_t pair01 = p0 | (p1 << 16);
+            uint32_t pair23 = p2 | (p3 << 16);
+            if (PanelOrder)
+            {
+                // 两个像素各自交换高低字节
+                pair01 = ((pair01 >> 8) & 0x00FF00FF) | ((pair01 << 8) & 0xFF00FF00);
+                pair23 = ((pair23 >> 8) & 0x00FF00FF) | ((pair23 << 8) & 0xFF00FF00);
+            }
+            out[0] = pair01;
+            out[1] = pair23;
+        }
+        bgr888RowReference<PanelOrder>(src + blocks * 12, dst + blocks * 4, width - blocks * 4);
+    }
+
+    /**
+     * @brief 转换一行 24 位 BMP 像素 (每像素 B, G, R 三个字节)，输出内存顺序的 RGB565。
+     * @param src 行数据起点 (不含行尾填充)。
+     * @param dst 输出，至少 width 个像素 (4 字节对齐时使用按字内核)。
+     * @param width 像素数。
+     */
+    static void bgr888RowToRgb565(const uint8_t *src, uint16_t *dst, size_t width)
+    {
+#if PIXEL_CONVERT_WORDS
+        bgr888RowWords<false>(src, dst, width);
+#else
+        bgr888RowReference<false>(src, dst, width);
+#endif
+    }
+
+    /**
+     * @brief 同上，输出面板顺序 (高字节在前) 的 RGB565，推送时不需要 swapBytes。
+     */
+    static void bgr888RowToPanel565(const uint8_t *src, uint16_t *dst, size_t width)
+    {
+#if PIXEL_CONVERT_WORDS
+        bgr888RowWords<true>(src, dst, width);
+#else
+        bgr888RowReference<true>(src, dst, width);
+#endif
+    }
+
+    /**
+     * @brief 宽度在编译期确定的版本 (通常是 PANEL.width，即整屏宽度的图片行)。
+     * 循环次数是常量，编译器可以展开循环，省去每个像素的边界比较。
+     */
+    template <size_t Width>
+    static void bgr888RowToRgb565(const uint8_t *src, uint16_t *dst)
+    {
+        bgr888RowToRgb565(src, dst, Width);
+    }
+
+    template <size_t Width>
+    static void bgr888RowToPanel565(const uint8_t *src, uint16_t *dst)
+    {
+        bgr888RowToPanel565(src, dst, Width);
+    }
+};
+
+#endif // PIXEL_CONVERT_H
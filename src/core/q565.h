@@ -0,0 +1,417 @@
+#ifndef Q565_H // 防止头文件被重复包含
+#define Q565_H
+
+#include <cstddef>
+#include <cstdint>
+#include "pixel_convert.h" // swap565 (面板字节顺序)
+
+/**
+ * @brief Q565 图片的流式解码器 (只有头文件，不依赖 Arduino，主机端可直接编译)。
+ * Q565 是在 RGB565 像素上工作的 QOI 风格无损编码，用于彩色漫画：文件比 24 位 BMP 小得多，
+ * 解码只有逐字节的查表和加减，接近复制数据的速度。编码器是 tools/q565_encode.py。
+ *
+ * 文件格式 (小端)：
+ * - 文件头 HEADER_BYTES 字节："Q565"、格式版本 (u16，VERSION)、宽度 (u16)、高度 (u16)、每组行数 G (u16)、组数 (u16)、
+ *   背景色 (u16，RGB565，扫描件的纸色)、内容框 左、上、右、下 (各 u16，不等于背景色的像素的外接矩形，
+ *   右、下不含；整张都是背景时全为 0)、空白行段数 (u16)；
+ * - 组索引：每组一个 u32，该组编码数据在文件中的起始位置；
+ * - 空白行段表：每段 (第一行 u16、行数 u16)，按行号排列，段内每一行都只有背景色 (编码器只记录足够长的段)；
+ * - 各组的编码数据依次相接。每组 G 行 (最后一组可能更少) 是一个独立的重启点：
+ *   组开始时前一个像素为白色 (0xFFFF)、64 项的颜色索引清零，行程不跨组，
+ *   所以任意滚动位置只需从所在组的开头解码，不需要上方的行。组内的行程可以跨行。
+ * 空白行仍然编码在数据中 (任何行都能解码)，但阅读器按空白行段表跳过它们：不读取、不解码、不推送。
+ * 操作码 (r/g/b 为 5/6/5 位分量，差值按分量位数取模)：
+ * - 00iiiiii        INDEX：颜色索引中的第 i 项 (索引位置 = (r * 3 + g * 5 + b * 7) % 64)；
+ * - 01rrggbb        DIFF：与前一个像素的差值 dr, dg, db 各在 -2..1 (偏置 2)；
+ * - 10gggggg RRRRBBBB LUMA：dg 在 -32..31 (偏置 32)，dr - dg/2 和 db - dg/2 在 -8..7 (偏置 8，dg/2 向下取整)；
+ * - 11rrrrrr        RUN：重复前一个像素 1..62 次 (rrrrrr 为 0..61)；
+ * - 0xFE lo hi      RGB565：原始像素；
+ * - 0xFF n          长行程：重复前一个像素 63 + n 次。
+ * 除行程外，每个解码出的像素都写入颜色索引并成为前一个像素。
+ *
+ * 使用方法：parseHeader() -> setSource() -> (需要跳过空白时 readBlankRuns()) -> seekRow() -> 逐行 decodeRow()。
+ * 编码数据通过 FetchFn 按窗口读取 (设备上是 SdReadProfile::readAligned()，扇区对齐的大块读取)，
+ * 解码器不持有缓冲区；窗口中剩余的数据不足一个操作码时从当前位置重新读取下一个窗口。
+ */
+class Q565Decoder
+{
+public:
+    static constexpr size_t HEADER_BYTES = 26;
+    // 格式版本：1 是没有版本字段的 12 字节文件头 (该位置是宽度，漫画图片不会只有 1、2 像素宽)，
+    // 2 加入了背景色、内容框和空白行段表。版本不同的文件需要用当前的 tools/q565_encode.py 重新编码
+    static constexpr uint16_t VERSION = 2;
+    static constexpr size_t MAX_OP_BYTES = 3;
+    static constexpr size_t MAX_BLANK_RUNS = 64; // 空白行段表最多读取的段数 (编码器保留最长的段)
+    static constexpr const char *FILE_EXTENSION = ".q565";
+
+    /**
+     * @brief 读取文件中 [offset, offset + bytes) 的数据。
+     * @return 数据的起点 (在下一次调用之前有效)；失败返回 nullptr。
+     */
+    typedef const uint8_t *(*FetchFn)(void *ctx, uint32_t offset, size_t bytes);
+
+    // 图片中的一个矩形 (像素)
+    struct Window
+    {
+        int x, y, width, height;
+    };
+
+private:
+    uint16_t imageWidth = 0;
+    uint16_t imageHeight = 0;
+    uint16_t rowsPerGroup = 0;
+    uint16_t groupCount = 0;
+    uint16_t backgroundColor = 0xFFFF;
+    uint16_t box[4] = {0, 0, 0, 0}; // 内容框：左、上、右、下 (右、下不含)
+    uint16_t blankRunCount = 0;     // 文件中的段数
+    uint16_t blankRunsLoaded = 0;   // readBlankRuns() 读入的段数
+    uint16_t blankFirst[MAX_BLANK_RUNS];
+    uint16_t blankRows[MAX_BLANK_RUNS];
+
+    FetchFn fetch = nullptr;
+    void *fetchCtx = nullptr;
+    size_t windowBytes = 0; // 每次读取的大小 (至少 MAX_OP_BYTES)
+    uint32_t fileBytes = 0;
+
+    const uint8_t *window = nullptr; // 当前窗口 (window 对应文件中的 windowOffset)
+    const uint8_t *in = nullptr;     // 下一个操作码
+    const uint8_t *inEnd = nullptr;
+    uint32_t windowOffset = 0;
+    int nextRow = -1; // 下一次 decodeRow() 解码的行 (-1: 未定位)
+    uint16_t prev = 0xFFFF;
+    uint32_t run = 0; // 前一个像素还要重复的次数
+    uint16_t index[64];
+
+    static uint16_t readLe16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+    static uint32_t readLe32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+    static uint8_t hash(uint16_t p) { return (uint8_t)(((p >> 11) * 3 + ((p >> 5) & 0x3F) * 5 + (p & 0x1F) * 7) & 0x3F); }
+
+    // 每组开始时的状态
+    void resetState()
+    {
+        prev = 0xFFFF;
+        run = 0;
+        for (uint16_t &entry : index)
+        {
+            entry = 0;
+        }
+    }
+
+    // 从 in 所在的文件位置读取下一个窗口 (文件中还有数据时)
+    bool refill()
+    {
+        uint32_t offset = windowOffset + (uint32_t)(in - window);
+        if (offset >= fileBytes)
+        {
+            return false;
+        }
+        size_t bytes = fileBytes - offset < windowBytes ? fileBytes - offset : windowBytes;
+        const uint8_t *data = fetch(fetchCtx, offset, bytes);
+        if (!data)
+        {
+            return false;
+        }
+        window = in = data;
+        inEnd = data + bytes;
+        windowOffset = offset;
+        return true;
+    }
+
+    // 开始解码 nextRow 行：到组的开头时重置状态 (各组的数据首尾相接，不需要重新定位)
+    bool beginRow()
+    {
+        if (nextRow < 0 || nextRow >= imageHeight)
+        {
+            return false;
+        }
+        if (nextRow % rowsPerGroup == 0)
+        {
+            resetState();
+        }
+        nextRow++;
+        return true;
+    }
+
+    /**
+     * @brief 继续解码 count 个像素 (可以跨行程和操作码)。
+     * @tparam Store false 时只推进解码状态，不写出像素 (窗口外的列、跳过的行)。
+     */
+    template <bool PanelOrder, bool Store>
+    bool decodePixels(uint16_t *out, size_t count)
+    {
+        while (count > 0)
+        {
+            if (run > 0)
+            {
+                size_t n = count < run ? count : run;
+                run -= n;
+                count -= n;
+                if (Store)
+                {
+                    const uint16_t value = PanelOrder ? PixelConvert::swap565(prev) : prev;
+                    while (n--)
+                    {
+                        *out++ = value;
+                    }
+                }
+                continue;
+            }
+            size_t avail = inEnd - in;
+            if (avail < MAX_OP_BYTES && refill())
+            {
+                avail = inEnd - in;
+            }
+            if (avail == 0)
+            {
+                return false;
+            }
+            const uint8_t op = in[0];
+            uint16_t px;
+            if (op < 0x40) // INDEX
+            {
+                px = index[op];
+                in++;
+            }
+            else if (op < 0x80) // DIFF
+            {
+                uint16_t r = ((prev >> 11) + ((op >> 4) & 3) - 2) & 0x1F;
+                uint16_t g = (((prev >> 5) & 0x3F) + ((op >> 2) & 3) - 2) & 0x3F;
+                uint16_t b = ((prev & 0x1F) + (op & 3) - 2) & 0x1F;
+                px = (uint16_t)((r << 11) | (g << 5) | b);
+                in++;
+            }
+            else if (op < 0xC0) // LUMA
+            {
+                if (avail < 2)
+                {
+                    return false;
+                }
+                const int dg = (op & 0x3F) - 32;
+                const int half = dg >> 1; // 向下取整
+                const int dr = (in[1] >> 4) - 8 + half;
+                const int db = (in[1] & 0x0F) - 8 + half;
+                uint16_t r = ((prev >> 11) + dr) & 0x1F;
+                uint16_t g = (((prev >> 5) & 0x3F) + dg) & 0x3F;
+                uint16_t b = ((prev & 0x1F) + db) & 0x1F;
+                px = (uint16_t)((r << 11) | (g << 5) | b);
+                in += 2;
+            }
+            else if (op < 0xFE) // RUN
+            {
+                run = (op & 0x3F) + 1;
+                in++;
+                continue;
+            }
+            else if (op == 0xFE) // RGB565
+            {
+                if (avail < 3)
+                {
+                    return false;
+                }
+                px = readLe16(in + 1);
+                in += 3;
+            }
+            else // 长行程
+            {
+                if (avail < 2)
+                {
+                    return false;
+                }
+                run = 63 + in[1];
+                in += 2;
+                continue;
+            }
+            index[hash(px)] = px;
+            prev = px;
+            count--;
+            if (Store)
+            {
+                *out++ = PanelOrder ? PixelConvert::swap565(px) : px;
+            }
+        }
+        return true;
+    }
+
+public:
+    static bool hasMagic(const uint8_t *header) { return header[0] == 'Q' && header[1] == '5' && header[2] == '6' && header[3] == '5'; }
+
+    /**
+     * @brief 文件头是否是其他版本的 Q565 (签名正确、版本不是 VERSION)：parseHeader() 拒绝这样的文件，
+     * 调用者据此提示重新编码，而不是报告文件损坏。
+     */
+    static bool isOtherVersion(const uint8_t *header) { return hasMagic(header) && readLe16(header + 4) != VERSION; }
+
+    /**
+     * @brief 解析文件开头的 HEADER_BYTES 字节。
+     * @return 签名和版本正确且尺寸、分组一致时返回 true。
+     */
+    bool parseHeader(const uint8_t *header)
+    {
+        if (!hasMagic(header) || readLe16(header + 4) != VERSION)
+        {
+            return false;
+        }
+        imageWidth = readLe16(header + 6);
+        imageHeight = readLe16(header + 8);
+        rowsPerGroup = readLe16(header + 10);
+        groupCount = readLe16(header + 12);
+        backgroundColor = readLe16(header + 14);
+        for (int i = 0; i < 4; i++)
+        {
+            box[i] = readLe16(header + 16 + 2 * i);
+        }
+        blankRunCount = readLe16(header + 24);
+        blankRunsLoaded = 0;
+        nextRow = -1;
+        return imageWidth > 0 && imageHeight > 0 && rowsPerGroup > 0 &&
+               groupCount == (imageHeight + rowsPerGroup - 1) / rowsPerGroup &&
+               box[0] <= box[2] && box[2] <= imageWidth && box[1] <= box[3] && box[3] <= imageHeight;
+    }
+
+    int width() const { return imageWidth; }
+    int height() const { return imageHeight; }
+    int groupRows() const { return rowsPerGroup; }
+    uint16_t background() const { return backgroundColor; }
+
+    // 内容框 (整张都是背景时为空)
+    Window content() const { return Window{box[0], box[1], box[2] - box[0], box[3] - box[1]}; }
+
+    /**
+     * @brief 裁掉空白边距后的区域：内容框向四周各扩展 margin 像素 (不超出图片)。
+     * 整张都是背景时返回整张图片 (空白页仍然占位)。
+     */
+    Window contentWindow(int margin) const
+    {
+        if (box[2] <= box[0] || box[3] <= box[1])
+        {
+            return Window{0, 0, imageWidth, imageHeight};
+        }
+        int left = box[0] > margin ? box[0] - margin : 0;
+        int top = box[1] > margin ? box[1] - margin : 0;
+        int right = box[2] + margin < imageWidth ? box[2] + margin : imageWidth;
+        int bottom = box[3] + margin < imageHeight ? box[3] + margin : imageHeight;
+        return Window{left, top, right - left, bottom - top};
+    }
+
+    /**
+     * @brief 设置编码数据的来源。
+     * @param window 每次读取的字节数 (越大读取次数越少，不小于 MAX_OP_BYTES)。
+     * @param size 文件大小。
+     */
+    void setSource(FetchFn fn, void *ctx, size_t window, uint32_t size)
+    {
+        fetch = fn;
+        fetchCtx = ctx;
+        windowBytes = window < MAX_OP_BYTES ? MAX_OP_BYTES : window;
+        fileBytes = size;
+        nextRow = -1;
+    }
+
+    /**
+     * @brief 读取空白行段表 (setSource() 之后，一次读取；超过 MAX_BLANK_RUNS 的段忽略)。
+     */
+    bool readBlankRuns()
+    {
+        blankRunsLoaded = 0;
+        const uint16_t runs = blankRunCount < MAX_BLANK_RUNS ? blankRunCount : (uint16_t)MAX_BLANK_RUNS;
+        if (runs == 0)
+        {
+            return true;
+        }
+        const uint8_t *table = fetch(fetchCtx, HEADER_BYTES + 4 * (uint32_t)groupCount, 4 * (size_t)runs);
+        if (!table)
+        {
+            return false;
+        }
+        for (uint16_t i = 0; i < runs; i++)
+        {
+            blankFirst[i] = readLe16(table + 4 * i);
+            blankRows[i] = readLe16(table + 4 * i + 2);
+        }
+        blankRunsLoaded = runs;
+        window = in = inEnd = nullptr; // 读取覆盖了窗口 (fetch 的缓冲区只有一块)
+        nextRow = -1;
+        return true;
+    }
+
+    /**
+     * @brief 从 row 开始连续的空白行数 (row 不在空白行段中时为 0)。
+     */
+    int blankRowsFrom(int row) const
+    {
+        for (uint16_t i = 0; i < blankRunsLoaded && blankFirst[i] <= row; i++)
+        {
+            int end = blankFirst[i] + blankRows[i];
+            if (row < end)
+            {
+                return end - row;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief 定位到第 row 行：同一组中向后的行、或者中间只隔着空白行段 (每行只有一两个行程操作码，
+     * 数据多半已在当前窗口中) 时直接继续解码，否则从所在组的重启点开始 (读取一项组索引和一个新窗口)。
+     * 跳过的行只推进解码状态，不写出像素。
+     */
+    bool seekRow(int row)
+    {
+        if (row < 0 || row >= imageHeight)
+        {
+            return false;
+        }
+        const int group = row / rowsPerGroup;
+        const bool forward = nextRow >= 0 && row >= nextRow;
+        if (!forward || (group != nextRow / rowsPerGroup && blankRowsFrom(nextRow) < row - nextRow))
+        {
+            const uint8_t *entry = fetch(fetchCtx, HEADER_BYTES + 4 * (uint32_t)group, 4);
+            if (!entry)
+            {
+                return false;
+            }
+            window = in = inEnd = nullptr;
+            windowOffset = readLe32(entry);
+            resetState();
+            nextRow = group * rowsPerGroup;
+        }
+        while (nextRow < row)
+        {
+            if (!beginRow() || !decodePixels<false, false>(nullptr, imageWidth))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 解码下一行 (seekRow() 之后依次调用，到组的末尾时自动进入下一组)。
+     * @tparam PanelOrder true 时输出面板字节顺序 (高字节在前)，直接推送时不需要 swapBytes。
+     * @param dst 至少 width() 个像素。
+     * @return 数据不足或已在最后一行之后时返回 false。
+     */
+    template <bool PanelOrder = false>
+    bool decodeRow(uint16_t *dst)
+    {
+        return beginRow() && decodePixels<PanelOrder, true>(dst, imageWidth);
+    }
+
+    /**
+     * @brief 解码下一行的第 [x, x + count) 列到 dst (裁掉边距时使用)；窗口外的列只推进解码状态。
+     * @param dst 至少 count 个像素。
+     */
+    template <bool PanelOrder = false>
+    bool decodeRow(uint16_t *dst, int x, int count)
+    {
+        if (x < 0 || count < 0 || x + count > imageWidth)
+        {
+            return false;
+        }
+        return beginRow() && decodePixels<PanelOrder, false>(nullptr, x) &&
+               decodePixels<PanelOrder, true>(dst, count) &&
+               decodePixels<PanelOrder, false>(nullptr, imageWidth - x - count);
+    }
+};
+
+#endif // Q565_H
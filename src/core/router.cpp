@@ -2,6 +2,10 @@
 #include <WString.h>       // 显式包含 WString.h 以确保 String 类的定义可用
 #include "router.h"        // 包含 Router 类的头文件
 #include "../pages/pages.h" // 包含完整的 Page 类定义 (包括子类的前向声明可能不够)
+#include "scheduler.h"         // 销毁页面前取消该页面注册的定时器/空闲任务
+#include "mem_stats.h"         // 每次导航后采样堆状态
+#include "trace.h"             // 区间跟踪
+#include "compositor.h"        // 切换页面时丢弃旧页面的脏矩形
 
 // 初始化静态单例实例指针
 Router* Router::instance = nullptr;
@@ -29,6 +33,7 @@ void Router::registerPage(const std::string &name, Page* (*creator)()) // Change
 // 导航到指定名称的注册页面，可选择传递参数
 void Router::navigateTo(const std::string &name, void *params)
 {
+    TRACE_SPAN(TraceName::ROUTER_NAVIGATE);
     // 在 routes map 中查找页面名称
     auto it = routes.find(name);
     // 如果找到了对应的路由
@@ -49,12 +54,21 @@ void Router::navigateTo(const std::string &name, void *params)
         }
 
         // 现在删除旧页面对象并切换到新页面
-        delete currentPage; // 对 nullptr 调用 delete 是安全的
+        // 先让旧页面释放资源，并取消它注册的调度任务，避免回调访问已销毁的页面
+        if (currentPage) {
+            currentPage->cleanup();
+            Scheduler::getInstance().cancelOwner(currentPage);
+        }
+        delete currentPage; // 对 nullptr 调用 delete 是安全的 (旧页面的 arena 随之整块释放)
+        // 旧页面的 arena 归还后再为新页面申请，使两个页面复用同一块内存
+        newPage->arena().begin(newPage->arenaSize());
+        Compositor::getInstance().discard(); // 旧页面标记的区域不再有意义
         currentPage = newPage; // 更新当前页面指针
         currentPageName = name; // 存储新页面的名称
         currentPageParams = params; // 存储用于新页面的参数
         // 调用新页面的 display 方法来显示它
         currentPage->display();
+        MemStats::getInstance().sampleNavigation(currentPageName.c_str());
     }
     else {
         // 如果找不到路由，可以考虑添加错误处理逻辑
@@ -65,6 +79,7 @@ void Router::navigateTo(const std::string &name, void *params)
 // 导航回历史记录中的上一个页面
 bool Router::goBack()
 {
+    TRACE_SPAN(TraceName::ROUTER_NAVIGATE);
     // 如果历史记录为空
     if (history.empty())
     {
@@ -93,9 +108,11 @@ bool Router::goBack()
         // 在删除当前页面对象之前，调用其 cleanup 方法
         if (currentPage) {
             currentPage->cleanup();
+            Scheduler::getInstance().cancelOwner(currentPage); // 取消该页面注册的调度任务
         }
-        // 现在删除当前页面对象
+        // 现在删除当前页面对象 (其 arena 随之整块释放)，再为上一页面申请 arena
         delete currentPage;
+        previousPage->arena().begin(previousPage->arenaSize());
 
         // 重要：在删除页面之后、覆盖 currentPageParams 之前，删除动态分配的参数。
         // 仅当它是已知的动态类型时才删除。
@@ -107,11 +124,13 @@ bool Router::goBack()
         }
 
         // 切换到上一页面
+        Compositor::getInstance().discard(); // 旧页面标记的区域不再有意义
         currentPage = previousPage; // 更新当前页面指针
         currentPageName = lastPageInfo.name; // 恢复页面名称
         currentPageParams = paramsToUse;     // 从历史记录项恢复参数
         // 显示恢复的页面
         currentPage->display();
+        MemStats::getInstance().sampleNavigation(currentPageName.c_str());
         return true; // 成功返回
     }
     else {
@@ -129,12 +148,25 @@ Page* Router::getCurrentPage()
     return currentPage;
 }
 
+// 合成一帧：当前页面标记的脏矩形交给它的 paint() 重绘
+void Router::composeFrame()
+{
+    if (!currentPage)
+    {
+        return;
+    }
+    Compositor::getInstance().compose([](void *ctx, const DirtyRect &clip) {
+        static_cast<Page *>(ctx)->paint(clip);
+    }, currentPage, currentPage->usesIndexedCanvas());
+}
+
 // Router 类的析构函数
 Router::~Router()
 {
     // 清理当前页面（如果存在）
     if (currentPage) {
         currentPage->cleanup(); // 删除前调用 cleanup
+        Scheduler::getInstance().cancelOwner(currentPage);
         delete currentPage;
         currentPage = nullptr;
     }
@@ -71,7 +71,8 @@ public:
 
     /**
      * @brief 导航到指定名称的页面。
-     * 如果页面已注册，则创建新页面实例，销毁旧页面，更新当前页面指针，并将旧页面添加到历史记录。
+     * 如果页面已注册，则创建新页面实例，销毁旧页面 (先调用其 cleanup())，更新当前页面指针，并将旧页面添加到历史记录。
+     * 旧页面销毁后才为新页面申请 arena (Page::arenaSize())，这样页面之间复用同一块 scratch 内存。
      * @param name 要导航到的页面的注册名称。
      * @param params (可选) 传递给新页面的参数指针。默认为 nullptr。页面需要知道如何解释这些参数。
      */
@@ -84,6 +85,12 @@ public:
      */
     bool goBack();
 
+    /**
+     * @brief 合成一帧：把当前页面本帧标记的脏矩形 (Page::invalidate) 交给它的 paint() 重绘。
+     * 主循环每一轮在 handleTouch()/handleLoop() 之后调用一次。
+     */
+    void composeFrame();
+
     /**
      * @brief 获取当前活动的页面指针。
      * @return 指向当前 Page 对象的指针，如果当前没有活动页面则为 nullptr。
@@ -0,0 +1,388 @@
+#include "scheduler.h" // 包含 Scheduler 类的头文件
+#include <algorithm>   // std::remove_if
+
+// 初始化静态成员
+Scheduler *Scheduler::instance = nullptr;
+TaskHandle_t Scheduler::loopTaskHandle = nullptr;
+volatile uint32_t Scheduler::eventCount = 0;
+
+// 私有构造函数
+Scheduler::Scheduler() : nextId(1), dispatching(false), postQueue(nullptr) {}
+
+// 获取单例实例
+Scheduler &Scheduler::getInstance()
+{
+    if (!instance)
+    {
+        instance = new Scheduler();
+    }
+    return *instance;
+}
+
+// 记录主循环任务句柄，之后中断才能通过任务通知唤醒主循环
+void Scheduler::begin()
+{
+    loopTaskHandle = xTaskGetCurrentTaskHandle();
+    if (!postQueue)
+    {
+        postQueue = xQueueCreate(SCHEDULER_POST_QUEUE_LENGTH, sizeof(PostedCall));
+    }
+    Serial.println("调度器已初始化。");
+}
+
+// 分配一个新的任务句柄 (跳过 0)
+Scheduler::TaskId Scheduler::allocateId()
+{
+    TaskId id = nextId++;
+    if (nextId == INVALID_TASK)
+    {
+        nextId = 1; // 回绕时跳过无效句柄
+    }
+    return id;
+}
+
+// 移除已被取消的任务。回调执行期间不做移除，避免迭代时修改列表。
+void Scheduler::compact()
+{
+    if (dispatching)
+    {
+        return;
+    }
+    timers.erase(std::remove_if(timers.begin(), timers.end(),
+                                [](const Timer &t) { return !t.active; }),
+                 timers.end());
+    idleTasks.erase(std::remove_if(idleTasks.begin(), idleTasks.end(),
+                                   [](const IdleTask &t) { return !t.active; }),
+                    idleTasks.end());
+}
+
+// 添加定时器
+Scheduler::TaskId Scheduler::addTimer(uint32_t delayMs, TimerCallback callback, void *ctx, uint32_t periodMs)
+{
+    if (!callback)
+    {
+        return INVALID_TASK;
+    }
+    Timer timer;
+    timer.id = allocateId();
+    timer.callback = callback;
+    timer.ctx = ctx;
+    timer.dueMs = millis() + delayMs;
+    timer.periodMs = periodMs;
+    timer.active = true;
+    timers.push_back(timer);
+    return timer.id;
+}
+
+// 推迟已有定时器 (防抖)
+bool Scheduler::rescheduleTimer(TaskId id, uint32_t delayMs)
+{
+    for (auto &timer : timers)
+    {
+        if (timer.id == id && timer.active)
+        {
+            timer.dueMs = millis() + delayMs;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 添加空闲任务
+Scheduler::TaskId Scheduler::addIdleTask(IdleCallback callback, void *ctx, uint8_t priority, uint32_t budgetUs)
+{
+    if (!callback)
+    {
+        return INVALID_TASK;
+    }
+    IdleTask task;
+    task.id = allocateId();
+    task.callback = callback;
+    task.ctx = ctx;
+    task.priority = priority;
+    task.budgetUs = budgetUs > 0 ? budgetUs : IDLE_TASK_DEFAULT_BUDGET_US;
+    task.active = true;
+    idleTasks.push_back(task);
+    return task.id;
+}
+
+// 检查任务是否仍然有效
+bool Scheduler::isScheduled(TaskId id) const
+{
+    if (id == INVALID_TASK)
+    {
+        return false;
+    }
+    for (const auto &timer : timers)
+    {
+        if (timer.id == id)
+        {
+            return timer.active;
+        }
+    }
+    for (const auto &task : idleTasks)
+    {
+        if (task.id == id)
+        {
+            return task.active;
+        }
+    }
+    return false;
+}
+
+// 取消单个任务
+void Scheduler::cancel(TaskId id)
+{
+    if (id == INVALID_TASK)
+    {
+        return;
+    }
+    for (auto &timer : timers)
+    {
+        if (timer.id == id)
+        {
+            timer.active = false;
+        }
+    }
+    for (auto &task : idleTasks)
+    {
+        if (task.id == id)
+        {
+            task.active = false;
+        }
+    }
+    compact();
+}
+
+// 取消某个所有者注册的全部任务
+void Scheduler::cancelOwner(void *ctx)
+{
+    if (!ctx)
+    {
+        return;
+    }
+    for (auto &timer : timers)
+    {
+        if (timer.ctx == ctx)
+        {
+            timer.active = false;
+        }
+    }
+    for (auto &task : idleTasks)
+    {
+        if (task.ctx == ctx)
+        {
+            task.active = false;
+        }
+    }
+    compact();
+}
+
+// 从任意任务投递回调到主循环
+bool Scheduler::post(TimerCallback callback, void *ctx)
+{
+    if (!callback || !postQueue)
+    {
+        return false;
+    }
+    PostedCall call = {callback, ctx};
+    if (xQueueSend(postQueue, &call, 0) != pdTRUE)
+    {
+        return false; // 队列已满，由调用方决定是否重试
+    }
+    if (loopTaskHandle && !isLoopTask())
+    {
+        xTaskNotifyGive(loopTaskHandle); // 唤醒可能正在休眠的主循环
+    }
+    return true;
+}
+
+// 从其他任务唤醒主循环
+void Scheduler::wake()
+{
+    if (loopTaskHandle && !isLoopTask())
+    {
+        xTaskNotifyGive(loopTaskHandle);
+    }
+}
+
+// 当前是否运行在主循环任务中
+bool Scheduler::isLoopTask()
+{
+    return loopTaskHandle == nullptr || xTaskGetCurrentTaskHandle() == loopTaskHandle;
+}
+
+// 执行所有到期的定时器
+void Scheduler::runDueTimers()
+{
+    // 先执行其他任务投递过来的回调
+    PostedCall call;
+    while (postQueue && xQueueReceive(postQueue, &call, 0) == pdTRUE)
+    {
+        call.callback(call.ctx);
+    }
+
+    uint32_t now = millis();
+    dispatching = true;
+    // 使用下标遍历：回调中可能添加新的定时器导致 vector 重新分配
+    for (size_t i = 0; i < timers.size(); i++)
+    {
+        if (!timers[i].active || (int32_t)(now - timers[i].dueMs) < 0)
+        {
+            continue; // 已取消或尚未到期 (使用有符号差值以正确处理 millis 回绕)
+        }
+        Timer timer = timers[i]; // 复制一份，回调期间 timers[i] 的引用可能失效
+        if (timer.periodMs > 0)
+        {
+            timers[i].dueMs = now + timer.periodMs; // 周期定时器：安排下一次
+        }
+        else
+        {
+            timers[i].active = false; // 一次性定时器：执行后移除
+        }
+        timer.callback(timer.ctx);
+    }
+    dispatching = false;
+    compact();
+}
+
+// 在时间窗口内按优先级执行空闲任务
+void Scheduler::runIdle(uint32_t windowUs)
+{
+    uint32_t start = micros();
+    uint32_t eventsAtStart = eventCount;
+
+    while (eventCount == eventsAtStart) // 有触摸/按键中断时立即让出
+    {
+        uint32_t elapsed = micros() - start;
+        if (elapsed >= windowUs)
+        {
+            break;
+        }
+
+        // 选出优先级最高的任务 (同优先级按列表顺序，执行后移到末尾实现轮转)
+        int selected = -1;
+        for (size_t i = 0; i < idleTasks.size(); i++)
+        {
+            if (idleTasks[i].active && (selected < 0 || idleTasks[i].priority > idleTasks[selected].priority))
+            {
+                selected = (int)i;
+            }
+        }
+        if (selected < 0)
+        {
+            break; // 没有空闲任务
+        }
+
+        IdleTask task = idleTasks[selected];
+        uint32_t budget = std::min(task.budgetUs, windowUs - elapsed);
+
+        uint32_t taskStart = micros();
+        dispatching = true;
+        bool more = task.callback(task.ctx, budget);
+        dispatching = false;
+        uint32_t used = micros() - taskStart;
+
+        if (used > budget * 2)
+        {
+            Serial.printf("调度器：空闲任务 %u 超出时间预算 (%lu us / %lu us)\n",
+                          task.id, (unsigned long)used, (unsigned long)budget);
+        }
+
+        // 回调期间列表可能变化，重新按句柄查找
+        for (size_t i = 0; i < idleTasks.size(); i++)
+        {
+            if (idleTasks[i].id != task.id)
+            {
+                continue;
+            }
+            if (!more || !idleTasks[i].active)
+            {
+                idleTasks[i].active = false; // 完成或在回调中被取消
+            }
+            else if (i + 1 < idleTasks.size())
+            {
+                IdleTask moved = idleTasks[i];
+                idleTasks.erase(idleTasks.begin() + i);
+                idleTasks.push_back(moved); // 移到末尾，让同优先级的其他任务有机会执行
+            }
+            break;
+        }
+        compact();
+    }
+}
+
+// 是否有待执行的空闲任务
+bool Scheduler::hasIdleWork() const
+{
+    for (const auto &task : idleTasks)
+    {
+        if (task.active)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 距离最近的定时器到期还有多少毫秒
+uint32_t Scheduler::msUntilNextTimer() const
+{
+    if (postQueue && uxQueueMessagesWaiting(postQueue) > 0)
+    {
+        return 0; // 有投递的回调等待执行
+    }
+    uint32_t now = millis();
+    uint32_t nearest = UINT32_MAX;
+    for (const auto &timer : timers)
+    {
+        if (!timer.active)
+        {
+            continue;
+        }
+        int32_t diff = (int32_t)(timer.dueMs - now);
+        if (diff <= 0)
+        {
+            return 0; // 已有到期的定时器
+        }
+        nearest = std::min(nearest, (uint32_t)diff);
+    }
+    return nearest;
+}
+
+// 休眠直到中断唤醒或超时
+void Scheduler::waitForEvent(uint32_t timeoutMs)
+{
+    if (timeoutMs > LOOP_MAX_SLEEP_MS)
+    {
+        timeoutMs = LOOP_MAX_SLEEP_MS; // 兜底：即使漏掉中断也会定期醒来
+    }
+    if (timeoutMs == 0)
+    {
+        return;
+    }
+    if (loopTaskHandle)
+    {
+        // 如果休眠前中断已经发生，通知计数非零，这里会立即返回
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs));
+    }
+    else
+    {
+        delay(timeoutMs); // begin() 之前退化为普通延时
+    }
+}
+
+// 中断服务程序中调用：唤醒主循环
+void IRAM_ATTR Scheduler::wakeFromISR()
+{
+    eventCount = eventCount + 1;
+    if (loopTaskHandle)
+    {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(loopTaskHandle, &higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken)
+        {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
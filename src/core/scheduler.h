@@ -0,0 +1,208 @@
+#ifndef SCHEDULER_H // 防止头文件被重复包含
+#define SCHEDULER_H
+
+#include <Arduino.h>  // 包含 Arduino 核心库 (millis, micros 等)
+#include <vector>     // 包含 std::vector，用于存储定时器和空闲任务
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h> // 任务通知，用于在无事可做时让主循环休眠
+#include <freertos/queue.h> // post() 使用的跨任务消息队列
+#include "../config/config.h" // 调度器相关常量
+
+/**
+ * @brief 协作式任务调度器单例类。
+ * 运行在 Arduino 主循环 (loopTask) 中，提供三类服务：
+ *  - 定时器：一次性或周期性回调 (例如延迟保存字体快速缓存)。
+ *  - 空闲任务：带优先级的后台工作 (预取、建索引等)，每次调用都有时间预算，
+ *    只在没有触摸/定时器事件需要处理时运行。
+ *  - 事件等待：主循环在没有工作时休眠到下一个定时器到期或被中断 (触摸 IRQ、按键) 唤醒，
+ *    取代原来无条件的 delay(10) 轮询。
+ * 所有回调都在主循环任务中执行，因此回调内部可以安全地访问 Display / SDCard / Font。
+ * 线程安全：除 post()、wake() 和 wakeFromISR() 外，所有方法只能在主循环任务中调用。
+ * 其他任务 (例如 JobSystem 的工作线程) 需要主循环做事时，使用 post() 投递回调。
+ * 回调使用函数指针 + 上下文指针 (与 Router 的做法一致)，上下文通常是注册任务的页面或模块，
+ * Router 在销毁页面前会调用 cancelOwner() 取消该页面注册的所有任务。
+ */
+class Scheduler
+{
+public:
+    using TaskId = uint16_t;          // 任务句柄，0 表示无效
+    static const TaskId INVALID_TASK = 0;
+
+    /**
+     * @brief 定时器回调类型。
+     * @param ctx 注册时传入的上下文指针。
+     */
+    using TimerCallback = void (*)(void *ctx);
+
+    /**
+     * @brief 空闲任务回调类型。
+     * 回调应在 budgetUs 微秒左右完成一小段工作后返回。
+     * @param ctx 注册时传入的上下文指针。
+     * @param budgetUs 本次调用允许使用的时间 (微秒)。
+     * @return 如果还有剩余工作返回 true (下次空闲时继续调用)；返回 false 表示完成，任务被移除。
+     */
+    using IdleCallback = bool (*)(void *ctx, uint32_t budgetUs);
+
+    // 空闲任务优先级 (数值越大越先执行)
+    enum Priority : uint8_t
+    {
+        PRIORITY_LOW = 0,    // 持久化、统计等可以推迟的工作
+        PRIORITY_NORMAL = 1, // 一般的预取工作
+        PRIORITY_HIGH = 2    // 很快就会用到的数据 (例如下一页内容)
+    };
+
+private:
+    struct Timer
+    {
+        TaskId id;
+        TimerCallback callback;
+        void *ctx;
+        uint32_t dueMs;    // 到期时间 (millis)
+        uint32_t periodMs; // 0 表示一次性定时器
+        bool active;       // 被取消后置为 false，在安全的时机再从列表中移除
+    };
+
+    struct IdleTask
+    {
+        TaskId id;
+        IdleCallback callback;
+        void *ctx;
+        uint8_t priority;
+        uint32_t budgetUs; // 每次调用的时间预算
+        bool active;
+    };
+
+    static Scheduler *instance;     // 单例指针
+    std::vector<Timer> timers;      // 所有定时器 (数量很少，线性扫描即可)
+    std::vector<IdleTask> idleTasks; // 所有空闲任务
+    TaskId nextId;                  // 下一个分配的任务句柄
+    bool dispatching;               // 是否正在执行回调 (此时只做标记删除)
+    static TaskHandle_t loopTaskHandle; // 主循环任务句柄，用于任务通知唤醒 (ISR 中读)
+    QueueHandle_t postQueue;        // 其他任务投递到主循环的回调队列
+
+    // post() 投递的消息
+    struct PostedCall
+    {
+        TimerCallback callback;
+        void *ctx;
+    };
+    static volatile uint32_t eventCount; // 中断唤醒计数 (ISR 中递增)，空闲任务据此判断是否需要让出
+
+    Scheduler();
+
+    TaskId allocateId();
+    void compact(); // 移除已取消的任务
+
+public:
+    // 禁止拷贝构造和赋值
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    /**
+     * @brief 获取 Scheduler 单例。
+     */
+    static Scheduler &getInstance();
+
+    /**
+     * @brief 记录主循环任务句柄。必须在 setup() 中 (即主循环任务上) 调用一次。
+     */
+    void begin();
+
+    /**
+     * @brief 添加定时器。
+     * @param delayMs 多少毫秒后首次触发。
+     * @param callback 回调函数。
+     * @param ctx 上下文指针 (同时作为 cancelOwner 的所有者标识)。
+     * @param periodMs 周期 (毫秒)，0 表示只触发一次。
+     * @return 任务句柄。
+     */
+    TaskId addTimer(uint32_t delayMs, TimerCallback callback, void *ctx, uint32_t periodMs = 0);
+
+    /**
+     * @brief 将已有定时器推迟到 delayMs 毫秒之后触发 (用于防抖)。
+     * @return 如果定时器仍然存在返回 true。
+     */
+    bool rescheduleTimer(TaskId id, uint32_t delayMs);
+
+    /**
+     * @brief 添加空闲任务。
+     * @param callback 回调函数，返回 false 表示工作已完成。
+     * @param ctx 上下文指针 (同时作为 cancelOwner 的所有者标识)。
+     * @param priority 优先级，见 Priority。
+     * @param budgetUs 每次调用的时间预算 (微秒)。
+     * @return 任务句柄。
+     */
+    TaskId addIdleTask(IdleCallback callback, void *ctx, uint8_t priority = PRIORITY_NORMAL, uint32_t budgetUs = IDLE_TASK_DEFAULT_BUDGET_US);
+
+    /**
+     * @brief 检查任务是否仍在调度中。
+     */
+    bool isScheduled(TaskId id) const;
+
+    /**
+     * @brief 取消单个任务 (定时器或空闲任务)。在回调内部调用也是安全的。
+     */
+    void cancel(TaskId id);
+
+    /**
+     * @brief 取消所有以 ctx 为上下文注册的任务。
+     * Router 在删除页面前调用，防止回调访问已销毁的页面。
+     */
+    void cancelOwner(void *ctx);
+
+    /**
+     * @brief 从任意任务投递一个回调，由主循环在下一轮执行 (线程安全)。
+     * 用于工作线程把结果交回主循环，例如请求保存字体缓存。
+     * @param callback 回调函数。
+     * @param ctx 上下文指针。
+     * @return 如果投递成功返回 true；队列已满或 begin() 之前调用返回 false。
+     */
+    bool post(TimerCallback callback, void *ctx);
+
+    /**
+     * @brief 判断当前代码是否运行在主循环任务中。
+     */
+    static bool isLoopTask();
+
+    /**
+     * @brief 执行所有已到期的定时器，以及其他任务通过 post() 投递的回调。
+     */
+    void runDueTimers();
+
+    /**
+     * @brief 在给定时间窗口内执行空闲任务 (按优先级)。
+     * 如果在此期间有中断事件 (触摸/按键) 到来，会提前返回以保证响应速度。
+     * @param windowUs 最多使用的时间 (微秒)。
+     */
+    void runIdle(uint32_t windowUs);
+
+    /**
+     * @brief 是否有待执行的空闲任务。
+     */
+    bool hasIdleWork() const;
+
+    /**
+     * @brief 距离下一个定时器到期还有多少毫秒。
+     * @return 毫秒数；没有定时器时返回 UINT32_MAX。
+     */
+    uint32_t msUntilNextTimer() const;
+
+    /**
+     * @brief 休眠直到被中断唤醒或超时。
+     * @param timeoutMs 最长休眠时间 (会再被 LOOP_MAX_SLEEP_MS 限制)。
+     */
+    void waitForEvent(uint32_t timeoutMs);
+
+    /**
+     * @brief 从其他任务唤醒主循环 (线程安全)，不投递回调。
+     * 用于工作线程完成任务后让页面在下一次 handleLoop() 中收取结果，而不是等到休眠超时。
+     */
+    static void wake();
+
+    /**
+     * @brief 在中断服务程序中调用，唤醒主循环。
+     */
+    static void IRAM_ATTR wakeFromISR();
+};
+
+#endif // SCHEDULER_H
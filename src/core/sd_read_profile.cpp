@@ -0,0 +1,149 @@
+#include "sd_read_profile.h"
+#include <algorithm>       // std::min, std::max
+#include <esp_heap_caps.h> // 空闲内部 RAM 的最大连续块
+#include "memory_budget.h" // 探测缓冲区来自启动时预留的临时内存
+#include "trace.h"         // 区间跟踪
+
+SdReadProfile *SdReadProfile::instance = nullptr;
+
+SdReadProfile::SdReadProfile()
+    : probed(false), latencyUs(0), bytesPerSecond(0), efficientBytes(SD_READ_DEFAULT_BYTES), reads(0), bytesRead(0), readUs(0)
+{
+}
+
+SdReadProfile &SdReadProfile::getInstance()
+{
+    if (!instance)
+    {
+        instance = new SdReadProfile();
+    }
+    return *instance;
+}
+
+uint32_t SdReadProfile::timeReads(File &file, uint8_t *buffer, size_t bytes, int rounds)
+{
+    const size_t positions = (file.size() - bytes) / SD_SECTOR_BYTES + 1;
+    uint32_t best = UINT32_MAX;
+    for (int round = 0; round < rounds; round++)
+    {
+        // 每次换一个位置 (间隔大于读取大小)，FATFS 的扇区窗口里不会留有上一次的数据
+        uint32_t offset = (uint32_t)(((size_t)round * (bytes / SD_SECTOR_BYTES + 1)) % positions) * SD_SECTOR_BYTES;
+        if (!file.seek(offset))
+        {
+            return 0;
+        }
+        uint32_t start = micros();
+        if (file.read(buffer, bytes) != bytes)
+        {
+            return 0;
+        }
+        best = std::min(best, (uint32_t)(micros() - start));
+    }
+    return best;
+}
+
+void SdReadProfile::probe(File &file)
+{
+    if (probed || !file || file.size() < 2 * SD_READ_PROBE_BYTES)
+    {
+        return;
+    }
+    uint8_t *buffer = (uint8_t *)MemoryBudget::getInstance().acquireTransient(SD_READ_PROBE_BYTES, BUFFER_CAPS);
+    if (!buffer)
+    {
+        return;
+    }
+    uint32_t smallUs = timeReads(file, buffer, SD_SECTOR_BYTES, SD_READ_PROBE_ROUNDS);
+    uint32_t largeUs = timeReads(file, buffer, SD_READ_PROBE_BYTES, SD_READ_PROBE_ROUNDS);
+    MemoryBudget::getInstance().releaseTransient(buffer);
+    if (smallUs == 0 || largeUs == 0)
+    {
+        return; // 读取失败
+    }
+    probed = true;
+
+    // 时间 = 延迟 + 字节数 / 吞吐量：两个点确定两个参数
+    const size_t extraBytes = SD_READ_PROBE_BYTES - SD_SECTOR_BYTES;
+    size_t bytes;
+    if (largeUs > smallUs)
+    {
+        double usPerByte = (double)(largeUs - smallUs) / extraBytes;
+        double latency = std::max(0.0, smallUs - usPerByte * SD_SECTOR_BYTES);
+        latencyUs = (uint32_t)latency;
+        bytesPerSecond = (uint32_t)(1e6 / usPerByte);
+        // 延迟占读取时间的比例为 p 时：latency = p * (latency + bytes * usPerByte)
+        bytes = (size_t)(latency / usPerByte * (100 - SD_READ_OVERHEAD_PERCENT) / SD_READ_OVERHEAD_PERCENT);
+    }
+    else
+    {
+        // 大小对时间没有可测的影响 (开销占绝对多数)：读取越大越好
+        latencyUs = smallUs;
+        bytesPerSecond = 0;
+        bytes = SD_READ_MAX_BYTES;
+    }
+
+    // 扇区的整数倍；不小于 4 KB 时为 4 KB 的整数倍，落在簇内
+    const size_t granule = bytes >= 4096 ? 4096 : SD_SECTOR_BYTES;
+    bytes = (bytes + granule - 1) / granule * granule;
+    efficientBytes = std::max((size_t)SD_READ_MIN_BYTES, std::min(bytes, (size_t)SD_READ_MAX_BYTES));
+    Serial.printf("SdReadProfile：延迟 %lu us，吞吐量 %lu KB/s，有效读取大小 %u 字节\n", (unsigned long)latencyUs,
+                  (unsigned long)(bytesPerSecond / 1024), (unsigned)efficientBytes);
+}
+
+size_t SdReadProfile::readBytes(size_t extraBytes) const
+{
+    // 预留的临时缓冲区总能提供的大小
+    const size_t reserved = MEMORY_TRANSIENT_RESERVE_BYTES - alignedBytes(extraBytes);
+    if (efficientBytes <= reserved)
+    {
+        return efficientBytes;
+    }
+    size_t largest = heap_caps_get_largest_free_block(BUFFER_CAPS);
+    size_t spare = largest > MEMORY_LOW_WATERMARK_BYTES + alignedBytes(extraBytes) ? largest - MEMORY_LOW_WATERMARK_BYTES - alignedBytes(extraBytes) : 0;
+    size_t bytes = std::max(reserved, std::min(efficientBytes, spare));
+    return bytes / SD_SECTOR_BYTES * SD_SECTOR_BYTES;
+}
+
+const uint8_t *SdReadProfile::readAligned(File &file, uint32_t offset, size_t bytes, uint8_t *buffer)
+{
+    const uint32_t start = offset / SD_SECTOR_BYTES * SD_SECTOR_BYTES;
+    const size_t lead = offset - start;
+    size_t span = (lead + bytes + SD_SECTOR_BYTES - 1) / SD_SECTOR_BYTES * SD_SECTOR_BYTES;
+    if (start + span > file.size())
+    {
+        span = std::max(file.size() - start, lead + bytes); // 最后一个扇区不完整 (数据不够时下面的检查失败)
+    }
+    size_t got;
+    uint32_t began = micros();
+    {
+        TRACE_SPAN(TraceName::SD_READ);
+        got = file.seek(start) ? file.read(buffer, span) : 0;
+    }
+    reads++;
+    bytesRead += got;
+    readUs += micros() - began;
+    return got >= lead + bytes ? buffer + lead : nullptr;
+}
+
+const uint8_t *SdReadProfile::fetchAligned(void *ctx, uint32_t offset, size_t bytes)
+{
+    AlignedSource &source = *static_cast<AlignedSource *>(ctx);
+    return getInstance().readAligned(*source.file, offset, bytes, source.buffer);
+}
+
+void SdReadProfile::printStats() const
+{
+    if (probed)
+    {
+        Serial.printf("SD 读取：延迟 %lu us，吞吐量 %lu KB/s，有效读取大小 %u 字节 (当前可用 %u 字节)\n",
+                      (unsigned long)latencyUs, (unsigned long)(bytesPerSecond / 1024), (unsigned)efficientBytes,
+                      (unsigned)readBytes(0));
+    }
+    else
+    {
+        Serial.printf("SD 读取：尚未探测，使用默认读取大小 %u 字节\n", (unsigned)efficientBytes);
+    }
+    uint32_t us = readUs.load();
+    Serial.printf("SD 读取：对齐读取 %lu 次，%lu KB，平均 %lu KB/s\n", (unsigned long)reads.load(),
+                  (unsigned long)(bytesRead.load() / 1024), (unsigned long)(us ? (uint64_t)bytesRead.load() * 1000000 / us / 1024 : 0));
+}
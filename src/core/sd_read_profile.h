@@ -0,0 +1,95 @@
+#ifndef SD_READ_PROFILE_H // 防止头文件被重复包含
+#define SD_READ_PROFILE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <atomic>             // 读取统计，工作线程也会读取
+#include <esp_heap_caps.h>    // 读取缓冲区的内存类型
+#include "../config/config.h" // SD_READ_* 常量
+
+/**
+ * @brief SD 卡读取特性单例类：测量每次读取的固定开销和持续吞吐量，选择大块读取的大小。
+ * 每次读取都有与大小无关的开销 (SD 命令、FATFS 查找簇链)，读取太小时时间都花在开销上；
+ * 但读取越大缓冲区越大。第一次打开漫画时 probe() 用两种大小各读几次，按线性模型
+ * (时间 = 延迟 + 字节数 / 吞吐量) 求出两个参数，选择开销不超过 SD_READ_OVERHEAD_PERCENT 的最小读取大小；
+ * 快的卡 (延迟相对吞吐量大) 得到更大的读取，readBytes() 再按空闲内部 RAM 限制。
+ * 读取大小是扇区 (SD_SECTOR_BYTES) 的整数倍，不小于 4 KB 时是 4 KB 的整数倍 (FAT32 最小的簇，
+ * Arduino SD 库不提供实际的簇大小)；readAligned() 把读取的起点对齐到扇区，FATFS 直接把整扇区传输到缓冲区，
+ * 不经过它的单扇区窗口。
+ * 线程安全：probe() 只在主循环中调用；readBytes()、readAligned() 和统计可在任意任务中调用。
+ */
+class SdReadProfile
+{
+private:
+    static SdReadProfile *instance;
+    bool probed;
+    uint32_t latencyUs;      // 每次读取的固定开销
+    uint32_t bytesPerSecond; // 持续吞吐量 (0 表示探测时测不出大小对时间的影响)
+    size_t efficientBytes;   // 选择的读取大小
+
+    // 统计 (readAligned)
+    std::atomic<uint32_t> reads;
+    std::atomic<uint32_t> bytesRead;
+    std::atomic<uint32_t> readUs;
+
+    SdReadProfile();
+
+    // 在文件中 rounds 个不同的扇区对齐位置各读取 bytes 字节，返回最短的一次 (微秒)
+    static uint32_t timeReads(File &file, uint8_t *buffer, size_t bytes, int rounds);
+
+public:
+    SdReadProfile(const SdReadProfile &) = delete;
+    SdReadProfile &operator=(const SdReadProfile &) = delete;
+
+    static SdReadProfile &getInstance();
+
+    // 读取缓冲区的内存类型：SD 传输用 DMA，缓冲区必须在内部 RAM 中 (PSRAM 中的缓冲区要经驱动逐块复制)。
+    // readBytes() 按这种内存的最大空闲块计算大小，缓冲区用 MemoryBudget::acquireTransient(bytes, BUFFER_CAPS) 获取
+    static constexpr uint32_t BUFFER_CAPS = MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA | MALLOC_CAP_8BIT;
+
+    /**
+     * @brief 用一个已打开的文件测量读取特性 (只在第一次调用时测量；文件太小时跳过，下次再试)。
+     * 读取后文件位置不确定，调用者需要重新定位。
+     */
+    void probe(File &file);
+
+    bool isProbed() const { return probed; }
+    size_t getEfficientBytes() const { return efficientBytes; }
+
+    /**
+     * @brief 一次大块读取的字节数：有效读取大小，受内存限制。
+     * 不超过启动时预留的临时缓冲区 (减去 extraBytes) 时总能分配；更大时只使用空闲内部 RAM
+     * (SD 传输需要 DMA 可用的内存) 中不会触发内存压力的部分。
+     * @param extraBytes 同一块缓冲区中的其他数据 (例如解码后的一行像素)。
+     */
+    size_t readBytes(size_t extraBytes) const;
+
+    /**
+     * @brief 读取文件中 [offset, offset + bytes) 的数据：起点向前对齐到扇区，终点向后对齐 (超出文件末尾时读到末尾)。
+     * @param buffer 至少 alignedBytes(bytes) 字节，地址 4 字节对齐。
+     * @return 数据在 buffer 中的起点 (buffer + offset % SD_SECTOR_BYTES)；失败返回 nullptr。
+     */
+    const uint8_t *readAligned(File &file, uint32_t offset, size_t bytes, uint8_t *buffer);
+
+    // fetchAligned() 的参数：文件和 readAligned() 使用的缓冲区 (至少 alignedBytes(每次读取的大小) 字节)
+    struct AlignedSource
+    {
+        File *file;
+        uint8_t *buffer;
+    };
+
+    /**
+     * @brief readAligned() 的回调形式 (Q565Decoder::FetchFn)，ctx 指向 AlignedSource。
+     */
+    static const uint8_t *fetchAligned(void *ctx, uint32_t offset, size_t bytes);
+
+    // readAligned() 读取 bytes 字节最多需要的缓冲区大小
+    static constexpr size_t alignedBytes(size_t bytes) { return bytes + 2 * SD_SECTOR_BYTES; }
+
+    /**
+     * @brief 通过串口输出探测结果和 readAligned() 的累计吞吐量。
+     */
+    void printStats() const;
+};
+
+#endif // SD_READ_PROFILE_H
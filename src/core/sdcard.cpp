@@ -1,4 +1,5 @@
 #include "sdcard.h"  // 包含 SDCard 类的头文件
+#include "trace.h"   // 区间跟踪
 #include <algorithm> // 包含 C++ 标准库的算法头文件，用于排序 (std::sort)
 
 // 初始化静态单例实例指针
@@ -35,20 +36,20 @@ bool SDCard::begin() {
     return loadDirectory("/");
 }
 
-// 检查指定路径是否是一个漫画目录
-bool SDCard::checkIsComic(const String& path) {
+// 读取目录下 .info 文件中某个键的字符串值
+String SDCard::readInfoValue(const String& dirPath, const char* key) {
     // 构建 .info 文件的完整路径
-    String infoPath = path + "/" + INFO_FILE; // INFO_FILE 在 config.h 中定义
+    String infoPath = dirPath + "/" + INFO_FILE; // INFO_FILE 在 config.h 中定义
     // 检查 .info 文件是否存在
     if (!SD.exists(infoPath)) {
-        return false; // 文件不存在，不是漫画目录
+        return ""; // 文件不存在
     }
 
     // 打开 .info 文件进行读取
     File infoFile = SD.open(infoPath);
     // 如果文件打开失败
     if (!infoFile) {
-        return false; // 无法打开文件，判定为非漫画目录
+        return ""; // 无法打开文件
     }
 
     // 读取文件的全部内容到一个 String 对象
@@ -57,34 +58,109 @@ bool SDCard::checkIsComic(const String& path) {
     infoFile.close();
 
     // --- 简单的 JSON 解析逻辑 ---
-    // 查找 "type" 键的位置
-    int typePos = content.indexOf("\"type\"");
-    if (typePos == -1) {
-        return false; // 未找到 "type" 键
+    // 查找键的位置 (带引号，例如 "type")
+    int keyPos = content.indexOf(String("\"") + key + "\"");
+    if (keyPos == -1) {
+        return ""; // 未找到键
     }
 
-    // 查找 "type" 键后面的冒号位置
-    int colonPos = content.indexOf(":", typePos);
+    // 查找键后面的冒号位置
+    int colonPos = content.indexOf(":", keyPos);
     if (colonPos == -1) {
-        return false; // 格式错误
+        return ""; // 格式错误
     }
 
     // 查找冒号后面的第一个引号 (值的开始)
     int quotePos = content.indexOf("\"", colonPos);
     if (quotePos == -1) {
-        return false; // 格式错误
+        return ""; // 格式错误
     }
 
     // 查找值的结束引号
     int endQuotePos = content.indexOf("\"", quotePos + 1);
     if (endQuotePos == -1) {
-        return false; // 格式错误
+        return ""; // 格式错误
     }
 
     // 提取引号之间的值
-    String type = content.substring(quotePos + 1, endQuotePos);
-    // 比较提取出的类型值是否为 "comic"
-    return type == "comic";
+    return content.substring(quotePos + 1, endQuotePos);
+}
+
+// 检查指定路径是否是一个漫画目录
+bool SDCard::checkIsComic(const String& path) {
+    // .info 文件中 "type" 的值为 "comic"
+    return readInfoValue(path, "type") == "comic";
+}
+
+// 自然顺序比较 (数字串按数值比较)
+bool SDCard::naturalLess(const String& a, const String& b) {
+    const char* pa = a.c_str();
+    const char* pb = b.c_str();
+    while (*pa && *pb) {
+        if (isdigit((unsigned char)*pa) && isdigit((unsigned char)*pb)) {
+            // 跳过前导零后，位数多的数字大；位数相同时逐位比较
+            while (*pa == '0') pa++;
+            while (*pb == '0') pb++;
+            const char* ea = pa;
+            const char* eb = pb;
+            while (isdigit((unsigned char)*ea)) ea++;
+            while (isdigit((unsigned char)*eb)) eb++;
+            if (ea - pa != eb - pb) {
+                return ea - pa < eb - pb;
+            }
+            int cmp = strncmp(pa, pb, ea - pa);
+            if (cmp != 0) {
+                return cmp < 0;
+            }
+            pa = ea;
+            pb = eb;
+            continue;
+        }
+        if (*pa != *pb) {
+            return (unsigned char)*pa < (unsigned char)*pb;
+        }
+        pa++;
+        pb++;
+    }
+    return *pa == 0 && *pb != 0;
+}
+
+// 查找下一章 (同一父目录中自然顺序的下一个漫画目录)
+String SDCard::nextSiblingComic(const String& dirPath) {
+    int lastSlash = dirPath.lastIndexOf('/');
+    if (lastSlash < 0) {
+        return "";
+    }
+    String parentPath = lastSlash == 0 ? String("/") : dirPath.substring(0, lastSlash);
+    String currentName = dirPath.substring(lastSlash + 1);
+    File dir = SD.open(parentPath);
+    if (!dir || !dir.isDirectory()) {
+        return "";
+    }
+
+    // 只需要排在当前目录之后的最小者，不必排序整个目录
+    String best;
+    File entry;
+    while (entry = dir.openNextFile()) {
+        String name = String(entry.name());
+        // entry.name() 在某些版本中是完整路径，只取最后一段
+        int slash = name.lastIndexOf('/');
+        if (slash >= 0) {
+            name = name.substring(slash + 1);
+        }
+        bool candidate = entry.isDirectory() && naturalLess(currentName, name) &&
+                         (best.length() == 0 || naturalLess(name, best));
+        String path = String(entry.path());
+        entry.close();
+        if (candidate && checkIsComic(path)) {
+            best = name;
+        }
+    }
+    dir.close();
+    if (best.length() == 0) {
+        return "";
+    }
+    return (lastSlash == 0 ? String("/") : parentPath + "/") + best;
 }
 
 // 更新分页信息
@@ -226,6 +302,7 @@ bool SDCard::exists(const String& path) {
 
 // 打开指定路径的文件
 File SDCard::openFile(const String& path, const char* mode) {
+    TRACE_SPAN(TraceName::SD_OPEN);
     // 直接调用 SD 库的 open 方法，传入路径和打开模式
     return SD.open(path, mode);
 }
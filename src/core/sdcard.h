@@ -20,6 +20,13 @@ struct FileItem {
 /**
  * @brief SD 卡管理单例类。
  * 负责初始化 SD 卡、浏览目录、获取文件列表、分页显示以及基本文件操作。
+ *
+ * 线程安全：
+ *  - 目录浏览状态 (currentPath、currentItems、分页) 以及 begin/loadDirectory/enterDirectory/goBack/
+ *    nextPage/prevPage 只能在主循环任务中调用。
+ *  - exists() 和 openFile() 可以在 JobSystem 工作线程中调用：ESP32 的 FATFS 以可重入方式
+ *    (FF_FS_REENTRANT) 编译，文件系统操作按卷加锁。但同一个 File 对象不能在两个任务之间共享，
+ *    每个任务必须自己打开文件。
  */
 class SDCard {
 private:
@@ -72,6 +79,30 @@ public:
      */
     bool enterDirectory(const String& dirName);
 
+    /**
+     * @brief 读取目录下 .info 文件中某个键的字符串值。
+     * 例如漫画目录的 {"type": "comic", "mode": "page", "direction": "rtl"}。
+     * @param dirPath 目录路径。
+     * @param key 键名 (不含引号)。
+     * @return 键的值；文件或键不存在时返回空字符串。
+     */
+    String readInfoValue(const String& dirPath, const char* key);
+
+    /**
+     * @brief 查找同一父目录中按自然顺序排在 dirPath 之后的第一个漫画目录 (下一章)。
+     * 章节通常是并列的文件夹 ("第2话" 在 "第10话" 之前)，因此按自然顺序而不是字典序比较。
+     * 只使用文件系统调用，可以在 JobSystem 工作线程中调用。
+     * @param dirPath 当前漫画目录的完整路径。
+     * @return 下一章的完整路径；没有时返回空字符串。
+     */
+    String nextSiblingComic(const String& dirPath);
+
+    /**
+     * @brief 自然顺序比较：名称中的数字串按数值比较，其余字符逐字节比较。
+     * @return a 排在 b 之前时返回 true。
+     */
+    static bool naturalLess(const String& a, const String& b);
+
     /**
      * @brief 返回上一级目录。
      * 更新当前路径到父目录并重新加载内容。
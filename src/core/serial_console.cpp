@@ -0,0 +1,111 @@
+#include "serial_console.h" // 包含 SerialConsole 类的头文件
+#include <cstring>          // strcmp, strchr
+
+// 初始化静态单例实例指针
+SerialConsole *SerialConsole::instance = nullptr;
+
+SerialConsole::SerialConsole() : lineLength(0), pollPosted(false)
+{
+    lineBuffer[0] = '\0';
+}
+
+SerialConsole &SerialConsole::getInstance()
+{
+    if (!instance)
+    {
+        instance = new SerialConsole();
+    }
+    return *instance;
+}
+
+void SerialConsole::begin()
+{
+    Serial.onReceive([this]() { onReceive(); });
+    poll(); // 启动前已经到达的字符
+    Serial.println("串口命令台已启动，输入 help 查看命令。");
+}
+
+void SerialConsole::registerCommand(const char *name, const char *help, CommandCallback callback, void *ctx)
+{
+    commands.push_back({name, help, callback, ctx});
+}
+
+void SerialConsole::onReceive()
+{
+    if (!pollPosted.exchange(true) && !Scheduler::getInstance().post(onPoll, this))
+    {
+        pollPosted.store(false); // 队列已满：下一批数据到达时再投递
+    }
+}
+
+void SerialConsole::onPoll(void *ctx)
+{
+    SerialConsole *console = static_cast<SerialConsole *>(ctx);
+    console->pollPosted.store(false); // 先清除：读取过程中到达的数据会再投递一次
+    console->poll();
+}
+
+// 读取串口中已到达的字符，遇到换行时执行命令
+void SerialConsole::poll()
+{
+    while (Serial.available() > 0)
+    {
+        char c = (char)Serial.read();
+        if (c == '\r' || c == '\n')
+        {
+            if (lineLength > 0)
+            {
+                lineBuffer[lineLength] = '\0';
+                execute(lineBuffer);
+                lineLength = 0;
+            }
+        }
+        else if (lineLength < sizeof(lineBuffer) - 1)
+        {
+            lineBuffer[lineLength++] = c;
+        }
+        // 超长的行直接截断
+    }
+}
+
+// 解析并执行一行命令
+void SerialConsole::execute(char *line)
+{
+    char *args = strchr(line, ' ');
+    if (args)
+    {
+        *args++ = '\0';
+        while (*args == ' ')
+        {
+            args++;
+        }
+    }
+    else
+    {
+        args = line + strlen(line);
+    }
+
+    if (strcmp(line, "help") == 0)
+    {
+        printHelp();
+        return;
+    }
+    for (const Command &command : commands)
+    {
+        if (strcmp(line, command.name) == 0)
+        {
+            command.callback(command.ctx, args);
+            return;
+        }
+    }
+    Serial.printf("未知命令: %s (输入 help 查看命令)\n", line);
+}
+
+void SerialConsole::printHelp()
+{
+    Serial.println("可用命令:");
+    for (const Command &command : commands)
+    {
+        Serial.printf("  %-10s %s\n", command.name, command.help);
+    }
+}
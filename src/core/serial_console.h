@@ -0,0 +1,72 @@
+#ifndef SERIAL_CONSOLE_H // 防止头文件被重复包含
+#define SERIAL_CONSOLE_H
+
+#include <Arduino.h>
+#include <vector>             // 存储注册的命令
+#include <atomic>             // 接收回调在 UART 事件任务中运行
+#include "../config/config.h" // 行缓冲区大小
+#include "scheduler.h"        // 把读取投递到主循环
+
+/**
+ * @brief 串口调试命令台单例类。
+ * 串口收到数据时 (Serial.onReceive，在 UART 事件任务中) 用 Scheduler::post() 唤醒主循环读取，
+ * 按行读取命令 (例如 "mem")，调用注册的回调。没有输入时不唤醒主循环，不影响休眠省电。
+ * 各模块在 setup() 中注册自己的诊断命令，例如输出内存统计。
+ * 线程安全：读取和命令回调都在主循环中执行；接收回调只投递一次读取。
+ */
+class SerialConsole
+{
+public:
+    /**
+     * @brief 命令回调类型。
+     * @param ctx 注册时传入的上下文指针。
+     * @param args 命令名之后的参数 (已去掉前导空格，可能为空字符串)。
+     */
+    using CommandCallback = void (*)(void *ctx, const char *args);
+
+private:
+    struct Command
+    {
+        const char *name; // 命令名 (静态字符串)
+        const char *help; // 帮助说明 (静态字符串)
+        CommandCallback callback;
+        void *ctx;
+    };
+
+    static SerialConsole *instance;
+    std::vector<Command> commands;
+    char lineBuffer[SERIAL_CONSOLE_LINE_LENGTH];
+    size_t lineLength;
+    std::atomic<bool> pollPosted; // 已投递、主循环还没执行的读取 (连续到达的数据只投递一次)
+
+    SerialConsole();
+
+    // UART 事件任务中的接收回调：投递一次 onPoll
+    void onReceive();
+    static void onPoll(void *ctx);
+    void poll();
+    void execute(char *line);
+    void printHelp();
+
+public:
+    SerialConsole(const SerialConsole &) = delete;
+    SerialConsole &operator=(const SerialConsole &) = delete;
+
+    static SerialConsole &getInstance();
+
+    /**
+     * @brief 开始接收串口命令。在 setup() 中 Serial.begin() 之后、Scheduler::begin() 之后调用。
+     */
+    void begin();
+
+    /**
+     * @brief 注册命令。
+     * @param name 命令名 (静态字符串)。
+     * @param help 帮助说明 (静态字符串)。
+     * @param callback 回调函数。
+     * @param ctx 上下文指针。
+     */
+    void registerCommand(const char *name, const char *help, CommandCallback callback, void *ctx = nullptr);
+};
+
+#endif // SERIAL_CONSOLE_H
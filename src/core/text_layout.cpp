@@ -0,0 +1,219 @@
+#include "text_layout.h" // 包含 TextLayout 类的头文件
+#include "utf8.h"        // UTF-8 首字节规则
+
+// 空格和制表符是单词分隔符
+static inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+TextLayout::TextLayout(int availableWidth, uint16_t fontSize, LineCallback onLine, void *ctx)
+    : availableWidth(availableWidth), fontSize(fontSize), onLine(onLine), ctx(ctx),
+      lineStart(0), wordStart(0), position(0)
+{
+}
+
+// 从指定偏移开始新的一行
+void TextLayout::reset(size_t offset)
+{
+    currentLine = "";
+    wordBuffer = "";
+    lineStart = offset;
+    wordStart = offset;
+    position = offset;
+}
+
+// 估算文本宽度 (不创建临时 String)
+int TextLayout::measure(const char *text, size_t length, uint16_t fontSize, uint8_t *owed)
+{
+    int width = 0;
+    size_t i = 0;
+    size_t step = 0;
+    while (i < length)
+    {
+        uint8_t first = (uint8_t)text[i];
+        if (first < 0x80)
+        {
+            width += fontSize / 2; // ASCII 按半宽估算
+            step = 1;
+        }
+        else
+        {
+            width += fontSize;                  // 非 ASCII 按全宽估算
+            step = Utf8::sequenceLength(first); // 无效的首字节单独计为一个字符
+        }
+        i += step;
+    }
+    if (owed)
+    {
+        *owed = i > length ? (uint8_t)(i - length) : 0;
+    }
+    return width;
+}
+
+void TextLayout::emit(const String &line, size_t nextLineOffset, LineEnd end)
+{
+    if (onLine)
+    {
+        onLine(ctx, line, nextLineOffset, end);
+    }
+}
+
+// 处理一个非换行字节
+void TextLayout::feed(char c)
+{
+    size_t at = position++;
+    int lineWidth = widthOf(currentLine);
+    uint8_t owed = 0;
+    int wordWidth = measure(wordBuffer.c_str(), wordBuffer.length(), fontSize, &owed);
+    // 多字节字符的后续字节已经计入首字节的宽度
+    int wordPlusCharWidth = wordWidth + (owed ? 0 : ((uint8_t)c < 0x80 ? fontSize / 2 : fontSize));
+
+    if (lineWidth + wordPlusCharWidth > availableWidth)
+    {
+        // 断行处的空白被丢弃，下一行从它之后开始
+        size_t charLineStart = isBlank(c) ? at + 1 : at;
+        if (currentLine.length() > 0)
+        {
+            // 当前行已有内容：单词整体移到下一行
+            emit(currentLine, wordBuffer.length() > 0 ? wordStart : charLineStart, LineEnd::WRAP);
+            currentLine = wordBuffer;
+            lineStart = wordStart;
+            wordBuffer = "";
+            if (!isBlank(c))
+            {
+                wordBuffer += c;
+                wordStart = at;
+            }
+        }
+        else
+        {
+            // 单词本身比整行还宽：按字符强制断开
+            size_t split = 0;
+            int fittedWidth = 0;
+            while (split < wordBuffer.length())
+            {
+                uint8_t first = (uint8_t)wordBuffer[split];
+                size_t charLen = Utf8::sequenceLength(first);
+                int charWidth = first < 0x80 ? fontSize / 2 : fontSize;
+                if (fittedWidth + charWidth > availableWidth)
+                {
+                    break;
+                }
+                fittedWidth += charWidth;
+                split += charLen;
+            }
+            if (split > wordBuffer.length())
+            {
+                split = wordBuffer.length(); // 末尾是不完整的字符
+            }
+
+            size_t remainingStart = wordStart + split;
+            bool hasRemaining = split < wordBuffer.length();
+            if (split > 0)
+            {
+                emit(wordBuffer.substring(0, split), hasRemaining ? remainingStart : charLineStart, LineEnd::WRAP);
+            }
+            wordBuffer = wordBuffer.substring(split);
+            wordStart = hasRemaining ? remainingStart : at;
+            if (!isBlank(c))
+            {
+                wordBuffer += c;
+            }
+            currentLine = "";
+        }
+        return;
+    }
+
+    // 放得下：加入当前单词，遇到分隔符时把单词放进当前行
+    if (wordBuffer.length() == 0)
+    {
+        wordStart = at;
+    }
+    wordBuffer += c;
+    if (isBlank(c))
+    {
+        if (lineWidth + widthOf(wordBuffer) <= availableWidth)
+        {
+            if (currentLine.length() == 0)
+            {
+                lineStart = wordStart;
+            }
+            currentLine += wordBuffer;
+        }
+        else
+        {
+            if (currentLine.length() > 0)
+            {
+                emit(currentLine, wordStart, LineEnd::WRAP);
+            }
+            currentLine = wordBuffer;
+            lineStart = wordStart;
+        }
+        wordBuffer = "";
+    }
+}
+
+// 把当前单词放进当前行，放不下时先输出当前行
+void TextLayout::flushWord()
+{
+    if (wordBuffer.length() == 0)
+    {
+        return;
+    }
+    if (widthOf(currentLine) + widthOf(wordBuffer) <= availableWidth)
+    {
+        if (currentLine.length() == 0)
+        {
+            lineStart = wordStart;
+        }
+        currentLine += wordBuffer;
+    }
+    else
+    {
+        if (currentLine.length() > 0)
+        {
+            emit(currentLine, wordStart, LineEnd::WRAP);
+        }
+        currentLine = wordBuffer;
+        lineStart = wordStart;
+    }
+    wordBuffer = "";
+}
+
+// 换行符结束当前段落 (空行也输出)
+void TextLayout::endParagraph(size_t nextOffset)
+{
+    flushWord();
+    emit(currentLine, nextOffset, LineEnd::PARAGRAPH);
+    currentLine = "";
+    position = nextOffset;
+    lineStart = nextOffset;
+    wordStart = nextOffset;
+}
+
+// 文件结束
+void TextLayout::finish()
+{
+    flushWord();
+    if (currentLine.length() > 0)
+    {
+        emit(currentLine, position, LineEnd::END);
+    }
+    currentLine = "";
+    lineStart = position;
+}
+
+// 尚未输出的文本的起始偏移
+size_t TextLayout::pendingOffset() const
+{
+    if (currentLine.length() > 0)
+    {
+        return lineStart;
+    }
+    if (wordBuffer.length() > 0)
+    {
+        return wordStart;
+    }
+    return position;
+}
@@ -0,0 +1,100 @@
+#ifndef TEXT_LAYOUT_H // 防止头文件被重复包含
+#define TEXT_LAYOUT_H
+
+#include <Arduino.h> // String
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 文本阅读器的自动换行 (逐字节流式处理)。
+ * 规则与文本阅读器一直使用的一致：
+ *  - 宽度估算：ASCII 字符为 fontSize/2，其它字符为 fontSize (按 UTF-8 首字节识别，一个字符只计一次)；
+ *  - 以空格/制表符分词，单词放不下时整体移到下一行；自动换行处的空白被丢弃；
+ *  - 单个单词比整行还宽时按字符强制断开；
+ *  - 换行符 (由调用方识别 LF/CR/CRLF 后调用 endParagraph()) 结束当前行，空行也算一行。
+ * 每完成一行调用一次 LineCallback，并给出下一行在文件中的起始偏移 (用于行索引和预取)。
+ * 元数据计算和绘制共用这一个实现，保证两边的行号一致；基准测试也直接测量它的吞吐量。
+ * 不依赖 Font 实例和屏幕，可以在任意任务中使用 (每个实例只能在一个任务中使用)。
+ */
+class TextLayout
+{
+public:
+    // 一行是怎样结束的
+    enum class LineEnd : uint8_t
+    {
+        WRAP,      // 自动换行
+        PARAGRAPH, // 文件中的换行符
+        END        // 文件结束
+    };
+
+    /**
+     * @brief 行完成回调。
+     * @param ctx 注册时传入的上下文。
+     * @param line 行内容 (只在回调期间有效)。
+     * @param nextLineOffset 下一行在文件中的起始偏移。
+     * @param end 行结束的原因。
+     */
+    typedef void (*LineCallback)(void *ctx, const String &line, size_t nextLineOffset, LineEnd end);
+
+    /**
+     * @param availableWidth 可用宽度 (像素)。
+     * @param fontSize 字体大小 (像素，例如 16)。
+     * @param onLine 行完成回调。
+     * @param ctx 回调上下文。
+     */
+    TextLayout(int availableWidth, uint16_t fontSize, LineCallback onLine, void *ctx);
+
+    /**
+     * @brief 清空缓冲区，从文件偏移 offset 开始新的一行 (seek 之后调用)。
+     */
+    void reset(size_t offset);
+
+    /**
+     * @brief 处理一个非换行字节 (位于当前偏移处)。
+     */
+    void feed(char c);
+
+    /**
+     * @brief 调用方读到了换行符：结束当前段落。
+     * @param nextOffset 换行符 (CRLF 为两个字节) 之后的文件偏移。
+     */
+    void endParagraph(size_t nextOffset);
+
+    /**
+     * @brief 文件结束：输出缓冲区中剩余的内容。
+     */
+    void finish();
+
+    /**
+     * @brief 尚未输出的文本 (当前行 + 当前单词) 在文件中的起始偏移。
+     */
+    size_t pendingOffset() const;
+
+    /**
+     * @brief 下一个字节的文件偏移。
+     */
+    size_t offset() const { return position; }
+
+    /**
+     * @brief 按上述规则估算一段 UTF-8 文本的像素宽度。
+     * @param owed (可选) 返回最后一个字符还缺少的后续字节数 (文本在多字节字符中间截断时不为 0)。
+     */
+    static int measure(const char *text, size_t length, uint16_t fontSize, uint8_t *owed = nullptr);
+
+private:
+    int availableWidth;
+    uint16_t fontSize;
+    LineCallback onLine;
+    void *ctx;
+    String currentLine; // 当前行中已经放下的单词
+    String wordBuffer;  // 正在累积的单词
+    size_t lineStart;   // currentLine 的文件偏移
+    size_t wordStart;   // wordBuffer 的文件偏移
+    size_t position;    // 下一个字节的文件偏移
+
+    int widthOf(const String &s) const { return measure(s.c_str(), s.length(), fontSize); }
+    void emit(const String &line, size_t nextLineOffset, LineEnd end);
+    void flushWord(); // 换行或文件结束时把 wordBuffer 放进当前行 (放不下则先输出当前行)
+};
+
+#endif // TEXT_LAYOUT_H
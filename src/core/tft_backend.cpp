@@ -0,0 +1,46 @@
+#ifdef ARDUINO
+
+#include <Arduino.h>          // pinMode / digitalWrite
+#include "tft_backend.h"      // 包含 TftBackend 类的头文件
+#include <new>                // std::nothrow
+#include "../config/config.h" // TFT_BL, PANEL
+
+// 面板描述必须与 TFT_eSPI 的 User_Setup 一致 (驱动的尺寸、颜色顺序和总线在库编译时确定)
+#if defined(TFT_WIDTH) && defined(TFT_HEIGHT)
+static_assert((PANEL.rotation & 1 ? TFT_HEIGHT : TFT_WIDTH) == PANEL.width &&
+                  (PANEL.rotation & 1 ? TFT_WIDTH : TFT_HEIGHT) == PANEL.height,
+              "PANEL size does not match TFT_WIDTH/TFT_HEIGHT in the TFT_eSPI setup");
+#endif
+#if defined(TFT_RGB_ORDER)
+static_assert((TFT_RGB_ORDER == TFT_BGR) == (PANEL.colorOrder == PanelDescriptor::BGR),
+              "PANEL colour order does not match TFT_RGB_ORDER in the TFT_eSPI setup");
+#endif
+#if defined(TFT_PARALLEL_16_BIT)
+static_assert(PANEL.busWidth == 16, "PANEL bus width does not match the TFT_eSPI setup (16-bit parallel)");
+#elif defined(TFT_PARALLEL_8_BIT)
+static_assert(PANEL.busWidth == 8, "PANEL bus width does not match the TFT_eSPI setup (8-bit parallel)");
+#else
+static_assert(PANEL.busWidth == 1, "PANEL bus width does not match the TFT_eSPI setup (SPI)");
+#endif
+
+void TftBackend::init()
+{
+    tft.init();
+
+    // 设置背光引脚为输出，并打开背光
+    pinMode(TFT_BL, OUTPUT);
+    digitalWrite(TFT_BL, HIGH);
+}
+
+DisplayBackend *TftBackend::createCanvas(int16_t w, int16_t h)
+{
+    TftCanvas *canvas = new (std::nothrow) TftCanvas(&tft);
+    if (canvas && !canvas->create(w, h))
+    {
+        delete canvas;
+        canvas = nullptr;
+    }
+    return canvas;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,122 @@
+#ifndef TFT_BACKEND_H
+#define TFT_BACKEND_H
+
+#ifdef ARDUINO // TFT_eSPI 只存在于设备上；主机端使用 FramebufferBackend
+
+#include <TFT_eSPI.h> // 主图形库，用于驱动 TFT 屏幕
+#include <SPI.h>      // TFT_eSPI 依赖的 SPI 通信库
+#include "display_backend.h"
+
+/**
+ * @brief 设备上的显示后端：每个方法直接转发给 TFT_eSPI (引脚和驱动由 User_Setup.h 配置)。
+ * init() 同时打开背光。
+ */
+class TftBackend : public DisplayBackend
+{
+private:
+    mutable TFT_eSPI tft; // TFT_eSPI 显示对象 (它的 width()/getSwapBytes() 等不是 const 方法)
+
+public:
+    void init() override;
+    void setRotation(uint8_t rotation) override { tft.setRotation(rotation); }
+
+    int16_t width() const override { return tft.width(); }
+    int16_t height() const override { return tft.height(); }
+
+    void setClipRect(int32_t x, int32_t y, int32_t w, int32_t h) override { tft.setViewport(x, y, w, h, false); }
+    void clearClipRect() override { tft.resetViewport(); }
+    DisplayBackend *createCanvas(int16_t w, int16_t h) override;
+
+    void fillScreen(uint32_t color) override { tft.fillScreen(color); }
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override { tft.fillRect(x, y, w, h, color); }
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override { tft.drawRect(x, y, w, h, color); }
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color) override
+    {
+        tft.fillRoundRect(x, y, w, h, radius, color);
+    }
+    void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color) override
+    {
+        tft.drawRoundRect(x, y, w, h, radius, color);
+    }
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) override { tft.drawFastHLine(x, y, w, color); }
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) override { tft.drawFastVLine(x, y, h, color); }
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) override { tft.drawLine(x0, y0, x1, y1, color); }
+    void drawPixel(int32_t x, int32_t y, uint32_t color) override { tft.drawPixel(x, y, color); }
+
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) override { tft.pushImage(x, y, w, h, data); }
+    void readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data) override { tft.readRect(x, y, w, h, data); }
+    void setSwapBytes(bool swap) override { tft.setSwapBytes(swap); }
+    bool getSwapBytes() const override { return tft.getSwapBytes(); }
+
+    void setTextColor(uint16_t color) override { tft.setTextColor(color); }
+    void setTextColor(uint16_t foreground, uint16_t background) override { tft.setTextColor(foreground, background); }
+    void setTextSize(uint8_t size) override { tft.setTextSize(size); }
+    void setTextFont(uint8_t font) override { tft.setTextFont(font); }
+    void setTextDatum(uint8_t datum) override { tft.setTextDatum(datum); }
+    int16_t drawString(const char *text, int32_t x, int32_t y) override { return tft.drawString(text, x, y); }
+    using DisplayBackend::drawString;
+};
+
+/**
+ * @brief TftBackend::createCanvas() 返回的离屏画布：转发给 TFT_eSprite (同样的绘图代码画到内存中)。
+ * 精灵内存在 create() 中分配 (有 PSRAM 时在 PSRAM 中)，析构时释放。画布没有裁剪区和离屏画布。
+ */
+class TftCanvas : public DisplayBackend
+{
+private:
+    mutable TFT_eSprite sprite;
+
+public:
+    explicit TftCanvas(TFT_eSPI *parent) : sprite(parent) {}
+    ~TftCanvas() override { sprite.deleteSprite(); }
+
+    // 分配 w x h 的 16 位精灵，失败返回 false
+    bool create(int16_t w, int16_t h)
+    {
+        sprite.setColorDepth(16);
+        return sprite.createSprite(w, h) != nullptr;
+    }
+
+    void init() override {}
+    void setRotation(uint8_t rotation) override { (void)rotation; }
+
+    int16_t width() const override { return sprite.width(); }
+    int16_t height() const override { return sprite.height(); }
+
+    void setClipRect(int32_t x, int32_t y, int32_t w, int32_t h) override { sprite.setViewport(x, y, w, h, false); }
+    void clearClipRect() override { sprite.resetViewport(); }
+    DisplayBackend *createCanvas(int16_t w, int16_t h) override { return nullptr; }
+
+    void fillScreen(uint32_t color) override { sprite.fillSprite(color); }
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override { sprite.fillRect(x, y, w, h, color); }
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override { sprite.drawRect(x, y, w, h, color); }
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color) override
+    {
+        sprite.fillRoundRect(x, y, w, h, radius, color);
+    }
+    void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color) override
+    {
+        sprite.drawRoundRect(x, y, w, h, radius, color);
+    }
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) override { sprite.drawFastHLine(x, y, w, color); }
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) override { sprite.drawFastVLine(x, y, h, color); }
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) override { sprite.drawLine(x0, y0, x1, y1, color); }
+    void drawPixel(int32_t x, int32_t y, uint32_t color) override { sprite.drawPixel(x, y, color); }
+
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) override { sprite.pushImage(x, y, w, h, data); }
+    void readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data) override { sprite.readRect(x, y, w, h, data); }
+    void setSwapBytes(bool swap) override { sprite.setSwapBytes(swap); }
+    bool getSwapBytes() const override { return sprite.getSwapBytes(); }
+
+    void setTextColor(uint16_t color) override { sprite.setTextColor(color); }
+    void setTextColor(uint16_t foreground, uint16_t background) override { sprite.setTextColor(foreground, background); }
+    void setTextSize(uint8_t size) override { sprite.setTextSize(size); }
+    void setTextFont(uint8_t font) override { sprite.setTextFont(font); }
+    void setTextDatum(uint8_t datum) override { sprite.setTextDatum(datum); }
+    int16_t drawString(const char *text, int32_t x, int32_t y) override { return sprite.drawString(text, x, y); }
+    using DisplayBackend::drawString;
+};
+
+#endif // ARDUINO
+
+#endif // TFT_BACKEND_H
@@ -0,0 +1,184 @@
+#include "thumbnail_file.h"
+#include <algorithm>           // std::min, std::max
+#include "sdcard.h"           // 打开缩略图文件
+#include "trace.h"            // 区间跟踪
+#include "../config/config.h" // COMIC_THUMB_FILE
+
+static const uint8_t THUMB_MAGIC[4] = {'C', 'T', 'H', 'B'};
+
+static void putLe16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void putLe32(uint8_t *p, uint32_t v)
+{
+    putLe16(p, (uint16_t)v);
+    putLe16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t getLe16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t getLe32(const uint8_t *p) { return getLe16(p) | ((uint32_t)getLe16(p + 2) << 16); }
+
+bool ThumbnailFile::open(const String &comicDir, int count, int width, int height)
+{
+    close();
+    path = comicDir + "/" + COMIC_THUMB_FILE;
+    thumbWidth = (uint16_t)width;
+    thumbHeight = (uint16_t)height;
+    offsets.assign(count, 0);
+    endOffset = HEADER_BYTES + count * sizeof(uint32_t);
+
+    SDCard &sd = SDCard::getInstance();
+    if (sd.exists(path))
+    {
+        File file = sd.openFile(path);
+        uint8_t header[HEADER_BYTES];
+        bool valid = file && file.read(header, sizeof(header)) == sizeof(header) && memcmp(header, THUMB_MAGIC, 4) == 0 &&
+                     getLe16(header + 4) == VERSION && getLe16(header + 6) == thumbWidth &&
+                     getLe16(header + 8) == thumbHeight && getLe16(header + 10) == count;
+        for (int i = 0; valid && i < count; i++)
+        {
+            uint8_t entry[4];
+            valid = file.read(entry, sizeof(entry)) == sizeof(entry);
+            offsets[i] = valid ? getLe32(entry) : 0;
+        }
+        if (valid)
+        {
+            endOffset = file.size();
+            file.close();
+            return true;
+        }
+        if (file)
+        {
+            file.close();
+        }
+        Serial.printf("Thumbnails: %s is stale, rebuilding it.\n", path.c_str());
+        offsets.assign(count, 0);
+    }
+    if (!create())
+    {
+        Serial.printf("Thumbnails: cannot create %s\n", path.c_str());
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ThumbnailFile::close()
+{
+    path = "";
+    offsets.clear();
+    endOffset = 0;
+}
+
+// 写入文件头和全 0 的偏移表
+bool ThumbnailFile::create()
+{
+    File file = SDCard::getInstance().openFile(path, FILE_WRITE);
+    if (!file)
+    {
+        return false;
+    }
+    uint8_t header[HEADER_BYTES];
+    memcpy(header, THUMB_MAGIC, 4);
+    putLe16(header + 4, VERSION);
+    putLe16(header + 6, thumbWidth);
+    putLe16(header + 8, thumbHeight);
+    putLe16(header + 10, (uint16_t)offsets.size());
+    bool ok = file.write(header, sizeof(header)) == sizeof(header);
+    uint8_t zero[4] = {0, 0, 0, 0};
+    for (size_t i = 0; ok && i < offsets.size(); i++)
+    {
+        ok = file.write(zero, sizeof(zero)) == sizeof(zero);
+    }
+    file.close();
+    return ok;
+}
+
+bool ThumbnailFile::writeEntry(File &file, int index, uint32_t offset)
+{
+    uint8_t entry[4];
+    putLe32(entry, offset);
+    return file.seek(HEADER_BYTES + index * sizeof(uint32_t)) && file.write(entry, sizeof(entry)) == sizeof(entry);
+}
+
+bool ThumbnailFile::append(int index, const uint16_t *pixels)
+{
+    if (!isOpen() || index < 0 || index >= count() || has(index))
+    {
+        return false;
+    }
+    // 先追加数据，再写偏移表：中途断电时偏移表仍指向 0 (缩略图视为未生成)
+    File file = SDCard::getInstance().openFile(path, "r+");
+    if (!file)
+    {
+        return false;
+    }
+    const size_t bytes = thumbnailBytes();
+    bool ok = file.seek(endOffset) && file.write((const uint8_t *)pixels, bytes) == bytes && writeEntry(file, index, endOffset);
+    file.close();
+    if (ok)
+    {
+        offsets[index] = endOffset;
+        endOffset += bytes;
+    }
+    return ok;
+}
+
+int ThumbnailFile::readRange(int first, int n, uint16_t *buffer, int bufferThumbnails, ThumbnailCallback callback, void *ctx)
+{
+    if (!isOpen() || bufferThumbnails <= 0)
+    {
+        return -1;
+    }
+    const int end = std::min(first + n, count());
+    const size_t bytes = thumbnailBytes();
+    const size_t pixelsPerThumbnail = bytes / sizeof(uint16_t);
+    File file;
+    int reads = 0;
+    for (int i = std::max(first, 0); i < end;)
+    {
+        if (!has(i))
+        {
+            i++;
+            continue;
+        }
+        // 连续存放的一段缩略图合并为一次读取
+        int run = 1;
+        while (run < bufferThumbnails && i + run < end && has(i + run) && offsets[i + run] == offsets[i] + run * bytes)
+        {
+            run++;
+        }
+        if (!file)
+        {
+            file = SDCard::getInstance().openFile(path);
+            if (!file)
+            {
+                return -1;
+            }
+        }
+        bool ok;
+        {
+            TRACE_SPAN(TraceName::SD_READ);
+            ok = file.seek(offsets[i]) && file.read((uint8_t *)buffer, run * bytes) == run * bytes;
+        }
+        if (!ok)
+        {
+            file.close();
+            return -1;
+        }
+        reads++;
+        for (int k = 0; k < run; k++)
+        {
+            callback(ctx, i + k, buffer + k * pixelsPerThumbnail);
+        }
+        i += run;
+    }
+    if (file)
+    {
+        file.close();
+    }
+    return reads;
+}
@@ -0,0 +1,74 @@
+#ifndef THUMBNAIL_FILE_H // 防止头文件被重复包含
+#define THUMBNAIL_FILE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <vector>
+
+/**
+ * @brief 一本漫画的缩略图文件 (漫画目录下的 COMIC_THUMB_FILE)。
+ * 所有缩略图以 RGB565 (小端，与内存中相同) 打包在一个文件中：
+ *   文件头 HEADER_BYTES：'C' 'T' 'H' 'B'、版本 (2)、缩略图宽 (2)、高 (2)、图片数 (2)；
+ *   偏移表：图片数 x 4 字节，第 i 张缩略图在文件中的位置 (0 表示尚未生成)；
+ *   缩略图数据：每张 width x height x 2 字节，按生成顺序追加。
+ * 缩略图在浏览网格时按需生成 (页面在 JobSystem 上用 BmpScaler 缩小原图，完成后调用 append())，之后直接从文件读取。
+ * 网格按顺序生成同一屏的缩略图，因此它们在文件中是连续的，readRange() 可以一次读取整屏。
+ * 尺寸或图片数变化 (换了面板、增删了图片) 时丢弃旧文件重新生成。
+ * 线程安全：只能在主循环任务中使用。
+ */
+class ThumbnailFile
+{
+public:
+    static constexpr size_t HEADER_BYTES = 12;
+    static constexpr uint16_t VERSION = 1;
+
+    // readRange() 的回调：pixels 为第 index 张缩略图 (width x height 个 RGB565 像素)
+    using ThumbnailCallback = void (*)(void *ctx, int index, const uint16_t *pixels);
+
+private:
+    String path;
+    uint16_t thumbWidth;
+    uint16_t thumbHeight;
+    std::vector<uint32_t> offsets; // 每张图片的缩略图位置 (0 = 尚未生成)
+    uint32_t endOffset;            // 下一张缩略图追加的位置
+
+    bool create();
+    bool writeEntry(File &file, int index, uint32_t offset);
+
+public:
+    ThumbnailFile() : thumbWidth(0), thumbHeight(0), endOffset(0) {}
+
+    /**
+     * @brief 打开 (不存在或不匹配时创建) 漫画目录的缩略图文件，读取偏移表。
+     * @param comicDir 漫画目录。
+     * @param count 图片数。
+     * @param width/height 缩略图尺寸。
+     * @return 文件可用时返回 true。
+     */
+    bool open(const String &comicDir, int count, int width, int height);
+    void close();
+    bool isOpen() const { return path.length() > 0; }
+
+    int count() const { return (int)offsets.size(); }
+    int width() const { return thumbWidth; }
+    int height() const { return thumbHeight; }
+    size_t thumbnailBytes() const { return (size_t)thumbWidth * thumbHeight * sizeof(uint16_t); }
+    bool has(int index) const { return index >= 0 && index < count() && offsets[index] != 0; }
+
+    /**
+     * @brief 把第 index 张缩略图追加到文件并写入偏移表。
+     * @param pixels 缩略图像素 (width x height 个 RGB565 像素)。
+     * @return 写入成功返回 true；已经生成过的缩略图不会重复写入，返回 false。
+     */
+    bool append(int index, const uint16_t *pixels);
+
+    /**
+     * @brief 读取 [first, first + n) 中已生成的缩略图，对每一张调用 callback。
+     * 文件中连续存放的缩略图合并为一次读取，每次最多 bufferThumbnails 张。
+     * @param buffer 读取缓冲区 (bufferThumbnails * thumbnailBytes() 字节)。
+     * @return 读取文件的次数；出错返回 -1。
+     */
+    int readRange(int first, int n, uint16_t *buffer, int bufferThumbnails, ThumbnailCallback callback, void *ctx);
+};
+
+#endif // THUMBNAIL_FILE_H
@@ -1,5 +1,7 @@
 #include "touch.h"    // 包含 Touch 类的头文件
 #include <Arduino.h> // 包含 Arduino 核心库，用于 map(), Serial, String, pinMode, digitalWrite 等函数
+#include "scheduler.h" // 触摸中断用于唤醒主循环
+#include "touch_trace.h" // 触摸轨迹录制
 
 // 初始化静态单例实例指针为空
 Touch* Touch::instance = nullptr;
@@ -48,13 +50,27 @@ void Touch::begin() {
     ts.begin(touchSPI);
     // 根据显示方向设置旋转。
     // 这确保触摸坐标与显示坐标匹配。
-    // 值 '1' 通常对应 ILI9341 的横屏模式。
-    ts.setRotation(1);
+    // 与显示使用同一个面板描述中的方向 (panel.h)。
+    ts.setRotation(PANEL.rotation);
+
+    // 用自己的 ISR 替换库注册的 IRQ 中断：除了设置 isrWake，还要唤醒休眠中的主循环，
+    // 这样主循环可以一直休眠到真正有触摸发生，而不必每 10ms 轮询一次。
+    attachInterruptArg(digitalPinToInterrupt(XPT2046_IRQ), onTouchInterrupt, this, FALLING);
 
     initialized = true; // 标记为已初始化
     Serial.println("触摸屏已初始化。"); // 打印初始化完成信息
 }
 
+/**
+ * @brief 触摸 IRQ 中断服务程序 (XPT2046 按下时 IRQ 引脚拉低)。
+ * 与库自带 ISR 的行为一致 (设置 isrWake，让 touched() 去读取控制器)，并额外唤醒主循环。
+ */
+void IRAM_ATTR Touch::onTouchInterrupt(void* arg) {
+    Touch* self = static_cast<Touch*>(arg);
+    self->ts.isrWake = true;
+    Scheduler::wakeFromISR();
+}
+
 /**
  * @brief 检查屏幕当前是否被触摸。
  * 依赖于底层 XPT2046 库的 touched() 方法。
@@ -108,5 +124,8 @@ bool Touch::getPoint(uint16_t& x, uint16_t& y) {
     lastX = x;
     lastY = y;
 
+    // 录制触摸轨迹时记录这个点 (未录制时立即返回)
+    TouchTrace::getInstance().record(x, y, millis());
+
     return true; // 成功读取并映射了一个触摸点
 }
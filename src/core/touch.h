@@ -23,6 +23,13 @@ private:
     Touch();
     static Touch* instance;     // 指向 Touch 类单例实例的指针
 
+    /**
+     * @brief 触摸 IRQ 中断服务程序。
+     * 替代库自带的 ISR：设置库的 isrWake 标志，并唤醒休眠中的主循环 (见 Scheduler)。
+     * @param arg 指向 Touch 实例的指针。
+     */
+    static void IRAM_ATTR onTouchInterrupt(void* arg);
+
 public:
     // 删除拷贝构造函数和赋值操作符，防止复制单例实例
     Touch(const Touch&) = delete;
@@ -0,0 +1,319 @@
+#include "touch_trace.h" // 包含 TouchTrace 类的头文件
+#include <algorithm>     // std::sort
+#include <cstdlib>       // strtoul
+#include <cstring>       // strrchr
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <SD.h> // 轨迹文件保存在 SD 卡上
+#define TOUCH_TRACE_PRINTF(...) Serial.printf(__VA_ARGS__)
+#else
+#include <cstdio>
+#define TOUCH_TRACE_PRINTF(...) printf(__VA_ARGS__)
+#endif
+
+// 初始化静态单例实例指针
+TouchTrace *TouchTrace::instance = nullptr;
+
+TouchTrace::TouchTrace() : state(State::IDLE), startMs(0), nextEvent(0), overflowReported(false)
+{
+}
+
+TouchTrace &TouchTrace::getInstance()
+{
+    if (!instance)
+    {
+        instance = new TouchTrace();
+    }
+    return *instance;
+}
+
+// --- 录制 ---
+
+void TouchTrace::startRecording(uint32_t nowMs)
+{
+    events.clear();
+    latencies.clear();
+    startMs = nowMs;
+    overflowReported = false;
+    state = State::RECORDING;
+    TOUCH_TRACE_PRINTF("TouchTrace：开始录制\n");
+}
+
+void TouchTrace::record(uint16_t x, uint16_t y, uint32_t nowMs)
+{
+    if (state != State::RECORDING)
+    {
+        return;
+    }
+    if (events.size() >= TOUCH_TRACE_MAX_EVENTS)
+    {
+        if (!overflowReported)
+        {
+            TOUCH_TRACE_PRINTF("TouchTrace：已达到 %d 个事件，后续触摸不再记录\n", TOUCH_TRACE_MAX_EVENTS);
+            overflowReported = true;
+        }
+        return;
+    }
+    events.push_back({nowMs - startMs, x, y});
+}
+
+bool TouchTrace::stopRecording(const char *path)
+{
+    if (state != State::RECORDING)
+    {
+        return false;
+    }
+    state = State::IDLE;
+    TOUCH_TRACE_PRINTF("TouchTrace：录制结束，%u 个事件\n", (unsigned)events.size());
+    return save(path);
+}
+
+// --- 回放 ---
+
+bool TouchTrace::startReplay(const char *path, uint32_t nowMs)
+{
+    if (state != State::IDLE || !load(path))
+    {
+        return false;
+    }
+    return startReplay(nowMs);
+}
+
+bool TouchTrace::startReplay(uint32_t nowMs)
+{
+    if (events.empty())
+    {
+        TOUCH_TRACE_PRINTF("TouchTrace：没有可回放的事件\n");
+        return false;
+    }
+    latencies.assign(events.size(), 0);
+    nextEvent = 0;
+    startMs = nowMs;
+    state = State::REPLAYING;
+    TOUCH_TRACE_PRINTF("TouchTrace：开始回放 %u 个事件 (%lu ms)\n", (unsigned)events.size(),
+                       (unsigned long)events.back().timeMs);
+    return true;
+}
+
+bool TouchTrace::nextDue(uint32_t nowMs, uint16_t &x, uint16_t &y)
+{
+    if (state != State::REPLAYING || nextEvent >= events.size())
+    {
+        return false;
+    }
+    const Event &event = events[nextEvent];
+    if (nowMs - startMs < event.timeMs)
+    {
+        return false; // 还没到时间
+    }
+    x = event.x;
+    y = event.y;
+    return true;
+}
+
+void TouchTrace::eventHandled(uint32_t latencyUs)
+{
+    if (state != State::REPLAYING || nextEvent >= events.size())
+    {
+        return;
+    }
+    latencies[nextEvent++] = latencyUs;
+    if (nextEvent == events.size())
+    {
+        state = State::IDLE;
+        printReport();
+    }
+}
+
+uint32_t TouchTrace::msUntilNextEvent(uint32_t nowMs) const
+{
+    if (state != State::REPLAYING || nextEvent >= events.size())
+    {
+        return UINT32_MAX;
+    }
+    uint32_t elapsed = nowMs - startMs;
+    uint32_t due = events[nextEvent].timeMs;
+    return due > elapsed ? due - elapsed : 0;
+}
+
+void TouchTrace::stop()
+{
+    if (state == State::REPLAYING)
+    {
+        state = State::IDLE;
+        TOUCH_TRACE_PRINTF("TouchTrace：回放中止 (%u/%u)\n", (unsigned)nextEvent, (unsigned)events.size());
+        printReport();
+    }
+    state = State::IDLE;
+}
+
+void TouchTrace::printReport() const
+{
+    if (nextEvent == 0)
+    {
+        return;
+    }
+    std::vector<uint32_t> sorted(latencies.begin(), latencies.begin() + nextEvent);
+    uint64_t total = 0;
+    for (size_t i = 0; i < nextEvent; i++)
+    {
+        const Event &event = events[i];
+        TOUCH_TRACE_PRINTF("REPLAY,%u,%lu,%u,%u,%lu\n", (unsigned)i, (unsigned long)event.timeMs, event.x, event.y,
+                           (unsigned long)latencies[i]);
+        total += latencies[i];
+    }
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    TOUCH_TRACE_PRINTF("REPLAY_SUMMARY,events=%u,avg_us=%lu,p50_us=%lu,p95_us=%lu,max_us=%lu\n", (unsigned)n,
+                       (unsigned long)(total / n), (unsigned long)sorted[n / 2],
+                       (unsigned long)sorted[std::min(n - 1, n * 95 / 100)], (unsigned long)sorted[n - 1]);
+}
+
+// --- 文件格式 ---
+
+bool TouchTrace::parseLine(const char *line, Event &out)
+{
+    if (*line == '#' || *line == '\0' || *line == '\r' || *line == '\n')
+    {
+        return false;
+    }
+    char *end;
+    unsigned long t = strtoul(line, &end, 10);
+    if (*end != ',')
+    {
+        return false;
+    }
+    unsigned long x = strtoul(end + 1, &end, 10);
+    if (*end != ',')
+    {
+        return false;
+    }
+    unsigned long y = strtoul(end + 1, &end, 10);
+    if (*end != '\0' && *end != '\r' && *end != '\n')
+    {
+        return false;
+    }
+    out.timeMs = (uint32_t)t;
+    out.x = (uint16_t)x;
+    out.y = (uint16_t)y;
+    return true;
+}
+
+#ifdef ARDUINO
+
+bool TouchTrace::save(const char *path) const
+{
+    // 确保父目录存在
+    const char *slash = strrchr(path, '/');
+    if (slash && slash != path)
+    {
+        String dir = String(path).substring(0, slash - path);
+        if (!SD.exists(dir.c_str()))
+        {
+            SD.mkdir(dir.c_str());
+        }
+    }
+    File file = SD.open(path, FILE_WRITE);
+    if (!file)
+    {
+        TOUCH_TRACE_PRINTF("TouchTrace：无法写入 %s\n", path);
+        return false;
+    }
+    file.print("# NovelComicReader touch trace v1\n# time_ms,x,y\n");
+    char line[32];
+    for (const Event &event : events)
+    {
+        int len = snprintf(line, sizeof(line), "%lu,%u,%u\n", (unsigned long)event.timeMs, event.x, event.y);
+        file.write((const uint8_t *)line, len);
+    }
+    file.close();
+    TOUCH_TRACE_PRINTF("TouchTrace：已保存到 %s\n", path);
+    return true;
+}
+
+bool TouchTrace::load(const char *path)
+{
+    File file = SD.open(path, FILE_READ);
+    if (!file)
+    {
+        TOUCH_TRACE_PRINTF("TouchTrace：无法打开 %s\n", path);
+        return false;
+    }
+    events.clear();
+    char line[64];
+    size_t length = 0;
+    bool tooLong = false; // 过长的行 (注释) 直接跳过
+    Event event;
+    while (file.available())
+    {
+        char c = file.read();
+        if (c == '\n')
+        {
+            line[length] = '\0';
+            if (!tooLong && parseLine(line, event) && events.size() < TOUCH_TRACE_MAX_EVENTS)
+            {
+                events.push_back(event);
+            }
+            length = 0;
+            tooLong = false;
+            continue;
+        }
+        if (length == sizeof(line) - 1)
+        {
+            tooLong = true;
+            continue;
+        }
+        line[length++] = c;
+    }
+    line[length] = '\0';
+    if (!tooLong && parseLine(line, event) && events.size() < TOUCH_TRACE_MAX_EVENTS)
+    {
+        events.push_back(event); // 最后一行没有换行符
+    }
+    file.close();
+    return !events.empty();
+}
+
+#else
+
+bool TouchTrace::save(const char *path) const
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        TOUCH_TRACE_PRINTF("TouchTrace：无法写入 %s\n", path);
+        return false;
+    }
+    fputs("# NovelComicReader touch trace v1\n# time_ms,x,y\n", file);
+    for (const Event &event : events)
+    {
+        fprintf(file, "%lu,%u,%u\n", (unsigned long)event.timeMs, event.x, event.y);
+    }
+    fclose(file);
+    return true;
+}
+
+bool TouchTrace::load(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        TOUCH_TRACE_PRINTF("TouchTrace：无法打开 %s\n", path);
+        return false;
+    }
+    events.clear();
+    char line[64];
+    Event event;
+    while (fgets(line, sizeof(line), file))
+    {
+        if (parseLine(line, event) && events.size() < TOUCH_TRACE_MAX_EVENTS)
+        {
+            events.push_back(event);
+        }
+    }
+    fclose(file);
+    return !events.empty();
+}
+
+#endif
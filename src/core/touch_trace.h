@@ -0,0 +1,131 @@
+#ifndef TOUCH_TRACE_H // 防止头文件被重复包含
+#define TOUCH_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../config/config.h" // TOUCH_TRACE_* 常量
+
+/**
+ * @brief 触摸轨迹录制和回放，用于在相同的阅读过程上比较不同固件的端到端延迟。
+ *  - 录制：Touch::getPoint() 读到的每个触摸点连同时间戳 (相对录制开始) 记录在内存中，停止时保存为文本文件
+ *    (每行 "时间ms,x,y")。
+ *  - 回放：按原来的时间间隔把事件交给主循环，主循环把它当作真实触摸传给 Page::handleTouch()，
+ *    并测量从注入到本轮 handleTouch() + handleLoop() 返回 (页面绘制都在主循环中同步完成，即最后一个像素推送完) 的时间。
+ *    回放结束后按 "REPLAY,..." 行输出每个事件的延迟和汇总 (平均、p50、p95、最大)。
+ * 不依赖 Router 和屏幕：录制/回放开始时由调用方导航到起始页面。
+ * 文件读写在设备上使用 SD 卡，在主机上 (未定义 ARDUINO) 使用 stdio，
+ * 主机端回放 (tools/host_bench) 用同一份代码驱动排版模型。
+ * 线程安全：只在主循环中使用。
+ */
+class TouchTrace
+{
+public:
+    // 一个触摸事件
+    struct Event
+    {
+        uint32_t timeMs; // 相对录制开始的时间
+        uint16_t x;
+        uint16_t y;
+    };
+
+    enum class State : uint8_t
+    {
+        IDLE,
+        RECORDING,
+        REPLAYING
+    };
+
+private:
+    static TouchTrace *instance;
+    State state;
+    std::vector<Event> events;
+    std::vector<uint32_t> latencies; // 回放时每个事件的延迟 (微秒)，与 events 一一对应
+    uint32_t startMs;                // 录制/回放开始的时间
+    size_t nextEvent;                // 回放中下一个要注入的事件
+    bool overflowReported;           // 录制超过 TOUCH_TRACE_MAX_EVENTS 时只提示一次
+
+    TouchTrace();
+
+public:
+    TouchTrace(const TouchTrace &) = delete;
+    TouchTrace &operator=(const TouchTrace &) = delete;
+
+    static TouchTrace &getInstance();
+
+    State getState() const { return state; }
+    bool isReplaying() const { return state == State::REPLAYING; }
+    const std::vector<Event> &getEvents() const { return events; }
+
+    // --- 录制 ---
+
+    /**
+     * @brief 清空已有事件并开始录制。
+     * @param nowMs 当前时间 (millis())。
+     */
+    void startRecording(uint32_t nowMs);
+
+    /**
+     * @brief 记录一个触摸点 (不在录制中时忽略)。由 Touch::getPoint() 调用。
+     */
+    void record(uint16_t x, uint16_t y, uint32_t nowMs);
+
+    /**
+     * @brief 停止录制并把事件保存到文件。
+     * @return 保存成功返回 true。
+     */
+    bool stopRecording(const char *path);
+
+    // --- 回放 ---
+
+    /**
+     * @brief 从文件加载事件并开始回放。
+     * @param nowMs 当前时间 (millis())，事件时间相对于它。
+     * @return 文件不存在、格式错误或为空时返回 false。
+     */
+    bool startReplay(const char *path, uint32_t nowMs);
+
+    /**
+     * @brief 开始回放内存中已有的事件 (例如刚录制完的，或主机端生成的)。
+     */
+    bool startReplay(uint32_t nowMs);
+
+    /**
+     * @brief 取出下一个到期的事件。主循环每轮调用一次 (取代 Touch::getPoint())。
+     * @return 有事件到期时返回 true 并填写坐标；调用方处理完后必须调用 eventHandled()。
+     */
+    bool nextDue(uint32_t nowMs, uint16_t &x, uint16_t &y);
+
+    /**
+     * @brief 报告上一个注入事件的处理时间；最后一个事件处理完后输出报告并结束回放。
+     * @param latencyUs 从注入到页面处理 (含绘制) 完成的微秒数。
+     */
+    void eventHandled(uint32_t latencyUs);
+
+    /**
+     * @brief 距离下一个事件到期的毫秒数 (主循环据此缩短休眠)；不在回放中时返回 UINT32_MAX。
+     */
+    uint32_t msUntilNextEvent(uint32_t nowMs) const;
+
+    /**
+     * @brief 中止录制或回放 (回放时输出已完成部分的报告)。
+     */
+    void stop();
+
+    /**
+     * @brief 输出回放结果："REPLAY,序号,时间ms,x,y,延迟us" 每个事件一行，最后一行为汇总。
+     */
+    void printReport() const;
+
+    // --- 文件格式 ---
+
+    bool save(const char *path) const;
+    bool load(const char *path);
+
+    /**
+     * @brief 解析一行 "时间ms,x,y" (以 # 开头的注释行和空行返回 false)。
+     */
+    static bool parseLine(const char *line, Event &out);
+};
+
+#endif // TOUCH_TRACE_H
@@ -0,0 +1,99 @@
+#include "trace.h" // 包含 Trace 类的头文件
+
+// 初始化静态单例实例指针
+Trace *Trace::instance = nullptr;
+
+Trace::Trace() : writeIndex(0), paused(false)
+{
+    memset(events, 0, sizeof(events));
+}
+
+Trace &Trace::getInstance()
+{
+    if (!instance)
+    {
+        instance = new Trace();
+    }
+    return *instance;
+}
+
+// 记录一个区间 (任意核心)
+void Trace::record(TraceName name, uint32_t startUs, uint32_t durationUs)
+{
+    if (paused.load())
+    {
+        return;
+    }
+    uint32_t slot = writeIndex.fetch_add(1) % TRACE_BUFFER_SIZE;
+    Event &event = events[slot];
+    event.startUs = startUs;
+    event.durationUs = durationUs;
+    event.name = (uint8_t)name;
+    event.core = (uint8_t)xPortGetCoreID();
+}
+
+void Trace::clear()
+{
+    paused.store(true);
+    writeIndex.store(0);
+    paused.store(false);
+}
+
+const char *Trace::nameOf(TraceName name)
+{
+    switch (name)
+    {
+    case TraceName::ROUTER_NAVIGATE:
+        return "router_navigate";
+    case TraceName::FONT_GET_BITMAP:
+        return "font_get_bitmap";
+    case TraceName::FONT_SD_LOAD:
+        return "font_sd_load";
+    case TraceName::DISPLAY_DRAW_TEXT:
+        return "display_draw_text";
+    case TraceName::TEXT_DRAW_CONTENT:
+        return "text_draw_content";
+    case TraceName::TEXT_PREFETCH:
+        return "text_prefetch";
+    case TraceName::COMIC_DRAW_CONTENT:
+        return "comic_draw_content";
+    case TraceName::COMIC_DRAW_NEW_AREA:
+        return "comic_draw_new_area";
+    case TraceName::COMIC_PAGE_DECODE:
+        return "comic_page_decode";
+    case TraceName::COMIC_THUMBNAIL:
+        return "comic_thumbnail";
+    case TraceName::SD_OPEN:
+        return "sd_open";
+    case TraceName::SD_READ:
+        return "sd_read";
+    case TraceName::COMPOSE_FRAME:
+        return "compose_frame";
+    default:
+        return "?";
+    }
+}
+
+// 以 Chrome trace_event JSON 格式输出 ("X" 完整事件，pid 0，tid 为核心号)
+void Trace::dumpChromeJson()
+{
+    paused.store(true); // 导出期间不再写入，避免覆盖正在输出的记录
+    uint32_t total = writeIndex.load();
+    uint32_t count = total < TRACE_BUFFER_SIZE ? total : TRACE_BUFFER_SIZE;
+    uint32_t first = total - count;
+
+    Serial.printf("Trace：%lu 个区间 (共记录 %lu 个，缓冲区 %d)，复制下面的 JSON 到 chrome://tracing\n",
+                  (unsigned long)count, (unsigned long)total, TRACE_BUFFER_SIZE);
+    Serial.println("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    Serial.println("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"core0 (jobs_io)\"}},");
+    Serial.print("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"core1 (loop)\"}}");
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const Event &event = events[(first + i) % TRACE_BUFFER_SIZE];
+        Serial.printf(",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,\"pid\":0,\"tid\":%u}",
+                      nameOf((TraceName)event.name), (unsigned long)event.startUs,
+                      (unsigned long)event.durationUs, event.core);
+    }
+    Serial.println("\n]}");
+    paused.store(false);
+}
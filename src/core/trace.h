@@ -0,0 +1,107 @@
+#ifndef TRACE_H // 防止头文件被重复包含
+#define TRACE_H
+
+#include <Arduino.h>
+#include <atomic>             // 两个核心同时写入环形缓冲区
+#include "../config/config.h" // TRACE_ENABLED, TRACE_BUFFER_SIZE
+
+/**
+ * @brief 跟踪区间名称。环形缓冲区中只存 id，导出时再转换为字符串。
+ */
+enum class TraceName : uint8_t
+{
+    ROUTER_NAVIGATE,     // Router::navigateTo / goBack (含旧页面清理和新页面 display)
+    FONT_GET_BITMAP,     // Font::getCharacterBitmap
+    FONT_SD_LOAD,        // 字形缓存未命中时从 SD 卡加载
+    DISPLAY_DRAW_TEXT,   // Display::drawText (排版 + SPI 推送)
+    TEXT_DRAW_CONTENT,   // TextViewerPage::drawContent
+    TEXT_PREFETCH,       // 下一页字形预取任务
+    COMIC_DRAW_CONTENT,  // ComicViewerPage::drawContent
+    COMIC_DRAW_NEW_AREA, // ComicViewerPage::drawNewArea
+    COMIC_PAGE_DECODE,   // BmpScaler：把一张图片缩放解码为整屏页面或缩略图 (后台任务或直接绘制)
+    COMIC_THUMBNAIL,     // 在后台任务中缩小一张缩略图
+    SD_OPEN,             // SDCard::openFile
+    SD_READ,             // 大块 SD 读取 (字形、漫画条带、预取)
+    COMPOSE_FRAME,       // Compositor::compose (一帧中所有脏矩形的重绘)
+    COUNT
+};
+
+/**
+ * @brief 轻量级区间跟踪单例类。
+ * 每个区间记录 (名称 id, 开始时间, 持续时间, 核心) 到固定大小的环形缓冲区，新记录覆盖最旧的记录。
+ * 通过串口命令 "trace" 导出为 Chrome trace_event JSON (chrome://tracing 或 Perfetto 打开)，
+ * 可以看到一次翻页中 SD 读取、排版和 SPI 推送各占多少时间。
+ * 线程安全：record() 可在任意任务/核心中调用 (原子地分配槽位)；dump() 只在主循环中调用，
+ * 导出期间暂停记录。
+ * 在 config.h 中把 TRACE_ENABLED 设为 0 时，TRACE_SPAN 不产生任何代码。
+ */
+class Trace
+{
+public:
+    struct Event
+    {
+        uint32_t startUs;    // 开始时间 (micros)
+        uint32_t durationUs; // 持续时间
+        uint8_t name;        // TraceName
+        uint8_t core;        // 记录时所在核心
+    };
+
+private:
+    static Trace *instance;
+    Event events[TRACE_BUFFER_SIZE];
+    std::atomic<uint32_t> writeIndex; // 下一个写入位置 (单调递增，对缓冲区大小取模)
+    std::atomic<bool> paused;
+
+    Trace();
+
+public:
+    Trace(const Trace &) = delete;
+    Trace &operator=(const Trace &) = delete;
+
+    static Trace &getInstance();
+
+    /**
+     * @brief 记录一个已结束的区间。
+     */
+    void record(TraceName name, uint32_t startUs, uint32_t durationUs);
+
+    /**
+     * @brief 清空缓冲区。
+     */
+    void clear();
+
+    /**
+     * @brief 通过串口以 Chrome trace_event JSON 格式输出缓冲区中的所有区间 (按时间顺序)。
+     */
+    void dumpChromeJson();
+
+    static const char *nameOf(TraceName name);
+};
+
+/**
+ * @brief 作用域区间：构造时记录开始时间，析构时写入环形缓冲区。请使用 TRACE_SPAN 宏。
+ */
+class TraceSpan
+{
+public:
+    explicit TraceSpan(TraceName name) : name(name), startUs(micros()) {}
+    ~TraceSpan() { Trace::getInstance().record(name, startUs, micros() - startUs); }
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    TraceName name;
+    uint32_t startUs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if TRACE_ENABLED
+// 跟踪当前作用域，例如 TRACE_SPAN(TraceName::FONT_GET_BITMAP);
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) do { } while (0)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,82 @@
+#ifndef UTF8_H // 防止头文件被重复包含
+#define UTF8_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 无状态的 UTF-8 辅助函数 (只有头文件，不依赖 Arduino)。
+ * Font、TextLayout 和文本预取共用这里的首字节规则，主机端基准测试 (tools/host_bench) 也直接编译它。
+ */
+class Utf8
+{
+public:
+    /**
+     * @brief 根据首字节判断一个字符占用的字节数。
+     * @return 1~4。无效的首字节 (包括孤立的后续字节) 返回 1，当作单字节字符处理以避免死循环。
+     */
+    static size_t sequenceLength(uint8_t first)
+    {
+        if (first < 0x80)
+            return 1;
+        if ((first & 0xE0) == 0xC0)
+            return 2;
+        if ((first & 0xF0) == 0xE0)
+            return 3;
+        if ((first & 0xF8) == 0xF0)
+            return 4;
+        return 1;
+    }
+
+    /**
+     * @brief 计算以 0 结尾的 UTF-8 字符串中的字符数 (不计后续字节)。
+     */
+    static size_t length(const char *str)
+    {
+        size_t len = 0;
+        for (; *str; str++)
+        {
+            if ((*str & 0xC0) != 0x80)
+            {
+                len++;
+            }
+        }
+        return len;
+    }
+
+    /**
+     * @brief 把一个 UTF-8 字符转换为 Unicode 码点。
+     * @return 码点；输入为空或序列无效时返回 0。
+     */
+    static uint32_t decode(const char *s)
+    {
+        if (!s || *s == '\0')
+        {
+            return 0;
+        }
+        uint8_t c1 = (uint8_t)s[0];
+        if (c1 < 0x80)
+        {
+            return c1;
+        }
+        size_t len = sequenceLength(c1);
+        if (len == 1)
+        {
+            return 0; // 无效的起始字节
+        }
+        for (size_t i = 1; i < len; i++)
+        {
+            if ((s[i] & 0xC0) != 0x80)
+            {
+                return 0; // 后续字节不是 10xxxxxx
+            }
+        }
+        if (len == 2)
+            return ((c1 & 0x1F) << 6) | (s[1] & 0x3F);
+        if (len == 3)
+            return ((c1 & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+        return ((uint32_t)(c1 & 0x07) << 18) | ((s[1] & 0x3F) << 12) | ((s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+    }
+};
+
+#endif // UTF8_H
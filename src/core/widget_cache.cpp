@@ -0,0 +1,189 @@
+#include "widget_cache.h"
+#include "display.h"   // 离屏绘制 (Display::beginOffscreen) 和推送
+#include "mem_stats.h" // WIDGET_CACHE 标签
+
+WidgetCache *WidgetCache::instance = nullptr;
+
+WidgetCache::WidgetCache() : usedBytes(0), hits(0), misses(0), bypassed(0)
+{
+    mutex = xSemaphoreCreateMutex(); // 收缩回调可能在工作线程中调用
+    budgetId = MemoryBudget::getInstance().registerCache("widgets", MemoryBudget::PRIORITY_LOW,
+                                                         WIDGET_CACHE_MIN_BYTES, WIDGET_CACHE_PREFERRED_BYTES,
+                                                         onMemoryPressure, this);
+}
+
+WidgetCache &WidgetCache::getInstance()
+{
+    if (!instance)
+    {
+        instance = new WidgetCache();
+    }
+    return *instance;
+}
+
+// 淘汰 LRU 链表尾部的条目，直到占用不超过 targetBytes
+size_t WidgetCache::evictTo(size_t targetBytes)
+{
+    size_t freed = 0;
+    while (usedBytes > targetBytes && !entries.empty())
+    {
+        Entry &victim = entries.back();
+        free(victim.pixels);
+        MemStats::getInstance().recordFree(MemTag::WIDGET_CACHE, victim.bytes);
+        usedBytes -= victim.bytes;
+        freed += victim.bytes;
+        entries.pop_back();
+    }
+    MemoryBudget::getInstance().reportUsage(budgetId, usedBytes);
+    return freed;
+}
+
+// 内存压力回调：丢弃最久未使用的条目 (下次绘制时重新渲染)
+size_t WidgetCache::onMemoryPressure(void *ctx, size_t bytesToFree)
+{
+    WidgetCache *self = static_cast<WidgetCache *>(ctx);
+    xSemaphoreTake(self->mutex, portMAX_DELAY);
+    size_t target = self->usedBytes > bytesToFree ? self->usedBytes - bytesToFree : 0;
+    size_t freed = self->evictTo(target);
+    xSemaphoreGive(self->mutex);
+    return freed;
+}
+
+// 在离屏画布上绘制控件并取出像素
+uint16_t *WidgetCache::renderEntry(int16_t w, int16_t h, uint16_t background, RenderCallback render, void *ctx, size_t bytes)
+{
+    uint16_t *pixels = (uint16_t *)MemoryBudget::getInstance().allocate(bytes, budgetId);
+    if (!pixels)
+    {
+        return nullptr;
+    }
+    Display &display = Display::getInstance();
+    DisplayBackend *canvas = display.getTFT()->createCanvas(w, h);
+    if (!canvas)
+    {
+        free(pixels);
+        return nullptr;
+    }
+
+    // 画布使用与屏幕相同的字节序设置，自定义字体的 pushImage 结果才与直接绘制一致
+    canvas->setSwapBytes(display.getTFT()->getSwapBytes());
+    canvas->fillScreen(background);
+    if (!display.beginOffscreen(canvas))
+    {
+        delete canvas;
+        free(pixels);
+        return nullptr;
+    }
+    render(ctx, 0, 0);
+    display.endOffscreen();
+    canvas->readRect(0, 0, w, h, pixels);
+    delete canvas;
+    return pixels;
+}
+
+// 推送缓存的像素 (readRect 得到的是逻辑颜色，需要 swapBytes)
+void WidgetCache::push(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels)
+{
+    DisplayBackend *tft = Display::getInstance().getTFT();
+    bool swap = tft->getSwapBytes();
+    tft->setSwapBytes(true);
+    tft->pushImage(x, y, w, h, pixels);
+    tft->setSwapBytes(swap);
+}
+
+void WidgetCache::draw(const char *widget, uint64_t state, const char *label, int16_t x, int16_t y, int16_t w, int16_t h,
+                       RenderCallback render, void *ctx, uint16_t background)
+{
+    if (w <= 0 || h <= 0)
+    {
+        return;
+    }
+
+    char suffix[48];
+    snprintf(suffix, sizeof(suffix), "|%llx|%dx%d|%x", (unsigned long long)state, w, h, background);
+    std::string key = widget;
+    key += '|';
+    key += label ? label : "";
+    key += suffix;
+
+    // 1. 命中：移动到 LRU 前端并推送
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+    {
+        if (it->key == key)
+        {
+            entries.splice(entries.begin(), entries, it);
+            hits++;
+            push(x, y, w, h, it->pixels);
+            xSemaphoreGive(mutex);
+            return;
+        }
+    }
+
+    // 2. 未命中：先为新条目腾出预算，再渲染
+    size_t bytes = (size_t)w * h * sizeof(uint16_t);
+    size_t budget = MemoryBudget::getInstance().budgetOf(budgetId);
+    bool cacheable = bytes <= WIDGET_CACHE_MAX_ENTRY_BYTES && bytes <= budget;
+    if (cacheable)
+    {
+        evictTo(budget - bytes);
+    }
+    xSemaphoreGive(mutex);
+
+    uint16_t *pixels = cacheable ? renderEntry(w, h, background, render, ctx, bytes) : nullptr;
+    if (!pixels)
+    {
+        // 太大或内存不足：直接画到屏幕上
+        bypassed++;
+        render(ctx, x, y);
+        return;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    misses++;
+    entries.push_front({key, w, h, pixels, bytes});
+    usedBytes += bytes;
+    MemStats::getInstance().recordAlloc(MemTag::WIDGET_CACHE, bytes);
+    MemoryBudget::getInstance().reportUsage(budgetId, usedBytes);
+    push(x, y, w, h, pixels);
+    xSemaphoreGive(mutex);
+}
+
+// 按钮的绘制回调
+void WidgetCache::renderButton(void *ctx, int16_t x, int16_t y)
+{
+    const ButtonStyle &style = *static_cast<const ButtonStyle *>(ctx);
+    Display &display = Display::getInstance();
+    display.getTFT()->fillRoundRect(x, y, style.width, style.height, 5, style.fill);
+    if (style.outline != style.fill)
+    {
+        display.getTFT()->drawRoundRect(x, y, style.width, style.height, 5, style.outline);
+    }
+    display.drawCenteredText(style.label, x, y, style.width, style.height, style.textSize, style.useCustomFont);
+}
+
+void WidgetCache::drawButton(const char *label, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t fill, uint16_t outline,
+                             uint8_t textSize, bool useCustomFont, uint16_t background)
+{
+    ButtonStyle style = {label, w, h, fill, outline, textSize, useCustomFont};
+    uint64_t state = fill | ((uint64_t)outline << 16) | ((uint64_t)textSize << 32) | ((uint64_t)useCustomFont << 40);
+    draw("button", state, label, x, y, w, h, renderButton, &style, background);
+}
+
+void WidgetCache::clear()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    evictTo(0);
+    xSemaphoreGive(mutex);
+}
+
+void WidgetCache::printStats()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    size_t count = entries.size();
+    size_t used = usedBytes;
+    xSemaphoreGive(mutex);
+    Serial.printf("WidgetCache：%u 个条目，%u / %u 字节；命中 %lu，渲染 %lu，直接绘制 %lu\n", (unsigned)count,
+                  (unsigned)used, (unsigned)MemoryBudget::getInstance().budgetOf(budgetId), (unsigned long)hits,
+                  (unsigned long)misses, (unsigned long)bypassed);
+}
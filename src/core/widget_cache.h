@@ -0,0 +1,114 @@
+#ifndef WIDGET_CACHE_H // 防止头文件被重复包含
+#define WIDGET_CACHE_H
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>            // 颜色常量 (TFT_BLACK 等)
+#include <list>                  // LRU 顺序
+#include <string>                // 条目的键
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>     // 互斥锁 (收缩回调可能在其他任务中调用)
+#include "memory_budget.h"       // 预算和 PSRAM 优先的分配
+#include "../config/config.h"    // WIDGET_CACHE_* 常量
+
+/**
+ * @brief 控件精灵缓存单例类。
+ * 按钮、文件图标、菜单方块等控件每次重绘都要用图元 (圆角矩形、直线、字符) 重新画一遍，
+ * 每个图元都是一次或多次 SPI 窗口设置。缓存把每个 (控件, 状态, 标签, 尺寸) 第一次绘制时渲染到
+ * 离屏画布 (DisplayBackend::createCanvas()) 中，取出 RGB565 像素保存 (有 PSRAM 时在 PSRAM 中)，
+ * 之后只需一次 pushImage。
+ * 颜色属于状态的一部分，所以颜色方案改变后自然生成新的条目；clear() 用于整体失效 (例如更换主题)。
+ * 内存：在 MemoryBudget 中注册为 "widgets" (PRIORITY_LOW，丢弃后只是重新渲染)，超出预算时按 LRU 淘汰。
+ * 线程安全：draw() 只能在主循环任务中调用 (与 Display 相同)；收缩回调可在任意任务中调用，条目列表由互斥锁保护。
+ */
+class WidgetCache
+{
+public:
+    /**
+     * @brief 控件绘制回调：通过 Display 绘制控件，左上角位于 (x, y)。
+     * 缓存未命中时在离屏画布上以 (0, 0) 调用；无法缓存时直接在屏幕上以控件位置调用。
+     */
+    using RenderCallback = void (*)(void *ctx, int16_t x, int16_t y);
+
+private:
+    struct Entry
+    {
+        std::string key;  // 控件|状态|标签|宽x高|背景色
+        int16_t width;
+        int16_t height;
+        uint16_t *pixels; // RGB565 (逻辑颜色，按 setSwapBytes(true) 推送)
+        size_t bytes;
+    };
+
+    // drawButton() 传给绘制回调的参数
+    struct ButtonStyle
+    {
+        const char *label;
+        int16_t width;
+        int16_t height;
+        uint16_t fill;
+        uint16_t outline;
+        uint8_t textSize;
+        bool useCustomFont;
+    };
+
+    static WidgetCache *instance;
+    std::list<Entry> entries;          // 前端为最近使用
+    size_t usedBytes;
+    MemoryBudget::ClientId budgetId;
+    SemaphoreHandle_t mutex;
+
+    // 统计信息
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t bypassed; // 太大或内存不足，直接绘制
+
+    WidgetCache();
+
+    // 淘汰最久未使用的条目，直到占用不超过 targetBytes (调用时必须持有 mutex)，返回释放的字节数
+    size_t evictTo(size_t targetBytes);
+
+    // 渲染一个新条目；失败返回 nullptr (调用时不持有 mutex)
+    uint16_t *renderEntry(int16_t w, int16_t h, uint16_t background, RenderCallback render, void *ctx, size_t bytes);
+
+    static void push(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels);
+    static size_t onMemoryPressure(void *ctx, size_t bytesToFree);
+    static void renderButton(void *ctx, int16_t x, int16_t y);
+
+public:
+    WidgetCache(const WidgetCache &) = delete;
+    WidgetCache &operator=(const WidgetCache &) = delete;
+
+    static WidgetCache &getInstance();
+
+    /**
+     * @brief 在 (x, y) 绘制一个 w x h 的控件：命中时直接推送缓存的像素，否则先渲染并缓存。
+     * @param widget 控件种类 (例如 "button"、"folder")。
+     * @param state 影响外观的状态 (颜色、高亮等打包成整数)。
+     * @param label 标签文字 (没有时传 nullptr)。
+     * @param render 绘制回调，只能使用 ctx 和坐标绘制，结果必须只由键决定。
+     * @param background 控件下面的背景色 (圆角等未覆盖的像素)。
+     */
+    void draw(const char *widget, uint64_t state, const char *label, int16_t x, int16_t y, int16_t w, int16_t h,
+              RenderCallback render, void *ctx, uint16_t background = TFT_BLACK);
+
+    /**
+     * @brief 绘制圆角按钮 (填充色 + 边框 + 居中标签)。
+     * @param outline 边框颜色；与 fill 相同时不画边框。
+     * @param textSize 标签字号 (Display::drawCenteredText 的 size)。
+     * @param useCustomFont 标签是否使用自定义字体 (中文标签)。
+     */
+    void drawButton(const char *label, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t fill, uint16_t outline,
+                    uint8_t textSize, bool useCustomFont, uint16_t background = TFT_BLACK);
+
+    /**
+     * @brief 清空缓存 (颜色方案或字体改变后调用)。
+     */
+    void clear();
+
+    /**
+     * @brief 通过串口输出统计信息 (条目数、占用、命中率)。
+     */
+    void printStats();
+};
+
+#endif // WIDGET_CACHE_H
@@ -0,0 +1,570 @@
+#include <Arduino.h>
+#include <SD.h>         // SD.cardSize() for the results header
+#include <algorithm>    // std::min, std::max
+
+#include "benchmark_page.h"
+#include "text_viewer_page.h"       // TextViewerPage::textAreaWidth() for the layout benchmark
+#include "../core/font.h"
+#include "../core/sdcard.h"
+#include "../core/memory_budget.h"  // Read buffers come from the transient reserve
+#include "../core/text_layout.h"    // The line breaker used by the text viewer
+#include "../core/pixel_convert.h"  // Comic row conversion kernels
+#include "../core/sd_read_profile.h" // SD read buffers live in DMA-capable internal RAM
+
+// Glyph size used by the text viewer (TEXT_FONT_SIZE 1 -> 16px)
+static const uint16_t BENCH_GLYPH_SIZE = 16;
+// Largest SD block size; the read buffer is sized for it
+static const size_t BENCH_SD_BLOCK_SIZES[] = {512, 4096, 16384};
+static const size_t BENCH_SD_MAX_BLOCK = 16384;
+// Text used for the layout benchmark when the reference book is missing
+static const char BENCH_LAYOUT_SAMPLE[] =
+    "第一章 雨夜\n"
+    "窗外的雨下了一整夜，街道上的灯光在水洼里摇晃。He opened the old notebook and read the first line again.\n"
+    "“你确定要这样做吗？”她问。这个问题他已经想了很久，answer 却始终没有出现。\n";
+
+// Initialize the static singleton pointer
+BenchmarkRunner *BenchmarkRunner::instance = nullptr;
+
+BenchmarkRunner::BenchmarkRunner()
+    : timer(Scheduler::INVALID_TASK), step(STEP_DONE), running(false), revisionCounter(0),
+      turnsDone(0), turnTotalUs(0), turnMaxUs(0)
+{
+}
+
+BenchmarkRunner &BenchmarkRunner::getInstance()
+{
+    if (!instance)
+    {
+        instance = new BenchmarkRunner();
+    }
+    return *instance;
+}
+
+void BenchmarkRunner::start()
+{
+    if (running)
+    {
+        return;
+    }
+    resultList.clear();
+    step = STEP_SD;
+    turnsDone = 0;
+    turnTotalUs = 0;
+    turnMaxUs = 0;
+    running = true;
+    revisionCounter++;
+    Serial.println("Benchmark: starting suite");
+    timer = Scheduler::getInstance().addTimer(BENCH_STEP_INTERVAL_MS, onStep, this, BENCH_STEP_INTERVAL_MS);
+}
+
+void BenchmarkRunner::onStep(void *ctx)
+{
+    static_cast<BenchmarkRunner *>(ctx)->runStep();
+}
+
+void BenchmarkRunner::addResult(const char *name, float value, const char *unit)
+{
+    Result result;
+    strncpy(result.name, name, sizeof(result.name) - 1);
+    result.name[sizeof(result.name) - 1] = '\0';
+    result.value = value;
+    result.unit = unit;
+    resultList.push_back(result);
+    revisionCounter++;
+    if (unit)
+    {
+        Serial.printf("Benchmark: %s = %.2f %s\n", name, value, unit);
+    }
+    else
+    {
+        Serial.printf("Benchmark: %s skipped\n", name);
+    }
+}
+
+// One step per timer tick, so the main loop (touch, timers, page redraws) keeps running in between
+void BenchmarkRunner::runStep()
+{
+    Router &router = Router::getInstance();
+    switch (step)
+    {
+    case STEP_SD:
+        benchSdRead();
+        step = STEP_FONT;
+        break;
+    case STEP_FONT:
+        benchFontLookup();
+        step = STEP_BLIT;
+        break;
+    case STEP_BLIT:
+        benchGlyphBlit();
+        step = STEP_LAYOUT;
+        break;
+    case STEP_LAYOUT:
+        benchTextLayout();
+        step = STEP_CONVERT;
+        break;
+    case STEP_CONVERT:
+        benchPixelConvert();
+        step = STEP_COMIC_OPEN;
+        break;
+    case STEP_COMIC_OPEN:
+        if (SDCard::getInstance().exists(BENCH_REFERENCE_COMIC))
+        {
+            uint32_t start = micros();
+            router.navigateTo("comic", new String(BENCH_REFERENCE_COMIC)); // Router::goBack deletes the parameter
+            router.composeFrame();                                          // Include the first paint, as loop() would
+            addResult("comic_open", (micros() - start) / 1000.0f, "ms");
+            step = STEP_COMIC_REDRAW;
+        }
+        else
+        {
+            addResult("comic_redraw", 0, nullptr);
+            step = STEP_BOOK_OPEN;
+        }
+        break;
+    case STEP_COMIC_REDRAW:
+        benchComicRedraw();
+        router.goBack();
+        step = STEP_BOOK_OPEN;
+        break;
+    case STEP_BOOK_OPEN:
+        if (SDCard::getInstance().exists(BENCH_REFERENCE_BOOK))
+        {
+            uint32_t start = micros();
+            router.navigateTo("text", new String(BENCH_REFERENCE_BOOK));
+            router.composeFrame();
+            addResult("book_open", (micros() - start) / 1000.0f, "ms");
+            step = STEP_PAGE_TURN;
+        }
+        else
+        {
+            addResult("page_turn", 0, nullptr);
+            step = STEP_DONE;
+        }
+        break;
+    case STEP_PAGE_TURN:
+        if (!pageTurn())
+        {
+            router.goBack();
+            step = STEP_DONE;
+        }
+        break;
+    case STEP_DONE:
+    default:
+        Scheduler::getInstance().cancel(timer);
+        timer = Scheduler::INVALID_TASK;
+        running = false;
+        revisionCounter++;
+        printResults();
+        break;
+    }
+}
+
+// Sequential and random reads of the reference book at each block size
+void BenchmarkRunner::benchSdRead()
+{
+    SDCard &sd = SDCard::getInstance();
+    if (!sd.exists(BENCH_REFERENCE_BOOK))
+    {
+        addResult("sd_read", 0, nullptr);
+        return;
+    }
+    uint8_t *buffer = static_cast<uint8_t *>(MemoryBudget::getInstance().acquireTransient(BENCH_SD_MAX_BLOCK, SdReadProfile::BUFFER_CAPS));
+    if (!buffer)
+    {
+        addResult("sd_read", 0, nullptr);
+        return;
+    }
+    File file = sd.openFile(BENCH_REFERENCE_BOOK);
+    size_t fileSize = file ? file.size() : 0;
+    char name[24];
+
+    for (size_t blockSize : BENCH_SD_BLOCK_SIZES)
+    {
+        if (fileSize < blockSize)
+        {
+            snprintf(name, sizeof(name), "sd_seq_%u", (unsigned)blockSize);
+            addResult(name, 0, nullptr); // Reference book too small for this block size
+            continue;
+        }
+
+        // Sequential: read from the start in blockSize chunks
+        size_t total = std::min((size_t)BENCH_SD_READ_BYTES, fileSize);
+        size_t done = 0;
+        file.seek(0);
+        uint32_t start = micros();
+        while (done + blockSize <= total)
+        {
+            size_t n = file.read(buffer, blockSize);
+            if (n == 0)
+            {
+                break;
+            }
+            done += n;
+        }
+        uint32_t elapsed = std::max<uint32_t>(micros() - start, 1);
+        snprintf(name, sizeof(name), "sd_seq_%u", (unsigned)blockSize);
+        addResult(name, done * 1000000.0f / 1024.0f / elapsed, "KB/s");
+
+        // Random: block-aligned offsets from a fixed-seed LCG, so every run reads the same blocks
+        uint32_t seed = 12345;
+        size_t blocks = fileSize / blockSize;
+        start = micros();
+        for (int i = 0; i < BENCH_SD_RANDOM_READS; i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            file.seek(((seed >> 8) % blocks) * blockSize);
+            file.read(buffer, blockSize);
+        }
+        elapsed = std::max<uint32_t>(micros() - start, 1);
+        snprintf(name, sizeof(name), "sd_rand_%u", (unsigned)blockSize);
+        addResult(name, BENCH_SD_RANDOM_READS * 1000000.0f / elapsed, "ops/s");
+    }
+    file.close();
+    MemoryBudget::getInstance().releaseTransient(buffer);
+}
+
+// Cache miss (SD load) and hit lookup time per glyph
+void BenchmarkRunner::benchFontLookup()
+{
+    Font &font = Font::getInstance();
+    const char *sample = BENCH_FONT_SAMPLE;
+    size_t offset = 0;
+    uint32_t missUs = 0;
+    uint32_t hitUs = 0;
+    int misses = 0;
+    while (true)
+    {
+        String character = Font::getNextCharacter(sample, offset);
+        if (character.length() == 0)
+        {
+            break;
+        }
+        Font::Guard guard; // Keep the prefetch worker from reloading the glyph between evict and lookup
+        font.evictCharacter(character.c_str(), BENCH_GLYPH_SIZE);
+        uint32_t start = micros();
+        bool loaded = font.getCharacterBitmap(character.c_str(), BENCH_GLYPH_SIZE) != nullptr;
+        missUs += micros() - start;
+        if (!loaded)
+        {
+            continue;
+        }
+        misses++;
+        start = micros();
+        for (int i = 0; i < BENCH_FONT_HIT_REPEAT; i++)
+        {
+            font.getCharacterBitmap(character.c_str(), BENCH_GLYPH_SIZE);
+        }
+        hitUs += micros() - start;
+    }
+    if (misses == 0)
+    {
+        addResult("font_lookup", 0, nullptr); // Font files missing on the card
+        return;
+    }
+    addResult("font_miss", (float)missUs / misses, "us");
+    addResult("font_hit", (float)hitUs / (misses * BENCH_FONT_HIT_REPEAT), "us");
+}
+
+// Cached custom-font glyphs drawn to the panel
+void BenchmarkRunner::benchGlyphBlit()
+{
+    Display &display = Display::getInstance();
+    const char *sample = BENCH_FONT_SAMPLE;
+    {
+        // The font benchmark has just cached the sample; skip if it could not load any glyph
+        size_t offset = 0;
+        String first = Font::getNextCharacter(sample, offset);
+        Font::Guard guard;
+        if (!Font::getInstance().getCharacterBitmap(first.c_str(), BENCH_GLYPH_SIZE))
+        {
+            addResult("glyph_blit", 0, nullptr);
+            return;
+        }
+    }
+
+    const uint16_t top = 32; // Below the page header
+    const uint16_t cols = SCREEN_WIDTH / BENCH_GLYPH_SIZE;
+    const uint16_t rows = (SCREEN_HEIGHT - top) / BENCH_GLYPH_SIZE;
+    size_t length = strlen(sample);
+    size_t offset = 0;
+    uint32_t start = micros();
+    for (int i = 0; i < BENCH_BLIT_GLYPHS; i++)
+    {
+        if (offset >= length)
+        {
+            offset = 0;
+        }
+        String character = Font::getNextCharacter(sample, offset);
+        uint16_t x = (i % cols) * BENCH_GLYPH_SIZE;
+        uint16_t y = top + ((i / cols) % rows) * BENCH_GLYPH_SIZE;
+        display.drawCharacter(character.c_str(), x, y, 1, true);
+    }
+    uint32_t elapsed = std::max<uint32_t>(micros() - start, 1);
+    addResult("glyph_blit", BENCH_BLIT_GLYPHS * 1000000.0f / elapsed, "glyph/s");
+}
+
+// TextLayout throughput over the start of the reference book (or the built-in sample)
+void BenchmarkRunner::benchTextLayout()
+{
+    char *buffer = static_cast<char *>(MemoryBudget::getInstance().acquireTransient(BENCH_LAYOUT_BYTES));
+    if (!buffer)
+    {
+        addResult("text_layout", 0, nullptr);
+        return;
+    }
+    size_t length = 0;
+    if (SDCard::getInstance().exists(BENCH_REFERENCE_BOOK))
+    {
+        File file = SDCard::getInstance().openFile(BENCH_REFERENCE_BOOK);
+        if (file)
+        {
+            length = file.read(reinterpret_cast<uint8_t *>(buffer), BENCH_LAYOUT_BYTES);
+            file.close();
+        }
+    }
+    if (length == 0)
+    {
+        // Whole copies of the sample only, so no character is cut in half
+        const size_t sampleLength = sizeof(BENCH_LAYOUT_SAMPLE) - 1;
+        while (length + sampleLength <= BENCH_LAYOUT_BYTES)
+        {
+            memcpy(buffer + length, BENCH_LAYOUT_SAMPLE, sampleLength);
+            length += sampleLength;
+        }
+    }
+
+    uint32_t lines = 0;
+    TextLayout layout(TextViewerPage::textAreaWidth(), BENCH_GLYPH_SIZE,
+                      [](void *ctx, const String &, size_t, TextLayout::LineEnd) { (*static_cast<uint32_t *>(ctx))++; },
+                      &lines);
+    uint32_t start = micros();
+    for (int pass = 0; pass < BENCH_LAYOUT_PASSES; pass++)
+    {
+        layout.reset(0);
+        for (size_t i = 0; i < length; i++)
+        {
+            char c = buffer[i];
+            if (c == '\n' || c == '\r')
+            {
+                if (c == '\r' && i + 1 < length && buffer[i + 1] == '\n')
+                {
+                    i++; // CRLF
+                }
+                layout.endParagraph(i + 1);
+                continue;
+            }
+            layout.feed(c);
+        }
+        layout.finish();
+    }
+    uint32_t elapsed = std::max<uint32_t>(micros() - start, 1);
+    MemoryBudget::getInstance().releaseTransient(buffer);
+    // Bytes per microsecond == MB/s
+    addResult("text_layout", (float)length * BENCH_LAYOUT_PASSES / elapsed, "MB/s");
+    addResult("layout_lines", (float)lines / BENCH_LAYOUT_PASSES, "lines");
+}
+
+// Converts BENCH_CONVERT_ROWS full-width BGR888 rows with one kernel; returns Mpix/s
+template <void (*Convert)(const uint8_t *, uint16_t *, size_t)>
+static float convertRate(const uint8_t *rows, size_t rowSize, uint16_t *pixels)
+{
+    uint32_t start = micros();
+    for (int row = 0; row < BENCH_CONVERT_ROWS; row++)
+    {
+        Convert(rows + (row & 7) * rowSize, pixels, PANEL.width);
+    }
+    uint32_t elapsed = std::max<uint32_t>(micros() - start, 1);
+    // Pixels per microsecond == Mpix/s
+    return (float)BENCH_CONVERT_ROWS * PANEL.width / elapsed;
+}
+
+// BGR888 -> RGB565 row conversion: scalar reference, word kernel and panel byte order.
+// The rows start 2 bytes past a word boundary, as they do in the comic viewer's sector-aligned reads
+// of a BMP with the usual 54-byte header.
+void BenchmarkRunner::benchPixelConvert()
+{
+    const size_t rowSize = (PANEL.width * 3 + 3) & ~3;
+    const size_t bytes = 8 * rowSize + 4 + PANEL.width * sizeof(uint16_t);
+    uint8_t *buffer = static_cast<uint8_t *>(MemoryBudget::getInstance().acquireTransient(bytes));
+    if (!buffer)
+    {
+        addResult("convert", 0, nullptr);
+        return;
+    }
+    uint8_t *rows = buffer + 2;
+    uint16_t *pixels = reinterpret_cast<uint16_t *>(buffer + 8 * rowSize + 4);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < 8 * rowSize; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        rows[i] = seed >> 16;
+    }
+    addResult("convert_scalar", convertRate<PixelConvert::bgr888RowReference<false>>(rows, rowSize, pixels), "Mpix/s");
+    addResult("convert_words", convertRate<PixelConvert::bgr888RowToRgb565>(rows, rowSize, pixels), "Mpix/s");
+    addResult("convert_panel", convertRate<PixelConvert::bgr888RowToPanel565>(rows, rowSize, pixels), "Mpix/s");
+    MemoryBudget::getInstance().releaseTransient(buffer);
+}
+
+// Full-screen redraws of the reference comic at its first screen
+void BenchmarkRunner::benchComicRedraw()
+{
+    Page *page = Router::getInstance().getCurrentPage();
+    if (!page)
+    {
+        addResult("comic_redraw", 0, nullptr);
+        return;
+    }
+    uint32_t start = micros();
+    for (int i = 0; i < BENCH_COMIC_REDRAWS; i++)
+    {
+        page->display();
+    }
+    uint32_t elapsed = std::max<uint32_t>(micros() - start, 1);
+    addResult("comic_redraw", BENCH_COMIC_REDRAWS * 1000000.0f / elapsed, "fps");
+}
+
+// One scripted page turn: a tap in the lower half of the text area scrolls forward
+bool BenchmarkRunner::pageTurn()
+{
+    Page *page = Router::getInstance().getCurrentPage();
+    if (page && turnsDone < BENCH_PAGE_TURNS)
+    {
+        uint32_t start = micros();
+        page->handleTouch(SCREEN_WIDTH / 2, SCREEN_HEIGHT - 10);
+        Router::getInstance().composeFrame(); // The page repaints at the end of the frame
+        uint32_t elapsed = micros() - start;
+        turnTotalUs += elapsed;
+        turnMaxUs = std::max(turnMaxUs, elapsed);
+        turnsDone++;
+        return true;
+    }
+    if (turnsDone > 0)
+    {
+        addResult("page_turn_avg", turnTotalUs / 1000.0f / turnsDone, "ms");
+        addResult("page_turn_max", turnMaxUs / 1000.0f, "ms");
+    }
+    return false;
+}
+
+void BenchmarkRunner::printResults() const
+{
+    // One CSV line per value so runs can be collected from the log and diffed
+    Serial.printf("BENCH,build,%s %s\n", __DATE__, __TIME__);
+    Serial.printf("BENCH,sd_card_mb,%lu\n", (unsigned long)(SD.cardSize() / (1024 * 1024)));
+    for (const Result &result : resultList)
+    {
+        if (result.unit)
+        {
+            Serial.printf("BENCH,%s,%.3f,%s\n", result.name, result.value, result.unit);
+        }
+        else
+        {
+            Serial.printf("BENCH,%s,skipped\n", result.name);
+        }
+    }
+}
+
+
+// --- BenchmarkPage ---
+
+BenchmarkPage::BenchmarkPage()
+    : displayManager(Display::getInstance()),
+      runner(BenchmarkRunner::getInstance()),
+      shownRevision(0)
+{
+}
+
+void BenchmarkPage::drawHeader()
+{
+    DisplayBackend *tft = displayManager.getTFT();
+    tft->fillRect(0, 0, SCREEN_WIDTH, HEADER_HEIGHT, TFT_DARKGREY);
+
+    tft->fillRoundRect(BACK_BUTTON_X, BUTTON_Y, BUTTON_WIDTH, BUTTON_HEIGHT, 5, TFT_BLUE);
+    tft->setTextColor(TFT_WHITE, TFT_BLUE);
+    displayManager.drawCenteredText("Back", BACK_BUTTON_X, BUTTON_Y, BUTTON_WIDTH, BUTTON_HEIGHT, 1);
+
+    uint16_t runColor = runner.isRunning() ? TFT_DARKGREY : TFT_DARKGREEN;
+    tft->fillRoundRect(RUN_BUTTON_X, BUTTON_Y, BUTTON_WIDTH, BUTTON_HEIGHT, 5, runColor);
+    tft->setTextColor(TFT_WHITE, runColor);
+    displayManager.drawCenteredText(runner.isRunning() ? "..." : "Run", RUN_BUTTON_X, BUTTON_Y, BUTTON_WIDTH, BUTTON_HEIGHT, 1);
+
+    tft->setTextColor(TFT_WHITE, TFT_DARKGREY);
+    displayManager.drawCenteredText("基准测试", 0, 0, SCREEN_WIDTH, HEADER_HEIGHT, 1);
+}
+
+void BenchmarkPage::drawResults()
+{
+    DisplayBackend *tft = displayManager.getTFT();
+    tft->fillRect(0, HEADER_HEIGHT, SCREEN_WIDTH, SCREEN_HEIGHT - HEADER_HEIGHT, TFT_BLACK);
+    // Built-in 6x8 font: fast, and does not touch the glyph cache being measured
+    tft->setTextFont(1);
+    tft->setTextSize(1);
+    tft->setTextDatum(TL_DATUM);
+    tft->setTextColor(TFT_WHITE, TFT_BLACK);
+
+    const std::vector<BenchmarkRunner::Result> &results = runner.results();
+    uint16_t y = RESULTS_Y;
+    if (results.empty())
+    {
+        tft->drawString(runner.isRunning() ? "Running..." : "Tap Run. Results are also printed over serial.", 5, y);
+        return;
+    }
+    char value[24];
+    for (const BenchmarkRunner::Result &result : results)
+    {
+        if (y + RESULT_LINE_HEIGHT > SCREEN_HEIGHT)
+        {
+            break;
+        }
+        tft->drawString(result.name, 5, y);
+        if (result.unit)
+        {
+            snprintf(value, sizeof(value), "%.2f %s", result.value, result.unit);
+        }
+        else
+        {
+            snprintf(value, sizeof(value), "skipped");
+        }
+        tft->drawString(value, SCREEN_WIDTH / 2, y);
+        y += RESULT_LINE_HEIGHT;
+    }
+}
+
+void BenchmarkPage::display()
+{
+    shownRevision = runner.revision();
+    displayManager.getTFT()->fillScreen(TFT_BLACK);
+    drawHeader();
+    drawResults();
+}
+
+void BenchmarkPage::handleTouch(uint16_t x, uint16_t y)
+{
+    if (y >= BUTTON_Y && y < BUTTON_Y + BUTTON_HEIGHT)
+    {
+        if (x >= BACK_BUTTON_X && x < BACK_BUTTON_X + BUTTON_WIDTH)
+        {
+            if (!runner.isRunning()) // The macro steps navigate on their own
+            {
+                Router::getInstance().goBack();
+            }
+            return;
+        }
+        if (x >= RUN_BUTTON_X && x < RUN_BUTTON_X + BUTTON_WIDTH)
+        {
+            runner.start();
+            return; // handleLoop redraws when the runner reports progress
+        }
+    }
+}
+
+void BenchmarkPage::handleLoop()
+{
+    if (runner.revision() != shownRevision)
+    {
+        shownRevision = runner.revision();
+        drawHeader();
+        drawResults();
+    }
+}
@@ -0,0 +1,124 @@
+#ifndef BENCHMARK_PAGE_H
+#define BENCHMARK_PAGE_H
+
+#include <Arduino.h>
+#include <vector>
+#include "pages.h"              // Page base class, Router, Display
+#include "../core/scheduler.h"  // Timer that drives the benchmark steps
+#include "../config/config.h"   // BENCH_* constants
+
+/**
+ * @brief Runs the benchmark suite and keeps its results.
+ * Results live in this singleton (not in the page) because the macro benchmarks navigate to the
+ * comic and text viewers and back, which destroys and recreates the BenchmarkPage.
+ * The suite is driven by a Scheduler timer, one step per tick, on the main loop:
+ *  - micro: SD sequential/random read per block size, font cache hit/miss lookup,
+ *           glyph blit rate, text layout throughput, BGR888 -> RGB565 conversion per kernel;
+ *  - macro: comic full-screen redraw fps, scripted page turns on the reference book.
+ * Every result is printed over serial as "BENCH,<name>,<value>,<unit>" so runs on different
+ * firmware builds and SD cards can be diffed.
+ */
+class BenchmarkRunner
+{
+public:
+    struct Result
+    {
+        char name[24];
+        float value;
+        const char *unit; // nullptr: benchmark skipped (reference file missing)
+    };
+
+private:
+    enum Step : uint8_t
+    {
+        STEP_SD,
+        STEP_FONT,
+        STEP_BLIT,
+        STEP_LAYOUT,
+        STEP_CONVERT,
+        STEP_COMIC_OPEN,
+        STEP_COMIC_REDRAW,
+        STEP_BOOK_OPEN,
+        STEP_PAGE_TURN,
+        STEP_DONE
+    };
+
+    static BenchmarkRunner *instance;
+    Scheduler::TaskId timer;
+    Step step;
+    bool running;
+    uint32_t revisionCounter; // Bumped whenever results or state change (the page polls it)
+    std::vector<Result> resultList;
+    int turnsDone;            // Page turns performed so far
+    uint32_t turnTotalUs;     // Sum of page turn times
+    uint32_t turnMaxUs;       // Slowest page turn
+
+    BenchmarkRunner();
+
+    static void onStep(void *ctx);
+    void runStep();
+    void addResult(const char *name, float value, const char *unit);
+
+    // Individual benchmarks
+    void benchSdRead();
+    void benchFontLookup();
+    void benchGlyphBlit();
+    void benchTextLayout();
+    void benchPixelConvert();
+    void benchComicRedraw();
+    bool pageTurn(); // Returns false when the sequence is finished
+
+public:
+    BenchmarkRunner(const BenchmarkRunner &) = delete;
+    BenchmarkRunner &operator=(const BenchmarkRunner &) = delete;
+
+    static BenchmarkRunner &getInstance();
+
+    /**
+     * @brief Clears previous results and starts the suite (ignored while running).
+     */
+    void start();
+
+    bool isRunning() const { return running; }
+    uint32_t revision() const { return revisionCounter; }
+    const std::vector<Result> &results() const { return resultList; }
+
+    /**
+     * @brief Prints all results over serial (one CSV line each, plus build and SD card info).
+     */
+    void printResults() const;
+};
+
+/**
+ * @brief Benchmarks page: a Run button and the results of the last run.
+ */
+class BenchmarkPage : public Page
+{
+private:
+    Display &displayManager;
+    BenchmarkRunner &runner;
+    uint32_t shownRevision; // Runner revision currently on screen
+
+    // --- UI Layout Constants ---
+    static constexpr uint16_t HEADER_HEIGHT = 30;
+    static constexpr uint16_t BUTTON_WIDTH = 60;
+    static constexpr uint16_t BUTTON_HEIGHT = 24;
+    static constexpr uint16_t BUTTON_Y = 3;
+    static constexpr uint16_t BACK_BUTTON_X = 5;
+    static constexpr uint16_t RUN_BUTTON_X = SCREEN_WIDTH - 5 - BUTTON_WIDTH;
+    static constexpr uint16_t RESULTS_Y = HEADER_HEIGHT + 6;
+    static constexpr uint16_t RESULT_LINE_HEIGHT = 12;
+
+    void drawHeader();
+    void drawResults();
+
+public:
+    BenchmarkPage();
+
+    virtual void display() override;
+    virtual void handleTouch(uint16_t x, uint16_t y) override;
+    virtual void handleLoop() override; // Redraws the results when the runner reports progress
+    virtual ~BenchmarkPage() = default;
+};
+
+#endif // BENCHMARK_PAGE_H
@@ -1,6 +1,9 @@
 #include <Arduino.h>
 #include <FS.h>      // 用于文件系统操作
 #include <algorithm> // 用于 std::min 和 std::max
+#include <memory>    // std::unique_ptr (翻页模式的解码请求)
+#include <new>       // std::nothrow
+#include <ArduinoJson.h> // 阅读位置文件
 #include <vector>    // 用于 std::vector
 
 #include "pages.h"            // 包含页面基类和相关定义 (Correct path)
@@ -8,9 +11,75 @@
 #include "../core/sdcard.h"   // 包含 SD 卡管理类 (Adjusted path)
 #include "../core/router.h"   // 包含页面路由类 (Adjusted path)
 #include "../config/config.h" // 包含配置常量 (Adjusted path)
+#include "../core/memory_budget.h" // 条带解码缓冲区来自启动时预留的临时内存
+#include "../core/mem_stats.h"     // 按子系统统计内存
+#include "../core/trace.h"         // 区间跟踪
+#include "../core/bmp_scaler.h"    // 翻页模式：图片等比例缩放到一屏
+#include "../core/widget_cache.h"  // 缩略图网格底部的按钮
+#include "../core/sd_read_profile.h" // 条带每次读取的大小和扇区对齐的读取
 
 // ComicViewerPage 类实现
 
+// Q565 图片 (tools/q565_encode.py 转换的章节)
+static bool isQ565Image(const String &imagePath)
+{
+    return imagePath.endsWith(Q565Decoder::FILE_EXTENSION);
+}
+
+// 目录中图片的扩展名：有 1.q565 时整章使用 Q565，否则为 BMP
+static const char *imageExtension(SDCard &sd, const String &dir)
+{
+    return sd.exists(dir + "/1" + Q565Decoder::FILE_EXTENSION) ? Q565Decoder::FILE_EXTENSION : ".bmp";
+}
+
+// Q565 图片在滚动画布上显示的区域：COMIC_CROP_MARGINS 时裁掉内容框上下的空白，
+// 比屏幕宽的图片取以内容为中心的一屏宽 (放得下的图片保持整行，与不裁剪时位置相同)
+static Q565Decoder::Window q565View(const Q565Decoder &q565)
+{
+    Q565Decoder::Window view{0, 0, q565.width(), q565.height()};
+#if COMIC_CROP_MARGINS
+    Q565Decoder::Window content = q565.contentWindow(COMIC_CROP_KEEP_PIXELS);
+    view.y = content.y;
+    view.height = content.height;
+    if (q565.width() > SCREEN_WIDTH)
+    {
+        int left = content.x + content.width / 2 - SCREEN_WIDTH / 2;
+        view.x = std::max(0, std::min(left, q565.width() - SCREEN_WIDTH));
+        view.width = SCREEN_WIDTH;
+    }
+#endif
+    return view;
+}
+
+// 读取图片高度 (BMP 或 Q565 文件头)，失败时返回屏幕高度。章节连读的后台任务也调用 (使用自己的解码器)
+static int readImageHeight(SDCard &sd, const String &imagePath, BmpRowDecoder &decoder)
+{
+    File file = sd.openFile(imagePath);
+    int height = SCREEN_HEIGHT; // 默认高度，以防读取失败
+    if (file && isQ565Image(imagePath))
+    {
+        uint8_t header[Q565Decoder::HEADER_BYTES];
+        Q565Decoder q565;
+        if (file.read(header, sizeof(header)) == sizeof(header) && q565.parseHeader(header))
+        {
+            height = q565View(q565).height; // 裁掉的边距不占画布
+        }
+        file.close();
+    }
+    else if (file)
+    {
+        uint8_t header[BmpRowDecoder::HEADER_BYTES];
+        // 读取 BMP 文件头的前 54 字节
+        if (file.read(header, sizeof(header)) == sizeof(header) && decoder.parseHeader(header))
+        {
+            // 高度的绝对值 (自上而下存储的 BMP 高度为负数)
+            height = decoder.height();
+        }
+        file.close(); // 关闭文件
+    }
+    return height;
+}
+
 // Implementation of the virtual setParams method
 void ComicViewerPage::setParams(void *params)
 {
@@ -31,96 +100,266 @@ void ComicViewerPage::setParams(void *params)
 }
 
 /**
- * @brief 加载指定漫画路径下的所有图片文件。
- * 按照 "1.bmp", "2.bmp", ... 的顺序查找连续的 BMP 文件。
- * 同时计算并缓存每张图片的高度以及所有图片的总高度。
+ * @brief 加载指定漫画路径下的图片列表。
+ * 按照 "1.bmp", "2.bmp", ... 的顺序查找连续的 BMP 文件 (目录中有 1.q565 时查找 Q565 文件)，但不逐张读取文件头：
+ * 第一屏只需要一两张图片的高度，长章节逐张读取文件头会让打开时间与图片数成正比。
  *
  * @details
- * - 清空现有的图片文件列表 (imageFiles) 和高度缓存 (imageHeights)。
- * - 重置总漫画高度 (totalComicHeight)。
- * - 遍历数字索引，构建预期的图片文件名 (e.g., "/path/to/comic/1.bmp")。
- * - 使用 sdManager.exists() 检查文件是否存在，直到找不到连续的文件为止。
- * - 对于找到的每个文件：
- *   - 将其路径添加到 imageFiles 向量中。
- *   - 打开文件，读取 BMP 文件头以获取图片高度。
- *   - 将高度添加到 imageHeights 向量中。
- *   - 累加高度到 totalComicHeight。
- *   - 关闭文件。
- * - 如果计算出的 totalComicHeight 为 0 但找到了图片，设置一个默认高度（屏幕高度）作为回退。
+ * - countImages() 用 O(log n) 次 exists() 确定图片数 (中间缺号时可能偏大，后台扫描会纠正)。
+ * - 只读取第一张图片的文件头，其余图片的高度先取第一张的高度作为估计值，
+ *   滚动条和 totalComicHeight 在后台扫描完成前按估计值计算。
+ * - 绘制前 measureVisibleImages() 读取视口中图片的实际高度；startMetadataScan() 在后台读取其余图片，
+ *   完成后 applyMetadataScan() 一次替换所有估计值。
  */
 void ComicViewerPage::loadImages()
 {
     imageFiles.clear();   // 清空图片文件列表
     imageHeights.clear(); // 清空缓存的高度
+    imageStarts.clear();
+    imageMeasured.clear();
     totalComicHeight = 0; // 重置总高度
     Serial.print("Loading comic images from path: ");
     Serial.println(currentPath);
 
     // --- Display Loading Message ---
-    TFT_eSPI *tft = displayManager.getTFT();
+    DisplayBackend *tft = displayManager.getTFT();
     tft->fillScreen(TFT_WHITE);              // Clear screen
     tft->setTextColor(TFT_BLACK, TFT_WHITE); // Set text color
     tft->setTextDatum(MC_DATUM);             // Center alignment
     tft->drawString("Loading Comic...", SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 10);
-    Serial.println("Displayed initial loading message.");
     // --- End Initial Loading Message ---
 
-    // 寻找从 1.bmp 开始的连续图片文件
-    int index = 1;
-    while (true)
+    const char *extension = imageExtension(sdManager, currentPath);
+    const int count = countImages(currentPath, extension);
+    if (count == 0)
+    {
+        Serial.println("No images found.");
+        return;
+    }
+    imageFiles.reserve(count);
+    for (int index = 1; index <= count; index++)
+    {
+        imageFiles.push_back(currentPath + "/" + String(index) + extension);
+    }
+
+    // 第一次打开漫画时测量 SD 卡的读取特性 (决定条带每次读取的大小)
+    SdReadProfile &sdProfile = SdReadProfile::getInstance();
+    if (!sdProfile.isProbed())
     {
-        String imagePath = currentPath + "/" + String(index) + ".bmp";
-        if (!sdManager.exists(imagePath))
+        File file = sdManager.openFile(imageFiles[0]);
+        if (file)
         {
-            Serial.print("No more images found after index ");
-            Serial.println(index - 1);
-            break; // 找不到文件，停止加载
+            sdProfile.probe(file);
+            file.close();
         }
-        Serial.print("Found image: ");
-        Serial.println(imagePath);
-        imageFiles.push_back(imagePath); // 添加到文件列表
+    }
 
-        // --- 计算并缓存高度 ---
-        File file = sdManager.openFile(imagePath);
-        int height = SCREEN_HEIGHT; // 默认高度，以防读取失败
-        if (file)
+    // 第一张图片的高度作为其余图片的估计值 (同一章节的图片通常一样高)
+    const int estimate = readImageHeight(sdManager, imageFiles[0], bmp);
+    imageHeights.assign(count, estimate);
+    imageMeasured.assign(count, false);
+    imageMeasured[0] = true;
+    imageStarts.reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+        imageStarts.push_back(totalComicHeight); // 图片顶部在整本漫画中的位置
+        totalComicHeight += estimate;
+    }
+    Serial.printf("Comic images: %d found, estimated total height %d (first image %d rows)\n", count, totalComicHeight, estimate);
+    startMetadataScan();
+}
+
+// 连续图片的个数：先倍增找到第一个不存在的编号，再在最后一个存在的编号和它之间二分查找。
+// 编号中间有空缺时结果可能大于第一个空缺之前的图片数，后台扫描 (逐张检查) 会截断到正确的个数
+int ComicViewerPage::countImages(const String &dir, const char *extension)
+{
+    auto exists = [&](int index) { return sdManager.exists(dir + "/" + String(index) + extension); };
+    if (!exists(1))
+    {
+        return 0;
+    }
+    int present = 1; // 已知存在
+    int missing = 2; // 待确认不存在
+    while (exists(missing))
+    {
+        present = missing;
+        missing *= 2;
+    }
+    while (missing - present > 1)
+    {
+        int middle = present + (missing - present) / 2;
+        if (exists(middle))
+        {
+            present = middle;
+        }
+        else
+        {
+            missing = middle;
+        }
+    }
+    return present;
+}
+
+void ComicViewerPage::setImageHeight(int image, int height)
+{
+    imageMeasured[image] = true;
+    const int delta = height - imageHeights[image];
+    if (delta == 0)
+    {
+        return;
+    }
+    // 整张图片在视口上方时滚动偏移随之移动，屏幕上显示的内容不变
+    if (imageStarts[image] + imageHeights[image] <= scrollOffset)
+    {
+        scrollOffset += delta;
+    }
+    imageHeights[image] = height;
+    for (size_t i = image + 1; i < imageStarts.size(); i++)
+    {
+        imageStarts[i] += delta;
+    }
+    totalComicHeight += delta;
+}
+
+void ComicViewerPage::measureVisibleImages()
+{
+    // 高度变化后视口可能露出别的图片 (例如总高度变小后偏移被限制)，直到视口中的图片都已实测
+    bool changed = true;
+    while (changed && !imageFiles.empty())
+    {
+        changed = false;
+        int maxScrollOffset = (totalComicHeight > SCREEN_HEIGHT) ? (totalComicHeight - SCREEN_HEIGHT) : 0;
+        scrollOffset = std::max(0, std::min(scrollOffset, maxScrollOffset));
+        for (int i = currentImage(); i < (int)imageFiles.size() && imageStarts[i] < scrollOffset + SCREEN_HEIGHT; i++)
         {
-            uint8_t header[54];
-            // 读取 BMP 文件头的前 54 字节
-            if (file.read(header, 54) == 54 && header[0] == 'B' && header[1] == 'M')
+            if (!imageMeasured[i])
             {
-                // BMP 文件头中，高度信息位于偏移量 22 的位置 (4 字节整数)
-                height = *(int *)&header[22];
+                setImageHeight(i, readImageHeight(sdManager, imageFiles[i], bmp));
+                changed = true;
             }
-            file.close(); // 关闭文件
         }
-        imageHeights.push_back(height); // 缓存图片高度
-        totalComicHeight += height;     // 累加到总高度
-        Serial.print("  Image height: ");
-        Serial.println(height);
-        // --- 结束高度计算 ---
-
-        // --- Update Loading Progress Display ---
-        // Clear previous progress line (optional, depends on font/size)
-        tft->fillRect(0, SCREEN_HEIGHT / 2 + 10, SCREEN_WIDTH, 20, TFT_WHITE);
-        String progressText = "Loaded: " + String(index) + " (H:" + String(height) + ") Total H: " + String(totalComicHeight);
-        tft->drawString(progressText, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 10);
-        Serial.println(progressText);
-        // --- End Progress Update ---
-
-        index++; // 准备查找下一个文件
-    }
-    Serial.print("Total images loaded: ");
-    Serial.println(imageFiles.size());
-    Serial.print("Total comic height calculated: ");
-    Serial.println(totalComicHeight);
-    // 如果计算出的总高度为 0 但确实加载了图片（可能因为文件头读取失败），
-    // 提供一个基于屏幕高度的回退值，避免完全无法滚动。
-    if (totalComicHeight == 0 && !imageFiles.empty())
+    }
+}
+
+/**
+ * @brief 读取 BMP 文件头到 bmp 解码器，16 位 BI_BITFIELDS 图片还要读取颜色掩码，调色板图片读取调色板。
+ * @param file 已打开的图片文件 (读取后文件位置不确定，调用者按 chunkOffset() 重新定位)。
+ * @param scratch 读取调色板的临时缓冲区，至少 256 * 4 字节 (使用条带的原始数据缓冲区)。
+ * @return 格式受支持且读取成功时返回 true。
+ */
+bool ComicViewerPage::readBmpHeader(File &file, uint8_t *scratch)
+{
+    uint8_t header[BmpRowDecoder::HEADER_BYTES];
+    if (file.read(header, sizeof(header)) != sizeof(header))
+    {
+        Serial.println("Failed to read BMP header!");
+        return false;
+    }
+    if (!bmp.parseHeader(header))
+    {
+        Serial.println("Invalid or unsupported BMP file (supported: 24/16-bit, 8/4-bit paletted, uncompressed)!");
+        return false;
+    }
+    if (bmp.needsMasks())
+    {
+        uint8_t masks[BmpRowDecoder::MASKS_BYTES];
+        if (!file.seek(BmpRowDecoder::MASKS_OFFSET) || file.read(masks, sizeof(masks)) != sizeof(masks) || !bmp.setMasks(masks))
+        {
+            Serial.println("Unsupported 16-bit BMP bit fields (only RGB565 and RGB555)!");
+            return false;
+        }
+    }
+    if (bmp.paletteEntries() > 0)
+    {
+        size_t paletteBytes = bmp.paletteEntries() * 4;
+        size_t bytesRead;
+        {
+            TRACE_SPAN(TraceName::SD_READ);
+            bytesRead = file.seek(bmp.getPaletteOffset()) ? file.read(scratch, paletteBytes) : 0;
+        }
+        if (bytesRead != paletteBytes)
+        {
+            Serial.println("Failed to read BMP palette!");
+            return false;
+        }
+        bmp.setPalette(scratch, bmp.paletteEntries());
+    }
+    return true;
+}
+
+bool ComicViewerPage::readQ565Header(File &file)
+{
+    uint8_t header[Q565Decoder::HEADER_BYTES];
+    if (file.read(header, sizeof(header)) != sizeof(header) || !q565.parseHeader(header))
+    {
+        if (Q565Decoder::isOtherVersion(header))
+        {
+            Serial.println("Q565 file from another encoder version, re-encode it with tools/q565_encode.py");
+        }
+        else
+        {
+            Serial.println("Invalid Q565 file!");
+        }
+        return false;
+    }
+    return true;
+}
+
+bool ComicViewerPage::drawQ565Rows(File &file, int firstRow, int endRow, int screenY, int clipTop, int clipBottom,
+                                   uint8_t *rawBuffer, size_t readBytes, uint16_t *pixelBuffer)
+{
+    // 编码数据按 SD 卡的有效读取大小分窗口读取 (扇区对齐)；firstRow/endRow 是显示区域 (q565View) 中的行
+    const Q565Decoder::Window view = q565View(q565);
+    SdReadProfile::AlignedSource source{&file, rawBuffer};
+    q565.setSource(SdReadProfile::fetchAligned, &source, readBytes, file.size());
+    if (!q565.readBlankRuns() || !q565.seekRow(view.y + firstRow))
+    {
+        Serial.println("Q565 seek failed!");
+        return false;
+    }
+    DisplayBackend *tft = displayManager.getTFT();
+    tft->setSwapBytes(false); // 解码结果已是面板字节顺序
+    for (int row = firstRow; row < endRow;)
     {
-        totalComicHeight = SCREEN_HEIGHT; // 使用屏幕高度作为回退
-        Serial.println("Warning: Total height was 0, using fallback.");
+        if (touchManager.isTouched())
+        {
+            Serial.println("Touch detected during Q565 decode, stopping draw.");
+            touchManager.getPoint(lastTouchX, lastTouchY);
+            touchPending = true;
+            renderingInterrupted = true;
+            return true;
+        }
+        int y = screenY + (row - firstRow);
+        // 空白行段：不读取、不解码；背景是白色时屏幕已经清成白色，连填充也不需要
+        int blank = std::min(q565.blankRowsFrom(view.y + row), endRow - row);
+        if (blank > 0)
+        {
+            int top = std::max(y, clipTop);
+            int bottom = std::min(y + blank, clipBottom);
+            if (q565.background() != TFT_WHITE && top < bottom)
+            {
+                tft->fillRect(0, top, view.width, bottom - top, q565.background());
+            }
+            row += blank;
+            if (row < endRow && !q565.seekRow(view.y + row)) // 跨过的整组直接从下一个重启点开始
+            {
+                Serial.println("Q565 seek failed!");
+                return false;
+            }
+            continue;
+        }
+        if (!q565.decodeRow<true>(pixelBuffer, view.x, view.width))
+        {
+            Serial.println("Q565 row decode failed!");
+            return false;
+        }
+        if (y >= clipTop && y < clipBottom)
+        {
+            tft->pushImage(0, y, view.width, 1, pixelBuffer);
+        }
+        row++;
     }
+    return false;
 }
 
 /**
@@ -142,20 +381,19 @@ void ComicViewerPage::loadImages()
  * - 从 startImage 开始遍历图片列表：
  *   - 获取当前图片的缓存高度。
  *   - 打开图片文件。
- *   - 读取并验证 BMP 文件头，获取宽度和位深度（必须是 24 位）。
+ *   - 读取并验证 BMP 文件头 (readBmpHeader)，获取宽度和位深度（24/16 位，8/4 位调色板）。
  *   - 计算图片中实际需要读取和绘制的行范围 (startY, readHeight)，这取决于图片本身在屏幕上的可见部分。
  *   - 计算 BMP 行数据的实际存储大小 (actualRowSize)，包含 4 字节对齐的填充。
  *   - 计算像素数据在文件中的起始偏移量 (dataOffset)。
- *   - 分块读取图片数据（每次读取 BUFFER_ROWS 行）：
+ *   - 分块读取图片数据（每次读取 BUFFER_ROWS 行，即 SdReadProfile 选择的读取大小能容纳的行数）：
  *     - 计算当前块在文件中的位置 (pos)，注意 BMP 是从下往上存储的。
- *     - 使用 file.seek() 定位。
- *     - 使用 file.read() 将原始 BGR 数据读入 rawBuffer。
- *     - 逐行处理 rawBuffer 中的数据（从缓冲区底部开始，对应图片中较低的行号）：
+ *     - 使用 SdReadProfile::readAligned() 从对齐到扇区的位置读入 rawBuffer，chunk 指向数据块的起点。
+ *     - 逐行处理 chunk 中的数据（从缓冲区底部开始，对应图片中较低的行号）：
  *       - 获取指向当前行数据的指针 (currentRowPtr)。
  *       - 计算该行在屏幕上的目标 Y 坐标 (screenRowY)。
  *       - 如果 screenRowY 在屏幕范围内：
- *         - 将当前行的 BGR 数据转换为 RGB565 格式，存入 pixelBuffer。
- *         - 使用 tft->pushImage() 将 pixelBuffer 中的一行像素推送到屏幕的 (0, screenRowY) 位置。
+ *         - 用 bmp.decodePanelRow() 把当前行解码为 RGB565 格式 (存入 pixelBuffer，24 位图片输出面板字节顺序，RGB565 图片直接使用原始数据)。
+ *         - 使用 tft->pushImage() 将这一行像素推送到屏幕的 (0, screenRowY) 位置。
  *   - 关闭文件。
  *   - 更新 yOffset，准备绘制下一张图片。
  * - 循环直到绘制完所有可见图片或超出屏幕底部。
@@ -163,6 +401,7 @@ void ComicViewerPage::loadImages()
  */
 bool ComicViewerPage::drawContent()
 {
+    TRACE_SPAN(TraceName::COMIC_DRAW_CONTENT);
     // 用白色填充背景
     displayManager.getTFT()->fillScreen(TFT_WHITE);
     Serial.println("Drawing comic content");
@@ -173,6 +412,7 @@ bool ComicViewerPage::drawContent()
         displayManager.drawCenteredText("No images found", 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
         return false; // Return false as drawing didn't complete (no images)
     }
+    measureVisibleImages(); // 视口中的图片使用实际高度 (其余图片可能还是估计值)
 
     // 使用缓存的总高度
     Serial.print("Using cached total height: ");
@@ -191,8 +431,12 @@ bool ComicViewerPage::drawContent()
     Serial.print("Scroll offset: ");
     Serial.println(scrollOffset);
 
+    // 本次绘制的临时内存都从页面 arena 分配，函数返回时整体回卷 (Scope 必须先于使用它的容器声明)
+    Arena::Scope scratch(arena());
+
     // --- 计算每张图片在漫画长条中的起始 Y 坐标 ---
-    std::vector<int> startPositions; // 存储每张图片顶部的绝对 Y 坐标
+    std::vector<int, ArenaAllocator<int>> startPositions{ArenaAllocator<int>(&arena(), MemTag::COMIC_BUFFERS)}; // 存储每张图片顶部的绝对 Y 坐标
+    startPositions.reserve(imageHeights.size()); // 一次分配到位 (arena 中的旧块不会被复用)
     int currentHeightSum = 0;
     for (int height : imageHeights)
     { // 遍历缓存的高度
@@ -229,28 +473,31 @@ bool ComicViewerPage::drawContent()
     Serial.println(yOffset);
 
     // --- 定义缓冲区 ---
-    // 缓冲区大小，减少以降低单次 heap 分配大小，缓解碎片问题
-    const int BUFFER_ROWS = 16; // Reduced from 16
-    const int BPP = 3;         // Bytes per pixel (24-bit BMP)
-    // 计算存储原始 BMP 行数据（包括填充）所需的最大缓冲区大小
-    // BMP 行数据需要填充到 4 字节的倍数: ((width * BPP + 3) & ~3)
-    // 这里假设最大宽度为屏幕宽度来分配缓冲区
-    const int MAX_RAW_ROW_SIZE = ((SCREEN_WIDTH * BPP + 3) & ~3);
-    const int RAW_BUFFER_SIZE = MAX_RAW_ROW_SIZE * BUFFER_ROWS;
-
-    // Dynamically allocate buffers on the heap
-    uint8_t *rawBuffer = new (std::nothrow) uint8_t[RAW_BUFFER_SIZE];
-    uint16_t *pixelBuffer = new (std::nothrow) uint16_t[SCREEN_WIDTH];
+    // 每次读取的字节数来自 SdReadProfile (SD 卡的有效传输大小，受内存限制)，
+    // 每张图片按自己的行大小换算为条带行数 (调色板图片的行更小，一次读取更多行)
+    const size_t READ_BYTES = SdReadProfile::getInstance().readBytes(SCREEN_WIDTH * sizeof(uint16_t));
+    const int RAW_BUFFER_SIZE = SdReadProfile::alignedBytes(READ_BYTES); // 扇区对齐读取的余量
+
+    // 两个缓冲区放在同一块临时内存中 (来自页面 arena)
+    // arena 不可用时 (例如申请失败) 退回到 MemoryBudget 的临时分配
+    const size_t STRIP_BYTES = RAW_BUFFER_SIZE + SCREEN_WIDTH * sizeof(uint16_t);
+    uint8_t *stripBuffer = arena().allocArray<uint8_t>(STRIP_BYTES);
+    const bool stripFromArena = stripBuffer != nullptr;
+    if (!stripFromArena)
+    {
+        stripBuffer = (uint8_t *)MemoryBudget::getInstance().acquireTransient(STRIP_BYTES, SdReadProfile::BUFFER_CAPS);
+    }
 
     // Check if allocation succeeded
-    if (!rawBuffer || !pixelBuffer)
+    if (!stripBuffer)
     {
         Serial.println("ERROR: Failed to allocate drawing buffers in drawContent!");
-        delete[] rawBuffer;   // Safe even if nullptr
-        delete[] pixelBuffer; // Safe even if nullptr
         displayManager.drawCenteredText("Memory Error", 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
         return false; // Cannot proceed, drawing did not complete (but wasn't interrupted by touch)
     }
+    MemStats::Scoped stripStats(MemTag::COMIC_BUFFERS, STRIP_BYTES);
+    uint8_t *rawBuffer = stripBuffer;
+    uint16_t *pixelBuffer = (uint16_t *)(stripBuffer + RAW_BUFFER_SIZE); // RAW_BUFFER_SIZE 是 4 的倍数，对齐安全
 
     bool touchDetected = false; // Flag to track if touch interrupted drawing
 
@@ -286,20 +533,26 @@ bool ComicViewerPage::drawContent()
             continue;
         }
 
-        // --- 读取并验证 BMP 文件头 ---
-        uint8_t header[54];
-        size_t bytesRead = file.read(header, 54);
-        if (bytesRead != 54)
+        if (isQ565Image(imageFiles[i]))
         {
-            Serial.println("Failed to read BMP header!");
+            // Q565：从可见的第一行所在的重启点开始解码，上方的行不读取
+            int startY = std::max(0, -yOffset);
+            int readHeight = std::min(SCREEN_HEIGHT - std::max(0, yOffset), height - startY);
+            if (readQ565Header(file) && q565View(q565).width <= SCREEN_WIDTH && readHeight > 0)
+            {
+                touchDetected = drawQ565Rows(file, startY, startY + readHeight, std::max(0, yOffset), 0, SCREEN_HEIGHT,
+                                             rawBuffer, READ_BYTES, pixelBuffer);
+            }
             file.close();
+            if (touchDetected)
+                break;
             yOffset += height;
             continue;
         }
-        // 验证 BMP 签名 ('BM')
-        if (header[0] != 'B' || header[1] != 'M')
+
+        // --- 读取并验证 BMP 文件头 (调色板暂存在条带缓冲区中) ---
+        if (!readBmpHeader(file, rawBuffer))
         {
-            Serial.println("Invalid BMP file!");
             file.close();
             yOffset += height;
             continue;
@@ -307,9 +560,8 @@ bool ComicViewerPage::drawContent()
         // --- 结束 BMP 文件头处理 ---
 
         // 从文件头获取宽度和位深度 (高度使用缓存值)
-        int width = *(int *)&header[18];
-        // height = *(int *)&header[22]; // 使用缓存的高度
-        int bitsPerPixel = *(short *)&header[28];
+        int width = bmp.width();
+        int bitsPerPixel = bmp.getBitsPerPixel();
 
         Serial.print("Image dimensions (WxH): ");
         Serial.print(width);
@@ -327,14 +579,6 @@ bool ComicViewerPage::drawContent()
             yOffset += height;
             continue;
         }
-        if (bitsPerPixel != 24)
-        {
-            Serial.println("Only 24-bit BMP supported!");
-            file.close();
-            yOffset += height;
-            continue;
-        }
-
         // --- 计算需要读取和绘制的行范围 ---
         // startY: 图片内部需要开始读取的行号 (0-based)
         //         如果图片顶部在屏幕上方 (yOffset < 0)，则从 -yOffset 行开始读
@@ -355,10 +599,10 @@ bool ComicViewerPage::drawContent()
         // --- 分块读取并绘制图片数据 ---
         if (readHeight > 0)
         {
-            // 计算当前图片 BMP 行数据的实际大小（包括填充）
-            int actualRowSize = ((width * BPP + 3) & ~3);
-            // 获取像素数据在文件中的起始偏移量
-            long dataOffset = (*(int *)&header[10]); // bfOffBits
+            // 计算当前图片 BMP 行数据的实际大小（包括填充，取决于位深度）
+            int actualRowSize = bmp.rowBytes();
+            const int BUFFER_ROWS = std::max(1, (int)(READ_BYTES / actualRowSize)); // 每次读取的行数
+            Serial.printf("Strip: %d rows x %d bytes per read (%u-byte reads)\n", BUFFER_ROWS, actualRowSize, (unsigned)READ_BYTES);
 
             // 循环读取，每次读取 BUFFER_ROWS 行，或者剩余行数（如果不足）
             for (int row = startY; row < startY + readHeight;)
@@ -377,39 +621,28 @@ bool ComicViewerPage::drawContent()
 
                 // 计算本次要读取的行数
                 int rowsToRead = std::min(BUFFER_ROWS, (startY + readHeight) - row);
-                int bufferBytesToRead = rowsToRead * actualRowSize; // 本次要读取的总字节数
 
                 // 计算文件中要读取的第一行的位置
-                // BMP 数据是倒置存储的（从下往上）
+                // BMP 数据通常是倒置存储的（从下往上）
                 // 文件中的行号 = (图片总高度 - 1 - 图片内行号)
                 // 要读取的块中，图片内行号范围是 [firstRowInChunk, firstRowInChunk + rowsToRead - 1]
                 // 对应文件中的行号范围是 [height - 1 - (firstRowInChunk + rowsToRead - 1), height - 1 - firstRowInChunk]
                 // 我们需要定位到这个范围在文件中的起始位置，即对应图片行 (firstRowInChunk + rowsToRead - 1) 的数据起始位置
+                // (高度为负数的 BMP 自上而下存储，起始位置就是 firstRowInChunk 行；由 bmp.chunkOffset() 处理)
                 int firstRowInChunk = row; // 当前块在图片中起始行号
-                long pos = dataOffset + (height - 1 - (firstRowInChunk + rowsToRead - 1)) * actualRowSize;
-
-                // 定位文件指针
-                if (!file.seek(pos))
-                {
-                    Serial.println("Seek failed!");
-                    row += rowsToRead; // 跳过这个块
-                    continue;
-                }
+                long pos = bmp.chunkOffset(firstRowInChunk, rowsToRead);
 
-                // 读取 BGR 数据块到 rawBuffer
-                size_t actualBytesRead = file.read(rawBuffer, bufferBytesToRead);
-                if (actualBytesRead != bufferBytesToRead)
+                // 读取数据块到 rawBuffer (起点对齐到扇区，chunk 指向数据块的第一个字节)
+                const uint8_t *chunk = SdReadProfile::getInstance().readAligned(file, pos, rowsToRead * actualRowSize, rawBuffer);
+                if (!chunk)
                 {
-                    Serial.print("Chunk read failed! Expected ");
-                    Serial.print(bufferBytesToRead);
-                    Serial.print(", got ");
-                    Serial.println(actualBytesRead);
+                    Serial.println("Chunk read failed!");
                     row += rowsToRead; // 跳过这个块
                     continue;
                 }
 
                 // --- 逐行处理缓冲区中的数据 ---
-                // 因为我们读取的是文件中的连续块，对应图片中从下往上的行
+                // 因为我们读取的是文件中的连续块，对应图片中从下往上的行 (自上而下的 BMP 除外)
                 // 所以处理缓冲区时，需要从缓冲区尾部向前处理，或者调整指针计算
                 for (int chunkRowIndex = 0; chunkRowIndex < rowsToRead; ++chunkRowIndex)
                 {
@@ -428,32 +661,27 @@ bool ComicViewerPage::drawContent()
                     // 当前处理的行在图片中的实际行号
                     int currentRowInImage = firstRowInChunk + chunkRowIndex;
                     // 获取当前行数据在 rawBuffer 中的起始指针
-                    // rawBuffer[0] 对应图片行 firstRowInChunk + rowsToRead - 1
-                    // rawBuffer[actualRowSize] 对应图片行 firstRowInChunk + rowsToRead - 2
+                    // chunk[0] 对应图片行 firstRowInChunk + rowsToRead - 1
+                    // chunk[actualRowSize] 对应图片行 firstRowInChunk + rowsToRead - 2
                     // ...
-                    // rawBuffer[(rowsToRead - 1 - chunkRowIndex) * actualRowSize] 对应图片行 firstRowInChunk + chunkRowIndex
-                    uint8_t *currentRowPtr = rawBuffer + (rowsToRead - 1 - chunkRowIndex) * actualRowSize;
+                    // chunk[(rowsToRead - 1 - chunkRowIndex) * actualRowSize] 对应图片行 firstRowInChunk + chunkRowIndex
+                    const uint8_t *currentRowPtr = chunk + bmp.rowInChunk(chunkRowIndex, rowsToRead) * actualRowSize;
 
                     // 计算该行在屏幕上的 Y 坐标
-                    // screenRowY = 图片顶部屏幕坐标 + 图片内行号 - 图片内起始读取行号
-                    int screenRowY = yOffset + currentRowInImage - startY;
+                    // screenRowY = 可见区域的起始 Y + 图片内行号 - 图片内起始读取行号
+                    // (图片顶部在屏幕上方时起始读取行 startY 显示在屏幕顶部)
+                    int screenRowY = std::max(0, yOffset) + currentRowInImage - startY;
 
                     // 检查是否在屏幕范围内
                     if (screenRowY >= 0 && screenRowY < SCREEN_HEIGHT)
                     {
-                        // --- 转换 BGR 到 RGB565 ---
-                        for (int col = 0; col < width; col++)
-                        {
-                            pixelBuffer[col] = displayManager.getTFT()->color565(
-                                currentRowPtr[col * BPP + 2],  // R
-                                currentRowPtr[col * BPP + 1],  // G
-                                currentRowPtr[col * BPP + 0]); // B
-                        }
+                        // --- 解码为 RGB565 (BGR888/调色板转换；RGB565 图片直接使用读入的数据) ---
+                        // 24 位图片直接转换为面板字节顺序，推送时不再交换字节
+                        const uint16_t *rowPixels = bmp.decodePanelRow(currentRowPtr, pixelBuffer);
                         // --- 推送一行像素到屏幕 ---
                         // TFT_eSPI 的 pushImage 需要 uint16_t* 数据
-                        // 可能需要设置字节交换，具体取决于 TFT_eSPI 配置和目标硬件
-                        displayManager.getTFT()->setSwapBytes(true);
-                        displayManager.getTFT()->pushImage(0, screenRowY, width, 1, pixelBuffer);
+                        displayManager.getTFT()->setSwapBytes(!bmp.rowsInPanelOrder());
+                        displayManager.getTFT()->pushImage(0, screenRowY, width, 1, rowPixels);
                     }
                 }
                 // --- 结束处理缓冲区 ---
@@ -477,9 +705,11 @@ bool ComicViewerPage::drawContent()
     } // End image loop
     // --- 结束绘制所有可见图片 ---
 
-    // --- Clean up dynamically allocated buffers ---
-    delete[] rawBuffer;
-    delete[] pixelBuffer;
+    // --- Return the strip buffer (arena memory is rewound by the scope) ---
+    if (!stripFromArena)
+    {
+        MemoryBudget::getInstance().releaseTransient(stripBuffer);
+    }
 
     // Note: renderingInterrupted and touchPending flags are set directly within the interrupt checks now.
     // The local touchDetected flag is just for breaking loops.
@@ -550,7 +780,7 @@ bool ComicViewerPage::drawContent()
  */
 void ComicViewerPage::scrollDisplay(int scrollDelta)
 {
-    TFT_eSPI *tft = displayManager.getTFT();
+    DisplayBackend *tft = displayManager.getTFT();
     Serial.print("Scrolling display by delta: ");
     Serial.println(scrollDelta);
 
@@ -612,6 +842,7 @@ void ComicViewerPage::scrollDisplay(int scrollDelta)
  */
 bool ComicViewerPage::drawNewArea(int y, int h)
 {
+    TRACE_SPAN(TraceName::COMIC_DRAW_NEW_AREA);
     Serial.print("Drawing new area: y=");
     Serial.print(y);
     Serial.print(", h=");
@@ -622,6 +853,7 @@ bool ComicViewerPage::drawNewArea(int y, int h)
 
     if (imageFiles.empty())
         return false; // 没有图片可绘制
+    measureVisibleImages(); // 可能移动 scrollOffset (视口上方的估计高度被纠正时)，必须在计算绝对坐标之前
 
     // --- 计算绝对 Y 坐标范围 ---
     // 需要绘制的区域在整个漫画长条中的起始和结束 Y 坐标
@@ -636,7 +868,9 @@ bool ComicViewerPage::drawNewArea(int y, int h)
     // --- 计算图片起始位置 (如果需要) ---
     // 如果 startPositions 不是成员变量或在调用前未计算，需要在这里计算
     // (假设它在 drawContent 或 loadImages 中已计算并可用，或者重新计算)
-    std::vector<int> startPositions;
+    Arena::Scope scratch(arena()); // 本次绘制的临时内存，函数返回时整体回卷
+    std::vector<int, ArenaAllocator<int>> startPositions{ArenaAllocator<int>(&arena(), MemTag::COMIC_BUFFERS)};
+    startPositions.reserve(imageHeights.size());
     int currentHeightSum = 0;
     for (int h_cached : imageHeights)
     { // 使用缓存的高度
@@ -646,24 +880,28 @@ bool ComicViewerPage::drawNewArea(int y, int h)
     // --- 结束计算图片起始位置 ---
 
     // --- 定义缓冲区 (与 drawContent 相同) ---
-    // 缓冲区大小，减少以降低单次 heap 分配大小，缓解碎片问题
-    const int BUFFER_ROWS = 16; // Reduced from 16
-    const int BPP = 3;
-    const int MAX_RAW_ROW_SIZE = ((SCREEN_WIDTH * BPP + 3) & ~3);
-    const int RAW_BUFFER_SIZE = MAX_RAW_ROW_SIZE * BUFFER_ROWS;
-    // Dynamically allocate buffers on the heap
-    uint8_t *rawBuffer = new (std::nothrow) uint8_t[RAW_BUFFER_SIZE];
-    uint16_t *pixelBuffer = new (std::nothrow) uint16_t[SCREEN_WIDTH];
+    const size_t READ_BYTES = SdReadProfile::getInstance().readBytes(SCREEN_WIDTH * sizeof(uint16_t));
+    const int RAW_BUFFER_SIZE = SdReadProfile::alignedBytes(READ_BYTES);
+    // 两个缓冲区放在同一块临时内存中 (来自页面 arena)
+    // arena 不可用时 (例如申请失败) 退回到 MemoryBudget 的临时分配
+    const size_t STRIP_BYTES = RAW_BUFFER_SIZE + SCREEN_WIDTH * sizeof(uint16_t);
+    uint8_t *stripBuffer = arena().allocArray<uint8_t>(STRIP_BYTES);
+    const bool stripFromArena = stripBuffer != nullptr;
+    if (!stripFromArena)
+    {
+        stripBuffer = (uint8_t *)MemoryBudget::getInstance().acquireTransient(STRIP_BYTES, SdReadProfile::BUFFER_CAPS);
+    }
 
     // Check if allocation succeeded
-    if (!rawBuffer || !pixelBuffer)
+    if (!stripBuffer)
     {
+        // 即使内存压力处理后仍然失败：跳过这块区域 (下次完整重绘时补上)，不能使用无效缓冲区继续解码
         Serial.println("ERROR: Failed to allocate drawing buffers in drawNewArea!");
-        delete[] rawBuffer;   // Safe even if nullptr
-        delete[] pixelBuffer; // Safe even if nullptr
-        // Don't return here, maybe just skip drawing the new area or draw an error?
-        // For now, just log and continue (might result in visual glitches)
+        return false;
     }
+    MemStats::Scoped stripStats(MemTag::COMIC_BUFFERS, STRIP_BYTES);
+    uint8_t *rawBuffer = stripBuffer;
+    uint16_t *pixelBuffer = (uint16_t *)(stripBuffer + RAW_BUFFER_SIZE);
     // --- 结束定义缓冲区 ---
 
     bool touchDetected = false; // Flag for touch interruption
@@ -710,21 +948,36 @@ bool ComicViewerPage::drawNewArea(int y, int h)
             if (!file)
                 continue;
 
-            uint8_t header[54];
-            if (file.read(header, 54) != 54 || header[0] != 'B' || header[1] != 'M')
+            if (isQ565Image(imageFiles[i]))
+            {
+                // Q565：从 drawStartRowInImage 所在的重启点开始解码
+                int drawStartRowInImage = std::max(0, startAbsoluteY - imgStartY);
+                int drawEndRowInImage = std::min(imgHeight, endAbsoluteY - imgStartY);
+                int screenY = y + (imgStartY + drawStartRowInImage) - startAbsoluteY;
+                if (readQ565Header(file) && q565View(q565).width <= SCREEN_WIDTH && drawStartRowInImage < drawEndRowInImage)
+                {
+                    touchDetected = drawQ565Rows(file, drawStartRowInImage, drawEndRowInImage, screenY, y, y + h,
+                                                 rawBuffer, READ_BYTES, pixelBuffer);
+                }
+                file.close();
+                if (touchDetected)
+                    break;
+                continue;
+            }
+
+            if (!readBmpHeader(file, rawBuffer))
             {
                 file.close();
                 continue;
             }
-            int width = *(int *)&header[18];
-            int bitsPerPixel = *(short *)&header[28];
-            if (width > SCREEN_WIDTH || bitsPerPixel != 24)
+            int width = bmp.width();
+            if (width > SCREEN_WIDTH)
             {
                 file.close();
                 continue;
             }
-            int rowSize = ((width * BPP + 3) & ~3); // 当前图片的行大小
-            long dataOffset = (*(int *)&header[10]);
+            int rowSize = bmp.rowBytes(); // 当前图片的行大小
+            const int BUFFER_ROWS = std::max(1, (int)(READ_BYTES / rowSize)); // 每次读取的行数
 
             // --- 计算图片内部需要绘制的行范围 ---
             // drawStartRowInImage: 图片内开始绘制的行号 (0-based)
@@ -763,24 +1016,13 @@ bool ComicViewerPage::drawNewArea(int y, int h)
                     // --- End touch check ---
 
                     int rowsToRead = std::min(BUFFER_ROWS, drawEndRowInImage - row);
-                    int bufferBytesToRead = rowsToRead * rowSize;
                     int firstRowInChunk = row;
-                    long pos = dataOffset + (imgHeight - 1 - (firstRowInChunk + rowsToRead - 1)) * rowSize;
-
-                    if (!file.seek(pos))
-                    {
-                        Serial.println("Seek failed in drawNewArea!");
-                        row += rowsToRead;
-                        continue;
-                    }
+                    long pos = bmp.chunkOffset(firstRowInChunk, rowsToRead);
 
-                    size_t actualBytesRead = file.read(rawBuffer, bufferBytesToRead);
-                    if (actualBytesRead != bufferBytesToRead)
+                    const uint8_t *chunk = SdReadProfile::getInstance().readAligned(file, pos, rowsToRead * rowSize, rawBuffer);
+                    if (!chunk)
                     {
-                        Serial.print("Chunk read failed in drawNewArea! Expected ");
-                        Serial.print(bufferBytesToRead);
-                        Serial.print(", got ");
-                        Serial.println(actualBytesRead);
+                        Serial.println("Chunk read failed in drawNewArea!");
                         row += rowsToRead;
                         continue;
                     }
@@ -801,7 +1043,7 @@ bool ComicViewerPage::drawNewArea(int y, int h)
                         // --- End touch check ---
 
                         int currentRowInImage = firstRowInChunk + chunkRowIndex;
-                        uint8_t *currentRowPtr = rawBuffer + (rowsToRead - 1 - chunkRowIndex) * rowSize;
+                        const uint8_t *currentRowPtr = chunk + bmp.rowInChunk(chunkRowIndex, rowsToRead) * rowSize;
 
                         // 计算当前行在屏幕上的目标 Y 坐标
                         int currentScreenY = screenY + (currentRowInImage - drawStartRowInImage);
@@ -809,17 +1051,11 @@ bool ComicViewerPage::drawNewArea(int y, int h)
                         // --- 检查是否在指定的绘制区域 [y, y + h) 内 ---
                         if (currentScreenY >= y && currentScreenY < y + h)
                         {
-                            // 转换 BGR 到 RGB565
-                            for (int col = 0; col < width; col++)
-                            {
-                                pixelBuffer[col] = displayManager.getTFT()->color565(
-                                    currentRowPtr[col * BPP + 2],  // R
-                                    currentRowPtr[col * BPP + 1],  // G
-                                    currentRowPtr[col * BPP + 0]); // B
-                            }
-                            // 推送像素行
-                            displayManager.getTFT()->setSwapBytes(true);
-                            displayManager.getTFT()->pushImage(0, currentScreenY, width, 1, pixelBuffer);
+                            // 解码为 RGB565
+                            const uint16_t *rowPixels = bmp.decodePanelRow(currentRowPtr, pixelBuffer);
+                            // 推送像素行 (面板字节顺序的行不再交换字节)
+                            displayManager.getTFT()->setSwapBytes(!bmp.rowsInPanelOrder());
+                            displayManager.getTFT()->pushImage(0, currentScreenY, width, 1, rowPixels);
                         }
                     } // End row processing loop
 
@@ -889,10 +1125,11 @@ bool ComicViewerPage::drawNewArea(int y, int h)
     }
     // --- End Scroll Bar ---
 
-    // --- Clean up dynamically allocated buffers ---
-    // Important: Only delete if allocation succeeded!
-    delete[] rawBuffer;
-    delete[] pixelBuffer;
+    // --- Return the strip buffer (arena memory is rewound by the scope) ---
+    if (!stripFromArena)
+    {
+        MemoryBudget::getInstance().releaseTransient(stripBuffer);
+    }
 
     // Note: renderingInterrupted and touchPending flags are set directly within the interrupt checks now.
     if (renderingInterrupted)
@@ -909,17 +1146,18 @@ bool ComicViewerPage::drawNewArea(int y, int h)
 }
 
 /**
- * @brief 处理漫画阅读器中的触摸事件，主要用于滚动和返回。
+ * @brief 处理漫画阅读器中的触摸事件，主要用于滚动和打开缩略图网格。
  *
  * @param x 触摸点的 X 坐标。
  * @param y 触摸点的 Y 坐标。
- * @return bool 如果触摸事件被处理（用于滚动或返回），则返回 true；否则返回 false。
+ * @return bool 如果触摸事件被处理（用于滚动或打开网格），则返回 true；否则返回 false。
  *
  * @details
  * - 实现简单的双击检测：如果在 500ms 内连续点击，则触发返回操作。
  * - 根据触摸点的 Y 坐标判断滚动方向：
  *   - 触摸屏幕底部 1/4 区域：向下滚动 (scrollDelta = SCREEN_HEIGHT / 4)。
  *   - 触摸屏幕顶部 1/4 区域：向上滚动 (scrollDelta = -SCREEN_HEIGHT / 4)。
+ *   - 触摸屏幕中间区域：打开缩略图网格 (openGrid)。
  * - 如果确定了滚动方向 (scrollDelta != 0)：
  *   - 记录旧的滚动偏移 (oldScrollOffset)。
  *   - 计算最大允许的滚动偏移 (maxScrollOffset)，基于缓存的总高度。
@@ -1009,8 +1247,9 @@ bool ComicViewerPage::handleScrollGesture(uint16_t x, uint16_t y)
     }
     else if (y > (SCREEN_HEIGHT / 4) && y < (SCREEN_HEIGHT * 3) / 4)
     { // 触摸屏幕中间区域
-        Serial.println("Touch in middle area, going back");
-        Router::getInstance().goBack(); // 返回到上一个页面（文件浏览器）
+        Serial.println("Touch in middle area, opening thumbnail grid");
+        openGrid(); // 缩略图网格 (网格底部的 Exit 返回文件浏览器)
+        return true;
     }
 
     // 如果请求了滚动
@@ -1062,11 +1301,26 @@ void ComicViewerPage::setComicPath(const String &path)
 {
     Serial.print("Setting comic path to: ");
     Serial.println(path);
+    savePosition();     // 切换漫画前保存旧漫画的位置
     currentPath = path; // 更新当前路径
     scrollOffset = 0;   // 重置滚动偏移到顶部
+    currentPage = 0;    // 翻页模式从第一页开始
+    releasePageSlots(); // 旧漫画的页面不再有用
+    cancelMetadataScan();
+    cancelNextChapter();
+    gridOpen = false;
+    retireThumbnailJob(false);
+    thumbnails.close();
+    thumbnailChapter = -1;
+    // 阅读模式来自 .info：{"type": "comic", "mode": "page", "direction": "rtl"}
+    pageMode = sdManager.readInfoValue(path, "mode") == "page";
+    rightToLeft = sdManager.readInfoValue(path, "direction") == "rtl";
+    Serial.printf("Comic mode: %s%s\n", pageMode ? "page" : "scroll", pageMode && rightToLeft ? " (right to left)" : "");
     loadImages();       // 加载新路径下的图片并计算高度
     Serial.print("Image count after loading: ");
     Serial.println(imageFiles.size());
+    chapters.push_back({currentPath, 0}); // 读到末尾时再衔接下一章
+    restorePosition();  // 第一次绘制就显示上次离开时的画面
 }
 
 /**
@@ -1077,6 +1331,16 @@ void ComicViewerPage::display()
 {
     Serial.print("Display called, image count: ");
     Serial.println(imageFiles.size());
+    if (gridOpen)
+    {
+        drawGrid();
+        return;
+    }
+    if (pageMode)
+    {
+        showPage(currentPage); // 翻页模式：整屏显示当前页
+        return;
+    }
     // 绘制内容（会根据当前的 scrollOffset 绘制）
     renderingInterrupted = drawContent(); // Check return value
 }
@@ -1115,19 +1379,73 @@ void ComicViewerPage::handleTouch(uint16_t x, uint16_t y)
 void ComicViewerPage::cleanup()
 {
     Serial.println("ComicViewerPage::cleanup() called.");
+    savePosition();     // 下次打开时从这里继续
+    releasePageSlots(); // 先停止后台解码任务，再释放页面缓冲区
+    retireThumbnailJob(false);
+    cancelMetadataScan();
+    cancelNextChapter();
     imageFiles.clear();
     imageFiles.shrink_to_fit(); // Attempt to release vector memory
     imageHeights.clear();
     imageHeights.shrink_to_fit(); // Attempt to release vector memory
+    imageStarts.clear();
+    imageStarts.shrink_to_fit();
+    imageMeasured.clear();
+    imageMeasured.shrink_to_fit();
+    gridOpen = false;
+    thumbnails.close();
+    thumbnailChapter = -1;
     // Reset other state if necessary
     currentPath = "";
     scrollOffset = 0;
+    currentPage = 0;
     totalComicHeight = 0;
     Serial.println("ComicViewerPage resources cleaned up.");
 }
 
 void ComicViewerPage::handleLoop()
 {
+    // Page mode: collect finished background decodes (never block the main loop on them)
+    for (int i = 0; pageSlotsAllocated && i < COMIC_PAGE_SLOTS; i++)
+    {
+        if (pageSlots[i].job && pageSlots[i].job->isReady())
+        {
+            retirePageJob(pageSlots[i], true);
+        }
+    }
+
+    // Lazy metadata: replace estimated heights once the background header scan is done
+    applyMetadataScan();
+
+    // Chapter chaining: append the next chapter once its background scan is done, start the scan near the end
+    appendNextChapter();
+    prefetchNextChapter();
+
+    // Thumbnail grid: append the thumbnail scaled in the background (the job wakes the loop when it is done)
+    if (thumbnailJob && thumbnailJob->isReady())
+    {
+        retireThumbnailJob(true);
+    }
+
+    // Taps go to the grid; otherwise start scaling the next missing thumbnail
+    if (gridOpen)
+    {
+        if (touchPending)
+        {
+            touchPending = false;
+            handleGridTap(lastTouchX, lastTouchY);
+            return;
+        }
+        startNextThumbnail();
+        return;
+    }
+
+    if (pageMode && touchPending)
+    {
+        touchPending = false;
+        handlePageTap(lastTouchX, lastTouchY);
+        return;
+    }
 
     // Priority 1: Process pending touch events (only if rendering is complete)
     if (touchPending)
@@ -1152,3 +1470,871 @@ void ComicViewerPage::handleLoop()
         // This will be handled in the next loop iteration.
     }
 }
+
+// --- 翻页模式 ---
+
+// 翻页模式的解码请求归后台任务所有
+static void deletePageDecodeRequest(void *arg)
+{
+    delete static_cast<BmpScaler::Request *>(arg);
+}
+
+// 在 JobSystem 工作线程上解码一页到页面缓冲区
+static bool decodePageJob(JobFuture &job, void *arg)
+{
+    return BmpScaler::decode(*static_cast<BmpScaler::Request *>(arg), &job);
+}
+
+// 直接绘制时每个条带解码完成后推送到屏幕
+static void pushPageBand(void *ctx, int y, int rows, const uint16_t *pixels)
+{
+    DisplayBackend *tft = static_cast<Display *>(ctx)->getTFT();
+    tft->setSwapBytes(true);
+    tft->pushImage(0, y, SCREEN_WIDTH, rows, pixels);
+}
+
+ComicViewerPage::~ComicViewerPage()
+{
+    releasePageSlots();
+    retireThumbnailJob(false);
+    cancelMetadataScan();
+    cancelNextChapter();
+}
+
+// 分配整屏页面缓冲区。只在有 PSRAM 时分配 (没有 PSRAM 时内部 RAM 放不下，也不应该为此挤占其他缓存)
+bool ComicViewerPage::allocatePageSlots()
+{
+    if (pageSlotsAllocated)
+    {
+        return true;
+    }
+    if (!MemoryBudget::getInstance().hasPsram())
+    {
+        return false;
+    }
+    const size_t bytes = (size_t)SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t);
+    for (int i = 0; i < COMIC_PAGE_SLOTS; i++)
+    {
+        pageSlots[i] = {nullptr, -1, false, nullptr};
+    }
+    for (int i = 0; i < COMIC_PAGE_SLOTS; i++)
+    {
+        pageSlots[i].pixels = (uint16_t *)MemoryBudget::getInstance().allocate(bytes);
+        if (!pageSlots[i].pixels)
+        {
+            Serial.println("Comic page mode: page buffer allocation failed, drawing pages directly.");
+            for (int j = 0; j < i; j++)
+            {
+                free(pageSlots[j].pixels);
+                MemStats::getInstance().recordFree(MemTag::COMIC_BUFFERS, bytes);
+                pageSlots[j].pixels = nullptr;
+            }
+            return false;
+        }
+        MemStats::getInstance().recordAlloc(MemTag::COMIC_BUFFERS, bytes);
+    }
+    pageSlotsAllocated = true;
+    return true;
+}
+
+void ComicViewerPage::releasePageSlots()
+{
+    if (!pageSlotsAllocated)
+    {
+        return;
+    }
+    const size_t bytes = (size_t)SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t);
+    for (int i = 0; i < COMIC_PAGE_SLOTS; i++)
+    {
+        // 工作线程写完 (或放弃) 之前不能释放缓冲区
+        if (!retirePageJob(pageSlots[i], false))
+        {
+            Serial.println("Comic page mode: decode job did not stop, leaking its page buffer.");
+            continue;
+        }
+        free(pageSlots[i].pixels);
+        MemStats::getInstance().recordFree(MemTag::COMIC_BUFFERS, bytes);
+        pageSlots[i] = {nullptr, -1, false, nullptr};
+    }
+    pageSlotsAllocated = false;
+}
+
+ComicViewerPage::PageSlot *ComicViewerPage::findPageSlot(int page)
+{
+    for (int i = 0; i < COMIC_PAGE_SLOTS; i++)
+    {
+        if (pageSlots[i].page == page)
+        {
+            return &pageSlots[i];
+        }
+    }
+    return nullptr;
+}
+
+ComicViewerPage::PageSlot *ComicViewerPage::reusablePageSlot()
+{
+    for (int i = 0; i < COMIC_PAGE_SLOTS; i++)
+    {
+        int page = pageSlots[i].page;
+        if (page < 0 || page < currentPage - 1 || page > currentPage + 1)
+        {
+            return &pageSlots[i];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 结束缓冲区上的后台任务。
+ * @param keepResult true: 等待任务完成并保留结果 (翻到正在解码的页面)；false: 取消任务，缓冲区变为空。
+ * @return 缓冲区已不再被工作线程使用时返回 true (等待超时返回 false，此时不能复用或释放缓冲区)。
+ */
+bool ComicViewerPage::retirePageJob(PageSlot &slot, bool keepResult)
+{
+    if (slot.job)
+    {
+        if (!keepResult)
+        {
+            slot.job->cancel(); // 工作线程在下一行检查
+        }
+        if (!slot.job->wait(COMIC_PAGE_WAIT_MS))
+        {
+            return false;
+        }
+        slot.ready = keepResult && slot.job->succeeded();
+        Serial.printf("Comic page %d decode %s: queued %lu us, ran %lu us\n", slot.page + 1,
+                      slot.job->succeeded() ? "done" : "stopped", (unsigned long)slot.job->queueTimeUs(),
+                      (unsigned long)slot.job->runTimeUs());
+        slot.job->release();
+        slot.job = nullptr;
+    }
+    if (!slot.ready)
+    {
+        slot.page = -1;
+    }
+    return true;
+}
+
+// 在后台把第 page 张图片解码到一个空闲的页面缓冲区 (已在缓冲区中或超出范围时不做任何事)
+void ComicViewerPage::prefetchPage(int page)
+{
+    if (!pageSlotsAllocated || page < 0 || page >= (int)imageFiles.size() || findPageSlot(page))
+    {
+        return;
+    }
+    PageSlot *slot = reusablePageSlot();
+    if (!slot || !retirePageJob(*slot, false))
+    {
+        return;
+    }
+    BmpScaler::Request *request = new (std::nothrow) BmpScaler::Request(imageFiles[page], slot->pixels, SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (!request)
+    {
+        return;
+    }
+    slot->page = page;
+    slot->ready = false;
+    slot->job = JobSystem::getInstance().submit(JobType::SD_READ, decodePageJob, request, deletePageDecodeRequest);
+    if (!slot->job)
+    {
+        slot->page = -1; // 队列已满 (请求已被释放)，翻到这一页时再同步解码
+    }
+}
+
+void ComicViewerPage::showPage(int page)
+{
+    if (imageFiles.empty())
+    {
+        displayManager.getTFT()->fillScreen(TFT_WHITE);
+        displayManager.drawCenteredText("No images found", 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+        return;
+    }
+    currentPage = std::max(0, std::min(page, (int)imageFiles.size() - 1));
+    Serial.printf("Comic page mode: showing page %d / %u\n", currentPage + 1, (unsigned)imageFiles.size());
+    DisplayBackend *tft = displayManager.getTFT();
+
+    if (!allocatePageSlots())
+    {
+        // 没有页面缓冲区：逐条带解码并推送 (条带缓冲区来自页面 arena)
+        Arena::Scope scratch(arena());
+        const size_t bandBytes = (size_t)SCREEN_WIDTH * COMIC_PAGE_BAND_ROWS * sizeof(uint16_t);
+        uint16_t *band = arena().allocArray<uint16_t>(SCREEN_WIDTH * COMIC_PAGE_BAND_ROWS);
+        const bool bandFromArena = band != nullptr;
+        if (!bandFromArena)
+        {
+            band = (uint16_t *)MemoryBudget::getInstance().acquireTransient(bandBytes);
+        }
+        std::unique_ptr<BmpScaler::Request> request(new (std::nothrow) BmpScaler::Request(imageFiles[currentPage], band, SCREEN_WIDTH, SCREEN_HEIGHT));
+        if (request)
+        {
+            request->bandRows = COMIC_PAGE_BAND_ROWS;
+            request->bandDone = pushPageBand;
+            request->ctx = &displayManager;
+        }
+        if (!band || !request || !BmpScaler::decode(*request, nullptr))
+        {
+            tft->fillScreen(TFT_WHITE);
+            displayManager.drawCenteredText(band ? "Cannot open page" : "Memory Error", 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+        }
+        if (band && !bandFromArena)
+        {
+            MemoryBudget::getInstance().releaseTransient(band);
+        }
+        return;
+    }
+
+    // 1. 取得这一页：已解码直接用，正在解码就等它完成，否则同步解码到一个空闲缓冲区
+    PageSlot *slot = findPageSlot(currentPage);
+    if (slot && slot->job)
+    {
+        retirePageJob(*slot, true);
+    }
+    if (!slot || !slot->ready)
+    {
+        slot = slot ? slot : reusablePageSlot();
+        if (slot && retirePageJob(*slot, false))
+        {
+            std::unique_ptr<BmpScaler::Request> request(new (std::nothrow) BmpScaler::Request(imageFiles[currentPage], slot->pixels, SCREEN_WIDTH, SCREEN_HEIGHT));
+            slot->ready = request && BmpScaler::decode(*request, nullptr);
+            slot->page = slot->ready ? currentPage : -1;
+        }
+    }
+
+    // 2. 整屏一次推送
+    if (slot && slot->ready)
+    {
+        tft->setSwapBytes(true);
+        tft->pushImage(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, slot->pixels);
+    }
+    else
+    {
+        tft->fillScreen(TFT_WHITE);
+        displayManager.drawCenteredText("Cannot open page", 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+
+    // 3. 在后台准备下一页 (先) 和上一页
+    prefetchPage(currentPage + 1);
+    prefetchPage(currentPage - 1);
+}
+
+void ComicViewerPage::handlePageTap(uint16_t x, uint16_t y)
+{
+    const int zoneWidth = SCREEN_WIDTH / 3;
+    int step = 0;
+    if (x < zoneWidth)
+    {
+        step = rightToLeft ? 1 : -1; // 左侧
+    }
+    else if (x >= SCREEN_WIDTH - zoneWidth)
+    {
+        step = rightToLeft ? -1 : 1; // 右侧
+    }
+    else
+    {
+        Serial.println("Touch in middle area, opening thumbnail grid");
+        openGrid(); // 与滚动模式相同：点击中间打开缩略图网格
+        return;
+    }
+
+    int target = currentPage + step;
+    if (target < 0 || target >= (int)imageFiles.size())
+    {
+        Serial.println("Comic page mode: no more pages in this direction.");
+        return;
+    }
+    showPage(target);
+}
+
+// --- 缩略图网格 ---
+
+int ComicViewerPage::currentImage() const
+{
+    if (pageMode)
+    {
+        return currentPage;
+    }
+    // 视口顶部所在的图片：最后一个起点不大于 scrollOffset 的图片
+    int image = (int)(std::upper_bound(imageStarts.begin(), imageStarts.end(), scrollOffset) - imageStarts.begin()) - 1;
+    return std::max(0, image);
+}
+
+void ComicViewerPage::openGrid()
+{
+    if (imageFiles.empty())
+    {
+        Router::getInstance().goBack(); // 没有图片时中间点击仍然返回
+        return;
+    }
+    // 网格显示当前图片所在的章节；缩略图文件属于这一章
+    const int image = currentImage();
+    gridChapter = chapterOf(image);
+    const int chapterFirst = chapters[gridChapter].firstImage;
+    if (thumbnailChapter != gridChapter)
+    {
+        retireThumbnailJob(false); // 任务的结果属于另一章的缩略图文件
+        thumbnailChapter = gridChapter;
+        if (!thumbnails.open(chapters[gridChapter].path, chapterEnd(gridChapter) - chapterFirst, COMIC_THUMB_WIDTH, COMIC_THUMB_HEIGHT))
+        {
+            Serial.println("Thumbnails: no thumbnail file, showing the grid without thumbnails.");
+        }
+    }
+    gridOpen = true;
+    gridFirst = chapterFirst + (image - chapterFirst) / GRID_CELLS * GRID_CELLS;
+    drawGrid();
+}
+
+void ComicViewerPage::gridThumbnailPosition(int index, int &x, int &y) const
+{
+    int cell = index - gridFirst;
+    x = (cell % COMIC_GRID_COLUMNS) * GRID_CELL_WIDTH + (GRID_CELL_WIDTH - COMIC_THUMB_WIDTH) / 2;
+    y = (cell / COMIC_GRID_COLUMNS) * GRID_CELL_HEIGHT + (GRID_CELL_HEIGHT - COMIC_THUMB_HEIGHT - 10) / 2; // 下面留 10 像素给页码
+}
+
+// 推送一张缩略图 (pixels 为空时画占位框)，当前图片加蓝色边框，下面写章节内的页码
+void ComicViewerPage::drawGridThumbnail(int index, const uint16_t *pixels)
+{
+    DisplayBackend *tft = displayManager.getTFT();
+    int x, y;
+    gridThumbnailPosition(index, x, y);
+    if (pixels)
+    {
+        tft->setSwapBytes(true);
+        tft->pushImage(x, y, COMIC_THUMB_WIDTH, COMIC_THUMB_HEIGHT, pixels);
+    }
+    else
+    {
+        tft->fillRect(x, y, COMIC_THUMB_WIDTH, COMIC_THUMB_HEIGHT, TFT_LIGHTGREY);
+        tft->drawRect(x, y, COMIC_THUMB_WIDTH, COMIC_THUMB_HEIGHT, TFT_DARKGREY);
+    }
+    if (index == currentImage())
+    {
+        tft->drawRect(x - 2, y - 2, COMIC_THUMB_WIDTH + 4, COMIC_THUMB_HEIGHT + 4, TFT_BLUE);
+        tft->drawRect(x - 1, y - 1, COMIC_THUMB_WIDTH + 2, COMIC_THUMB_HEIGHT + 2, TFT_BLUE);
+    }
+    // 内建 6x8 字体，不经过字形缓存
+    tft->setTextFont(1);
+    tft->setTextSize(1);
+    tft->setTextDatum(MC_DATUM);
+    tft->setTextColor(TFT_BLACK, TFT_WHITE);
+    tft->drawString(String(index - chapters[gridChapter].firstImage + 1), x + COMIC_THUMB_WIDTH / 2, y + COMIC_THUMB_HEIGHT + 7);
+    tft->setTextFont(TEXT_FONT);
+}
+
+// readRange 的回调：缩略图文件中的索引是章节内的索引
+void ComicViewerPage::drawGridThumbnailCallback(void *ctx, int index, const uint16_t *pixels)
+{
+    ComicViewerPage *page = static_cast<ComicViewerPage *>(ctx);
+    page->drawGridThumbnail(page->chapters[page->gridChapter].firstImage + index, pixels);
+}
+
+int ComicViewerPage::nextMissingThumbnail(int from) const
+{
+    if (!thumbnails.isOpen())
+    {
+        return -1;
+    }
+    const int chapterFirst = chapters[gridChapter].firstImage;
+    int end = std::min(gridFirst + GRID_CELLS, chapterEnd(gridChapter));
+    for (int i = std::max(from, gridFirst); i < end; i++)
+    {
+        if (!thumbnails.has(i - chapterFirst))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void ComicViewerPage::drawGrid()
+{
+    DisplayBackend *tft = displayManager.getTFT();
+    tft->fillScreen(TFT_WHITE);
+    const int chapterFirst = chapters[gridChapter].firstImage;
+    const int chapterLast = chapterEnd(gridChapter);
+    const int count = std::min(GRID_CELLS, chapterLast - gridFirst);
+
+    // 底部按钮：上一屏、回到阅读位置、退出漫画、下一屏 (各占四分之一宽度)
+    static const char *const labels[] = {"<", "Resume", "Exit", ">"};
+    const int quarter = SCREEN_WIDTH / 4;
+    const int footerY = SCREEN_HEIGHT - GRID_FOOTER_HEIGHT;
+    for (int i = 0; i < 4; i++)
+    {
+        bool enabled = (i != 0 || gridFirst > chapterFirst) && (i != 3 || gridFirst + GRID_CELLS < chapterLast);
+        WidgetCache::getInstance().drawButton(labels[i], i * quarter + (quarter - GRID_BUTTON_WIDTH) / 2, footerY + 2,
+                                              GRID_BUTTON_WIDTH, GRID_FOOTER_HEIGHT - 4, enabled ? TFT_BLUE : TFT_DARKGREY,
+                                              TFT_WHITE, 1, true, TFT_WHITE);
+    }
+
+    // 未生成的缩略图先画占位框
+    for (int i = gridFirst; i < gridFirst + count; i++)
+    {
+        if (!thumbnails.has(i - chapterFirst))
+        {
+            drawGridThumbnail(i, nullptr);
+        }
+    }
+
+    // 已生成的缩略图：有 PSRAM 时整屏一个缓冲区 (连续存放时一次读取)，否则用页面 arena 放得下的张数
+    const size_t thumbBytes = thumbnails.thumbnailBytes();
+    if (thumbnails.isOpen() && count > 0 && thumbBytes > 0)
+    {
+        Arena::Scope scratch(arena());
+        int bufferThumbnails = 0;
+        uint16_t *buffer = nullptr;
+        size_t heapBytes = 0;
+        if (MemoryBudget::getInstance().hasPsram())
+        {
+            heapBytes = thumbBytes * count;
+            buffer = (uint16_t *)MemoryBudget::getInstance().allocate(heapBytes);
+            bufferThumbnails = buffer ? count : 0;
+        }
+        if (!buffer)
+        {
+            heapBytes = 0;
+            bufferThumbnails = std::min(count, (int)((arena().capacity() - arena().used()) / thumbBytes));
+            buffer = bufferThumbnails > 0 ? arena().allocArray<uint16_t>(bufferThumbnails * thumbBytes / sizeof(uint16_t)) : nullptr;
+        }
+        if (buffer)
+        {
+            MemStats::Scoped bufferStats(MemTag::COMIC_BUFFERS, heapBytes);
+            int reads = thumbnails.readRange(gridFirst - chapterFirst, count, buffer, bufferThumbnails, drawGridThumbnailCallback, this);
+            Serial.printf("Comic grid: images %d-%d, %d file reads\n", gridFirst - chapterFirst + 1, gridFirst - chapterFirst + count, reads);
+            if (heapBytes)
+            {
+                free(buffer);
+            }
+        }
+    }
+    gridNextMissing = nextMissingThumbnail(gridFirst);
+}
+
+// 在 JobSystem 工作线程上把一张图片缩小为缩略图
+static bool decodeThumbnailJob(JobFuture &job, void *arg)
+{
+    TRACE_SPAN(TraceName::COMIC_THUMBNAIL);
+    return BmpScaler::decode(*static_cast<BmpScaler::Request *>(arg), &job);
+}
+
+void ComicViewerPage::startNextThumbnail()
+{
+    if (thumbnailJob || gridNextMissing < 0)
+    {
+        return;
+    }
+    // 网格重绘时正在生成的那张可能已经写入文件：从当前位置重新找
+    const int index = nextMissingThumbnail(gridNextMissing);
+    if (index < 0)
+    {
+        gridNextMissing = -1;
+        return;
+    }
+    const size_t bytes = thumbnails.thumbnailBytes();
+    thumbnailPixels = (uint16_t *)MemoryBudget::getInstance().allocate(bytes);
+    if (!thumbnailPixels)
+    {
+        Serial.println("Thumbnails: no memory for the thumbnail buffer.");
+        return; // 下一轮主循环再试
+    }
+    MemStats::getInstance().recordAlloc(MemTag::COMIC_BUFFERS, bytes);
+    BmpScaler::Request *request = new (std::nothrow) BmpScaler::Request(imageFiles[index], thumbnailPixels, thumbnails.width(), thumbnails.height());
+    if (request)
+    {
+        thumbnailJob = JobSystem::getInstance().submit(JobType::SD_READ, decodeThumbnailJob, request, deletePageDecodeRequest);
+    }
+    if (!thumbnailJob)
+    {
+        free(thumbnailPixels); // 队列已满 (请求已被释放)：下一轮主循环再试
+        MemStats::getInstance().recordFree(MemTag::COMIC_BUFFERS, bytes);
+        thumbnailPixels = nullptr;
+        return;
+    }
+    thumbnailJobImage = index;
+    gridNextMissing = nextMissingThumbnail(index + 1); // 失败的图片不再重试
+}
+
+bool ComicViewerPage::retireThumbnailJob(bool keepResult)
+{
+    if (!thumbnailJob)
+    {
+        return true;
+    }
+    if (!keepResult)
+    {
+        thumbnailJob->cancel(); // 工作线程在下一行检查
+    }
+    const bool stopped = thumbnailJob->wait(COMIC_PAGE_WAIT_MS);
+    const int index = thumbnailJobImage;
+    if (stopped && keepResult)
+    {
+        // 缩略图文件只在主循环中写入
+        if (thumbnailJob->succeeded() && thumbnails.isOpen() &&
+            thumbnails.append(index - chapters[thumbnailChapter].firstImage, thumbnailPixels))
+        {
+            if (gridOpen && gridChapter == thumbnailChapter && index >= gridFirst && index < gridFirst + GRID_CELLS)
+            {
+                drawGridThumbnail(index, thumbnailPixels);
+            }
+        }
+        else
+        {
+            Serial.printf("Thumbnails: cannot generate the thumbnail of %s\n", imageFiles[index].c_str());
+        }
+        Serial.printf("Thumbnail %d: queued %lu us, ran %lu us\n", index - chapters[thumbnailChapter].firstImage + 1,
+                      (unsigned long)thumbnailJob->queueTimeUs(), (unsigned long)thumbnailJob->runTimeUs());
+    }
+    thumbnailJob->release();
+    thumbnailJob = nullptr;
+    thumbnailJobImage = -1;
+    if (!stopped)
+    {
+        Serial.println("Thumbnails: scale job did not stop, leaking its buffer.");
+        thumbnailPixels = nullptr; // 工作线程可能还在写入
+        return false;
+    }
+    free(thumbnailPixels);
+    MemStats::getInstance().recordFree(MemTag::COMIC_BUFFERS, thumbnails.thumbnailBytes());
+    thumbnailPixels = nullptr;
+    return true;
+}
+
+void ComicViewerPage::handleGridTap(uint16_t x, uint16_t y)
+{
+    if (y >= SCREEN_HEIGHT - GRID_FOOTER_HEIGHT)
+    {
+        switch (x * 4 / SCREEN_WIDTH)
+        {
+        case 0: // 上一屏
+            if (gridFirst > chapters[gridChapter].firstImage)
+            {
+                gridFirst -= GRID_CELLS;
+                drawGrid();
+            }
+            break;
+        case 1: // 回到网格打开前的位置
+            jumpToImage(-1);
+            break;
+        case 2:
+            Serial.println("Comic grid: exit");
+            Router::getInstance().goBack(); // 返回到上一个页面（文件浏览器）
+            break;
+        default: // 下一屏
+            if (gridFirst + GRID_CELLS < chapterEnd(gridChapter))
+            {
+                gridFirst += GRID_CELLS;
+                drawGrid();
+            }
+            break;
+        }
+        return;
+    }
+
+    int column = x / GRID_CELL_WIDTH;
+    int row = y / GRID_CELL_HEIGHT;
+    int index = gridFirst + row * COMIC_GRID_COLUMNS + column;
+    if (column < COMIC_GRID_COLUMNS && row < COMIC_GRID_ROWS && index < chapterEnd(gridChapter))
+    {
+        jumpToImage(index);
+    }
+}
+
+void ComicViewerPage::jumpToImage(int image)
+{
+    gridOpen = false;
+    gridNextMissing = -1;
+    if (image < 0)
+    {
+        display(); // 不跳转：重新绘制当前位置
+        return;
+    }
+    Serial.printf("Comic grid: jump to image %d\n", image + 1);
+    if (pageMode)
+    {
+        showPage(image);
+        return;
+    }
+    // 滚动模式：前缀和直接给出图片顶部的位置
+    int maxScrollOffset = (totalComicHeight > SCREEN_HEIGHT) ? (totalComicHeight - SCREEN_HEIGHT) : 0;
+    scrollOffset = std::min(imageStarts[image], maxScrollOffset);
+    renderingInterrupted = drawContent();
+}
+
+// --- 章节连读 ---
+
+int ComicViewerPage::chapterOf(int image) const
+{
+    int chapter = 0;
+    while (chapter + 1 < (int)chapters.size() && chapters[chapter + 1].firstImage <= image)
+    {
+        chapter++;
+    }
+    return chapter;
+}
+
+int ComicViewerPage::chapterEnd(int chapter) const
+{
+    return chapter + 1 < (int)chapters.size() ? chapters[chapter + 1].firstImage : (int)imageFiles.size();
+}
+
+/**
+ * @brief 读取下一章的参数和结果。提交方持有 future 期间可以读取结果，future 释放后由任务删除。
+ */
+struct ComicViewerPage::ChapterScan
+{
+    String fromDir;             // 画布中最后一章
+    String dir;                 // 结果：下一章目录 (没有时为空)
+    std::vector<String> files;  // 结果：下一章的图片路径
+    std::vector<int> heights;   // 结果：每张图片的高度
+};
+
+void ComicViewerPage::deleteChapterScan(void *arg)
+{
+    delete static_cast<ChapterScan *>(arg);
+}
+
+// 逐张读取 scan.dir 中从 1.bmp (或 1.q565) 开始的连续图片的高度 (在 JobSystem 工作线程上执行)
+void ComicViewerPage::scanImages(JobFuture &job, ChapterScan &scan)
+{
+    SDCard &sd = SDCard::getInstance();
+    BmpRowDecoder decoder; // 工作线程自己的解码器 (页面的 bmp 属于主循环)
+    const char *extension = imageExtension(sd, scan.dir);
+    for (int index = 1; !job.isCancelled(); index++)
+    {
+        String imagePath = scan.dir + "/" + String(index) + extension;
+        if (!sd.exists(imagePath))
+        {
+            break;
+        }
+        scan.files.push_back(imagePath);
+        scan.heights.push_back(readImageHeight(sd, imagePath, decoder));
+    }
+}
+
+// 在 JobSystem 工作线程上查找下一章并读取它的图片列表和高度
+bool ComicViewerPage::scanNextChapterJob(JobFuture &job, void *arg)
+{
+    ChapterScan &scan = *static_cast<ChapterScan *>(arg);
+    scan.dir = SDCard::getInstance().nextSiblingComic(scan.fromDir);
+    if (scan.dir.length() == 0)
+    {
+        return false;
+    }
+    scanImages(job, scan);
+    return !job.isCancelled() && !scan.files.empty();
+}
+
+void ComicViewerPage::prefetchNextChapter()
+{
+    if (chapterJob || chapterChainEnded || metadataJob || chapters.empty() || imageFiles.empty())
+    {
+        return; // 打开的目录还在扫描时图片数可能还会变化，等它完成
+    }
+    bool nearEnd = pageMode ? currentPage >= (int)imageFiles.size() - COMIC_CHAPTER_PREFETCH_SCREENS
+                            : scrollOffset + SCREEN_HEIGHT * (1 + COMIC_CHAPTER_PREFETCH_SCREENS) >= totalComicHeight;
+    if (!nearEnd)
+    {
+        return;
+    }
+    chapterScan = new (std::nothrow) ChapterScan();
+    if (!chapterScan)
+    {
+        return;
+    }
+    chapterScan->fromDir = chapters.back().path;
+    chapterJob = JobSystem::getInstance().submit(JobType::SD_READ, scanNextChapterJob, chapterScan, deleteChapterScan);
+    if (!chapterJob)
+    {
+        chapterScan = nullptr; // 队列已满 (参数已被释放)，下一轮再试
+    }
+}
+
+void ComicViewerPage::appendNextChapter()
+{
+    if (!chapterJob || !chapterJob->isReady())
+    {
+        return;
+    }
+    if (chapterJob->succeeded())
+    {
+        // 下一章接在画布末尾：滚动和翻页直接继续，不需要重新加载
+        const int first = (int)imageFiles.size();
+        chapters.push_back({chapterScan->dir, first});
+        for (size_t i = 0; i < chapterScan->files.size(); i++)
+        {
+            imageFiles.push_back(chapterScan->files[i]);
+            imageHeights.push_back(chapterScan->heights[i]);
+            imageMeasured.push_back(true);
+            imageStarts.push_back(totalComicHeight);
+            totalComicHeight += chapterScan->heights[i];
+        }
+        Serial.printf("Comic chapters: chained %s (%u images, scanned in %lu us)\n", chapterScan->dir.c_str(),
+                      (unsigned)chapterScan->files.size(), (unsigned long)chapterJob->runTimeUs());
+        if (pageMode)
+        {
+            prefetchPage(currentPage + 1); // 最后一页的下一页现在是下一章的第一页
+        }
+    }
+    else
+    {
+        chapterChainEnded = true;
+        Serial.println("Comic chapters: no next chapter.");
+    }
+    chapterJob->release();
+    chapterJob = nullptr;
+    chapterScan = nullptr;
+}
+
+void ComicViewerPage::cancelNextChapter()
+{
+    if (chapterJob)
+    {
+        chapterJob->cancel(); // 参数归任务所有，不必等待任务结束
+        chapterJob->release();
+        chapterJob = nullptr;
+        chapterScan = nullptr;
+    }
+    chapters.clear();
+    chapterChainEnded = false;
+}
+
+// --- 图片高度的后台扫描 ---
+
+// 在 JobSystem 工作线程上读取打开的目录中所有图片的高度 (也确认实际的图片数)
+bool ComicViewerPage::scanImagesJob(JobFuture &job, void *arg)
+{
+    scanImages(job, *static_cast<ChapterScan *>(arg));
+    return !job.isCancelled();
+}
+
+void ComicViewerPage::startMetadataScan()
+{
+    metadataScan = new (std::nothrow) ChapterScan();
+    if (!metadataScan)
+    {
+        return; // 只用估计值：视口中的图片绘制前仍会实测
+    }
+    metadataScan->dir = currentPath;
+    metadataJob = JobSystem::getInstance().submit(JobType::SD_READ, scanImagesJob, metadataScan, deleteChapterScan);
+    if (!metadataJob)
+    {
+        metadataScan = nullptr; // 队列已满 (参数已被释放)
+    }
+}
+
+void ComicViewerPage::applyMetadataScan()
+{
+    if (!metadataJob || !metadataJob->isReady())
+    {
+        return;
+    }
+    if (metadataJob->succeeded())
+    {
+        // 扫描期间只有这一章 (章节连读等待扫描完成)
+        const int count = std::min((int)metadataScan->heights.size(), (int)imageFiles.size());
+        if (count < (int)imageFiles.size())
+        {
+            // 编号中间有空缺：与逐张查找相同，只保留第一个空缺之前的图片
+            Serial.printf("Comic images: only %d consecutive images, dropping %u\n", count, (unsigned)(imageFiles.size() - count));
+            imageFiles.resize(count);
+            imageHeights.resize(count);
+            imageStarts.resize(count);
+            imageMeasured.resize(count);
+            totalComicHeight = count > 0 ? imageStarts[count - 1] + imageHeights[count - 1] : 0;
+            currentPage = std::min(currentPage, std::max(0, count - 1));
+        }
+        for (int i = 0; i < count; i++)
+        {
+            if (!imageMeasured[i])
+            {
+                setImageHeight(i, metadataScan->heights[i]);
+            }
+        }
+        Serial.printf("Comic images: all %d heights read in %lu us, total height %d\n", count,
+                      (unsigned long)metadataJob->runTimeUs(), totalComicHeight);
+    }
+    metadataJob->release();
+    metadataJob = nullptr;
+    metadataScan = nullptr;
+}
+
+void ComicViewerPage::cancelMetadataScan()
+{
+    if (metadataJob)
+    {
+        metadataJob->cancel(); // 参数归任务所有，不必等待任务结束
+        metadataJob->release();
+        metadataJob = nullptr;
+        metadataScan = nullptr;
+    }
+}
+
+// --- 阅读位置 ---
+
+void ComicViewerPage::savePosition()
+{
+    if (currentPath.length() == 0 || imageFiles.empty() || chapters.empty())
+    {
+        return;
+    }
+    // 位置属于正在阅读的章节 (已衔接到下一章时保存到下一章的目录，坐标相对于章节开头)
+    const int image = currentImage();
+    const int chapter = chapterOf(image);
+    const int first = chapters[chapter].firstImage;
+    // 只保存图片和图片内的行：打开时前面图片的高度可能还是估计值，绝对滚动偏移没有意义
+    StaticJsonDocument<JSON_OBJECT_SIZE(2)> doc;
+    doc["image"] = image - first;
+    doc["row"] = pageMode ? 0 : scrollOffset - imageStarts[image];
+    File file = sdManager.openFile(chapters[chapter].path + "/" + COMIC_POSITION_FILE, FILE_WRITE);
+    if (!file || serializeJson(doc, file) == 0)
+    {
+        Serial.println("Comic position: cannot write the position file.");
+    }
+    if (file)
+    {
+        file.close();
+    }
+}
+
+void ComicViewerPage::restorePosition()
+{
+    const String positionPath = currentPath + "/" + COMIC_POSITION_FILE;
+    if (imageFiles.empty() || !sdManager.exists(positionPath))
+    {
+        return;
+    }
+    File file = sdManager.openFile(positionPath);
+    if (!file)
+    {
+        return;
+    }
+    StaticJsonDocument<JSON_OBJECT_SIZE(4) + 32> doc; // 从文件读取时键名复制到文档中 (旧版本的文件还有两个键)
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    if (error)
+    {
+        Serial.printf("Comic position: ignoring unreadable position file (%s)\n", error.c_str());
+        return;
+    }
+
+    const int image = doc["image"].as<int>();
+    if (image < 0 || image >= (int)imageFiles.size())
+    {
+        return;
+    }
+    if (!pageMode && !imageMeasured[image])
+    {
+        setImageHeight(image, readImageHeight(sdManager, imageFiles[image], bmp)); // 行号按这张图片的实际高度限制
+    }
+    int maxScrollOffset = (totalComicHeight > SCREEN_HEIGHT) ? (totalComicHeight - SCREEN_HEIGHT) : 0;
+    scrollOffset = imageStarts[image] + std::max(0, std::min(doc["row"].as<int>(), imageHeights[image] - 1));
+    scrollOffset = std::max(0, std::min(scrollOffset, maxScrollOffset));
+    currentPage = image;
+    Serial.printf("Comic position: resuming at image %d (scroll offset %d)\n", image + 1, scrollOffset);
+
+    // 翻页模式：第一次绘制前就在后台解码这一页，showPage() 只需等它完成；前后两页随后预取
+    if (pageMode && allocatePageSlots())
+    {
+        prefetchPage(currentPage);
+        prefetchPage(currentPage + 1);
+        prefetchPage(currentPage - 1);
+    }
+}
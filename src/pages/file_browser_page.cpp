@@ -8,22 +8,73 @@
 #include "../core/display.h"   // 包含显示管理类 (Adjusted path)
 #include "../core/sdcard.h"    // 包含 SD 卡管理类 (Adjusted path)
 #include "../core/router.h"    // 包含页面路由类 (Adjusted path)
+#include "../core/widget_cache.h" // 按钮和图标的预渲染精灵
 #include "../config/config.h"    // 包含配置常量 (Adjusted path)
 
 // FileBrowserPage 类实现
 
 // 构造函数：初始化显示管理器和 SD 卡管理器的实例引用
 FileBrowserPage::FileBrowserPage()
-    : displayManager(Display::getInstance()), sdManager(SDCard::getInstance()) {}
+    : displayManager(Display::getInstance()), sdManager(SDCard::getInstance()), shownPage(0) {}
 
-// 显示文件浏览器页面的主函数
+// 显示文件浏览器页面的主函数：整屏重绘 (在本帧结束时由 paint() 完成)
 void FileBrowserPage::display()
 {
-    displayManager.clear(); // 清屏
-    drawHeader();           // 绘制顶部标题栏
-    drawContent();          // 绘制文件/目录列表
-    drawFooter();           // 绘制底部状态栏
-    drawNavigationButtons(); // 绘制导航按钮（返回、上一页、下一页）
+    shownPath = ""; // 强制整屏重绘
+    invalidateChanges();
+}
+
+// 与屏幕上显示的内容比较，只标记变化的区域
+void FileBrowserPage::invalidateChanges()
+{
+    const String &path = sdManager.getCurrentPath();
+    int page = sdManager.getCurrentPage();
+    if (shownPath.length() == 0 || path != shownPath)
+    {
+        // 进入了另一个目录 (或第一次显示)：标题、列表和按钮都变了
+        invalidate(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+    else if (page != shownPage)
+    {
+        // 同一目录翻页：标题不变，只重绘新旧两页中有内容的行，以及状态栏 (页码和翻页按钮)
+        size_t itemCount = sdManager.getCurrentItems().size();
+        for (size_t row = 0; row < MAX_ITEMS_PER_PAGE; row++)
+        {
+            bool shownRow = shownPage * MAX_ITEMS_PER_PAGE + row < itemCount;
+            bool newRow = page * MAX_ITEMS_PER_PAGE + row < itemCount;
+            if (shownRow || newRow)
+            {
+                invalidate(0, CONTENT_Y + row * ITEM_HEIGHT, SCREEN_WIDTH, ITEM_HEIGHT);
+            }
+        }
+        invalidate(0, SCREEN_HEIGHT - FOOTER_HEIGHT, SCREEN_WIDTH, FOOTER_HEIGHT);
+    }
+    shownPath = path;
+    shownPage = page;
+}
+
+// 重绘 clip 区域：先清除背景，再绘制与之相交的部分 (超出 clip 的像素已被裁剪)
+void FileBrowserPage::paint(const DirtyRect &clip)
+{
+    displayManager.getTFT()->fillRect(clip.x, clip.y, clip.w, clip.h, TFT_BLACK);
+    bool header = clip.intersects(0, 0, SCREEN_WIDTH, HEADER_HEIGHT);
+    bool footer = clip.intersects(0, SCREEN_HEIGHT - FOOTER_HEIGHT, SCREEN_WIDTH, FOOTER_HEIGHT);
+    if (header)
+    {
+        drawHeader(); // 绘制顶部标题栏
+    }
+    if (clip.intersects(0, CONTENT_Y, SCREEN_WIDTH, CONTENT_HEIGHT))
+    {
+        drawContent(clip); // 绘制文件/目录列表
+    }
+    if (footer)
+    {
+        drawFooter(); // 绘制底部状态栏
+    }
+    if (header || footer)
+    {
+        drawNavigationButtons(); // 绘制导航按钮（返回、上一页、下一页）
+    }
 }
 
 // 绘制页面顶部标题栏
@@ -37,11 +88,13 @@ void FileBrowserPage::drawHeader()
 
 // --- Private Helper Functions for Drawing ---
 
-// Helper function to draw a folder icon
-void FileBrowserPage::_drawFolder(uint16_t x, uint16_t y, bool isComic)
+// Folder icon with its top-left at (x, y) (the tab sticks out 5 px above the body); ctx points to isComic
+static void renderFolder(void *ctx, int16_t x, int16_t y)
 {
-    TFT_eSPI* tft = displayManager.getTFT(); // Get TFT object
+    DisplayBackend *tft = Display::getInstance().getTFT(); // Get TFT object (the widget cache canvas while rendering)
+    const bool isComic = *static_cast<const bool *>(ctx);
     const uint16_t folderColor = isComic ? TFT_YELLOW : TFT_CYAN;
+    y += 5; // Body below the tab
 
     // 绘制文件夹图标
     tft->fillRect(x, y, 40, 30, folderColor);
@@ -55,10 +108,10 @@ void FileBrowserPage::_drawFolder(uint16_t x, uint16_t y, bool isComic)
     }
 }
 
-// Helper function to draw a text file icon
-void FileBrowserPage::_drawTextFile(uint16_t x, uint16_t y)
+// Text file icon with its top-left at (x, y)
+static void renderTextFile(void *ctx, int16_t x, int16_t y)
 {
-    TFT_eSPI* tft = displayManager.getTFT(); // Get TFT object
+    DisplayBackend *tft = Display::getInstance().getTFT(); // Get TFT object (the widget cache canvas while rendering)
     const uint16_t fileColor = TFT_WHITE;
     const uint16_t lineColor = TFT_DARKGREY;
 
@@ -74,32 +127,27 @@ void FileBrowserPage::_drawTextFile(uint16_t x, uint16_t y)
     tft->drawLine(x + 20, y + 10, x + 30, y + 10, fileColor);
     tft->fillRect(x+21, y+1, 9, 9, TFT_BLACK); // Cover the area behind the fold
     tft->drawLine(x + 20, y, x + 30, y + 10, TFT_LIGHTGREY); // Fold line
+}
 
+// Helper function to draw a folder icon (body at (x, y), 40x30, tab above it); rendered once, then blitted from the widget cache
+void FileBrowserPage::_drawFolder(uint16_t x, uint16_t y, bool isComic)
+{
+    WidgetCache::getInstance().draw("folder", isComic, nullptr, x, y - 5, 40, 35, renderFolder, &isComic);
+}
 
+// Helper function to draw a text file icon (31x35 including the folded corner)
+void FileBrowserPage::_drawTextFile(uint16_t x, uint16_t y)
+{
+    WidgetCache::getInstance().draw("textfile", 0, nullptr, x, y, 31, 35, renderTextFile, nullptr);
 }
 
 // Helper function to draw a button
 void FileBrowserPage::_drawButton(const char *text, uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool isActive)
 {
-    TFT_eSPI* tft = displayManager.getTFT(); // Get TFT object
-    // 绘制按钮背景
+    // 绘制按钮背景、边框和文本 (Font 2, size 1)，由控件缓存渲染一次后直接推送
     uint16_t bgColor = isActive ? TFT_BLUE : TFT_DARKGREY;
     uint16_t textColor = TFT_WHITE;
-
-    tft->fillRoundRect(x, y, w, h, 5, bgColor);
-    tft->drawRoundRect(x, y, w, h, 5, textColor);
-
-    // 绘制文本 (using displayManager's text functions)
-    // Note: We need to manage text color/datum within this scope if needed,
-    // or rely on displayManager's state if appropriate.
-    // For simplicity, using drawCenteredText which handles its own state.
-    uint16_t textSize = 1; // Adjust size as needed for buttons
-    // Calculate vertical center for text based on button height and assumed text height (Font 2 = 16px)
-    uint16_t textY = y + (h - 16 * textSize) / 2;
-    // Use displayManager's text drawing function
-    displayManager.drawCenteredText(text, x, y, w, h, textSize, true);
-    // Restore default text color if necessary (drawCenteredText might change it)
-    // tft->setTextColor(TFT_WHITE, TFT_BLACK); // Example if needed
+    WidgetCache::getInstance().drawButton(text, x, y, w, h, bgColor, textColor, 1, true);
 }
 
 void FileBrowserPage::handleLoop() {
@@ -109,8 +157,8 @@ void FileBrowserPage::handleLoop() {
 
 // --- Public Methods ---
 
-// 绘制页面中间的文件/目录列表区域
-void FileBrowserPage::drawContent()
+// 绘制页面中间的文件/目录列表区域 (只绘制与 clip 相交的行)
+void FileBrowserPage::drawContent(const DirtyRect &clip)
 {
     const auto &items = sdManager.getCurrentItems(); // 获取当前目录下的所有项目
     // 计算当前页需要显示的项目起始和结束索引
@@ -123,6 +171,10 @@ void FileBrowserPage::drawContent()
         const auto &item = items[i];
         // 计算当前项目绘制的 Y 坐标
         uint16_t y = CONTENT_Y + (i - startIdx) * ITEM_HEIGHT;
+        if (!clip.intersects(0, y, SCREEN_WIDTH, ITEM_HEIGHT))
+        {
+            continue; // 这一行没有变化
+        }
 
         // 如果是目录，绘制文件夹图标（区分普通目录和漫画目录）
         if (item.isDirectory)
@@ -251,7 +303,7 @@ bool FileBrowserPage::handleItemTouch(uint16_t x, uint16_t y)
             Serial.print("Entering directory: ");
             Serial.println(item.name);
             sdManager.enterDirectory(item.name);
-            display(); // 重新绘制文件浏览器页面以显示新目录内容
+            invalidateChanges(); // 重新绘制文件浏览器页面以显示新目录内容
         }
         return true; // Directory touch event handled
     }
@@ -293,8 +345,8 @@ bool FileBrowserPage::handleNavigationTouch(uint16_t x, uint16_t y)
     // 检查是否点击了“返回”按钮区域（左上角）
     if (y < HEADER_HEIGHT && x < 65 && sdManager.getCurrentPath() != "/")
     {
-        sdManager.goBack(); // 返回上一级目录
-        display();          // 重新绘制页面
+        sdManager.goBack();  // 返回上一级目录
+        invalidateChanges(); // 重新绘制页面
         return true;        // 触摸事件已处理
     }
 
@@ -305,7 +357,7 @@ bool FileBrowserPage::handleNavigationTouch(uint16_t x, uint16_t y)
         if (x < 35 && sdManager.getCurrentPage() > 0)
         {
             sdManager.prevPage(); // 切换到上一页
-            display();            // 重新绘制页面
+            invalidateChanges();  // 只重绘变化的行和状态栏
             return true;          // 触摸事件已处理
         }
 
@@ -314,7 +366,7 @@ bool FileBrowserPage::handleNavigationTouch(uint16_t x, uint16_t y)
             sdManager.getCurrentPage() < sdManager.getTotalPages() - 1)
         {
             sdManager.nextPage(); // 切换到下一页
-            display();            // 重新绘制页面
+            invalidateChanges();  // 只重绘变化的行和状态栏
             return true;          // 触摸事件已处理
         }
     }
@@ -1,5 +1,6 @@
 #include "menu_page.h"
 #include "../core/font.h" // For drawing text and selectFont
+#include "../core/widget_cache.h" // Pre-rendered tiles and nav buttons
 #include <string>         // For std::to_string
 #include <algorithm>      // For std::min
 
@@ -47,6 +48,8 @@ void MenuPage::populateMenuItems() {
 
     // Add "File Management" item using its registered string name
     menuItems.push_back({"文件管理器", "browser", nullptr});
+    // Benchmarks (SD, font, layout, comic redraw, page turns) for comparing builds and SD cards
+    menuItems.push_back({"基准测试", "benchmark", nullptr});
 
     // --- Add more menu items here in the future ---
     // Example: menuItems.push_back({"Settings", "settings", nullptr}); // Assuming "settings" is registered
@@ -66,7 +69,7 @@ int MenuPage::getTotalPages() const {
 
 // Draw the header bar
 void MenuPage::drawHeader() {
-    TFT_eSPI* tft = displayManager.getTFT(); // Get the underlying TFT object
+    DisplayBackend *tft = displayManager.getTFT(); // Get the underlying TFT object
     tft->fillRect(0, 0, SCREEN_WIDTH, HEADER_HEIGHT, TFT_DARKGREY);
     // Use Display manager's centered text function for the header
     // Set text color via TFT object before calling drawCenteredText
@@ -77,7 +80,7 @@ void MenuPage::drawHeader() {
 
 // Draw the menu items for the current page in a grid
 void MenuPage::drawMenuItems() {
-    TFT_eSPI* tft = displayManager.getTFT();
+    DisplayBackend *tft = displayManager.getTFT();
     tft->fillRect(0, CONTENT_Y, SCREEN_WIDTH, CONTENT_HEIGHT, TFT_BLACK); // Clear content area
 
     if (itemsPerPage <= 0 || gridButtonWidth <= 0 || gridButtonHeight <= 0) return; // Cannot display items if grid is invalid
@@ -94,25 +97,15 @@ void MenuPage::drawMenuItems() {
         uint16_t itemX = ITEM_PADDING_X + col * (gridButtonWidth + ITEM_PADDING_X);
         uint16_t itemY = CONTENT_Y + ITEM_PADDING_Y + row * (gridButtonHeight + ITEM_PADDING_Y);
 
-        // Draw the button background with standard cyan
-        tft->fillRoundRect(itemX, itemY, gridButtonWidth, gridButtonHeight, 5, TFT_CYAN);
-
-        // Draw the item label centered within the button
-        // Temporarily set background color for drawString to match button, then reset
-        // uint16_t currentBgColor = tft->textbgcolor; // Store current background color - Not needed with drawCenteredText
-        // tft->setTextColor(TFT_WHITE, TFT_BLUE);     // Set text color with button background - Handled by drawCenteredText
-        // tft->drawString(menuItems[i].label.c_str(), itemX + itemWidth / 2, currentY + MENU_ITEM_HEIGHT / 2); // Use renamed constant
-        // tft->setTextColor(TFT_WHITE, currentBgColor); // Restore background color - Not needed
-
-        // Use Display manager's centered text function with smaller font size (size 2)
-        tft->setTextColor(TFT_BLACK, TFT_CYAN); // Set text color (BLACK for contrast) and background for the label
-        displayManager.drawCenteredText(menuItems[i].label.c_str(), itemX, itemY, gridButtonWidth, gridButtonHeight, 1);
+        // Draw the tile (standard cyan, label centered with size 1); rendered once, then blitted from the widget cache
+        WidgetCache::getInstance().drawButton(menuItems[i].label.c_str(), itemX, itemY, gridButtonWidth, gridButtonHeight,
+                                              TFT_CYAN, TFT_CYAN, 1, true);
     }
 }
 
 // Draw the footer with pagination controls
 void MenuPage::drawFooter() {
-    TFT_eSPI* tft = displayManager.getTFT();
+    DisplayBackend *tft = displayManager.getTFT();
     tft->fillRect(0, SCREEN_HEIGHT - FOOTER_HEIGHT, SCREEN_WIDTH, FOOTER_HEIGHT, TFT_DARKGREY);
 
     int totalPages = getTotalPages();
@@ -127,19 +120,16 @@ void MenuPage::drawFooter() {
 
     // Draw "Prev" button if not on the first page
     if (currentPageIndex > 0) {
-        tft->fillRoundRect(ITEM_PADDING_X, buttonY, NAV_BUTTON_WIDTH, NAV_BUTTON_HEIGHT, 5, TFT_BLUE);
-        tft->setTextColor(TFT_WHITE, TFT_BLUE); // Set text and background for button text
-        // Use drawCenteredText within the button bounds with smaller font size (size 2)
-        displayManager.drawCenteredText("Prev", ITEM_PADDING_X, buttonY, NAV_BUTTON_WIDTH, NAV_BUTTON_HEIGHT, 2);
+        // Blue button without outline on the footer background, label size 2
+        WidgetCache::getInstance().drawButton("Prev", ITEM_PADDING_X, buttonY, NAV_BUTTON_WIDTH, NAV_BUTTON_HEIGHT,
+                                              TFT_BLUE, TFT_BLUE, 2, true, TFT_DARKGREY);
     }
 
     // Draw "Next" button if not on the last page
     if (currentPageIndex < totalPages - 1) {
         uint16_t nextButtonX = SCREEN_WIDTH - ITEM_PADDING_X - NAV_BUTTON_WIDTH;
-        tft->fillRoundRect(nextButtonX, buttonY, NAV_BUTTON_WIDTH, NAV_BUTTON_HEIGHT, 5, TFT_BLUE);
-        tft->setTextColor(TFT_WHITE, TFT_BLUE); // Set text and background for button text
-        // Use drawCenteredText within the button bounds with smaller font size (size 2)
-        displayManager.drawCenteredText("Next", nextButtonX, buttonY, NAV_BUTTON_WIDTH, NAV_BUTTON_HEIGHT, 2);
+        WidgetCache::getInstance().drawButton("Next", nextButtonX, buttonY, NAV_BUTTON_WIDTH, NAV_BUTTON_HEIGHT,
+                                              TFT_BLUE, TFT_BLUE, 2, true, TFT_DARKGREY);
     }
 
     // Draw Page Number (e.g., "1 / 3")
@@ -152,13 +142,24 @@ void MenuPage::drawFooter() {
     // tft->setTextColor(TFT_WHITE, TFT_BLACK); // Example reset
 }
 
-// Main display function, called by the router
+// Main display function, called by the router; the page is drawn by paint() when the frame is composed
 void MenuPage::display() {
     Serial.println("MenuPage::display() called");
-    displayManager.getTFT()->fillScreen(TFT_BLACK); // Clear screen using TFT object
-    drawHeader();
-    drawMenuItems();
-    drawFooter();
+    invalidate(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+}
+
+// Repaint the parts of the page that intersect clip (drawing is already clipped to it)
+void MenuPage::paint(const DirtyRect &clip) {
+    displayManager.getTFT()->fillRect(clip.x, clip.y, clip.w, clip.h, TFT_BLACK);
+    if (clip.intersects(0, 0, SCREEN_WIDTH, HEADER_HEIGHT)) {
+        drawHeader();
+    }
+    if (clip.intersects(0, CONTENT_Y, SCREEN_WIDTH, CONTENT_HEIGHT)) {
+        drawMenuItems();
+    }
+    if (clip.intersects(0, SCREEN_HEIGHT - FOOTER_HEIGHT, SCREEN_WIDTH, FOOTER_HEIGHT)) {
+        drawFooter();
+    }
 }
 
 // Handle touch events for grid layout
@@ -204,7 +205,7 @@ void MenuPage::handleTouch(uint16_t x, uint16_t y) {
         {
             Serial.println("Touched Prev button");
             currentPageIndex--;
-            display(); // Redraw the page
+            invalidate(0, CONTENT_Y, SCREEN_WIDTH, SCREEN_HEIGHT - CONTENT_Y); // Grid and footer change
             return; // Touch handled
         }
 
@@ -216,7 +217,7 @@ void MenuPage::handleTouch(uint16_t x, uint16_t y) {
         {
             Serial.println("Touched Next button");
             currentPageIndex++;
-            display(); // Redraw the page
+            invalidate(0, CONTENT_Y, SCREEN_WIDTH, SCREEN_HEIGHT - CONTENT_Y); // Grid and footer change
             return; // Touch handled
         }
     }
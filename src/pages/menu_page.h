@@ -26,15 +26,15 @@ private:
     // --- UI Layout Constants (Grid Layout 3x4) ---
     static constexpr uint8_t MENU_COLS = 3;       // Number of columns in the grid
     static constexpr uint8_t MENU_ROWS = 4;       // Number of rows in the grid
-    static constexpr uint16_t HEADER_HEIGHT = 30; // Height for the header (e.g., "Menu")
-    static constexpr uint16_t FOOTER_HEIGHT = 35; // Height for the footer (pagination controls)
-    static constexpr uint16_t ITEM_PADDING_X = 10; // Horizontal padding between items and screen edges
-    static constexpr uint16_t ITEM_PADDING_Y = 10; // Vertical padding between items and header/footer
+    static constexpr uint16_t HEADER_HEIGHT = PANEL.scaleY(30); // Height for the header (e.g., "Menu")
+    static constexpr uint16_t FOOTER_HEIGHT = PANEL.scaleY(35); // Height for the footer (pagination controls)
+    static constexpr uint16_t ITEM_PADDING_X = PANEL.scaleX(10); // Horizontal padding between items and screen edges
+    static constexpr uint16_t ITEM_PADDING_Y = PANEL.scaleY(10); // Vertical padding between items and header/footer
     // Button width/height will be calculated dynamically based on screen size, padding, and grid dimensions
     // static constexpr uint16_t BUTTON_WIDTH = ...; // Calculated in cpp
     // static constexpr uint16_t BUTTON_HEIGHT = ...; // Calculated in cpp
-    static constexpr uint16_t NAV_BUTTON_WIDTH = 70;  // Width for Prev/Next buttons in footer
-    static constexpr uint16_t NAV_BUTTON_HEIGHT = 28; // Height for Prev/Next buttons in footer
+    static constexpr uint16_t NAV_BUTTON_WIDTH = PANEL.scaleX(70);  // Width for Prev/Next buttons in footer
+    static constexpr uint16_t NAV_BUTTON_HEIGHT = PANEL.scaleY(28); // Height for Prev/Next buttons in footer
     static constexpr uint16_t CONTENT_Y = HEADER_HEIGHT; // Y position where grid starts
     // Calculated content height available for grid items
     static constexpr uint16_t CONTENT_HEIGHT = SCREEN_HEIGHT - HEADER_HEIGHT - FOOTER_HEIGHT;
@@ -58,10 +58,18 @@ public:
     MenuPage();
 
     /**
-     * @brief Displays the menu page content (overrides Page).
+     * @brief Displays the menu page content (overrides Page): marks the whole screen for repaint at the end of the frame.
      */
     virtual void display() override;
 
+    /**
+     * @brief Repaints the header, grid and footer parts that intersect clip (overrides Page).
+     */
+    virtual void paint(const DirtyRect &clip) override;
+
+    // Few colours: composed on the 8-bit paletted canvas and pushed in one go
+    virtual bool usesIndexedCanvas() const override { return true; }
+
     /**
      * @brief Handles touch input on the menu page (overrides Page).
      * @param x Touch X coordinate.
@@ -2,6 +2,7 @@
 #include "pages.h"   // 包含页面类的声明
 #include "text_viewer_page.h" // Include TextViewerPage header here
 #include "menu_page.h" // Include MenuPage header here
+#include "benchmark_page.h" // BenchmarkPage header
 
 // Static member definition removed as the member itself was removed from FileBrowserPage
 
@@ -66,3 +67,12 @@ Page *createMenuPage() // Return Page*
     // 直接使用 new 创建 MenuPage 实例，隐式转换为 Page*
     return new MenuPage();
 }
+
+/**
+ * @brief 创建基准测试页面的工厂函数。
+ * @return 指向新创建的 BenchmarkPage 对象的指针 (作为 Page*)。
+ */
+Page *createBenchmarkPage()
+{
+    return new BenchmarkPage();
+}
@@ -16,6 +16,12 @@ class MenuPage;
 #include "../core/display.h"   // 显示管理 (封装 TFT_eSPI)
 #include "../core/sdcard.h"    // SD 卡文件系统管理
 #include "../core/touch.h"     // 触摸管理
+#include "../core/arena.h"     // 页面级 bump 分配器
+#include "../core/compositor.h" // 脏矩形合成器 (Page::invalidate / paint)
+#include "../core/bmp_decoder.h" // 漫画 BMP 行解码 (24/16 位，8/4 位调色板)
+#include "../core/q565.h"        // 漫画 Q565 图片的流式解码
+#include "../core/jobs.h"        // 漫画翻页模式的后台页面解码
+#include "../core/thumbnail_file.h" // 漫画缩略图网格
 
 // 页面基类 (Moved definition before FileBrowserPage)
 class Page
@@ -29,7 +35,21 @@ public:
     virtual void cleanup() {}
     // Add a virtual method to be called in the main loop for periodic tasks
     virtual void handleLoop() {}
+    // 页面 scratch arena 的大小 (字节)。Router 在销毁旧页面之后、display() 之前按此申请，0 表示不使用
+    virtual size_t arenaSize() const { return 0; }
+    // 页面的 scratch arena (页面销毁时整块释放)
+    Arena &arena() { return pageArena; }
+    // 在 clip 区域内重绘页面。绘图已被裁剪到 clip，只需先用背景色填充 clip，再绘制与之相交的元素。
+    // 默认不绘制：没有使用 invalidate() 的页面仍在 display()/handleTouch() 中直接绘图
+    virtual void paint(const DirtyRect &clip) {}
+    // paint() 是否先画到 8 位调色板画布再整块推送 (只用少数几种颜色的界面页面)
+    virtual bool usesIndexedCanvas() const { return false; }
+    // 标记区域需要重绘：本帧结束时 (Router::composeFrame) 合并所有区域，每个区域调用一次 paint()
+    void invalidate(int16_t x, int16_t y, int16_t w, int16_t h) { Compositor::getInstance().invalidate(x, y, w, h); }
     virtual ~Page() = default;
+
+private:
+    Arena pageArena; // 基类成员，比派生类的成员更晚析构，因此派生类中使用 ArenaAllocator 的容器可以安全析构
 };
 
 
@@ -45,18 +65,24 @@ private:
     // static ComicViewerPage* comicViewer; // Removed static instance
 
     // --- UI 布局常量 ---
-    static constexpr uint16_t HEADER_HEIGHT = 40; // 顶部标题栏高度
-    static constexpr uint16_t FOOTER_HEIGHT = 40; // 底部状态栏高度
+    static constexpr uint16_t HEADER_HEIGHT = PANEL.scaleY(40); // 顶部标题栏高度 (基准布局 40 像素)
+    static constexpr uint16_t FOOTER_HEIGHT = PANEL.scaleY(40); // 底部状态栏高度
     static constexpr uint16_t CONTENT_Y = HEADER_HEIGHT; // 内容区域起始 Y 坐标
     // 内容区域高度 (屏幕高度 - 头部 - 底部)
     static constexpr uint16_t CONTENT_HEIGHT = SCREEN_HEIGHT - HEADER_HEIGHT - FOOTER_HEIGHT;
     // 列表项高度和每页最大项数在 sdcard.h 中定义 (ITEM_HEIGHT, MAX_ITEMS_PER_PAGE)
 
+    // 屏幕上当前显示的内容 (用于只重绘发生变化的区域)
+    String shownPath; // 显示的目录 (空表示尚未显示)
+    int shownPage;    // 显示的分页
+
     // --- 私有辅助函数 ---
     void drawHeader();          // 绘制标题栏 (当前路径)
-    void drawContent();         // 绘制文件/目录列表
+    void drawContent(const DirtyRect &clip); // 绘制与 clip 相交的文件/目录列表行
     void drawFooter();          // 绘制状态栏 (分页信息)
     void drawNavigationButtons(); // 绘制导航按钮 (返回, 上/下一页)
+    // 与上次显示的内容比较，标记需要重绘的区域 (目录变化：整屏；只有分页变化：内容变化的行和状态栏)
+    void invalidateChanges();
     // Added declarations for helper drawing functions:
     void _drawFolder(uint16_t x, uint16_t y, bool isComic);
     void _drawTextFile(uint16_t x, uint16_t y); // Declaration for text file icon helper
@@ -73,10 +99,18 @@ public:
     FileBrowserPage();
 
     /**
-     * @brief 显示页面内容 (重写 Page 基类方法)
+     * @brief 显示页面内容 (重写 Page 基类方法)：标记整个屏幕需要重绘，在本帧结束时绘制
      */
     virtual void display() override;
 
+    /**
+     * @brief 重绘 clip 区域内的标题栏、列表行、状态栏和按钮 (重写 Page 基类方法)
+     */
+    virtual void paint(const DirtyRect &clip) override;
+
+    // 文件列表只有几种颜色：经 8 位画布合成
+    virtual bool usesIndexedCanvas() const override { return true; }
+
     /**
      * @brief 处理触摸事件 (重写 Page 基类方法)
      * @param x 触摸点 X 坐标
@@ -163,19 +197,91 @@ private:
     Touch& touchManager;     // 触摸管理器引用
     String currentPath;      // 当前打开的漫画目录路径
     int scrollOffset;        // 当前垂直滚动偏移量 (从漫画顶部开始的像素)
-    std::vector<String> imageFiles; // 漫画图片文件路径列表 (e.g., "1.bmp", "2.bmp")
-    std::vector<int> imageHeights;  // 缓存的每张图片的高度
-    int totalComicHeight;           // 缓存的所有图片的总高度
+    std::vector<String> imageFiles; // 漫画图片文件路径列表 (e.g., "1.bmp", "2.bmp"；转换过的章节为 "1.q565", ...)
+    std::vector<int> imageHeights;  // 缓存的每张图片的高度 (还没读取文件头的图片为估计值)
+    std::vector<int> imageStarts;   // 每张图片在整本漫画中的起始 Y 坐标 (imageHeights 的前缀和，网格跳转用)
+    std::vector<bool> imageMeasured; // 图片的高度是否已从文件头读取
+    int totalComicHeight;           // 缓存的所有图片的总高度 (后台扫描完成前包含估计值)
     bool renderingInterrupted;      // 标记上次绘制是否被触摸中断
     bool touchPending;              // 是否有待处理的触摸事件
     uint16_t lastTouchX;            // 上次触摸的 X 坐标
     uint16_t lastTouchY;            // 上次触摸的 Y 坐标
+    BmpRowDecoder bmp;              // 当前正在解码的图片 (格式、行顺序、调色板)
+    Q565Decoder q565;               // 当前正在解码的 Q565 图片 (尺寸、解码状态)
+
+    // --- 翻页模式 (.info 中 "mode": "page") ---
+    // 一个整屏页面缓冲区 (PSRAM)：page 为 -1 表示空；job 不为空时后台任务正在写入 pixels
+    struct PageSlot {
+        uint16_t* pixels;
+        int page;
+        bool ready;
+        JobFuture* job;
+    };
+    bool pageMode;                  // true: 每张图片缩放到一屏，点击左右翻页；false: 连续滚动
+    bool rightToLeft;               // 翻页模式下从右向左阅读 (点击左侧为下一页)
+    int currentPage;                // 翻页模式下当前显示的图片索引
+    bool pageSlotsAllocated;        // 是否有整屏页面缓冲区 (没有 PSRAM 时逐条带直接绘制)
+    PageSlot pageSlots[COMIC_PAGE_SLOTS];
+
+    // --- 缩略图网格 (点击中间打开) ---
+    static constexpr int GRID_CELLS = COMIC_GRID_COLUMNS * COMIC_GRID_ROWS;
+    static constexpr int GRID_FOOTER_HEIGHT = PANEL.scaleY(28);
+    static constexpr int GRID_CELL_WIDTH = SCREEN_WIDTH / COMIC_GRID_COLUMNS;
+    static constexpr int GRID_CELL_HEIGHT = (SCREEN_HEIGHT - GRID_FOOTER_HEIGHT) / COMIC_GRID_ROWS;
+    static constexpr int GRID_BUTTON_WIDTH = PANEL.scaleX(60);
+    bool gridOpen;                  // 正在显示缩略图网格
+    int gridFirst;                  // 网格当前一屏的第一张图片
+    int gridNextMissing;            // 下一张要按需生成的缩略图 (-1 表示本屏都已生成)
+    int gridChapter;                // 网格显示的章节 (网格只在一章内翻屏，缩略图文件属于这一章)
+    int thumbnailChapter;           // thumbnails 当前打开的是哪一章 (-1 表示未打开)
+    ThumbnailFile thumbnails;
+    JobFuture* thumbnailJob;        // 正在后台缩小的缩略图 (同时最多一张)
+    int thumbnailJobImage;          // thumbnailJob 缩小的图片 (imageFiles 中的索引)
+    uint16_t* thumbnailPixels;      // thumbnailJob 的输出缓冲区 (任务结束前不能释放)
+
+    // --- 章节连读：读到接近末尾时在后台读取下一章 (同一父目录中自然顺序的下一个漫画目录)，追加到画布末尾 ---
+    struct Chapter {
+        String path;    // 章节目录
+        int firstImage; // 第一张图片在 imageFiles 中的索引
+    };
+    struct ChapterScan;             // 后台任务的参数和结果 (定义在 .cpp 中)
+    std::vector<Chapter> chapters;  // 画布中的章节 (chapters[0] 为打开的目录)
+    ChapterScan* chapterScan;       // 正在读取的下一章 (归任务所有，chapterJob 释放后不能再访问)
+    JobFuture* chapterJob;
+    bool chapterChainEnded;         // 已确认没有下一章
+    ChapterScan* metadataScan;      // 打开的目录中其余图片的文件头扫描 (与下一章使用相同的任务参数)
+    JobFuture* metadataJob;
 
     // --- 私有辅助函数 ---
     /**
-     * @brief 加载漫画目录下的所有图片，并计算缓存高度。
+     * @brief 确定漫画目录下的图片数，只读取第一张图片的文件头；其余图片的高度先用估计值，在后台读取。
      */
     void loadImages();
+    int countImages(const String& dir, const char* extension); // 连续图片 1.bmp ... n.bmp 的个数 (倍增 + 二分查找，O(log n) 次 exists)
+    void measureVisibleImages();              // 读取视口中还没有实测高度的图片的文件头 (第一次绘制只需要这几张)
+    void setImageHeight(int image, int height); // 用实测高度替换估计值，屏幕顶部的内容保持不动
+    void startMetadataScan();
+    void applyMetadataScan();                 // 后台扫描完成后替换所有估计值 (主循环中轮询)
+    void cancelMetadataScan();
+    static bool scanImagesJob(JobFuture& job, void* arg); // 在工作线程上读取一个目录中所有图片的高度
+
+    /**
+     * @brief 读取 BMP 文件头 (以及颜色掩码、调色板) 到 bmp。
+     * @param scratch 读取调色板的临时缓冲区 (至少 1024 字节)
+     * @return 格式受支持且读取成功时返回 true
+     */
+    bool readBmpHeader(File& file, uint8_t* scratch);
+    bool readQ565Header(File& file); // 读取 Q565 文件头到 q565
+
+    /**
+     * @brief 绘制 Q565 图片的第 [firstRow, endRow) 行：从 firstRow 所在组的重启点开始解码 (不需要上方的行)，
+     * 解码结果 (面板字节顺序) 直接写入 pixelBuffer 推送。第 firstRow 行在屏幕的 screenY 行，只推送 [clipTop, clipBottom) 内的行。
+     * 行号是裁掉空白边距后的显示区域中的行 (COMIC_CROP_MARGINS)；空白行段跳过，不读取也不推送。
+     * @param rawBuffer 编码数据的读取缓冲区 (至少 SdReadProfile::alignedBytes(readBytes) 字节)
+     * @return true if drawing was interrupted by touch, false otherwise.
+     */
+    bool drawQ565Rows(File& file, int firstRow, int endRow, int screenY, int clipTop, int clipBottom,
+                      uint8_t* rawBuffer, size_t readBytes, uint16_t* pixelBuffer);
 
     /**
      * @brief 绘制当前视口的漫画内容。
@@ -206,11 +312,95 @@ private:
      */
     bool drawNewArea(int y, int h);
 
+    /**
+     * @brief 翻页模式：显示第 page 张图片 (一次整屏推送)，然后在后台解码下一页和上一页。
+     * 页面尚未解码时先等待后台任务或同步解码，不会显示解码了一半的页面。
+     * 没有页面缓冲区时逐条带解码并推送。
+     */
+    void showPage(int page);
+
+    /**
+     * @brief 翻页模式：处理点击 (左右两侧翻页，中间打开缩略图网格)。
+     */
+    void handlePageTap(uint16_t x, uint16_t y);
+
+    // 翻页模式的页面缓冲区管理
+    bool allocatePageSlots();
+    void releasePageSlots();
+    PageSlot* findPageSlot(int page);
+    PageSlot* reusablePageSlot(); // 不在 [currentPage - 1, currentPage + 1] 中的缓冲区
+    bool retirePageJob(PageSlot& slot, bool keepResult); // 结束 (等待或取消) 缓冲区上的后台任务
+    void prefetchPage(int page);
+
+    /**
+     * @brief 打开缩略图网格 (从当前图片所在的一屏开始)。
+     */
+    void openGrid();
+
+    /**
+     * @brief 绘制网格的一屏：已生成的缩略图从缩略图文件连续读取，其余先画占位框，由 handleLoop 逐张生成。
+     */
+    void drawGrid();
+
+    /**
+     * @brief 网格中的点击：缩略图跳转到该图片，底部按钮翻屏或关闭网格。
+     */
+    void handleGridTap(uint16_t x, uint16_t y);
+
+    /**
+     * @brief 关闭网格并显示第 image 张图片 (滚动模式滚动到图片顶部，翻页模式翻到这一页)；image 为 -1 时回到原来的位置。
+     */
+    void jumpToImage(int image);
+
+    // 网格单元格中缩略图的位置
+    void gridThumbnailPosition(int index, int& x, int& y) const;
+    void drawGridThumbnail(int index, const uint16_t* pixels);
+    static void drawGridThumbnailCallback(void* ctx, int index, const uint16_t* pixels);
+    // 在 JobSystem 上缩小下一张缺少的缩略图 (同时最多一个任务，主循环不阻塞在解码上)
+    void startNextThumbnail();
+    /**
+     * @brief 结束缩略图任务。
+     * @param keepResult true: 任务已结束，成功时追加到缩略图文件并推送到网格；false: 取消任务并丢弃结果。
+     * @return 缓冲区已不再被工作线程使用时返回 true (等待超时返回 false，此时缓冲区不能释放)。
+     */
+    bool retireThumbnailJob(bool keepResult);
+    int nextMissingThumbnail(int from) const; // 本屏中 from 之后第一张未生成的缩略图，没有时为 -1
+    int currentImage() const;                 // 正在阅读的图片 (滚动模式为视口顶部所在的图片)
+
+    // 章节连读
+    int chapterOf(int image) const;           // 图片所在的章节
+    int chapterEnd(int chapter) const;        // 章节最后一张图片之后的索引
+    void prefetchNextChapter();               // 接近末尾时提交读取下一章的后台任务
+    void appendNextChapter();                 // 后台任务完成后把下一章追加到画布 (主循环中轮询)
+    void cancelNextChapter();
+    static bool scanNextChapterJob(JobFuture& job, void* arg); // 在工作线程上查找并读取下一章
+    static void scanImages(JobFuture& job, ChapterScan& scan); // 读取 scan.dir 中连续图片的路径和高度
+    static void deleteChapterScan(void* arg);
+
+    /**
+     * @brief 把阅读位置 (图片索引、图片内的行) 写入漫画目录的 COMIC_POSITION_FILE。
+     */
+    void savePosition();
+
+    /**
+     * @brief 读取上次的阅读位置 (loadImages 之后、第一次绘制之前)，翻页模式同时在后台开始解码这一页和前后两页。
+     */
+    void restorePosition();
+
 public:
     /**
      * @brief ComicViewerPage 构造函数
      */
-    ComicViewerPage() : displayManager(Display::getInstance()), sdManager(SDCard::getInstance()), touchManager(Touch::getInstance()), scrollOffset(0), totalComicHeight(0), renderingInterrupted(false), touchPending(false), lastTouchX(0), lastTouchY(0) {} // Initialize flags and coordinates
+    ComicViewerPage() : displayManager(Display::getInstance()), sdManager(SDCard::getInstance()), touchManager(Touch::getInstance()), scrollOffset(0), totalComicHeight(0), renderingInterrupted(false), touchPending(false), lastTouchX(0), lastTouchY(0),
+                        pageMode(false), rightToLeft(false), currentPage(0), pageSlotsAllocated(false), pageSlots(),
+                        gridOpen(false), gridFirst(0), gridNextMissing(-1), gridChapter(0), thumbnailChapter(-1),
+                        thumbnailJob(nullptr), thumbnailJobImage(-1), thumbnailPixels(nullptr),
+                        chapterScan(nullptr), chapterJob(nullptr), chapterChainEnded(false), metadataScan(nullptr), metadataJob(nullptr) {} // Initialize flags and coordinates
+
+    /**
+     * @brief Router 在向前导航时直接删除页面 (不调用 cleanup())，这里也要结束后台解码任务。
+     */
+    ~ComicViewerPage() override;
 
     /**
      * @brief 显示页面内容 (重写 Page 基类方法)
@@ -229,6 +419,11 @@ public:
      */
     virtual void handleLoop() override; // Add handleLoop declaration
 
+    /**
+     * @brief 条带解码缓冲区和绘制时的临时数组从页面 arena 中分配。
+     */
+    virtual size_t arenaSize() const override { return PAGE_ARENA_COMIC_BYTES; }
+
     /**
      * @brief 设置要显示的漫画目录路径。
      * @param path 漫画目录的完整路径
@@ -281,5 +476,11 @@ Page* createComicViewerPage(); // Return Page*
  */
 Page* createMenuPage(); // Added factory for MenuPage
 
+/**
+ * @brief 创建基准测试页面实例。
+ * @return Page* 指向新实例的指针 (作为基类指针)。
+ */
+Page* createBenchmarkPage();
+
 
 #endif // PAGES_H
@@ -1,6 +1,7 @@
 #include <Arduino.h>
 #include <FS.h>
 #include <algorithm>     // For std::min, std::max
+#include <memory>        // For std::unique_ptr (prefetch buffer)
 #include <TFT_eSPI.h>    // Include for color constants like TFT_LIGHTGREY
 #include <SD.h>          // Include the SD library for SD.remove()
 #include <ArduinoJson.h> // Include ArduinoJson library
@@ -8,56 +9,150 @@
 #include "text_viewer_page.h"
 #include "../core/router.h"
 #include "../core/sdcard.h" // Needed for file operations
+#include "../core/memory_budget.h" // Sizes the cache JSON document against free memory
+#include "../core/widget_cache.h"  // Pre-rendered toolbar buttons
+#include "../core/mem_stats.h"     // Memory accounting per subsystem
+#include "../core/trace.h"         // Trace spans
+#include "../core/text_layout.h"   // Line breaking shared by the metadata pass and drawContent
 
 // --- Constants ---
+// Pixel sizes are for the 320x240 reference layout and scaled to the panel (config/panel.h)
 const int TEXT_FONT_SIZE = 1;   // Use font size 1 (e.g., 16x16)
 const int TEXT_MARGIN_X = 5;    // Left/right margin for text
 const int TEXT_MARGIN_Y = 5;    // Top/bottom margin for text
 const int SCROLLBAR_WIDTH = 10; // Width of the scrollbar
 const int SCROLLBAR_MARGIN = 2; // Margin between text and scrollbar
-const int BACK_BUTTON_WIDTH = 60;
-const int BACK_BUTTON_HEIGHT = 30;
+const int BACK_BUTTON_WIDTH = PANEL.scaleX(60);
+const int BACK_BUTTON_HEIGHT = PANEL.scaleY(30);
 const int BACK_BUTTON_X = 5;
 const int BACK_BUTTON_Y = 5;
 // Add Top Button constants (placed next to Back button)
-const int TOP_BUTTON_WIDTH = 50; // Slightly smaller buttons to fit more
-const int TOP_BUTTON_HEIGHT = 30;
+const int TOP_BUTTON_WIDTH = PANEL.scaleX(50); // Slightly smaller buttons to fit more
+const int TOP_BUTTON_HEIGHT = PANEL.scaleY(30);
 const int TOP_BUTTON_X = BACK_BUTTON_X + BACK_BUTTON_WIDTH + 5;
 const int TOP_BUTTON_Y = 5;
 // Bookmark Buttons (Prev, Add/Del, Next)
-const int PREV_BM_BUTTON_WIDTH = 40;
-const int PREV_BM_BUTTON_HEIGHT = 30;
+const int PREV_BM_BUTTON_WIDTH = PANEL.scaleX(40);
+const int PREV_BM_BUTTON_HEIGHT = PANEL.scaleY(30);
 const int PREV_BM_BUTTON_X = TOP_BUTTON_X + TOP_BUTTON_WIDTH + 5;
 const int PREV_BM_BUTTON_Y = 5;
-const int BM_BUTTON_WIDTH = 50; // Bookmark Add/Del
-const int BM_BUTTON_HEIGHT = 30;
+const int BM_BUTTON_WIDTH = PANEL.scaleX(50); // Bookmark Add/Del
+const int BM_BUTTON_HEIGHT = PANEL.scaleY(30);
 const int BM_BUTTON_X = PREV_BM_BUTTON_X + PREV_BM_BUTTON_WIDTH + 5;
 const int BM_BUTTON_Y = 5;
-const int NEXT_BM_BUTTON_WIDTH = 40;
-const int NEXT_BM_BUTTON_HEIGHT = 30;
+const int NEXT_BM_BUTTON_WIDTH = PANEL.scaleX(40);
+const int NEXT_BM_BUTTON_HEIGHT = PANEL.scaleY(30);
 const int NEXT_BM_BUTTON_X = BM_BUTTON_X + BM_BUTTON_WIDTH + 5;
 const int NEXT_BM_BUTTON_Y = 5;
 
 // Define content area based on button/header (Y position remains the same)
 const int CONTENT_Y = BACK_BUTTON_Y + BACK_BUTTON_HEIGHT + TEXT_MARGIN_Y * 2;
 const int CONTENT_HEIGHT = SCREEN_HEIGHT - CONTENT_Y - TEXT_MARGIN_Y;
+const int CONTENT_WIDTH = SCREEN_WIDTH - TEXT_MARGIN_X * 2 - SCROLLBAR_WIDTH - SCROLLBAR_MARGIN; // Text area (cleared on redraw)
+const int SCROLLBAR_X = SCREEN_WIDTH - SCROLLBAR_WIDTH - SCROLLBAR_MARGIN;
 
 // --- Constructor ---
 TextViewerPage::TextViewerPage()
     : displayManager(Display::getInstance()),
       fontManager(Font::getInstance()),
       touchManager(Touch::getInstance()), // Initialize touchManager reference
+      lineIndex(LineIndexMap::allocator_type(&arena(), MemTag::TEXT_INDEX)), // Index nodes live in the page arena
       currentScrollLine(0),
+      restoreScrollLine(-1),
       totalLines(0),
       linesPerPage(0),
       lineHeight(0),
       fileLoaded(false),
-      useCache(false) // Initialize useCache to false
+      useCache(false), // Initialize useCache to false
+      prefetchJob(nullptr),
+      nextPagePosition(0)
 // No comma needed after the last initializer
 {
     // Constructor body can be empty or used for other initializations if needed
 }
 
+TextViewerPage::~TextViewerPage()
+{
+    // Router deletes pages without cleanup() on forward navigation, so drop the job here too
+    cancelPrefetch();
+}
+
+// --- Next-page prefetch ---
+
+// Argument for prefetchNextPageJob. Owned by the job (freed by deletePrefetchRequest).
+struct PrefetchRequest
+{
+    String path;     // The worker opens its own File handle (File objects must not be shared)
+    size_t position; // Byte offset to start reading from
+    size_t length;   // Number of bytes to read
+};
+
+static void deletePrefetchRequest(void *arg)
+{
+    delete static_cast<PrefetchRequest *>(arg);
+}
+
+// Runs on the JobSystem I/O worker: loads every glyph of the next page into the Font memory cache,
+// so the next drawContent() mostly hits the cache instead of the SD card.
+bool TextViewerPage::prefetchNextPageJob(JobFuture &job, void *arg)
+{
+    TRACE_SPAN(TraceName::TEXT_PREFETCH);
+    PrefetchRequest *request = static_cast<PrefetchRequest *>(arg);
+    File file = SDCard::getInstance().openFile(request->path.c_str());
+    if (!file)
+    {
+        return false;
+    }
+
+    std::unique_ptr<char[]> buffer(new (std::nothrow) char[request->length]);
+    if (!buffer || !file.seek(request->position))
+    {
+        file.close();
+        return false;
+    }
+    size_t bytesRead;
+    {
+        TRACE_SPAN(TraceName::SD_READ);
+        bytesRead = file.read(reinterpret_cast<uint8_t *>(buffer.get()), request->length);
+    }
+    file.close();
+
+    // The start position may land inside a multi-byte character: skip continuation bytes
+    size_t offset = 0;
+    while (offset < bytesRead && ((uint8_t)buffer[offset] & 0xC0) == 0x80)
+    {
+        offset++;
+    }
+    Font::getInstance().prefetchText(buffer.get() + offset, bytesRead - offset, TEXT_FONT_SIZE * 16, &job);
+    return true;
+}
+
+void TextViewerPage::startNextPagePrefetch(int availableWidth)
+{
+    cancelPrefetch(); // The previous page's prefetch is no longer useful
+
+    // Worst case is 3 bytes per full-width character on every line of the page
+    size_t charsPerLine = availableWidth / (TEXT_FONT_SIZE * 16) + 1;
+    size_t length = std::min((size_t)TEXT_PREFETCH_MAX_BYTES, (size_t)linesPerPage * charsPerLine * 3);
+
+    PrefetchRequest *request = new (std::nothrow) PrefetchRequest{filePath, nextPagePosition, length};
+    if (!request)
+    {
+        return;
+    }
+    prefetchJob = JobSystem::getInstance().submit(JobType::FONT_PREFETCH, prefetchNextPageJob, request, deletePrefetchRequest);
+}
+
+void TextViewerPage::cancelPrefetch()
+{
+    if (prefetchJob)
+    {
+        prefetchJob->cancel();  // The worker stops at the next character
+        prefetchJob->release(); // The request is freed when the worker drops its reference
+        prefetchJob = nullptr;
+    }
+}
+
 // --- Private Member Variables --- (Adding detectedBookmarks here for clarity)
 std::vector<int> detectedBookmarks; // Stores line numbers of automatically detected bookmarks
 
@@ -157,62 +252,78 @@ void TextViewerPage::display()
         }
     }
 
-    // If metadata calculation/loading failed, the respective functions would have set fileLoaded=true
-    // and potentially stored an error message in lines[0].
-    // So, we clear *after* loadContent potentially displayed progress.
-    displayManager.clear();
+    // Metadata is ready (or failed with an error message): repaint the whole page at the end of the frame.
+    // The loading progress drawn by calculateFileMetadata() is replaced then.
+    invalidate(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+}
 
-    // Draw Back Button (similar to FileBrowserPage)
-    displayManager.getTFT()->fillRoundRect(BACK_BUTTON_X, BACK_BUTTON_Y, BACK_BUTTON_WIDTH, BACK_BUTTON_HEIGHT, 5, TFT_BLUE);
-    displayManager.getTFT()->drawRoundRect(BACK_BUTTON_X, BACK_BUTTON_Y, BACK_BUTTON_WIDTH, BACK_BUTTON_HEIGHT, 5, TFT_WHITE);
-    displayManager.drawCenteredText("Back", BACK_BUTTON_X, BACK_BUTTON_Y, BACK_BUTTON_WIDTH, BACK_BUTTON_HEIGHT, 1, false);
+// Repaint the parts of the page that intersect clip (drawing outside clip is clipped away)
+void TextViewerPage::paint(const DirtyRect &clip)
+{
+    displayManager.getTFT()->fillRect(clip.x, clip.y, clip.w, clip.h, TFT_BLACK);
+    if (clip.intersects(0, 0, SCREEN_WIDTH, CONTENT_Y))
+    {
+        drawToolbar();
+    }
+    if (!fileLoaded) // Check if metadata calculation is done
+    {
+        return;
+    }
+    bool contentDirty = clip.intersects(0, CONTENT_Y, SCREEN_WIDTH, CONTENT_HEIGHT);
+    // Check if an error occurred during metadata calculation
+    if (this->errorMessage.length() > 0)
+    {
+        if (contentDirty)
+        {
+            displayManager.drawCenteredText(this->errorMessage.c_str(), 0, CONTENT_Y, SCREEN_WIDTH, CONTENT_HEIGHT, 2);
+        }
+    }
+    else if (totalLines > 0)
+    {
+        // Only draw content and scrollbar if no error and metadata loaded
+        // --- Draw scrollbar FIRST ---
+        if (clip.intersects(SCROLLBAR_X, CONTENT_Y, SCROLLBAR_WIDTH, CONTENT_HEIGHT))
+        {
+            drawScrollbar();
+        }
+        // --- Then draw content (skipped when only the scrollbar changed, e.g. a bookmark toggle) ---
+        if (clip.intersects(TEXT_MARGIN_X, CONTENT_Y, CONTENT_WIDTH, CONTENT_HEIGHT))
+        {
+            drawContent();
+        }
+    }
+    else if (contentDirty)
+    {
+        // Handle case where fileLoaded is true but no lines/positions (e.g., empty file)
+        displayManager.drawCenteredText("File is empty.", 0, CONTENT_Y, SCREEN_WIDTH, CONTENT_HEIGHT, 2);
+    }
+}
 
+// Back, Top and the three bookmark buttons, plus the separator above the content area
+void TextViewerPage::drawToolbar()
+{
+    // Buttons are rendered once into the widget cache and blitted afterwards
+    WidgetCache &widgets = WidgetCache::getInstance();
+    // Draw Back Button (similar to FileBrowserPage)
+    widgets.drawButton("Back", BACK_BUTTON_X, BACK_BUTTON_Y, BACK_BUTTON_WIDTH, BACK_BUTTON_HEIGHT, TFT_BLUE, TFT_WHITE, 1, false);
     // Draw Top Button
-    displayManager.getTFT()->fillRoundRect(TOP_BUTTON_X, TOP_BUTTON_Y, TOP_BUTTON_WIDTH, TOP_BUTTON_HEIGHT, 5, TFT_CYAN); // Different color
-    displayManager.getTFT()->drawRoundRect(TOP_BUTTON_X, TOP_BUTTON_Y, TOP_BUTTON_WIDTH, TOP_BUTTON_HEIGHT, 5, TFT_WHITE);
-    displayManager.drawCenteredText("Top", TOP_BUTTON_X, TOP_BUTTON_Y, TOP_BUTTON_WIDTH, TOP_BUTTON_HEIGHT, 1, false);
-
+    widgets.drawButton("Top", TOP_BUTTON_X, TOP_BUTTON_Y, TOP_BUTTON_WIDTH, TOP_BUTTON_HEIGHT, TFT_CYAN, TFT_WHITE, 1, false); // Different color
     // Draw Prev Bookmark Button
-    displayManager.getTFT()->fillRoundRect(PREV_BM_BUTTON_X, PREV_BM_BUTTON_Y, PREV_BM_BUTTON_WIDTH, PREV_BM_BUTTON_HEIGHT, 5, TFT_ORANGE);
-    displayManager.getTFT()->drawRoundRect(PREV_BM_BUTTON_X, PREV_BM_BUTTON_Y, PREV_BM_BUTTON_WIDTH, PREV_BM_BUTTON_HEIGHT, 5, TFT_WHITE);
-    displayManager.drawCenteredText("<", PREV_BM_BUTTON_X, PREV_BM_BUTTON_Y, PREV_BM_BUTTON_WIDTH, PREV_BM_BUTTON_HEIGHT, 2, false); // Larger font for symbol
-
+    widgets.drawButton("<", PREV_BM_BUTTON_X, PREV_BM_BUTTON_Y, PREV_BM_BUTTON_WIDTH, PREV_BM_BUTTON_HEIGHT, TFT_ORANGE, TFT_WHITE, 2, false); // Larger font for symbol
     // Draw Bookmark Add/Remove Button
-    displayManager.getTFT()->fillRoundRect(BM_BUTTON_X, BM_BUTTON_Y, BM_BUTTON_WIDTH, BM_BUTTON_HEIGHT, 5, TFT_MAGENTA);
-    displayManager.getTFT()->drawRoundRect(BM_BUTTON_X, BM_BUTTON_Y, BM_BUTTON_WIDTH, BM_BUTTON_HEIGHT, 5, TFT_WHITE);
-    displayManager.drawCenteredText("Bmk", BM_BUTTON_X, BM_BUTTON_Y, BM_BUTTON_WIDTH, BM_BUTTON_HEIGHT, 1, false);
-
+    widgets.drawButton("Bmk", BM_BUTTON_X, BM_BUTTON_Y, BM_BUTTON_WIDTH, BM_BUTTON_HEIGHT, TFT_MAGENTA, TFT_WHITE, 1, false);
     // Draw Next Bookmark Button
-    displayManager.getTFT()->fillRoundRect(NEXT_BM_BUTTON_X, NEXT_BM_BUTTON_Y, NEXT_BM_BUTTON_WIDTH, NEXT_BM_BUTTON_HEIGHT, 5, TFT_ORANGE);
-    displayManager.getTFT()->drawRoundRect(NEXT_BM_BUTTON_X, NEXT_BM_BUTTON_Y, NEXT_BM_BUTTON_WIDTH, NEXT_BM_BUTTON_HEIGHT, 5, TFT_WHITE);
-    displayManager.drawCenteredText(">", NEXT_BM_BUTTON_X, NEXT_BM_BUTTON_Y, NEXT_BM_BUTTON_WIDTH, NEXT_BM_BUTTON_HEIGHT, 2, false); // Larger font for symbol
+    widgets.drawButton(">", NEXT_BM_BUTTON_X, NEXT_BM_BUTTON_Y, NEXT_BM_BUTTON_WIDTH, NEXT_BM_BUTTON_HEIGHT, TFT_ORANGE, TFT_WHITE, 2, false); // Larger font for symbol
 
     // Draw Content Area Separator (remains the same Y position)
     displayManager.getTFT()->drawFastHLine(0, CONTENT_Y - TEXT_MARGIN_Y - 1, SCREEN_WIDTH, TFT_DARKGREY); // Adjusted Y slightly for clarity
+}
 
-    if (fileLoaded) // Check if metadata calculation is done
-    {
-        // Check if an error occurred during metadata calculation
-        if (this->errorMessage.length() > 0)
-        { // Use this->errorMessage
-            displayManager.drawCenteredText(this->errorMessage.c_str(), 0, CONTENT_Y, SCREEN_WIDTH, CONTENT_HEIGHT, 2);
-        }
-        else if (totalLines > 0)
-        { // Check if metadata seems valid (just check lines now)
-            // Only draw content and scrollbar if no error and metadata loaded
-
-            // --- Draw scrollbar FIRST ---
-            drawScrollbar();
-            // --- Then draw content ---
-            drawContent();
-        }
-        else
-        {
-            // Handle case where fileLoaded is true but no lines/positions (e.g., empty file)
-            displayManager.drawCenteredText("File is empty.", 0, CONTENT_Y, SCREEN_WIDTH, CONTENT_HEIGHT, 2);
-        }
-    }
-    // No explicit else needed here, as loadContent handles the initial "Loading..." or error display.
+// Mark the text and the scrollbar for repaint (after the scroll position changed)
+void TextViewerPage::invalidateContent()
+{
+    invalidate(TEXT_MARGIN_X, CONTENT_Y, CONTENT_WIDTH, CONTENT_HEIGHT);
+    invalidate(SCROLLBAR_X, CONTENT_Y, SCROLLBAR_WIDTH, CONTENT_HEIGHT); // Merged with the text area by the compositor
 }
 
 void TextViewerPage::handleTouch(uint16_t x, uint16_t y)
@@ -233,16 +344,7 @@ void TextViewerPage::handleTouch(uint16_t x, uint16_t y)
         {
             Serial.println("Top button touched. Scrolling to top.");
             currentScrollLine = 0;
-            // Redraw content and scrollbar
-            int scrollbarX = SCREEN_WIDTH - SCROLLBAR_WIDTH - SCROLLBAR_MARGIN;
-            int contentClearX = TEXT_MARGIN_X;
-            int contentClearY = CONTENT_Y;
-            int contentClearWidth = SCREEN_WIDTH - TEXT_MARGIN_X * 2 - SCROLLBAR_WIDTH - SCROLLBAR_MARGIN;
-            int contentClearHeight = CONTENT_HEIGHT;
-            displayManager.getTFT()->fillRect(contentClearX, contentClearY, contentClearWidth, contentClearHeight, TFT_BLACK);
-            displayManager.getTFT()->fillRect(scrollbarX, contentClearY, SCROLLBAR_WIDTH, contentClearHeight, TFT_BLACK); // Clear scrollbar track area
-            drawContent();
-            drawScrollbar();
+            invalidateContent(); // Redraw content and scrollbar
         }
         return; // Don't process other touches if Top button was hit
     }
@@ -301,16 +403,7 @@ void TextViewerPage::handleTouch(uint16_t x, uint16_t y)
                 currentScrollLine = targetLine;
                 Serial.printf("Scrollbar touched. Jumping to line: %d\n", currentScrollLine);
 
-                // Redraw content and scrollbar (similar to handleScroll redraw logic)
-                int contentClearX = TEXT_MARGIN_X;
-                int contentClearY = CONTENT_Y;
-                int contentClearWidth = SCREEN_WIDTH - TEXT_MARGIN_X * 2 - SCROLLBAR_WIDTH - SCROLLBAR_MARGIN;
-                int contentClearHeight = CONTENT_HEIGHT;
-                displayManager.getTFT()->fillRect(contentClearX, contentClearY, contentClearWidth, contentClearHeight, TFT_BLACK);
-                displayManager.getTFT()->fillRect(scrollbarX, contentClearY, SCROLLBAR_WIDTH, contentClearHeight, TFT_BLACK); // Clear scrollbar track area
-
-                drawContent();
-                drawScrollbar();
+                invalidateContent(); // Redraw content and scrollbar (similar to handleScroll)
             }
         }
         // Check if touch is within the main content area (excluding header/button AND scrollbar)
@@ -414,6 +507,11 @@ void TextViewerPage::updateLoadingProgress(size_t currentBytes, size_t totalByte
     // displayManager.getTFT()->display(); // Or similar command if available/needed
 }
 
+int TextViewerPage::textAreaWidth()
+{
+    return SCREEN_WIDTH - TEXT_MARGIN_X * 2 - SCROLLBAR_WIDTH - SCROLLBAR_MARGIN;
+}
+
 void TextViewerPage::calculateLayout()
 {
     // Use font size 1 (16x16) for calculations
@@ -476,19 +574,17 @@ void TextViewerPage::calculateFileMetadata()
     // int lastPercentage = -1; // No longer using percentage for update trigger
     unsigned long lastProgressUpdateMillis = 0; // Track time of last progress update
 
-    // --- Local line counter for this pass ---
-    int calculatedLines = 0;
     lineIndex[0] = 0; // First line always starts at position 0
 
     // --- Initial progress display ---
-    displayManager.clear();                                  // Clear screen for loading progress
-    updateLoadingProgress(0, totalSize, calculatedLines, 0); // Show 0 lines, 0 elapsed initially
-    yield();                                                 // Allow display to update
+    displayManager.clear();                    // Clear screen for loading progress
+    updateLoadingProgress(0, totalSize, 0, 0); // Show 0 lines, 0 elapsed initially
+    yield();                                   // Allow display to update
 
     Serial.print("Loading file: ");
     Serial.println(pathCStr); // Log start of loading
 
-    int availableWidth = SCREEN_WIDTH - TEXT_MARGIN_X * 2 - SCROLLBAR_WIDTH - SCROLLBAR_MARGIN;
+    int availableWidth = textAreaWidth();
     if (availableWidth <= 0)
     {
         Serial.println("Error: Screen too narrow for text.");
@@ -500,43 +596,50 @@ void TextViewerPage::calculateFileMetadata()
         return;
     }
 
-    String currentLine = "";
-    String wordBuffer = "";
-
-    // Define the width calculation lambda function *before* the loop
-    auto calculateStringWidth = [&](const String &s) -> int
+    // Line breaking is shared with drawContent() (TextLayout), so both passes agree on line numbers.
+    // Each completed line updates the counter, the partial index and the detected bookmarks.
+    struct MetadataPass
     {
-        int totalWidth = 0;
-        size_t offset = 0;
-        uint16_t baseSize = TEXT_FONT_SIZE * 16; // Base size (e.g., 16)
-        while (offset < s.length())
+        TextViewerPage *page;
+        int lines;
+    };
+    MetadataPass pass = {this, 0};
+    TextLayout layout(availableWidth, TEXT_FONT_SIZE * 16, [](void *ctx, const String &line, size_t nextLineOffset, TextLayout::LineEnd end)
+    {
+        MetadataPass *pass = static_cast<MetadataPass *>(ctx);
+        int lineNumber = pass->lines++;
+        // --- Bookmark Detection ---
+        if (line.indexOf("%书签标志%") != -1)
         {
-            String nextCharStr = fontManager.getNextCharacter(s.c_str(), offset);
-            if (nextCharStr.length() > 0)
+            // Lines ended by a newline have always recorded the line after the marker
+            int bookmarkLine = (end == TextLayout::LineEnd::PARAGRAPH) ? pass->lines : lineNumber;
+            std::vector<int> &detected = pass->page->detectedBookmarks;
+            if (detected.empty() || detected.back() != bookmarkLine)
             {
-                // Estimate width: ASCII ~ half, Non-ASCII ~ full
-                if (fontManager.isAscii(nextCharStr.c_str()))
-                {
-                    totalWidth += baseSize / 2; // Estimate ASCII width as half
-                }
-                else
-                {
-                    totalWidth += baseSize; // Estimate Non-ASCII width as full
-                }
+                detected.push_back(bookmarkLine);
+                Serial.printf("DEBUG: Added detected bookmark for line: %d. Total detected: %u\n", bookmarkLine, detected.size());
             }
         }
-        return totalWidth;
-    };
+        // --- End Bookmark Detection ---
+        // Store index point if interval is reached (the start of the next line)
+        if (end != TextLayout::LineEnd::END && pass->lines % INDEX_INTERVAL == 0)
+        {
+            pass->page->lineIndex[pass->lines] = nextLineOffset;
+        }
+    }, &pass);
+    layout.reset(0);
 
+    size_t position = 0; // File offset of the next byte (avoids File::position() per byte)
     while (file.available())
     {
         char c = file.read();
+        position++;
 
         // --- Periodic Progress Update (Time-based) ---
         unsigned long currentMillis = millis();
         if (currentMillis - lastProgressUpdateMillis >= 100)
-        { // Update every 20ms
-            updateLoadingProgress(file.position(), totalSize, calculatedLines, currentMillis - startTimeMillis);
+        { // Update every 100ms
+            updateLoadingProgress(position, totalSize, pass.lines, currentMillis - startTimeMillis);
             lastProgressUpdateMillis = currentMillis; // Record time of this update
             yield();                                  // Allow other tasks (like display updates) to run
         }
@@ -548,266 +651,29 @@ void TextViewerPage::calculateFileMetadata()
             if (c == '\r' && file.peek() == '\n')
             {
                 file.read(); // Consume the '\n' for CRLF
+                position++;
             }
-
-            // Process the completed line (including the last word buffer content)
-            // size_t lineStartPosition = file.position(); // No longer storing positions
-
-            if (wordBuffer.length() > 0)
-            {
-                if (calculateStringWidth(currentLine) + calculateStringWidth(wordBuffer) <= availableWidth)
-                {
-                    currentLine += wordBuffer;
-                }
-                else
-                {
-                    // Final word doesn't fit, count the line without it
-                    if (currentLine.length() > 0)
-                    {
-                        calculatedLines++;
-                        // Position for the *next* line (the wordBuffer) is tricky, estimate based on current char pos?
-                        // For simplicity, we'll store the position *after* the newline for now.
-                        // The seek in drawContent will need refinement if exact word start is needed.
-                    }
-                    currentLine = wordBuffer; // Word becomes the new line
-                }
-                wordBuffer = ""; // Clear buffer after processing
-            }
-            calculatedLines++; // Count the completed line
-            // --- Bookmark Detection ---
-            String fullLineContent = currentLine; // Check the line content before resetting
-            int bookmarkIndex = fullLineContent.indexOf("%书签标志%");
-            if (bookmarkIndex != -1)
-            {
-                Serial.printf("DEBUG: Found '%%书签标志%%' in line content: '%s' at index %d\n", fullLineContent.c_str(), bookmarkIndex);
-                if (detectedBookmarks.empty() || detectedBookmarks.back() != calculatedLines)
-                { // Avoid duplicates for same line
-                    detectedBookmarks.push_back(calculatedLines);
-                    Serial.printf("DEBUG: Added detected bookmark for line: %d. Total detected: %u\n", calculatedLines, detectedBookmarks.size());
-                }
-                else
-                {
-                    Serial.printf("DEBUG: Duplicate bookmark marker detected for line: %d. Skipping add.\n", calculatedLines);
-                }
-            }
-            // --- End Bookmark Detection ---
-
-            // Store index point if interval is reached
-            if (calculatedLines % INDEX_INTERVAL == 0)
-            {
-                // Store the position *after* the newline, which is the start of the next line
-                lineIndex[calculatedLines] = file.position();
-            }
-            currentLine = ""; // Reset for the next line from the file
-            continue;         // Move to next character from file
-        }
-
-        // If it's not a newline, process the character for word wrapping
-
-        // Check width *before* adding the character to the word buffer
-        // This helps in deciding whether to break the line *before* the current word
-        int currentLinePixelWidth = calculateStringWidth(currentLine);
-        // Test width with potential new char added to word buffer
-        int wordBufferPlusCharWidth = calculateStringWidth(wordBuffer + c);
-
-        // Case 1: Adding the current character to the word buffer makes it exceed the line width
-        if (currentLinePixelWidth + wordBufferPlusCharWidth > availableWidth)
-        {
-            // Subcase 1.1: The current line already has content.
-            if (currentLine.length() > 0)
-            {
-                // --- Bookmark Detection ---
-                if (currentLine.indexOf("%书签标志%") != -1)
-                {
-                    if (detectedBookmarks.empty() || detectedBookmarks.back() != calculatedLines)
-                    {
-                        detectedBookmarks.push_back(calculatedLines);
-                        Serial.printf("Detected bookmark marker at wrapped line: %d\n", calculatedLines);
-                    }
-                }
-                // --- End Bookmark Detection ---
-                // Count the current line (without the word buffer)
-                calculatedLines++;
-                // Store index point if interval is reached
-                if (calculatedLines % INDEX_INTERVAL == 0)
-                {
-                    // Position is tricky here. It's the start of the wordBuffer line.
-                    // Estimate based on current file position minus the buffer length + char we just read.
-                    lineIndex[calculatedLines] = file.position() - (wordBuffer.length() + 1);
-                }
-                // Start the new line with the word buffer (which doesn't include 'c' yet)
-                currentLine = wordBuffer;
-                wordBuffer = ""; // Clear word buffer
-                // Start new word buffer with the current character 'c' (unless it's leading whitespace)
-                if (c != ' ' && c != '\t')
-                {
-                    wordBuffer += c;
-                }
-            }
-            // Subcase 1.2: The current line is empty, meaning the word buffer itself (plus 'c') is too long.
-            else
-            {
-                // We need to break the word buffer itself.
-                String fittedPart = "";
-                String remainingPart = "";
-                int fittedWidth = 0;
-                size_t wordOffset = 0;
-                uint16_t baseSize = TEXT_FONT_SIZE * 16;
-
-                // Iterate through the *existing* wordBuffer to see what fits
-                while (wordOffset < wordBuffer.length())
-                {
-                    String nextCharStr = fontManager.getNextCharacter(wordBuffer.c_str(), wordOffset);
-                    if (nextCharStr.length() > 0)
-                    {
-                        int charWidth = fontManager.isAscii(nextCharStr.c_str()) ? (baseSize / 2) : baseSize;
-                        if (fittedWidth + charWidth <= availableWidth)
-                        {
-                            fittedPart += nextCharStr;
-                            fittedWidth += charWidth;
-                        }
-                        else
-                        {
-                            // Character doesn't fit, the rest goes to remainingPart
-                            // Correctly get the substring from the *start* of the character that didn't fit
-                            remainingPart = wordBuffer.substring(wordOffset - nextCharStr.length());
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        break; // End of word buffer string
-                    }
-                }
-
-                // Add the part that fits (if any)
-                if (fittedPart.length() > 0)
-                {
-                    // --- Bookmark Detection ---
-                    if (fittedPart.indexOf("%书签标志%") != -1)
-                    {
-                        if (detectedBookmarks.empty() || detectedBookmarks.back() != calculatedLines)
-                        {
-                            detectedBookmarks.push_back(calculatedLines);
-                            Serial.printf("Detected bookmark marker at hard-wrapped line: %d\n", calculatedLines);
-                        }
-                    }
-                    // --- End Bookmark Detection ---
-                    calculatedLines++; // Count the fitted part as a line
-                    // Store index point if interval is reached
-                    if (calculatedLines % INDEX_INTERVAL == 0)
-                    {
-                        // Position is start of remainingPart line. Estimate.
-                        lineIndex[calculatedLines] = file.position() - (remainingPart.length() + 1);
-                    }
-                }
-                // The remaining part becomes the new word buffer, starting with the current char 'c' (unless whitespace)
-                wordBuffer = remainingPart;
-                if (c != ' ' && c != '\t')
-                {
-                    wordBuffer += c;
-                }
-                currentLine = ""; // Ensure current line is empty
-            }
-        }
-        // Case 2: Adding the character doesn't exceed the width
-        else
-        {
-            // Add the character to the word buffer
-            wordBuffer += c;
-
-            // If the character is a word separator (space/tab), add the word buffer to the current line
-            if (c == ' ' || c == '\t')
-            {
-                // Check if adding the word buffer (including space) fits
-                if (calculateStringWidth(currentLine) + calculateStringWidth(wordBuffer) <= availableWidth)
-                {
-                    currentLine += wordBuffer; // Add word buffer (including the space/tab)
-                    wordBuffer = "";           // Clear word buffer for the next word
-                }
-                else
-                {
-                    // Word buffer with space doesn't fit. Count current line.
-                    if (currentLine.length() > 0)
-                    {
-                        calculatedLines++;
-                        // Store index point if interval is reached
-                        if (calculatedLines % INDEX_INTERVAL == 0)
-                        {
-                            // Position is start of wordBuffer line. Estimate.
-                            lineIndex[calculatedLines] = file.position() - (wordBuffer.length() + 1);
-                        }
-                    }
-                    // Start new line with the word buffer (including space)
-                    currentLine = wordBuffer;
-                    wordBuffer = "";
-                }
-            }
-            // else: it's a normal character within a word, just keep accumulating in wordBuffer
+            layout.endParagraph(position);
+            continue;
         }
+        layout.feed(c);
     } // End of while(file.available()) loop
 
     // --- Final progress update ---
     // Ensure 100% is shown, along with the final line count and final time
-    updateLoadingProgress(totalSize, totalSize, calculatedLines, millis() - startTimeMillis);
-    // A small delay might be needed here if the screen clears too quickly
-    // delay(100); // Optional: delay 100ms to ensure 100% is visible
-
-    // Add any remaining content from the buffers after the loop finishes
-    if (wordBuffer.length() > 0)
-    {
-        // Check if the final word fits on the last line
-        if (calculateStringWidth(currentLine) + calculateStringWidth(wordBuffer) <= availableWidth)
-        {
-            currentLine += wordBuffer;
-        }
-        else
-        {
-            // Doesn't fit, count the current line (if any)
-            if (currentLine.length() > 0)
-            {
-                calculatedLines++;
-                // Store index point if interval is reached
-                if (calculatedLines % INDEX_INTERVAL == 0)
-                {
-                    // Position is start of wordBuffer line. Estimate.
-                    lineIndex[calculatedLines] = file.position() - wordBuffer.length();
-                }
-            }
-            currentLine = wordBuffer; // Word buffer becomes the last line
-        }
-    }
-    // Count the very last line if it has content
-    if (currentLine.length() > 0)
-    {
-        // --- Bookmark Detection ---
-        int finalBookmarkIndex = currentLine.indexOf("%书签标志%");
-        if (finalBookmarkIndex != -1)
-        {
-            Serial.printf("DEBUG: Found '%%书签标志%%' in final line content: '%s' at index %d\n", currentLine.c_str(), finalBookmarkIndex);
-            if (detectedBookmarks.empty() || detectedBookmarks.back() != calculatedLines)
-            {
-                detectedBookmarks.push_back(calculatedLines);
-                Serial.printf("DEBUG: Added detected bookmark for final line: %d. Total detected: %u\n", calculatedLines, detectedBookmarks.size());
-            }
-            else
-            {
-                Serial.printf("DEBUG: Duplicate bookmark marker detected for final line: %d. Skipping add.\n", calculatedLines);
-            }
-        }
-        // --- End Bookmark Detection ---
-        calculatedLines++;
-        // Store index point if interval is reached (unlikely for the very last line, but check)
-        if (calculatedLines % INDEX_INTERVAL == 0)
-        {
-            // Position is tricky, maybe store end of file? Or just rely on previous index.
-            // Let's not store an index for the very last partial line.
-        }
-    }
+    updateLoadingProgress(totalSize, totalSize, pass.lines, millis() - startTimeMillis);
 
+    // Count whatever is left in the line/word buffers
+    layout.finish();
     file.close();
-    totalLines = calculatedLines; // Store the final calculated count
+    totalLines = pass.lines; // Store the final calculated count
     fileLoaded = true;            // Mark metadata as calculated *after* processing
+    if (restoreScrollLine >= 0)
+    {
+        // Recalculated because the cache was outdated: return to where the reader was
+        currentScrollLine = std::max(0, std::min(restoreScrollLine, totalLines - linesPerPage));
+        restoreScrollLine = -1;
+    }
     Serial.printf("File metadata calculated. Total wrapped lines: %d. Index points: %d\n", totalLines, lineIndex.size());
 
     // If calculation was successful (no error message), save to cache
@@ -825,14 +691,10 @@ void TextViewerPage::calculateFileMetadata()
 // Refactored drawContent: Reads file on demand, wraps, and draws visible lines.
 void TextViewerPage::drawContent()
 {
-    int y = CONTENT_Y;  // Starting Y position for drawing text
-    int linesDrawn = 0; // Counter for lines drawn on the current screen
+    TRACE_SPAN(TraceName::TEXT_DRAW_CONTENT);
+    int y = CONTENT_Y; // Starting Y position for drawing text
 
-    // Clear the content area before drawing new text
-    displayManager.getTFT()->fillRect(TEXT_MARGIN_X, y,
-                                      SCREEN_WIDTH - TEXT_MARGIN_X * 2 - SCROLLBAR_WIDTH - SCROLLBAR_MARGIN,
-                                      CONTENT_HEIGHT, // Use calculated content height
-                                      TFT_BLACK);     // Assuming black background
+    // The content area has already been cleared by paint()
 
     // --- File Reading and On-the-Fly Wrapping/Drawing ---
     const char *pathCStr = filePath.c_str();
@@ -844,7 +706,7 @@ void TextViewerPage::drawContent()
         return;
     }
 
-    int availableWidth = SCREEN_WIDTH - TEXT_MARGIN_X * 2 - SCROLLBAR_WIDTH - SCROLLBAR_MARGIN;
+    int availableWidth = textAreaWidth();
     if (availableWidth <= 0)
     {
         displayManager.drawText("Error: Screen too narrow.", TEXT_MARGIN_X, y, TEXT_FONT_SIZE, true);
@@ -887,56 +749,35 @@ void TextViewerPage::drawContent()
     }
 
     // --- Read from seeked position, count lines until currentScrollLine ---
-    String currentLine = "";
-    String wordBuffer = "";
-    int linesProcessedSoFar = seekLine; // Start counting from the line we seeked to
-
-    // Re-use the width calculation lambda
-    auto calculateStringWidth = [&](const String &s) -> int
+    // Wrapping uses the same TextLayout as calculateFileMetadata(), so line numbers match the index.
+    struct DrawPass
     {
-        int totalWidth = 0;
-        size_t offset = 0;
-        uint16_t baseSize = TEXT_FONT_SIZE * 16;
-        while (offset < s.length())
-        {
-            String nextCharStr = fontManager.getNextCharacter(s.c_str(), offset);
-            if (nextCharStr.length() > 0)
-            {
-                if (fontManager.isAscii(nextCharStr.c_str()))
-                {
-                    totalWidth += baseSize / 2;
-                }
-                else
-                {
-                    totalWidth += baseSize;
-                }
-            }
-        }
-        return totalWidth;
+        TextViewerPage *page;
+        int y;
+        int linesProcessedSoFar; // Start counting from the line we seeked to
+        int linesDrawn;
     };
-
-    // Lambda to draw a line *if* it's within the visible range
-    auto drawVisibleLine = [&](const String &lineToDraw)
+    DrawPass pass = {this, y, seekLine, 0};
+    // Draw a line *if* it's within the visible range
+    TextLayout layout(availableWidth, TEXT_FONT_SIZE * 16, [](void *ctx, const String &lineToDraw, size_t, TextLayout::LineEnd)
     {
-        if (linesProcessedSoFar >= currentScrollLine && linesDrawn < linesPerPage)
+        DrawPass *pass = static_cast<DrawPass *>(ctx);
+        TextViewerPage *page = pass->page;
+        if (pass->linesProcessedSoFar >= page->currentScrollLine && pass->linesDrawn < page->linesPerPage)
         {
-            displayManager.drawText(lineToDraw.c_str(), TEXT_MARGIN_X, y + (linesDrawn * lineHeight), TEXT_FONT_SIZE, true);
-            linesDrawn++;
+            page->displayManager.drawText(lineToDraw.c_str(), TEXT_MARGIN_X, pass->y + (pass->linesDrawn * page->lineHeight), TEXT_FONT_SIZE, true);
+            pass->linesDrawn++;
         }
-        linesProcessedSoFar++; // Increment *after* checking visibility
-    };
-
-    // bool touchDetected = false; // REMOVED: Flag for touch interruption
+        pass->linesProcessedSoFar++; // Increment *after* checking visibility
+    }, &pass);
+    layout.reset(seekPos);
 
     // Read from the seeked position until enough lines are drawn or EOF
-    while (file.available() && linesDrawn < linesPerPage) // Stop drawing if screen is full
+    size_t position = seekPos;
+    while (file.available() && pass.linesDrawn < linesPerPage) // Stop drawing if screen is full
     {
-        // --- REMOVED: Check for touch interrupt ---
-        // if (touchManager.isTouched()) { ... }
-        // --- End removed touch check ---
-
-        // Read character by character from the seeked position
         char c = file.read();
+        position++;
 
         // Handle line breaks first (CRLF, LF, CR)
         if (c == '\n' || c == '\r')
@@ -944,129 +785,30 @@ void TextViewerPage::drawContent()
             if (c == '\r' && file.peek() == '\n')
             {
                 file.read(); // Consume the '\n' for CRLF
+                position++;
             }
-
-            // Process the completed line (including the last word buffer content)
-            if (wordBuffer.length() > 0)
-            {
-                if (calculateStringWidth(currentLine) + calculateStringWidth(wordBuffer) <= availableWidth)
-                {
-                    currentLine += wordBuffer;
-                }
-                else
-                {
-                    // Word doesn't fit after newline
-                    if (currentLine.length() > 0)
-                        drawVisibleLine(currentLine); // Draw previous line if not empty
-                    currentLine = wordBuffer;         // Word becomes the new line
-                }
-                wordBuffer = "";
-            }
-            // Draw the completed line (which might be empty if file ended with newline)
-            drawVisibleLine(currentLine);
-            currentLine = "";
-            continue; // Move to next char
-        }
-
-        // If it's not a newline, process the character for word wrapping
-        int currentLinePixelWidth = calculateStringWidth(currentLine);
-        int wordBufferPlusCharWidth = calculateStringWidth(wordBuffer + c);
-
-        // Case 1: Adding the current character makes the word buffer exceed the line width
-        if (currentLinePixelWidth + wordBufferPlusCharWidth > availableWidth)
-        {
-            // Subcase 1.1: The current line already has content.
-            if (currentLine.length() > 0)
-            {
-                drawVisibleLine(currentLine); // Draw the current line
-                currentLine = wordBuffer;     // Start new line with word buffer
-                wordBuffer = "";
-                if (c != ' ' && c != '\t')
-                    wordBuffer += c; // Start new word buffer unless whitespace
-            }
-            // Subcase 1.2: The current line is empty (long word needs breaking).
-            else
-            {
-                String fittedPart = "";
-                String remainingPart = "";
-                int fittedWidth = 0;
-                size_t wordOffset = 0;
-                uint16_t baseSize = TEXT_FONT_SIZE * 16;
-                while (wordOffset < wordBuffer.length())
-                {
-                    String nextCharStr = fontManager.getNextCharacter(wordBuffer.c_str(), wordOffset);
-                    if (nextCharStr.length() > 0)
-                    {
-                        int charWidth = fontManager.isAscii(nextCharStr.c_str()) ? (baseSize / 2) : baseSize;
-                        if (fittedWidth + charWidth <= availableWidth)
-                        {
-                            fittedPart += nextCharStr;
-                            fittedWidth += charWidth;
-                        }
-                        else
-                        {
-                            remainingPart = wordBuffer.substring(wordOffset - nextCharStr.length());
-                            break;
-                        }
-                    }
-                    else
-                        break;
-                }
-                if (fittedPart.length() > 0)
-                    drawVisibleLine(fittedPart); // Draw the fitted part
-                wordBuffer = remainingPart;
-                if (c != ' ' && c != '\t')
-                    wordBuffer += c; // Start new word buffer unless whitespace
-                currentLine = "";
-            }
+            layout.endParagraph(position);
+            continue;
         }
-        // Case 2: Adding the character doesn't exceed the width
-        else
-        {
-            wordBuffer += c;
-            if (c == ' ' || c == '\t')
-            {
-                if (calculateStringWidth(currentLine) + calculateStringWidth(wordBuffer) <= availableWidth)
-                {
-                    currentLine += wordBuffer;
-                    wordBuffer = "";
-                }
-                else
-                {
-                    // Word buffer with space doesn't fit. Count current line.
-                    if (currentLine.length() > 0)
-                        drawVisibleLine(currentLine); // Draw current line
-                    currentLine = wordBuffer;         // Start new line with word buffer (incl. space)
-                    wordBuffer = "";
-                }
-            }
-        }
-        // Optimization: If we've already processed enough lines to get past the visible area,
-        // we could potentially break early, but the file.available() check handles this.
+        layout.feed(c);
     } // End while
 
-    // Draw any remaining content from the buffers after the loop finishes
-    if (wordBuffer.length() > 0)
+    // The page is full and there is more text: warm the font cache for the next page in the background.
+    // Buffered text has already been read from the file, so back up to where it starts.
+    bool pageFull = pass.linesDrawn >= linesPerPage && file.available();
+    if (pageFull)
     {
-        if (calculateStringWidth(currentLine) + calculateStringWidth(wordBuffer) <= availableWidth)
-        {
-            currentLine += wordBuffer;
-        }
-        else
-        {
-            // Doesn't fit, count the current line (if any) and add the word buffer as a new line
-            if (currentLine.length() > 0)
-                drawVisibleLine(currentLine);
-            currentLine = wordBuffer; // Word buffer becomes the last line
-        }
+        nextPagePosition = layout.pendingOffset();
     }
-    // Draw the very last line if it has content and we haven't filled the page yet
-    if (currentLine.length() > 0)
+    else
     {
-        drawVisibleLine(currentLine); // Draw the very last line if needed
+        layout.finish(); // Draw any remaining content from the buffers (end of file)
     }
-
     file.close(); // Close the file regardless of how the loop exited
+    if (pageFull)
+    {
+        startNextPagePrefetch(availableWidth);
+    }
 
     // --- REMOVED: Handle touch if detected ---
     // if (touchDetected) { ... }
@@ -1087,8 +829,7 @@ void TextViewerPage::drawScrollbar()
     int scrollbarY = CONTENT_Y;           // Align with text content area top
     int scrollbarHeight = CONTENT_HEIGHT; // Align with text content area height
 
-    // Draw scrollbar track (clear previous first)
-    displayManager.getTFT()->fillRect(scrollbarX, scrollbarY, SCROLLBAR_WIDTH, scrollbarHeight, TFT_BLACK); // Clear area
+    // Draw scrollbar track (paint() has cleared it)
     displayManager.getTFT()->drawRect(scrollbarX, scrollbarY, SCROLLBAR_WIDTH, scrollbarHeight, TFT_DARKGREY);
 
     // Calculate handle size and position
@@ -1187,23 +928,8 @@ void TextViewerPage::handleScroll(int touchY)
     // Only redraw if scroll position actually changed
     if (currentScrollLine != previousScrollLine)
     {
-        // --- Clear only the content area, not the whole screen ---
-        int contentClearX = TEXT_MARGIN_X;
-        int contentClearY = CONTENT_Y;
-        int contentClearWidth = SCREEN_WIDTH - TEXT_MARGIN_X * 2 - SCROLLBAR_WIDTH - SCROLLBAR_MARGIN;
-        int contentClearHeight = CONTENT_HEIGHT;
-        displayManager.getTFT()->fillRect(contentClearX, contentClearY, contentClearWidth, contentClearHeight, TFT_BLACK);
-
-        // Clear the scrollbar area separately
-        int scrollbarX = SCREEN_WIDTH - SCROLLBAR_WIDTH - SCROLLBAR_MARGIN;
-        displayManager.getTFT()->fillRect(scrollbarX, contentClearY, SCROLLBAR_WIDTH, contentClearHeight, TFT_BLACK); // Clear scrollbar track area
-
-        // --- No need to redraw static elements ---
-
-        // Draw the updated scrollbar FIRST for immediate feedback
-        drawScrollbar();
-        // Then draw the updated content
-        drawContent();
+        // --- Repaint only the content area and scrollbar, not the toolbar ---
+        invalidateContent();
     }
 }
 
@@ -1215,6 +941,7 @@ void TextViewerPage::handleScroll(int touchY)
 void TextViewerPage::cleanup()
 {
     Serial.println("TextViewerPage::cleanup() called.");
+    cancelPrefetch();
 
     // Save current scroll position to cache before clearing state,
     // but only if the file was loaded successfully without errors.
@@ -1273,8 +1000,20 @@ bool TextViewerPage::loadMetadataFromCache(size_t currentOriginalFileSize)
     // Example: 10k index entries * ~20 bytes/entry = 200KB. 100 bookmarks * ~5 bytes = 0.5KB.
     // Add overhead for keys and structure. Let's try 256KB initially.
     // IMPORTANT: This might exceed available RAM on some ESP32 models! Monitor memory usage.
-    const size_t jsonCapacity = JSON_OBJECT_SIZE(5) + JSON_ARRAY_SIZE(500) + JSON_ARRAY_SIZE(10000) + 256 * 1024; // Adjust capacity as needed
-    DynamicJsonDocument doc(jsonCapacity);                                                                        // Allocate on heap
+    // The fixed 256KB request failed on boards without PSRAM once the font cache had grown, so ask the
+    // memory budget instead: each {"l":n,"p":n} entry costs about three times its text size in the pool.
+    const size_t desiredCapacity = JSON_OBJECT_SIZE(7) + JSON_ARRAY_SIZE(500) + JSON_ARRAY_SIZE(10000) + 256 * 1024;
+    const size_t minimumCapacity = cacheFile.size() * 3 + 1024;
+    const size_t jsonCapacity = MemoryBudget::getInstance().ensureAvailable(desiredCapacity, minimumCapacity);
+    if (jsonCapacity == 0)
+    {
+        Serial.printf("DEBUG: Not enough memory to parse cache (%u bytes needed).\n", minimumCapacity);
+        cacheFile.close();
+        errorMessage = "Cache not loaded (memory).";
+        return false; // Falls back to recalculating metadata
+    }
+    DynamicJsonDocument doc(jsonCapacity); // Allocate on heap
+    MemStats::Scoped docStats(MemTag::TEXT_CACHE_JSON, doc.capacity());
 
     Serial.println("DEBUG: Deserializing JSON from cache file...");
     DeserializationError error = deserializeJson(doc, cacheFile);
@@ -1299,6 +1038,22 @@ bool TextViewerPage::loadMetadataFromCache(size_t currentOriginalFileSize)
     }
     Serial.println("DEBUG: Cached file size matches current file size.");
 
+    // --- Validate cache version ---
+    // Older caches hold index offsets computed under other rules: recalculate, but keep what the reader set
+    if (doc["version"].as<int>() != TEXT_CACHE_VERSION)
+    {
+        Serial.printf("DEBUG: Cache version %d, expected %d. Recalculating the index.\n", doc["version"].as<int>(), TEXT_CACHE_VERSION);
+        restoreScrollLine = std::max(0, doc["lastScrollLine"].as<int>());
+        bookmarks.clear();
+        for (JsonVariant v : doc["bookmarks"].as<JsonArray>())
+        {
+            bookmarks.push_back(v.as<int>());
+        }
+        std::sort(bookmarks.begin(), bookmarks.end());
+        errorMessage = "Cache outdated.";
+        return false;
+    }
+
     // --- Extract data from JSON ---
     if (!doc.containsKey("totalLines") || !doc.containsKey("lastScrollLine"))
     {
@@ -1446,10 +1201,20 @@ void TextViewerPage::saveMetadataToCache()
 
     // --- Create JSON Document ---
     // Adjust capacity based on expected data size. See notes in loadMetadataFromCache.
-    const size_t jsonCapacity = JSON_OBJECT_SIZE(6) + JSON_ARRAY_SIZE(bookmarks.size()) + JSON_ARRAY_SIZE(detectedBookmarks.size()) + JSON_ARRAY_SIZE(lineIndex.size()) + 256 * 1024; // Adjust capacity
+    // The exact size is known here: one 2-member object per index entry plus the arrays (keys are literals).
+    const size_t minimumCapacity = JSON_OBJECT_SIZE(7) + JSON_ARRAY_SIZE(bookmarks.size()) + JSON_ARRAY_SIZE(detectedBookmarks.size()) +
+                                   JSON_ARRAY_SIZE(lineIndex.size()) + lineIndex.size() * JSON_OBJECT_SIZE(2) + 1024;
+    const size_t jsonCapacity = MemoryBudget::getInstance().ensureAvailable(minimumCapacity, minimumCapacity);
+    if (jsonCapacity == 0)
+    {
+        Serial.printf("DEBUG: Not enough memory to build cache JSON (%u bytes needed). Skipping save.\n", minimumCapacity);
+        return;
+    }
     DynamicJsonDocument doc(jsonCapacity);
+    MemStats::Scoped docStats(MemTag::TEXT_CACHE_JSON, doc.capacity());
 
     Serial.println("DEBUG: Populating JSON document...");
+    doc["version"] = TEXT_CACHE_VERSION;
     doc["originalFileSize"] = currentOriginalFileSize;
     doc["totalLines"] = totalLines;
     doc["lastScrollLine"] = currentScrollLine;
@@ -1574,8 +1339,8 @@ void TextViewerPage::toggleBookmark()
         Serial.printf("Bookmark added for line: %d\n", lineToBookmark);
     }
 
-    // Redraw the scrollbar immediately to show the updated markers
-    drawScrollbar();
+    // Repaint the scrollbar to show the updated markers (the text is unchanged)
+    invalidate(SCROLLBAR_X, CONTENT_Y, SCROLLBAR_WIDTH, CONTENT_HEIGHT);
     // No need to save cache immediately, will be saved on cleanup or next load.
 }
 
@@ -1621,8 +1386,8 @@ void TextViewerPage::goToPrevBookmark()
         {
             currentScrollLine = 0;
         }
-        // Full redraw needed after jump
-        display(); // Easiest way to trigger full redraw
+        // Content and scrollbar change after the jump; the toolbar does not
+        invalidateContent();
     }
     else
     {
@@ -1672,8 +1437,8 @@ void TextViewerPage::goToNextBookmark()
         {
             currentScrollLine = 0;
         }
-        // Full redraw needed after jump
-        display(); // Easiest way to trigger full redraw
+        // Content and scrollbar change after the jump; the toolbar does not
+        invalidateContent();
     }
     else
     {
@@ -1683,6 +1448,13 @@ void TextViewerPage::goToNextBookmark()
 }
 void TextViewerPage::handleLoop()
 {
-    // Currently no periodic tasks needed for text viewer
-    return;
+    // Poll the next-page prefetch job (never block the main loop on it)
+    if (prefetchJob && prefetchJob->isReady())
+    {
+        Serial.printf("Next page prefetch %s: queued %lu us, ran %lu us\n",
+                      prefetchJob->succeeded() ? "done" : "skipped",
+                      (unsigned long)prefetchJob->queueTimeUs(), (unsigned long)prefetchJob->runTimeUs());
+        prefetchJob->release();
+        prefetchJob = nullptr;
+    }
 }
\ No newline at end of file
@@ -10,10 +10,16 @@
 #include "../core/display.h"  // Display manager
 #include "../core/font.h"     // Font manager
 #include "../core/touch.h"    // Touch manager
+#include "../core/jobs.h"     // Background font prefetch for the next page
 #include "../config/config.h" // Screen dimensions etc.
 
 // Constants (moved INDEX_INTERVAL here for clarity)
 const int INDEX_INTERVAL = 100;  // Store position every 100 lines
+// Version of the .cacheinfo JSON ("version" key). Bump it whenever the cached line numbers or index
+// offsets would come out differently. 1 (no key): index points recorded before TextLayout, which stored
+// other offsets. Wrapped line numbers did not change, so an outdated cache keeps its scroll line and
+// manual bookmarks while the index is recalculated.
+const int TEXT_CACHE_VERSION = 2;
 
 // NOTE: CacheHeader and CacheIndexEntry structs removed as we are moving to a unified JSON cache.
 
@@ -28,22 +34,30 @@ private:
     bool useCache;             // Flag to indicate if loading from cache is intended
     // std::vector<String> lines; // No longer storing all lines
     // std::vector<size_t> lineStartPositions; // REMOVED: To save memory, avoid storing all positions
-    std::map<int, size_t> lineIndex; // Partial index: line number -> file position
+    // Partial index: line number -> file position. Nodes come from the page arena (heap once it is full),
+    // so the index is released wholesale when the page is destroyed instead of fragmenting the heap.
+    using LineIndexMap = std::map<int, size_t, std::less<int>, ArenaAllocator<std::pair<const int, size_t>>>;
+    LineIndexMap lineIndex;
     std::vector<int> bookmarks;      // Stores line numbers of manually added bookmarks
     std::vector<int> detectedBookmarks; // Stores line numbers of automatically detected bookmarks (%书签标志%)
 
     int currentScrollLine;     // Index of the top visible line
+    int restoreScrollLine;     // Scroll line kept from an outdated cache, applied after recalculation (-1: none)
     int totalLines;            // Total number of wrapped lines (calculated once)
     int linesPerPage;          // How many lines fit on the screen
     int lineHeight;            // Height of a single line in pixels
     bool fileLoaded;           // Flag indicating if file metadata (size, total lines) is calculated
     unsigned long startTimeMillis; // For ETC calculation
     String errorMessage;       // Stores error message from metadata calculation
+    JobFuture *prefetchJob;    // Pending FONT_PREFETCH job for the next page (nullptr if none)
+    size_t nextPagePosition;   // Approximate file position of the first line after the visible page
 
     // Private helper methods
     void calculateFileMetadata();  // Calculates total lines, size, and populates partial index
     void drawContent();            // Draws the visible text lines (uses partial index + sequential read)
     void drawScrollbar();          // Draws the scrollbar
+    void drawToolbar();            // Draws the buttons above the content area
+    void invalidateContent();      // Marks the text and scrollbar for repaint at the end of the frame
     void handleScroll(int touchY); // Handles scrolling based on touch Y
     void calculateLayout();        // Calculates linesPerPage and lineHeight
     // Updated to accept current file size for validation against cache
@@ -54,18 +68,30 @@ private:
     void goToNextBookmark();       // Jumps to the next bookmark
     // Updated to show size, line count, and ETC during loading
     void updateLoadingProgress(size_t currentBytes, size_t totalBytes, int currentLineCount, unsigned long elapsedMillis);
+    // Next-page glyph prefetch (runs on the JobSystem I/O worker)
+    void startNextPagePrefetch(int availableWidth); // Submits a prefetch job starting at nextPagePosition
+    void cancelPrefetch();                          // Cancels and releases the pending prefetch job
+    static bool prefetchNextPageJob(JobFuture &job, void *arg); // Job function: reads bytes, loads glyphs
 
 
 public:
     TextViewerPage();
-    ~TextViewerPage() override = default; // Use default destructor
+    ~TextViewerPage() override; // Releases any pending prefetch job
 
     void display() override;
+    // Repaints the toolbar, text and scrollbar parts that intersect clip
+    void paint(const DirtyRect &clip) override;
+    // White text on black plus a few toolbar colours: composed on the 8-bit canvas, one push per band instead of one per glyph
+    bool usesIndexedCanvas() const override { return true; }
     void handleTouch(uint16_t x, uint16_t y) override;
     // Add handleLoop declaration
     void handleLoop() override;
+    // Arena for the line index nodes
+    size_t arenaSize() const override { return PAGE_ARENA_TEXT_BYTES; }
     // Override to receive parameters from the router
     void setParams(void *params) override;
+    // Width in pixels available to a line of text (used by the layout and the benchmarks)
+    static int textAreaWidth();
 
     // Method to set the file path before displaying the page
     void setFilePath(const String &path);
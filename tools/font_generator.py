@@ -1,24 +1,94 @@
 #!/usr/bin/env python3
 import os
-from PIL import Image, ImageDraw, ImageFont
-import struct
 import argparse
 import json
-import numpy as np
+
+NIBBLE_HEADER_MAX_SIZE = 16  # 字符格不超过 16 像素时记录头用 4 位的位置和尺寸 (GlyphBitmap::NIBBLE_HEADER_MAX_SIZE)
+
+
+def square_bytes(size):
+    """size x size 方块位图的字节数 (GlyphBitmap::squareBytes)。"""
+    return (size * size + 7) // 8
+
+
+def pack_glyph(bitmap, size):
+    """把 size x size 的 0/1 像素列表 (逐行) 打包为字形记录 (格式见 src/core/glyph_bitmap.h)。
+
+    记录只保存墨迹的外接矩形：size <= 16 时头 2 字节 [x | y << 4, (宽 - 1) | (高 - 1) << 4]，
+    否则 4 字节 [x, y, 宽, 高]；之后是宽 x 高 位的连续位流，低位在前。只有头的记录是空白字形。
+    裁剪后不比方块小时返回方块本身，固件按记录长度区分两者。与 GlyphBitmap::cropSquare() 逐字节一致。
+    """
+    if size > 255:
+        raise ValueError("glyph size %d does not fit the record header" % size)
+    square = bytearray(square_bytes(size))
+    for i, bit in enumerate(bitmap):
+        if bit:
+            square[i >> 3] |= 1 << (i & 7)
+    header = 2 if size <= NIBBLE_HEADER_MAX_SIZE else 4
+    inked = [(i % size, i // size) for i, bit in enumerate(bitmap) if bit]
+    if not inked:
+        return bytes(header) if header < len(square) else bytes(square)
+    left = min(x for x, _ in inked)
+    top = min(y for _, y in inked)
+    width = max(x for x, _ in inked) + 1 - left
+    height = max(y for _, y in inked) + 1 - top
+    if header + (width * height + 7) // 8 >= len(square):
+        return bytes(square)
+    bits = bytearray((width * height + 7) // 8)
+    for x, y in inked:
+        bit = (y - top) * width + (x - left)
+        bits[bit >> 3] |= 1 << (bit & 7)
+    if header == 2:
+        head = bytes([left | top << 4, (width - 1) | (height - 1) << 4])
+    else:
+        head = bytes([left, top, width, height])
+    return head + bytes(bits)
+
+
+def read_legacy_glyphs(font_dir, sizes):
+    """读取旧格式的字库 (索引项没有 "bytes"，.font 中是 size x size 方块)。
+
+    返回 (字符列表, {(字符, 大小): 0/1 像素列表})，字符按索引文件中的顺序。
+    """
+    chars, bitmaps, files = [], {}, {}
+    n = 1
+    while os.path.exists(os.path.join(font_dir, "index_%d.json" % n)):
+        with open(os.path.join(font_dir, "index_%d.json" % n), encoding="utf-8") as f:
+            index = json.load(f)
+        for char, entries in index.items():
+            for size in sizes:
+                entry = entries.get(str(size))
+                if entry is None:
+                    continue
+                if "bytes" in entry:
+                    raise ValueError("%s is not a legacy font pack (index entries have \"bytes\")" % font_dir)
+                if entry["file"] not in files:
+                    with open(os.path.join(font_dir, entry["file"]), "rb") as f:
+                        files[entry["file"]] = f.read()
+                square = files[entry["file"]][entry["offset"]:entry["offset"] + square_bytes(size)]
+                if len(square) != square_bytes(size):
+                    raise ValueError("%s: %s (%d) is truncated" % (entry["file"], char, size))
+                bitmaps[(char, size)] = [(square[i >> 3] >> (i & 7)) & 1 for i in range(size * size)]
+            if char not in chars:
+                chars.append(char)
+        n += 1
+    return chars, bitmaps
+
 
 class FontGenerator:
-    def __init__(self, ttf_path, sizes=[16, 24, 32], chars_per_file=100):
+    def __init__(self, ttf_path, sizes=[16, 24, 32], chars_per_file=100, output_dir="font_data"):
         self.ttf_path = ttf_path
         self.sizes = sizes
         self.chars_per_file = chars_per_file
-        self.output_dir = "font_data"
+        self.output_dir = output_dir
         self.debug_dir = os.path.join(self.output_dir, "debug")
         self.cache_dir = os.path.join(self.output_dir, "cache") # Add cache directory path
         os.makedirs(self.output_dir, exist_ok=True)
-        os.makedirs(self.debug_dir, exist_ok=True)
-        os.makedirs(self.cache_dir, exist_ok=True) # Create cache directory
 
     def char_to_bitmap(self, char, size):
+        from PIL import Image, ImageDraw, ImageFont  # 只有渲染需要 Pillow，pack_glyph() 不需要
+        import numpy as np
+
         # 创建更大的画布以确保完整捕获字符
         canvas_size = int(size * 2)  # 调整画布大小
         img = Image.new('L', (canvas_size, canvas_size), 'white')
@@ -63,67 +133,55 @@ class FontGenerator:
 
         return bitmap
 
-    def generate_font_data(self, chars):
+    def generate_font_data(self, chars, bitmaps=None):
+        """生成字库。bitmaps 为 {(字符, 大小): 像素列表} 时使用这些像素 (转换旧字库)，不渲染 TTF，也不写单字缓存。"""
+        write_cache = bitmaps is None
+        if write_cache:
+            os.makedirs(self.cache_dir, exist_ok=True) # Create cache directory
         index_data = {}
         for size in self.sizes:
             # 按块处理字符
             for chunk_idx, i in enumerate(range(0, len(chars), self.chars_per_file)):
                 chunk_chars = chars[i:i + self.chars_per_file]
-                font_data = []
-                
-                # 为每个字符生成位图数据并保存单个缓存文件
+                font_bytes = bytearray()
+
+                # 为每个字符生成字形记录并保存单个缓存文件
                 for char in chunk_chars:
-                    bitmap = self.char_to_bitmap(char, size)
-                    font_data.extend(bitmap) # Keep accumulating for the chunked file
-
-                    # --- Add cache file generation ---
-                    # Pack individual character bitmap to bytes
-                    char_bytes = bytearray()
-                    num_bits = size * size
-                    for bit_idx in range(0, num_bits, 8):
-                        byte = 0
-                        for j in range(8):
-                            current_bit_idx = bit_idx + j
-                            if current_bit_idx < num_bits and bitmap[current_bit_idx]:
-                                byte |= (1 << j)
-                        char_bytes.append(byte)
-
-                    # Save individual cache file
+                    if bitmaps is None:
+                        bitmap = self.char_to_bitmap(char, size)
+                    elif (char, size) in bitmaps:
+                        bitmap = bitmaps[(char, size)]
+                    else:
+                        continue
+                    record = pack_glyph(bitmap, size)
+
+                    # 更新索引数据 (记录长度不固定，偏移按累计字节数计算)
+                    if char not in index_data:
+                        index_data[char] = {}
+                    index_data[char][str(size)] = {
+                        'file': f"{size}x{size}_{chunk_idx + 1}.font",
+                        'offset': len(font_bytes),
+                        'bytes': len(record)
+                    }
+                    font_bytes += record # Keep accumulating for the chunked file
+
+                    if not write_cache:
+                        continue
+                    # Save individual cache file (与固件的单字缓存同名：<字符>_<大小>.glyph2)
                     # Replace characters potentially invalid in filenames (basic example)
                     safe_char_name = char.replace('/', '_slash_').replace('\\', '_bslash_')
-                    cache_filename = os.path.join(self.cache_dir, f"{safe_char_name}_{size}.font")
+                    cache_filename = os.path.join(self.cache_dir, f"{safe_char_name}_{size}.glyph2")
                     try:
                         with open(cache_filename, 'wb') as f_cache:
-                            f_cache.write(char_bytes)
+                            f_cache.write(record)
                     except OSError as e:
                         # Handle cases where filename might still be invalid
                         print(f"Warning: Could not write cache file '{cache_filename}': {e}")
-                    # --- End cache file generation ---
 
-                # 保存字体数据 (Chunked file)
-                font_filename = f"{size}x{size}_{chunk_idx + 1}.font"
-                font_path = os.path.join(self.output_dir, font_filename)
-                
-                # 将位数据转换为字节（每8位一个字节）
-                font_bytes = bytearray()
-                for i in range(0, len(font_data), 8):
-                    byte = 0
-                    for j in range(8):
-                        if i + j < len(font_data) and font_data[i + j]:
-                            byte |= (1 << j)
-                    font_bytes.append(byte)
-                
+                # 保存字体数据 (Chunked file，字形记录依次相连)
+                font_path = os.path.join(self.output_dir, f"{size}x{size}_{chunk_idx + 1}.font")
                 with open(font_path, 'wb') as f:
                     f.write(font_bytes)
-                
-                # 更新索引数据
-                for idx, char in enumerate(chunk_chars):
-                    if char not in index_data:
-                        index_data[char] = {}
-                    index_data[char][str(size)] = {
-                        'file': font_filename,
-                        'offset': idx * (size * size) // 8
-                    }
         
         # 保存索引数据（按块）
         chars_list = list(index_data.keys())
@@ -138,12 +196,22 @@ class FontGenerator:
 
 def main():
     parser = argparse.ArgumentParser(description='Generate dot matrix font data')
-    parser.add_argument('ttf_path', help='Path to TTF font file')
-    parser.add_argument('chars_file', help='File containing characters to convert')
+    parser.add_argument('ttf_path', nargs='?', help='Path to TTF font file')
+    parser.add_argument('chars_file', nargs='?', help='File containing characters to convert')
     parser.add_argument('--sizes', nargs='+', type=int, default=[16, 24, 32],
                       help='Font sizes to generate')
+    parser.add_argument('--convert', metavar='FONT_DIR',
+                      help='Rewrite a legacy font pack (size x size squares) in FONT_DIR as glyph records, without the TTF')
     args = parser.parse_args()
 
+    if args.convert:
+        # 旧字库转换为字形记录：同样的字符顺序和分块，输出覆盖原来的 .font 和 index_*.json
+        chars, bitmaps = read_legacy_glyphs(args.convert, args.sizes)
+        FontGenerator(None, args.sizes, output_dir=args.convert).generate_font_data(chars, bitmaps)
+        return
+    if not args.ttf_path or not args.chars_file:
+        parser.error('ttf_path and chars_file are required unless --convert is given')
+
     # 读取字符
     with open(args.chars_file, 'r', encoding='utf-8') as f:
         chars = f.read().strip()
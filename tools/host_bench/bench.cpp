@@ -0,0 +1,867 @@
+// Host benchmark for the pure-computation parts of the firmware:
+// UTF-8 helpers, TextLayout (text viewer line wrapping), GlyphCache (Font LRU cache)
+// and the BMP BGR888 -> RGB565 row conversion used by the comic viewer (scalar reference, word kernel
+// and panel byte order; the kernels are first checked bit for bit against the reference, exit 1 on mismatch)
+// and the Q565 strip decoder (the encoded corpus must decode to the BMP pixels, also from every restart point,
+// the margin metadata must match the page it was computed from, and headers of another format version are refused)
+// and the glyph records cropped from the shipped font squares (every record must reproduce its square).
+//
+// The firmware sources are compiled unchanged against the thin Arduino String/File shims in shim/.
+// Every result is printed as "BENCH,<name>,<value>,<unit>,<allocs per op>" (same prefix as the
+// on-device benchmark page) so a run can be diffed against baseline.txt with compare.py. The first line is a
+// calibration loop that compare.py uses to scale the timings when the baseline comes from another machine.
+//
+// Usage: host_bench <corpus dir> [font dir]   (corpus generated by make_corpus.py, font dir default ../../font_data)
+
+#include <Arduino.h>
+#include <FS.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../../src/core/utf8.h"
+#include "../../src/core/text_layout.h"
+#include "../../src/core/glyph_cache.h"
+#include "../../src/core/pixel_convert.h"
+#include "../../src/core/q565.h"
+#include "../../src/core/glyph_bitmap.h"
+
+// --- Allocation counting (every operator new, plus GlyphCache bitmaps through its AllocFn) ---
+
+static size_t allocCount = 0;
+
+void *operator new(size_t size)
+{
+    allocCount++;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+static void *countingAlloc(void *ctx, size_t bytes)
+{
+    (void)ctx;
+    allocCount++;
+    return malloc(bytes);
+}
+
+// --- Firmware parameters mirrored here (text viewer area, font size, comic strip size, cache budget) ---
+
+static const int TEXT_AREA_WIDTH = 320 - 5 * 2 - 10 - 2; // TextViewerPage::textAreaWidth()
+static const uint16_t TEXT_FONT_PX = 16;                 // TEXT_FONT_SIZE * 16
+static const size_t GLYPH_BYTES = 16 * 16 / 8;           // One 16x16 1bpp glyph
+static const size_t CACHE_MIN_BYTES = 8 * 1024;          // FONT_CACHE_MIN_SIZE_BYTES
+static const size_t CACHE_MAX_BYTES = 40 * 1024;         // FONT_CACHE_MAX_SIZE_BYTES
+static const int STRIP_ROWS = 16;                        // ComicViewerPage BUFFER_ROWS
+static const int PASSES = 7;                             // Best of N passes
+
+static void report(const char *name, double value, const char *unit, double allocsPerOp)
+{
+    printf("BENCH,%s,%.3f,%s,%.3f\n", name, value, unit, allocsPerOp);
+}
+
+static double seconds(unsigned long startUs)
+{
+    return (micros() - startUs) / 1e6;
+}
+
+static bool readWhole(const std::string &path, std::string &out)
+{
+    File file(path.c_str());
+    if (!file)
+    {
+        fprintf(stderr, "cannot open %s (run make_corpus.py first)\n", path.c_str());
+        return false;
+    }
+    out.resize(file.size());
+    return file.read((uint8_t *)&out[0], out.size()) == out.size();
+}
+
+// --- Calibration: a fixed mix of dependent integer work and table lookups, no firmware code ---
+
+// compare.py divides the timings by this rate's ratio to the baseline's, so a baseline recorded on another
+// (faster or slower) machine still flags only the benchmarks that changed relative to the rest.
+static void benchCalibration()
+{
+    static uint32_t table[16 * 1024]; // 64 KB: cache resident, like the glyph cache and the strip buffers
+    const int ops = 1 << 22;
+    double best = 1e9;
+    uint32_t state = 1;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        unsigned long start = micros();
+        for (int i = 0; i < ops; i++)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            table[state & 0x3FFF] += state;
+            state += table[(state >> 7) & 0x3FFF];
+        }
+        best = std::min(best, seconds(start));
+    }
+    if (state == 0)
+        printf("# %u\n", (unsigned)table[0]); // keep the loop observable
+    report("calibration", ops / best / 1e6, "Mop/s", 0);
+}
+
+// --- UTF-8 helpers ---
+
+static void benchUtf8(const std::string &text)
+{
+    double best = 1e9;
+    size_t chars = 0;
+    uint32_t checksum = 0;
+    size_t allocs = 0;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        size_t before = allocCount;
+        unsigned long start = micros();
+        chars = 0;
+        for (size_t i = 0; i < text.size();)
+        {
+            checksum += Utf8::decode(text.c_str() + i);
+            i += Utf8::sequenceLength((uint8_t)text[i]);
+            chars++;
+        }
+        best = std::min(best, seconds(start));
+        allocs = allocCount - before;
+    }
+    report("utf8_decode", text.size() / best / 1e6, "MB/s", (double)allocs / chars);
+
+    best = 1e9;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        size_t before = allocCount;
+        unsigned long start = micros();
+        checksum += Utf8::length(text.c_str());
+        best = std::min(best, seconds(start));
+        allocs = allocCount - before;
+    }
+    report("utf8_length", text.size() / best / 1e6, "MB/s", (double)allocs / chars);
+    if (checksum == 1)
+        printf("#\n"); // Keep the loops from being optimised away
+}
+
+// --- Text layout: the same per-byte File loop as TextViewerPage::calculateFileMetadata() ---
+
+static void benchLayout(const char *name, const std::string &path)
+{
+    struct Pass
+    {
+        size_t lines;
+        size_t bytes;
+    };
+    double best = 1e9;
+    Pass pass = {0, 0};
+    size_t allocs = 0;
+    size_t fileBytes = 0;
+    for (int run = 0; run < PASSES; run++)
+    {
+        File file(path.c_str());
+        if (!file)
+        {
+            fprintf(stderr, "cannot open %s\n", path.c_str());
+            return;
+        }
+        fileBytes = file.size();
+        pass = {0, 0};
+        TextLayout layout(TEXT_AREA_WIDTH, TEXT_FONT_PX, [](void *ctx, const String &line, size_t, TextLayout::LineEnd)
+        {
+            Pass *pass = static_cast<Pass *>(ctx);
+            pass->lines++;
+            pass->bytes += line.length();
+        }, &pass);
+        layout.reset(0);
+
+        size_t before = allocCount;
+        unsigned long start = micros();
+        size_t position = 0;
+        while (file.available())
+        {
+            char c = file.read();
+            position++;
+            if (c == '\n' || c == '\r')
+            {
+                if (c == '\r' && file.peek() == '\n')
+                {
+                    file.read();
+                    position++;
+                }
+                layout.endParagraph(position);
+                continue;
+            }
+            layout.feed(c);
+        }
+        layout.finish();
+        best = std::min(best, seconds(start));
+        allocs = allocCount - before;
+    }
+    std::string lineName = std::string(name) + "_lines";
+    report(name, fileBytes / best / 1e6, "MB/s", (double)allocs / std::max<size_t>(pass.lines, 1));
+    report(lineName.c_str(), (double)pass.lines, "lines", 0);
+}
+
+// --- Glyph cache: replay the novel's glyph stream through the LRU cache ---
+
+static void benchGlyphCache(const char *name, const std::string &text, size_t capacity)
+{
+    // Keys for every non-ASCII character, in reading order (built once, outside the timed loop)
+    std::vector<std::string> stream;
+    for (size_t i = 0; i < text.size();)
+    {
+        size_t len = Utf8::sequenceLength((uint8_t)text[i]);
+        if (len > 1 && i + len <= text.size())
+        {
+            stream.emplace_back(text, i, len);
+        }
+        i += len;
+    }
+    uint8_t glyph[GLYPH_BYTES] = {0};
+
+    double best = 1e9;
+    size_t hits = 0;
+    size_t allocs = 0;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        GlyphCache cache(countingAlloc, nullptr);
+        hits = 0;
+        size_t before = allocCount;
+        unsigned long start = micros();
+        for (const std::string &character : stream)
+        {
+            GlyphCache::Key key(character, TEXT_FONT_PX); // Font::getCharacterBitmap() builds the key the same way
+            if (cache.get(key))
+            {
+                hits++;
+            }
+            else
+            {
+                cache.put(key, glyph, TEXT_FONT_PX, sizeof(glyph), capacity);
+            }
+        }
+        best = std::min(best, seconds(start));
+        allocs = allocCount - before;
+    }
+    std::string rateName = std::string(name) + "_hit";
+    report(name, best * 1e9 / stream.size(), "ns/lookup", (double)allocs / stream.size());
+    report(rateName.c_str(), 100.0 * hits / stream.size(), "%", 0);
+}
+
+// --- BMP: strip reads and row conversion as in ComicViewerPage::drawContent() ---
+
+typedef void (*ConvertFn)(const uint8_t *src, uint16_t *dst, size_t width);
+
+// The kernel is a template argument so it is inlined into the loop, as it is in BmpRowDecoder
+template <ConvertFn convert>
+static void benchConvert(const char *name, const std::vector<uint8_t> &rawBuffer, int rowSize,
+                         std::vector<uint16_t> &pixelBuffer, uint32_t &checksum)
+{
+    double best = 1e9;
+    size_t allocs = 0;
+    const size_t repeat = 20000;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        size_t before = allocCount;
+        unsigned long start = micros();
+        for (size_t i = 0; i < repeat; i++)
+        {
+            convert(rawBuffer.data() + (i % STRIP_ROWS) * rowSize, pixelBuffer.data(), 320);
+            checksum += pixelBuffer[i % 320];
+        }
+        best = std::min(best, seconds(start));
+        allocs = allocCount - before;
+    }
+    report(name, repeat * 320 / best / 1e6, "Mpix/s", (double)allocs / repeat);
+}
+
+// The word kernels must match the scalar reference bit for bit: every 24-bit colour, then every
+// source alignment (0..3) and row width 1..67 (head, 4-pixel blocks and tail in all combinations).
+static bool checkPixelConvert()
+{
+    const size_t width = 4096;
+    std::vector<uint8_t> src(width * 3 + 8);
+    std::vector<uint16_t> expected(width + 2), words(width + 2), panel(width + 2);
+    for (uint32_t first = 0; first < (1u << 24); first += width)
+    {
+        for (size_t i = 0; i < width; i++)
+        {
+            uint32_t color = first + i;
+            src[i * 3] = color & 0xFF;
+            src[i * 3 + 1] = (color >> 8) & 0xFF;
+            src[i * 3 + 2] = color >> 16;
+        }
+        PixelConvert::bgr888RowReference<false>(src.data(), expected.data(), width);
+        PixelConvert::bgr888RowToRgb565(src.data(), words.data(), width);
+        PixelConvert::bgr888RowToPanel565(src.data(), panel.data(), width);
+        for (size_t i = 0; i < width; i++)
+        {
+            if (words[i] != expected[i] || panel[i] != PixelConvert::swap565(expected[i]))
+            {
+                fprintf(stderr, "pixel_convert: colour %06x -> %04x, words %04x, panel %04x\n", first + (unsigned)i,
+                        expected[i], words[i], panel[i]);
+                return false;
+            }
+        }
+    }
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < src.size(); i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        src[i] = seed >> 16;
+    }
+    for (size_t align = 0; align < 4; align++)
+    {
+        for (size_t pixels = 1; pixels <= 67; pixels++)
+        {
+            const uint8_t *row = src.data() + align;
+            // Output one past the sentinel so overruns show up as a changed sentinel
+            expected[pixels] = words[pixels] = panel[pixels] = 0xA5A5;
+            PixelConvert::bgr888RowReference<false>(row, expected.data(), pixels);
+            PixelConvert::bgr888RowToRgb565(row, words.data(), pixels);
+            PixelConvert::bgr888RowToPanel565(row, panel.data(), pixels);
+            for (size_t i = 0; i <= pixels; i++)
+            {
+                uint16_t swapped = i < pixels ? PixelConvert::swap565(expected[i]) : expected[i];
+                if (words[i] != expected[i] || panel[i] != swapped)
+                {
+                    fprintf(stderr, "pixel_convert: alignment %zu width %zu pixel %zu differs\n", align, pixels, i);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static void benchBmp(const std::string &dir)
+{
+    static const char *files[] = {"001.bmp", "002.bmp", "003.bmp"};
+    const int maxRowSize = (320 * 3 + 3) & ~3;
+    std::vector<uint8_t> rawBuffer(maxRowSize * STRIP_ROWS);
+    std::vector<uint16_t> pixelBuffer(320);
+
+    double best = 1e9;
+    size_t pixels = 0;
+    size_t rowsDone = 0;
+    size_t allocs = 0;
+    uint32_t checksum = 0;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        pixels = 0;
+        rowsDone = 0;
+        size_t before = allocCount;
+        unsigned long start = micros();
+        for (const char *name : files)
+        {
+            File file((dir + "/comic/" + name).c_str());
+            if (!file)
+            {
+                fprintf(stderr, "cannot open comic/%s\n", name);
+                return;
+            }
+            uint8_t header[54];
+            if (file.read(header, sizeof(header)) != sizeof(header) || header[0] != 'B' || header[1] != 'M')
+            {
+                return;
+            }
+            uint32_t dataOffset, width, height;
+            memcpy(&dataOffset, header + 10, 4);
+            memcpy(&width, header + 18, 4);
+            memcpy(&height, header + 22, 4);
+            int rowSize = (width * 3 + 3) & ~3;
+
+            for (uint32_t row = 0; row < height;)
+            {
+                int rowsToRead = std::min<int>(STRIP_ROWS, height - row);
+                // Rows are stored bottom-up: seek to the last image row of the strip
+                file.seek(dataOffset + (height - (row + rowsToRead)) * rowSize);
+                file.read(rawBuffer.data(), rowsToRead * rowSize);
+                for (int chunkRow = 0; chunkRow < rowsToRead; chunkRow++)
+                {
+                    const uint8_t *rowPtr = rawBuffer.data() + (rowsToRead - 1 - chunkRow) * rowSize;
+                    PixelConvert::bgr888RowToRgb565(rowPtr, pixelBuffer.data(), width);
+                    checksum += pixelBuffer[width / 2];
+                }
+                row += rowsToRead;
+                rowsDone += rowsToRead;
+                pixels += (size_t)width * rowsToRead;
+            }
+        }
+        best = std::min(best, seconds(start));
+        allocs = allocCount - before;
+    }
+    report("bmp_strip", pixels / best / 1e6, "Mpix/s", (double)allocs / rowsDone);
+
+    // Conversion alone (buffer already in memory), per kernel
+    benchConvert<PixelConvert::bgr888RowReference<false>>("bmp_convert_scalar", rawBuffer, maxRowSize, pixelBuffer, checksum);
+    benchConvert<PixelConvert::bgr888RowToRgb565>("bmp_convert", rawBuffer, maxRowSize, pixelBuffer, checksum);
+    benchConvert<PixelConvert::bgr888RowToPanel565>("bmp_convert_panel", rawBuffer, maxRowSize, pixelBuffer, checksum);
+    if (checksum == 1)
+        printf("#\n");
+}
+
+// --- Q565 strip codec ---
+
+struct MemorySource
+{
+    const std::string *data;
+};
+
+static const uint8_t *fetchMemory(void *ctx, uint32_t offset, size_t bytes)
+{
+    const std::string &data = *static_cast<MemorySource *>(ctx)->data;
+    return offset + bytes <= data.size() ? reinterpret_cast<const uint8_t *>(data.data()) + offset : nullptr;
+}
+
+// Reads through the File shim into one buffer, like SdReadProfile::readAligned() on the device
+struct FileSource
+{
+    File *file;
+    std::vector<uint8_t> *buffer;
+};
+
+static const uint8_t *fetchFile(void *ctx, uint32_t offset, size_t bytes)
+{
+    FileSource &source = *static_cast<FileSource *>(ctx);
+    if (!source.file->seek(offset) || source.file->read(source.buffer->data(), bytes) != bytes)
+        return nullptr;
+    return source.buffer->data();
+}
+
+// 24-bit BMP -> RGB565 rows (top row first), through the scalar reference
+static bool loadBmp565(const std::string &path, int &width, int &height, std::vector<uint16_t> &pixels)
+{
+    std::string bmp;
+    if (!readWhole(path, bmp) || bmp.size() < 54)
+        return false;
+    uint32_t dataOffset;
+    int32_t w, h;
+    memcpy(&dataOffset, &bmp[10], 4);
+    memcpy(&w, &bmp[18], 4);
+    memcpy(&h, &bmp[22], 4);
+    width = w;
+    height = h < 0 ? -h : h;
+    const size_t stride = (width * 3 + 3) & ~3;
+    pixels.resize((size_t)width * height);
+    for (int y = 0; y < height; y++)
+    {
+        int fileRow = h < 0 ? y : height - 1 - y;
+        PixelConvert::bgr888RowReference<false>(reinterpret_cast<const uint8_t *>(bmp.data()) + dataOffset + fileRow * stride,
+                                                pixels.data() + (size_t)y * width, width);
+    }
+    return true;
+}
+
+// Decodes every .q565 file of the corpus sequentially and from each restart point (and a row inside each
+// group), in both byte orders, and compares with the BMP it was encoded from. Then reports decode speed
+// from memory (q565_decode) and through File reads (q565_strip), and the size relative to the BMP files.
+static bool benchQ565(const std::string &dir)
+{
+    static const char *names[] = {"001", "002", "003"};
+    std::string files[3];
+    std::vector<uint16_t> expected[3];
+    size_t bmpBytes = 0;
+    size_t q565Bytes = 0;
+    size_t pixels = 0;
+    for (int f = 0; f < 3; f++)
+    {
+        int width = 0, height = 0;
+        if (!loadBmp565(dir + "/comic/" + names[f] + ".bmp", width, height, expected[f]) ||
+            !readWhole(dir + "/comic/" + names[f] + ".q565", files[f]))
+            return false;
+        bmpBytes += 54 + (size_t)((width * 3 + 3) & ~3) * height;
+        q565Bytes += files[f].size();
+        pixels += (size_t)width * height;
+
+        MemorySource source{&files[f]};
+        Q565Decoder decoder;
+        if (files[f].size() < Q565Decoder::HEADER_BYTES || !decoder.parseHeader(reinterpret_cast<const uint8_t *>(files[f].data())) ||
+            decoder.width() != width || decoder.height() != height)
+        {
+            fprintf(stderr, "q565: %s.q565 header does not match the BMP\n", names[f]);
+            return false;
+        }
+        // A version 1 header (the width right after the magic, no version field) must be refused as another version
+        std::string v1 = files[f].substr(0, 4) + files[f].substr(6);
+        if (decoder.parseHeader(reinterpret_cast<const uint8_t *>(v1.data())) ||
+            !Q565Decoder::isOtherVersion(reinterpret_cast<const uint8_t *>(v1.data())) ||
+            !decoder.parseHeader(reinterpret_cast<const uint8_t *>(files[f].data())))
+        {
+            fprintf(stderr, "q565: a version 1 header of %s.q565 is not refused as another version\n", names[f]);
+            return false;
+        }
+        decoder.setSource(fetchMemory, &source, 4096, files[f].size());
+        std::vector<uint16_t> row(width);
+        const int groupRows = decoder.groupRows();
+        for (int pass = 0; pass < 3; pass++)
+        {
+            // pass 0: top to bottom; 1: every group start, bottom group first; 2: the middle row of every group
+            for (int g = 0; g * groupRows < height; g++)
+            {
+                int group = pass == 1 ? (height - 1) / groupRows - g : g;
+                int first = group * groupRows + (pass == 2 ? groupRows / 2 : 0);
+                int last = pass == 0 ? std::min(height, first + groupRows) : first + 1;
+                if (first >= height || !decoder.seekRow(first))
+                {
+                    if (first >= height)
+                        continue;
+                    fprintf(stderr, "q565: %s.q565 cannot seek to row %d\n", names[f], first);
+                    return false;
+                }
+                for (int y = first; y < last; y++)
+                {
+                    bool panel = (y & 1) != 0;
+                    bool ok = panel ? decoder.decodeRow<true>(row.data()) : decoder.decodeRow<false>(row.data());
+                    for (int x = 0; ok && x < width; x++)
+                    {
+                        uint16_t want = expected[f][(size_t)y * width + x];
+                        ok = row[x] == (panel ? PixelConvert::swap565(want) : want);
+                    }
+                    if (!ok)
+                    {
+                        fprintf(stderr, "q565: %s.q565 row %d does not match the BMP (pass %d)\n", names[f], y, pass);
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<uint16_t> row(320);
+    uint32_t checksum = 0;
+    double best = 1e9;
+    size_t allocs = 0;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        size_t before = allocCount;
+        unsigned long start = micros();
+        for (int f = 0; f < 3; f++)
+        {
+            MemorySource source{&files[f]};
+            Q565Decoder decoder;
+            decoder.parseHeader(reinterpret_cast<const uint8_t *>(files[f].data()));
+            decoder.setSource(fetchMemory, &source, 16384, files[f].size());
+            decoder.seekRow(0);
+            for (int y = 0; y < decoder.height(); y++)
+            {
+                decoder.decodeRow<true>(row.data());
+                checksum += row[y % decoder.width()];
+            }
+        }
+        best = std::min(best, seconds(start));
+        allocs = allocCount - before;
+    }
+    report("q565_decode", pixels / best / 1e6, "Mpix/s", (double)allocs / pixels);
+
+    std::vector<uint8_t> buffer(16384);
+    best = 1e9;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        size_t before = allocCount;
+        unsigned long start = micros();
+        for (const char *name : names)
+        {
+            File file((dir + "/comic/" + name + ".q565").c_str());
+            uint8_t header[Q565Decoder::HEADER_BYTES];
+            Q565Decoder decoder;
+            if (!file || file.read(header, sizeof(header)) != sizeof(header) || !decoder.parseHeader(header))
+                return false;
+            FileSource source{&file, &buffer};
+            decoder.setSource(fetchFile, &source, buffer.size(), file.size());
+            decoder.seekRow(0);
+            for (int y = 0; y < decoder.height(); y++)
+            {
+                decoder.decodeRow<true>(row.data());
+                checksum += row[y % decoder.width()];
+            }
+        }
+        best = std::min(best, seconds(start));
+        allocs = allocCount - before;
+    }
+    report("q565_strip", pixels / best / 1e6, "Mpix/s", (double)allocs / pixels);
+    report("q565_size", 100.0 * q565Bytes / bmpBytes, "%", 0);
+    if (checksum == 1)
+        printf("#\n");
+    return true;
+}
+
+// Counts the encoded bytes the decoder fetches
+struct CountingSource
+{
+    const std::string *data;
+    size_t fetched;
+};
+
+static const uint8_t *fetchCounting(void *ctx, uint32_t offset, size_t bytes)
+{
+    CountingSource &source = *static_cast<CountingSource *>(ctx);
+    if (offset + bytes > source.data->size())
+        return nullptr;
+    source.fetched += bytes;
+    return reinterpret_cast<const uint8_t *>(source.data->data()) + offset;
+}
+
+// Checks the margin metadata of margins/1.q565 against its BMP: the content box is the bounding box of the
+// non-white pixels, every indexed blank row is white and every white stretch of 4+ rows is indexed, and the
+// cropped window decodes to the BMP pixels. Then draws the cropped page like ComicViewerPage::drawQ565Rows
+// (blank runs skipped) and reports the share of the window's pixels pushed and of the file's bytes fetched.
+static bool benchQ565Margins(const std::string &dir)
+{
+    std::string file;
+    std::vector<uint16_t> expected;
+    int width = 0, height = 0;
+    if (!loadBmp565(dir + "/margins/1.bmp", width, height, expected) || !readWhole(dir + "/margins/1.q565", file))
+        return false;
+    Q565Decoder decoder;
+    if (file.size() < Q565Decoder::HEADER_BYTES || !decoder.parseHeader(reinterpret_cast<const uint8_t *>(file.data())) ||
+        decoder.width() != width || decoder.height() != height)
+    {
+        fprintf(stderr, "q565: margins/1.q565 header does not match the BMP\n");
+        return false;
+    }
+    auto white = [&](int y, int x0, int x1) {
+        for (int x = x0; x < x1; x++)
+            if (expected[(size_t)y * width + x] != decoder.background())
+                return false;
+        return true;
+    };
+
+    int left = width, top = height, right = 0, bottom = 0;
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            if (!white(y, x, x + 1))
+            {
+                left = std::min(left, x);
+                right = std::max(right, x + 1);
+                top = std::min(top, y);
+                bottom = y + 1;
+            }
+    Q565Decoder::Window box = decoder.content();
+    if (box.x != left || box.y != top || box.x + box.width != right || box.y + box.height != bottom)
+    {
+        fprintf(stderr, "q565: margins/1.q565 content box %d,%d-%d,%d, BMP %d,%d-%d,%d\n", box.x, box.y,
+                box.x + box.width, box.y + box.height, left, top, right, bottom);
+        return false;
+    }
+
+    CountingSource source{&file, 0};
+    decoder.setSource(fetchCounting, &source, 4096, file.size());
+    if (!decoder.readBlankRuns())
+        return false;
+    for (int y = 0; y < height;)
+    {
+        int blank = decoder.blankRowsFrom(y);
+        int stretch = 0;
+        while (y + stretch < height && white(y + stretch, 0, width))
+            stretch++;
+        if (blank != (stretch >= 4 ? stretch : 0))
+        {
+            fprintf(stderr, "q565: margins/1.q565 row %d: %d blank rows indexed, %d white\n", y, blank, stretch);
+            return false;
+        }
+        y += std::max(1, stretch);
+    }
+
+    const Q565Decoder::Window view = decoder.contentWindow(8);
+    std::vector<uint16_t> row(view.width);
+    size_t pushed = 0;
+    source.fetched = 0;
+    if (!decoder.seekRow(view.y))
+        return false;
+    for (int y = view.y; y < view.y + view.height;)
+    {
+        int blank = decoder.blankRowsFrom(y);
+        if (blank > 0)
+        {
+            y += blank;
+            if (y < view.y + view.height && !decoder.seekRow(y))
+                return false;
+            continue;
+        }
+        bool ok = decoder.decodeRow<true>(row.data(), view.x, view.width);
+        for (int x = 0; ok && x < view.width; x++)
+            ok = row[x] == PixelConvert::swap565(expected[(size_t)y * width + view.x + x]);
+        if (!ok)
+        {
+            fprintf(stderr, "q565: margins/1.q565 row %d of the cropped window does not match the BMP\n", y);
+            return false;
+        }
+        pushed += view.width;
+        y++;
+    }
+    report("q565_margin_push", 100.0 * pushed / ((size_t)view.width * view.height), "%", 0);
+    report("q565_margin_fetch", 100.0 * source.fetched / file.size(), "%", 0);
+    return true;
+}
+
+// --- Glyph records: the shipped font pack, and the crop Font::loadCharacter() applies to legacy packs ---
+
+// Number after "key": in an index entry (json.dump layout of tools/font_generator.py), searched in [from, to)
+static bool indexNumber(const std::string &index, const char *key, size_t from, size_t to, size_t &value)
+{
+    size_t at = index.find(key, from);
+    if (at == std::string::npos || at >= to)
+        return false;
+    value = strtoul(index.c_str() + at + strlen(key), nullptr, 10);
+    return true;
+}
+
+// Every glyph of one size in the pack: its square must crop to exactly the stored record (the firmware and
+// font_generator.py agree byte for byte) and the record must reproduce the square. Entries without "bytes"
+// (a legacy pack) are squares and only go through the crop. Reports the crop time per glyph and the stored
+// bytes (SD / glyph cache) and pushed pixels (SPI) as a share of the squares.
+static bool benchGlyphRecords(const std::string &fontDir, uint16_t size)
+{
+    const std::string prefix = std::to_string(size) + "x" + std::to_string(size) + "_";
+    const size_t squareBytes = GlyphBitmap::squareBytes(size);
+    std::vector<std::string> squares, stored;
+    std::map<std::string, std::string> files;
+    for (int n = 1;; n++)
+    {
+        std::string index;
+        std::string path = fontDir + "/index_" + std::to_string(n) + ".json";
+        FILE *probe = fopen(path.c_str(), "rb"); // the pack ends at the first missing index: no error for that one
+        if (!probe)
+            break;
+        fclose(probe);
+        if (!readWhole(path, index))
+            return false;
+        const std::string fileKey = "\"file\": \"" + prefix;
+        for (size_t at = index.find(fileKey); at != std::string::npos;)
+        {
+            size_t nameStart = at + fileKey.size() - prefix.size();
+            std::string name = index.substr(nameStart, index.find('"', nameStart) - nameStart);
+            size_t next = index.find(fileKey, at + 1);
+            size_t end = std::min(next, index.find('}', at));
+            size_t offset = 0, bytes = squareBytes;
+            bool record = indexNumber(index, "\"bytes\": ", at, end, bytes);
+            if (!indexNumber(index, "\"offset\": ", at, end, offset) || bytes > GlyphBitmap::maxRecordBytes(size))
+            {
+                fprintf(stderr, "glyph: bad index entry for %s in %s\n", name.c_str(), path.c_str());
+                return false;
+            }
+            if (!files.count(name) && !readWhole(fontDir + "/" + name, files[name]))
+                return false;
+            const std::string &font = files[name];
+            if (offset + bytes > font.size())
+            {
+                fprintf(stderr, "glyph: %s is shorter than its index\n", name.c_str());
+                return false;
+            }
+            stored.emplace_back(record ? font.substr(offset, bytes) : std::string());
+            std::string square(squareBytes, '\0');
+            if (!record)
+            {
+                square = font.substr(offset, bytes);
+            }
+            else
+            {
+                GlyphBitmap glyph;
+                if (!glyph.parse(reinterpret_cast<const uint8_t *>(font.data() + offset), bytes, size))
+                {
+                    fprintf(stderr, "glyph: record %zu of %s is not valid\n", offset, name.c_str());
+                    return false;
+                }
+                for (int py = 0; py < glyph.height; py++)
+                    for (int px = 0; px < glyph.width; px++)
+                        if (glyph.pixel(px, py))
+                        {
+                            size_t bit = (size_t)(glyph.y + py) * size + glyph.x + px;
+                            square[bit >> 3] |= (char)(1 << (bit & 7));
+                        }
+            }
+            squares.push_back(square);
+            at = next;
+        }
+    }
+    if (squares.empty())
+    {
+        fprintf(stderr, "glyph: no %ux%u glyphs in %s\n", size, size, fontDir.c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> record(GlyphBitmap::maxRecordBytes(size));
+    size_t recordBytes = 0, pixels = 0;
+    for (size_t i = 0; i < squares.size(); i++)
+    {
+        const uint8_t *square = reinterpret_cast<const uint8_t *>(squares[i].data());
+        size_t bytes = GlyphBitmap::cropSquare(square, size, record.data());
+        GlyphBitmap glyph;
+        bool ok = glyph.parse(record.data(), bytes, size) &&
+                  (stored[i].empty() || stored[i] == std::string(record.begin(), record.begin() + bytes));
+        for (int py = 0; ok && py < size; py++)
+            for (int px = 0; ok && px < size; px++)
+            {
+                size_t bit = (size_t)py * size + px;
+                bool inked = (square[bit >> 3] >> (bit & 7)) & 1;
+                bool inBox = px >= glyph.x && px < glyph.x + glyph.width && py >= glyph.y && py < glyph.y + glyph.height;
+                ok = inked == (inBox && glyph.pixel(px - glyph.x, py - glyph.y));
+            }
+        if (!ok)
+        {
+            fprintf(stderr, "glyph: %ux%u glyph %zu does not round-trip through its record\n", size, size, i);
+            return false;
+        }
+        recordBytes += bytes;
+        pixels += (size_t)glyph.width * glyph.height;
+    }
+
+    double best = 1e9;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        unsigned long start = micros();
+        for (const std::string &square : squares)
+            GlyphBitmap::cropSquare(reinterpret_cast<const uint8_t *>(square.data()), size, record.data());
+        best = std::min(best, seconds(start));
+    }
+    std::string suffix = "_" + std::to_string(size);
+    report(("glyph_crop" + suffix).c_str(), best * 1e9 / squares.size(), "ns/glyph", 0);
+    report(("glyph_bytes" + suffix).c_str(), 100.0 * recordBytes / (squares.size() * squareBytes), "%", 0);
+    report(("glyph_pixels" + suffix).c_str(), 100.0 * pixels / (squares.size() * (size_t)size * size), "%", 0);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <corpus dir> [font dir]\n", argv[0]);
+        return 2;
+    }
+    std::string dir = argv[1];
+    std::string fontDir = argc > 2 ? argv[2] : "../../font_data";
+    if (!checkPixelConvert())
+    {
+        return 1;
+    }
+    std::string utf8Text;
+    if (!readWhole(dir + "/novel_utf8.txt", utf8Text))
+    {
+        return 1;
+    }
+
+    benchCalibration();
+    benchUtf8(utf8Text);
+    benchLayout("layout_utf8", dir + "/novel_utf8.txt");
+    benchLayout("layout_gbk", dir + "/novel_gbk.txt");
+    benchGlyphCache("glyph_cache_8k", utf8Text, CACHE_MIN_BYTES);
+    benchGlyphCache("glyph_cache_40k", utf8Text, CACHE_MAX_BYTES);
+    benchBmp(dir);
+    if (!benchQ565(dir) || !benchQ565Margins(dir) || !benchGlyphRecords(fontDir, 16) || !benchGlyphRecords(fontDir, 32))
+    {
+        return 1;
+    }
+    return 0;
+}
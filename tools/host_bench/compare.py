@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Compare a host_bench run against the baseline file.
+
+Fails (exit 1) when
+  - a throughput (".../s") drops, or a time per op ("ns/...", "us", "ms") grows, by more than --tolerance percent;
+  - allocations per op increase (they are deterministic, so any increase is real);
+  - a behaviour figure (line count, hit rate) changes at all: the code now lays out or caches differently.
+Benchmarks missing from either file are reported but do not fail.
+
+Timings are absolute, so a baseline recorded on another machine would flag everything. Both files start with
+the "calibration" loop (fixed integer and table work, no firmware code): timings are scaled by the ratio of
+the two calibration rates before comparing, so only benchmarks that moved relative to the machine's speed
+fail. The scaling is approximate (memory-bound and compute-bound code do not scale alike), so when the two
+rates differ by more than --tolerance the baseline is taken to come from another machine: timing changes are
+still printed but only as advice and do not fail; re-run `make baseline` on this machine (with a clean tree)
+for a real timing comparison. Behaviour figures and allocations are never scaled and always fail.
+"""
+
+import argparse
+import sys
+
+CALIBRATION = "calibration"
+
+
+def load(path):
+    results = {}
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            parts = line.strip().split(",")
+            if len(parts) != 5 or parts[0] != "BENCH":
+                continue
+            results[parts[1]] = (float(parts[2]), parts[3], float(parts[4]))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--tolerance", type=float, default=25.0, help="allowed timing change in percent")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    # > 1: this machine is faster than the one that recorded the baseline
+    speed = 1.0
+    if CALIBRATION in baseline and CALIBRATION in current and baseline[CALIBRATION][0] > 0:
+        speed = current[CALIBRATION][0] / baseline[CALIBRATION][0]
+        print("%-20s machine speed %.2fx the baseline's, timings scaled" % (CALIBRATION, speed))
+    other_machine = abs(speed - 1.0) * 100 > args.tolerance
+    if other_machine:
+        print("%-20s baseline is from another machine: timing changes are advisory (run make baseline here)" % "")
+    failures = 0
+    for name, (value, unit, allocs) in current.items():
+        if name == CALIBRATION:
+            continue
+        if name not in baseline:
+            print("%-20s %12.3f %-10s (new)" % (name, value, unit))
+            continue
+        base_value, _, base_allocs = baseline[name]
+        if unit.endswith("/s"):
+            base_value *= speed
+        elif unit.startswith("ns/") or unit in ("us", "ms"):
+            base_value /= speed
+        change = (value - base_value) / base_value * 100 if base_value else 0.0
+        status = "ok"
+        timing = unit.endswith("/s") or unit.startswith("ns/") or unit in ("us", "ms")
+        if unit.endswith("/s"):
+            if change < -args.tolerance:
+                status = "SLOWER"
+        elif unit.startswith("ns/") or unit in ("us", "ms"):
+            if change > args.tolerance:
+                status = "SLOWER"
+        elif abs(value - base_value) > 1e-6:
+            status = "CHANGED"
+        if allocs > base_allocs + 1e-3:
+            status = "MORE ALLOCS (%.3f -> %.3f)" % (base_allocs, allocs)
+        if timing and other_machine and status == "SLOWER":
+            status = "slower? (advisory)"
+        elif status != "ok":
+            failures += 1
+        print("%-20s %12.3f %-10s %+7.1f%%  %s" % (name, value, unit, change, status))
+    for name in baseline:
+        if name not in current:
+            print("%-20s missing from current run" % name)
+
+    if failures:
+        print("%d regression(s) against %s" % (failures, args.baseline))
+        return 1
+    print("no regressions against %s" % args.baseline)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
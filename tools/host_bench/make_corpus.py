@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""Generate the host benchmark corpora (deterministic, so every run measures the same bytes).
+
+  novel_utf8.txt  large Chinese novel, UTF-8, LF line endings
+  novel_gbk.txt   the same text encoded as GBK with CRLF line endings (typical downloaded .txt);
+                  the reader treats it as raw bytes, so this measures how layout copes with non-UTF-8 input
+  comic/NNN.bmp   24-bit bottom-up BMP strips, as produced for the comic viewer (one odd width for row padding)
+  comic/NNN.q565  the same strips encoded by tools/q565_encode.py (host_bench checks they decode to the BMP pixels)
+  margins/1.bmp   a page like a scan: white margins around two panels and a white gutter between them,
+  margins/1.q565  and its Q565 encoding with the content box and blank-row runs the viewer uses to skip them
+  touch_trace.csv a reading session in the TouchTrace format (mostly "next" taps, some "back" taps and
+                  stray taps on the header buttons right of Back), for make replay
+
+The corpora are generated instead of committed so the repository stays small.
+"""
+
+import argparse
+import os
+import random
+import struct
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+import q565_encode  # noqa: E402  (tools/q565_encode.py)
+
+SEED = 20240501
+
+# GB2312 level-1 hanzi (0xB0A1-0xD7F9): all of them exist in GBK and UTF-8
+def common_hanzi():
+    chars = []
+    for hi in range(0xB0, 0xD8):
+        for lo in range(0xA1, 0xFF):
+            if hi == 0xD7 and lo > 0xF9:
+                break
+            chars.append(bytes([hi, lo]).decode("gb2312"))
+    return chars
+
+
+PUNCT_MID = ["，", "，", "，", "、", "；", "："]
+PUNCT_END = ["。", "。", "。", "！", "？", "……"]
+ASCII_WORDS = ["OK", "ESP32", "SD", "2024", "Hello", "TFT", "No.7", "A", "GPS", "100%"]
+
+
+def make_novel(target_chars, rng):
+    hanzi = common_hanzi()
+    # Zipf-like weights: a few hundred characters dominate, as in real text (drives glyph cache hit rate)
+    weights = [1.0 / (rank + 8) for rank in range(len(hanzi))]
+    rng.shuffle(hanzi)
+
+    paragraphs = []
+    count = 0
+    chapter = 1
+    while count < target_chars:
+        if not paragraphs or rng.random() < 0.01:
+            title = "第%d章 %s" % (chapter, "".join(rng.choices(hanzi, weights, k=rng.randint(2, 6))))
+            paragraphs.append(title)
+            paragraphs.append("")
+            chapter += 1
+        parts = ["　　"]
+        for _ in range(rng.randint(1, 6)):
+            clause = "".join(rng.choices(hanzi, weights, k=rng.randint(4, 24)))
+            if rng.random() < 0.08:
+                clause += " " + rng.choice(ASCII_WORDS) + " "
+            if rng.random() < 0.1:
+                clause = "“" + clause + "”"
+            parts.append(clause)
+            parts.append(rng.choice(PUNCT_MID))
+        parts[-1] = rng.choice(PUNCT_END)
+        paragraph = "".join(parts)
+        paragraphs.append(paragraph)
+        count += len(paragraph)
+        if rng.random() < 0.01:
+            paragraphs.append("%书签标志%")
+    return paragraphs
+
+
+def write_bmp_rows(path, width, rows):
+    """Write 24-bit rows (top row first, no padding) as a bottom-up BMP."""
+    row_size = (width * 3 + 3) & ~3
+    pixel_bytes = row_size * len(rows)
+    header = struct.pack("<2sIHHI", b"BM", 54 + pixel_bytes, 0, 0, 54)
+    info = struct.pack("<IiiHHIIiiII", 40, width, len(rows), 1, 24, 0, pixel_bytes, 2835, 2835, 0, 0)
+    with open(path, "wb") as f:
+        f.write(header)
+        f.write(info)
+        for row in reversed(rows):
+            f.write(row + bytes(row_size - 3 * width))
+
+
+def write_bmp(path, width, height, rng):
+    # Panels: flat fills with a few gradients and line art, stored bottom-up
+    panel_h = rng.randint(180, 320)
+    rows = []
+    for y in range(height):
+        panel = y // panel_h
+        base = (panel * 53) % 256
+        if y % panel_h < 4:
+            row = bytes(3 * width)  # black panel border
+        else:
+            row = bytearray(3 * width)
+            for x in range(width):
+                if x < 4 or x >= width - 4:
+                    continue
+                shade = (base + x // 2 + (y % panel_h) // 3) & 0xFF
+                row[3 * x] = shade               # B
+                row[3 * x + 1] = (shade * 3) & 0xFF  # G
+                row[3 * x + 2] = 255 - shade     # R
+            row = bytes(row)
+        rows.append(row)
+    write_bmp_rows(path, width, rows)
+
+
+def write_margin_bmp(path, width=360, height=900):
+    # Content box 30..330 x 60..840 (narrower than the screen although the page is wider), gutter rows 380..500
+    left, top, right, bottom = 30, 60, 330, 840
+    gutter_top, gutter_bottom = 380, 500
+    rows = []
+    for y in range(height):
+        row = bytearray(b"\xff" * (3 * width))
+        if top <= y < bottom and not gutter_top <= y < gutter_bottom:
+            panel_top, panel_bottom = (top, gutter_top) if y < gutter_top else (gutter_bottom, bottom)
+            for x in range(left, right):
+                if x < left + 3 or x >= right - 3 or y < panel_top + 3 or y >= panel_bottom - 3:
+                    row[3 * x:3 * x + 3] = b"\x00\x00\x00"  # panel border
+                else:
+                    shade = (x // 2 + (y - panel_top) // 3) & 0xFF
+                    row[3 * x:3 * x + 3] = bytes([shade, (shade * 3) & 0xFF, 255 - shade])
+        rows.append(bytes(row))
+    write_bmp_rows(path, width, rows)
+
+
+def write_trace(path, rng, events=400):
+    t = 0
+    with open(path, "w", encoding="ascii", newline="\n") as f:
+        f.write("# NovelComicReader touch trace v1\n# time_ms,x,y\n")
+        for _ in range(events):
+            t += rng.randint(800, 6000)  # reading pace between taps
+            roll = rng.random()
+            if roll < 0.85:
+                x, y = rng.randint(20, 280), rng.randint(150, 225)  # lower half: scroll down
+            elif roll < 0.97:
+                x, y = rng.randint(20, 280), rng.randint(50, 130)   # upper half: scroll up
+            else:
+                x, y = rng.randint(70, 319), rng.randint(0, 40)     # header: Top, bookmarks (not Back)
+            f.write("%d,%d,%d\n" % (t, x, y))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("out", help="output directory")
+    parser.add_argument("--chars", type=int, default=1000000, help="approximate novel length in characters")
+    args = parser.parse_args()
+
+    rng = random.Random(SEED)
+    os.makedirs(os.path.join(args.out, "comic"), exist_ok=True)
+    os.makedirs(os.path.join(args.out, "margins"), exist_ok=True)
+
+    paragraphs = make_novel(args.chars, rng)
+    with open(os.path.join(args.out, "novel_utf8.txt"), "w", encoding="utf-8", newline="\n") as f:
+        f.write("\n".join(paragraphs) + "\n")
+    with open(os.path.join(args.out, "novel_gbk.txt"), "w", encoding="gbk", newline="\r\n") as f:
+        f.write("\n".join(paragraphs) + "\n")
+
+    for index, (width, height) in enumerate([(320, 2400), (320, 1600), (318, 1200)], start=1):
+        bmp_path = os.path.join(args.out, "comic", "%03d.bmp" % index)
+        write_bmp(bmp_path, width, height, rng)
+        q565_encode.convert(bmp_path, os.path.join(args.out, "comic", "%03d.q565" % index), 16)
+
+    write_margin_bmp(os.path.join(args.out, "margins", "1.bmp"))
+    q565_encode.convert(os.path.join(args.out, "margins", "1.bmp"), os.path.join(args.out, "margins", "1.q565"), 16)
+
+    write_trace(os.path.join(args.out, "touch_trace.csv"), rng)
+
+    print("corpora written to %s" % args.out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,306 @@
+// Host rendering of the firmware pages into the framebuffer display backend.
+//
+// Unlike bench, this links the real pages (menu, file browser, text viewer, comic viewer)
+// and core (Display, Font, Router, SDCard, ...) against the shims: SD is a directory on the host,
+// the display is the FramebufferBackend Display creates when ARDUINO is not defined. Time is virtual
+// (HostClock), so everything the firmware paces by millis() happens at the same points on every run
+// and the frames are reproducible.
+//
+// Each step (opening a page, a tap) runs like one pass of loop(): handleTouch, then handleLoop, the
+// frame composition (dirty rectangles) and the due timers until the page is idle. After each step the
+// frame is saved as <out>/<step>.png and one line is printed:
+//   RENDER,<step>,<framebuffer hash>,<pixels pushed>,<windows set>,<SPI transactions>
+// The hash is the golden-image check (golden.txt); the counts are the overdraw metric, e.g. the
+// pixels pushed by one page turn.
+//
+// The SD root needs font_data/ (as on the card), novel.txt, comic/1.bmp, 2.bmp, ... and the same images
+// in pages/ with a page-mode .info, and in series/ch9 and series/ch10 as two chapters, plus the Q565
+// encodings of the images in q565/ and q565pages/ (page mode), and two copies of the margin test page
+// in margins/ and marginpages/ (page mode) ("make render" stages them). Pages write caches to the card, so
+// stage a fresh copy for every run.
+//
+// With --replay, a touch trace (TouchTrace) is replayed through the same pages instead, as touchplay does on
+// the device: each event is one pass of loop() (handleTouch, handleLoop, composeFrame), its latency is the
+// wall time of that pass, and the page then settles until the next event. With a book path (relative to the
+// SD root) the text viewer is opened on it first, otherwise the trace starts at the menu as when it was
+// recorded. Events are injected back to back on the virtual clock, so a long session replays in seconds.
+// Jobs run synchronously here, so work the device does in the background (the next page's glyph prefetch)
+// counts towards the latency of the event that submitted it. Output: the "REPLAY,..." lines of
+// TouchTrace::printReport(), the same format as on the device, and the pixels pushed.
+//
+// Usage: host_render <sd root> <out dir>
+//        host_render --replay <sd root> <trace.csv> [book]
+
+#include <Arduino.h>
+#include <SD.h>
+#include <SPI.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "../../src/config/config.h"
+#include "../../src/core/display.h"
+#include "../../src/core/framebuffer_backend.h"
+#include "../../src/core/font.h"
+#include "../../src/core/memory_budget.h"
+#include "../../src/core/router.h"
+#include "../../src/core/scheduler.h"
+#include "../../src/core/sdcard.h"
+#include "../../src/core/touch_trace.h"
+#include "../../src/pages/pages.h"
+#include "../../src/pages/benchmark_page.h"
+
+SPIClass sdSPI = SPIClass(HSPI); // Defined by NovelComicReader.ino on the device
+
+static const int SETTLE_PASSES = 50;     // loop() passes after each step
+static const uint32_t PASS_MS = 20;       // Virtual time between passes (TOUCH_POLL_INTERVAL_MS order)
+
+static FramebufferBackend *framebuffer = nullptr;
+static std::string outDir;
+
+// Run the page's periodic work, the frame composition and the timers, as loop() does without touches
+static void settle()
+{
+    for (int pass = 0; pass < SETTLE_PASSES; pass++)
+    {
+        if (Page *page = Router::getInstance().getCurrentPage())
+        {
+            page->handleLoop();
+        }
+        Router::getInstance().composeFrame();
+        Scheduler::getInstance().runDueTimers();
+        Router::getInstance().composeFrame();
+        HostClock::advanceMs(PASS_MS);
+    }
+}
+
+static void report(const char *step)
+{
+    const FramebufferBackend::Counters &counters = framebuffer->getCounters();
+    std::string png = outDir + "/" + step + ".png";
+    if (!framebuffer->savePng(png.c_str()))
+    {
+        fprintf(stderr, "cannot write %s\n", png.c_str());
+    }
+    printf("RENDER,%s,%08x,%llu,%u,%u\n", step, (unsigned)framebuffer->hash(), (unsigned long long)counters.pixels,
+           (unsigned)counters.windows, (unsigned)counters.transactions);
+    fflush(stdout);
+}
+
+static void navigate(const char *step, const char *page, void *params = nullptr)
+{
+    framebuffer->resetCounters();
+    Router::getInstance().navigateTo(page, params);
+    settle();
+    report(step);
+}
+
+static void tap(const char *step, uint16_t x, uint16_t y)
+{
+    framebuffer->resetCounters();
+    if (Page *page = Router::getInstance().getCurrentPage())
+    {
+        page->handleTouch(x, y);
+    }
+    settle();
+    report(step);
+}
+
+static void back(const char *step)
+{
+    framebuffer->resetCounters();
+    Router::getInstance().goBack();
+    settle();
+    report(step);
+}
+
+// Bring the firmware up on the SD root in the same order as setup()
+static bool begin(const char *sdRoot)
+{
+    HostClock::useVirtualTime(true);
+    SD.setRoot(sdRoot);
+
+    // JobSystem is not started, so jobs run synchronously on this thread
+    Scheduler::getInstance().begin();
+    Display &display = Display::getInstance();
+    framebuffer = static_cast<FramebufferBackend *>(display.getTFT()); // Host default backend
+    display.begin();
+    if (!SDCard::getInstance().begin())
+    {
+        fprintf(stderr, "no SD root at %s\n", sdRoot);
+        return false;
+    }
+    MemoryBudget::getInstance().begin();
+    Font::getInstance().loadFastFontCache();
+    display.clear();
+
+    Router &router = Router::getInstance();
+    router.registerPage("browser", createFileBrowserPage);
+    router.registerPage("viewer", createImageViewerPage);
+    router.registerPage("comic", createComicViewerPage);
+    router.registerPage("text", createTextViewerPage);
+    router.registerPage("menu", createMenuPage);
+    router.registerPage("benchmark", createBenchmarkPage);
+    return true;
+}
+
+static unsigned long wallMicros()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Replay a touch trace through the pages, as loop() does on the device while touchplay runs
+static int replay(const char *tracePath, const char *book)
+{
+    Router &router = Router::getInstance();
+    unsigned long openStart = wallMicros();
+    if (book)
+    {
+        router.navigateTo("text", new String(book)); // Router::goBack deletes the parameter
+    }
+    else
+    {
+        router.navigateTo("menu");
+    }
+    settle();
+    printf("# opened %s in %lu us\n", book ? book : "the menu", wallMicros() - openStart);
+
+    TouchTrace &trace = TouchTrace::getInstance();
+    if (!trace.startReplay(tracePath, millis()))
+    {
+        return 1;
+    }
+    framebuffer->resetCounters();
+    uint16_t x, y;
+    while (trace.isReplaying())
+    {
+        HostClock::advanceMs(trace.msUntilNextEvent(millis())); // Skip the idle gap
+        if (!trace.nextDue(millis(), x, y))
+        {
+            break;
+        }
+        unsigned long start = wallMicros();
+        if (Page *page = router.getCurrentPage())
+        {
+            page->handleTouch(x, y);
+        }
+        if (Page *page = router.getCurrentPage())
+        {
+            page->handleLoop();
+        }
+        router.composeFrame();
+        trace.eventHandled(wallMicros() - start);
+        settle();
+    }
+    const FramebufferBackend::Counters &counters = framebuffer->getCounters();
+    printf("# pixels %llu, windows %u, SPI transactions %u\n", (unsigned long long)counters.pixels,
+           (unsigned)counters.windows, (unsigned)counters.transactions);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 4 && strcmp(argv[1], "--replay") == 0)
+    {
+        return begin(argv[2]) ? replay(argv[3], argc >= 5 ? argv[4] : nullptr) : 1;
+    }
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <sd root> <out dir>\n       %s --replay <sd root> <trace.csv> [book]\n", argv[0], argv[0]);
+        return 2;
+    }
+    outDir = argv[2];
+    if (!begin(argv[1]))
+    {
+        return 1;
+    }
+
+    navigate("menu", "menu");
+    navigate("browser", "browser");
+    back("browser_back");
+
+    navigate("text_open", "text", new String("/novel.txt")); // Router::goBack deletes the parameter
+    char step[32];
+    for (int turn = 1; turn <= 4; turn++)
+    {
+        snprintf(step, sizeof(step), "text_down_%d", turn);
+        tap(step, SCREEN_WIDTH / 2, 200); // Lower half of the content area: half a page down
+    }
+    tap("text_up", SCREEN_WIDTH / 2, 80);
+    back("text_back");
+
+    navigate("comic_open", "comic", new String("/comic"));
+    for (int turn = 1; turn <= 4; turn++)
+    {
+        snprintf(step, sizeof(step), "comic_down_%d", turn);
+        tap(step, SCREEN_WIDTH / 2, 220); // Bottom strip: a quarter screen down
+    }
+    tap("comic_up", SCREEN_WIDTH / 2, 30);
+    // Middle tap opens the thumbnail grid (thumbnails are generated one per pass); a thumbnail jumps there
+    tap("comic_grid", SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
+    tap("comic_grid_pick", SCREEN_WIDTH * 5 / 8, SCREEN_HEIGHT / 8); // Third thumbnail
+    back("comic_back");
+
+    // Page mode (pages/.info has "mode": "page"): one fitted page per image, tap the right/left third
+    navigate("pages_open", "comic", new String("/pages"));
+    for (int turn = 1; turn <= 2; turn++)
+    {
+        snprintf(step, sizeof(step), "pages_next_%d", turn);
+        tap(step, SCREEN_WIDTH - 20, SCREEN_HEIGHT / 2);
+    }
+    tap("pages_prev", 20, SCREEN_HEIGHT / 2);
+    tap("pages_grid", SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
+    tap("pages_grid_pick", SCREEN_WIDTH * 5 / 8, SCREEN_HEIGHT / 8);
+    tap("pages_grid_cached", SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2); // Thumbnails now come from pages/.thumbs
+    back("pages_back");
+
+    // Reopening a comic resumes where it was left (the .position file written on leaving): the first
+    // frame matches comic_grid_pick / pages_grid_pick
+    navigate("comic_resume", "comic", new String("/comic"));
+    back("comic_resume_back");
+    navigate("pages_resume", "comic", new String("/pages"));
+    back("pages_resume_back");
+
+    // Chapter chaining: series/ch9 and series/ch10 are sibling chapters (natural order, ch9 before ch10).
+    // Jump to the end through the scrollbar; the next chapter is appended and scrolling continues into it
+    navigate("series_open", "comic", new String("/series/ch9"));
+    tap("series_end", SCREEN_WIDTH - 2, SCREEN_HEIGHT - 1);
+    for (int turn = 1; turn <= 2; turn++)
+    {
+        snprintf(step, sizeof(step), "series_down_%d", turn);
+        tap(step, SCREEN_WIDTH / 2, 220);
+    }
+    back("series_back");
+
+    // Q565 copies of the same images: every frame matches the BMP one (comic_open, comic_down_1/2,
+    // comic_grid, pages_open). Leaving mid-image and reopening redraws the whole screen from row 120 of
+    // the first image, so q565_resume matches q565_down_2
+    navigate("q565_open", "comic", new String("/q565"));
+    for (int turn = 1; turn <= 2; turn++)
+    {
+        snprintf(step, sizeof(step), "q565_down_%d", turn);
+        tap(step, SCREEN_WIDTH / 2, 220);
+    }
+    back("q565_back");
+    navigate("q565_resume", "comic", new String("/q565"));
+    tap("q565_grid", SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
+    back("q565_resume_back");
+    navigate("q565_pages_open", "comic", new String("/q565pages"));
+    back("q565_pages_back");
+
+    // Margin test page (360 wide, content 300 wide): the canvas shows the centred 320 columns, starts 8 rows
+    // above the content box and skips the white gutter without pushing it; page mode scales the content box
+    navigate("margins_open", "comic", new String("/margins"));
+    for (int turn = 1; turn <= 2; turn++)
+    {
+        snprintf(step, sizeof(step), "margins_down_%d", turn);
+        tap(step, SCREEN_WIDTH / 2, 220);
+    }
+    back("margins_back");
+    navigate("margins_pages_open", "comic", new String("/marginpages"));
+    back("margins_pages_back");
+    return 0;
+}
@@ -0,0 +1,332 @@
+// Thin host-side stand-in for the Arduino core: String, Serial, timing and the pin/interrupt calls
+// the firmware makes, so the firmware sources compile and run unchanged on the host.
+// ARDUINO is deliberately not defined: sources with a device/host split take their host branch.
+#ifndef HOST_BENCH_ARDUINO_H
+#define HOST_BENCH_ARDUINO_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+#define IRAM_ATTR
+#define DEC 10
+#define HEX 16
+
+class String
+{
+public:
+    String() {}
+    String(const char *s) : str(s ? s : "") {}
+    String(char c) : str(1, c) {}
+    String(const std::string &s) : str(s) {}
+    String(int v, unsigned char base = 10) : str(format(v, base)) {}
+    String(unsigned int v, unsigned char base = 10) : str(format(v, base)) {}
+    String(long v, unsigned char base = 10) : str(format(v, base)) {}
+    String(unsigned long v, unsigned char base = 10) : str(format(v, base)) {}
+    String(long long v) : str(std::to_string(v)) {}
+    String(unsigned long long v) : str(std::to_string(v)) {}
+    String(float v, unsigned int decimals = 2) : str(formatFloat(v, decimals)) {}
+    String(double v, unsigned int decimals = 2) : str(formatFloat(v, decimals)) {}
+
+    String &operator=(const char *s)
+    {
+        str = s ? s : "";
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        str += c;
+        return *this;
+    }
+    String &operator+=(const char *s)
+    {
+        str += s;
+        return *this;
+    }
+    String &operator+=(const String &s)
+    {
+        str += s.str;
+        return *this;
+    }
+    String &operator+=(int v) { return *this += String(v); }
+    String &operator+=(unsigned int v) { return *this += String(v); }
+    String &operator+=(long v) { return *this += String(v); }
+    String &operator+=(unsigned long v) { return *this += String(v); }
+    bool concat(const char *s, unsigned int n)
+    {
+        str.append(s, n);
+        return true;
+    }
+    bool concat(const String &s)
+    {
+        str += s.str;
+        return true;
+    }
+    bool concat(char c)
+    {
+        str += c;
+        return true;
+    }
+    bool reserve(unsigned int n)
+    {
+        str.reserve(n);
+        return true;
+    }
+
+    friend String operator+(const String &a, const String &b) { return String(a.str + b.str); }
+    friend String operator+(const String &a, const char *b) { return String(a.str + b); }
+    friend String operator+(const char *a, const String &b) { return String(std::string(a) + b.str); }
+    friend String operator+(const String &a, char b) { return String(a.str + b); }
+    friend String operator+(const String &a, int b) { return a + String(b); }
+    friend String operator+(const String &a, unsigned int b) { return a + String(b); }
+    friend String operator+(const String &a, long b) { return a + String(b); }
+    friend String operator+(const String &a, unsigned long b) { return a + String(b); }
+
+    unsigned int length() const { return (unsigned int)str.length(); }
+    bool isEmpty() const { return str.empty(); }
+    const char *c_str() const { return str.c_str(); }
+    char operator[](unsigned int i) const { return i < str.length() ? str[i] : 0; }
+    char &operator[](unsigned int i) { return str[i]; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+    bool operator==(const String &o) const { return str == o.str; }
+    bool operator==(const char *o) const { return str == (o ? o : ""); }
+    bool operator!=(const String &o) const { return str != o.str; }
+    bool operator!=(const char *o) const { return !(*this == o); }
+    bool operator<(const String &o) const { return str < o.str; }
+    bool equals(const String &o) const { return str == o.str; }
+    bool equalsIgnoreCase(const String &o) const
+    {
+        String a(*this), b(o);
+        a.toLowerCase();
+        b.toLowerCase();
+        return a.str == b.str;
+    }
+
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        if (from > to)
+        {
+            std::swap(from, to);
+        }
+        if (from >= str.length())
+        {
+            return String();
+        }
+        if (to > str.length())
+        {
+            to = (unsigned int)str.length();
+        }
+        return String(str.substr(from, to - from));
+    }
+
+    int indexOf(const char *s, unsigned int from = 0) const { return found(str.find(s, from)); }
+    int indexOf(const String &s, unsigned int from = 0) const { return found(str.find(s.str, from)); }
+    int indexOf(char c, unsigned int from = 0) const { return found(str.find(c, from)); }
+    int lastIndexOf(char c) const { return found(str.rfind(c)); }
+    int lastIndexOf(const char *s) const { return found(str.rfind(s)); }
+    int lastIndexOf(const String &s) const { return found(str.rfind(s.str)); }
+    bool startsWith(const String &prefix) const { return str.compare(0, prefix.str.size(), prefix.str) == 0; }
+    bool endsWith(const String &suffix) const
+    {
+        return str.size() >= suffix.str.size() && str.compare(str.size() - suffix.str.size(), suffix.str.size(), suffix.str) == 0;
+    }
+
+    void toLowerCase()
+    {
+        for (char &c : str)
+            c = (char)tolower((unsigned char)c);
+    }
+    void toUpperCase()
+    {
+        for (char &c : str)
+            c = (char)toupper((unsigned char)c);
+    }
+    void trim()
+    {
+        size_t begin = str.find_first_not_of(" \t\r\n");
+        size_t end = str.find_last_not_of(" \t\r\n");
+        str = begin == std::string::npos ? std::string() : str.substr(begin, end - begin + 1);
+    }
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1)
+    {
+        if (index < str.length())
+            str.erase(index, count);
+    }
+    void replace(const String &from, const String &to)
+    {
+        if (from.str.empty())
+            return;
+        for (size_t at = str.find(from.str); at != std::string::npos; at = str.find(from.str, at + to.str.size()))
+            str.replace(at, from.str.size(), to.str);
+    }
+    long toInt() const { return atol(str.c_str()); }
+    float toFloat() const { return (float)atof(str.c_str()); }
+
+private:
+    std::string str;
+
+    static int found(size_t at) { return at == std::string::npos ? -1 : (int)at; }
+    static std::string format(long long v, unsigned char base)
+    {
+        char buf[32];
+        snprintf(buf, sizeof(buf), base == 16 ? "%llx" : "%lld", v);
+        return buf;
+    }
+    static std::string format(unsigned long long v, unsigned char base)
+    {
+        char buf[32];
+        snprintf(buf, sizeof(buf), base == 16 ? "%llx" : "%llu", v);
+        return buf;
+    }
+    static std::string format(int v, unsigned char base) { return format((long long)v, base); }
+    static std::string format(long v, unsigned char base) { return format((long long)v, base); }
+    static std::string format(unsigned int v, unsigned char base) { return format((unsigned long long)v, base); }
+    static std::string format(unsigned long v, unsigned char base) { return format((unsigned long long)v, base); }
+    static std::string formatFloat(double v, unsigned int decimals)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        return buf;
+    }
+};
+
+// --- Serial: output goes to stderr so tools can keep stdout for their own results ---
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) { return write(&c, 1); }
+    virtual size_t write(const uint8_t *buf, size_t len) = 0;
+    size_t write(const char *buf, size_t len) { return write((const uint8_t *)buf, len); }
+    size_t print(const char *s) { return write(s, strlen(s)); }
+    size_t print(const String &s) { return print(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(unsigned int v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(unsigned long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(double v, int decimals = 2) { return print(String(v, (unsigned int)decimals)); }
+    size_t println() { return print("\n"); }
+    template <typename T>
+    size_t println(const T &v)
+    {
+        size_t n = print(v);
+        return n + println();
+    }
+    template <typename T>
+    size_t println(const T &v, int format)
+    {
+        size_t n = print(v, format);
+        return n + println();
+    }
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buf[512];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        return len > 0 ? write(buf, std::min<size_t>(len, sizeof(buf) - 1)) : 0;
+    }
+};
+
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long) {}
+    using Print::write;
+    size_t write(const uint8_t *buf, size_t len) override { return fwrite(buf, 1, len, stderr); }
+    int available() { return 0; }
+    int read() { return -1; }
+    void onReceive(std::function<void()>, bool = false) {} // no input on the host
+    explicit operator bool() const { return true; }
+};
+
+inline HardwareSerial Serial;
+
+// --- Time ---
+// Real time by default (benchmarks). host_render switches to a virtual clock that advances one
+// microsecond per query, so anything the firmware paces by time (progress redraws every N ms)
+// happens at the same points on every run.
+
+struct HostClock
+{
+    static inline bool virtualTime = false;
+    static inline uint64_t virtualUs = 0;
+
+    static void useVirtualTime(bool enable) { virtualTime = enable; }
+    static void advanceMs(uint32_t ms) { virtualUs += (uint64_t)ms * 1000; }
+};
+
+inline unsigned long micros()
+{
+    if (HostClock::virtualTime)
+    {
+        return (unsigned long)(++HostClock::virtualUs);
+    }
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline unsigned long millis()
+{
+    return micros() / 1000;
+}
+
+inline void delay(unsigned long ms)
+{
+    if (HostClock::virtualTime)
+    {
+        HostClock::advanceMs(ms);
+    }
+}
+inline void delayMicroseconds(unsigned int) {}
+inline void yield() {}
+
+// --- Pins and interrupts (no hardware: inputs read as released) ---
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return HIGH; }
+inline int digitalPinToInterrupt(int pin) { return pin; }
+inline void attachInterrupt(uint8_t, void (*)(void), int) {}
+inline void attachInterruptArg(uint8_t, void (*)(void *), void *, int) {}
+inline void detachInterrupt(uint8_t) {}
+inline void esp_deep_sleep_start() { exit(0); }
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+template <class T>
+T constrain(T value, T low, T high) { return value < low ? low : (value > high ? high : value); }
+inline long random(long max) { return max > 0 ? rand() % max : 0; }
+inline long random(long min, long max) { return min + random(max - min); }
+inline void randomSeed(unsigned long seed) { srand((unsigned)seed); }
+
+#endif // HOST_BENCH_ARDUINO_H
@@ -0,0 +1,734 @@
+// Host stand-in for the part of ArduinoJson (v6 API) the firmware uses: a small DOM with
+// operator[] / containsKey / as<T>() / implicit conversions, nested arrays and objects,
+// range-for over arrays, and deserializeJson() / serializeJson() on streams and files.
+// Documents have no fixed capacity (StaticJsonDocument<N> and DynamicJsonDocument only record it).
+#ifndef HOST_BENCH_ARDUINOJSON_H
+#define HOST_BENCH_ARDUINOJSON_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Arduino.h"
+
+struct JsonNode
+{
+    enum Type
+    {
+        NUL,
+        BOOLEAN,
+        INTEGER,
+        FLOAT,
+        STRING,
+        ARRAY,
+        OBJECT
+    } type = NUL;
+    bool boolean = false;
+    long long integer = 0;
+    double number = 0;
+    std::string text;
+    std::vector<std::shared_ptr<JsonNode>> items;
+    std::vector<std::pair<std::string, std::shared_ptr<JsonNode>>> members;
+
+    std::shared_ptr<JsonNode> find(const std::string &key) const
+    {
+        if (type == OBJECT)
+        {
+            for (const auto &member : members)
+            {
+                if (member.first == key)
+                    return member.second;
+            }
+        }
+        return nullptr;
+    }
+    void reset(Type newType)
+    {
+        *this = JsonNode();
+        type = newType;
+    }
+};
+typedef std::shared_ptr<JsonNode> JsonNodePtr;
+
+class JsonArray;
+class JsonObject;
+
+class JsonVariant
+{
+public:
+    JsonVariant() {}
+    explicit JsonVariant(const JsonNodePtr &node) : node(node) {}
+
+    bool isNull() const { return !node || node->type == JsonNode::NUL; }
+    size_t size() const
+    {
+        if (!node)
+            return 0;
+        return node->type == JsonNode::ARRAY ? node->items.size() : (node->type == JsonNode::OBJECT ? node->members.size() : 0);
+    }
+
+    // Object member; assigning to a missing member creates it
+    JsonVariant operator[](const std::string &key) const
+    {
+        JsonVariant child(node ? node->find(key) : nullptr);
+        child.parent = node;
+        child.key = key;
+        return child;
+    }
+    JsonVariant operator[](const char *key) const { return (*this)[std::string(key)]; }
+    JsonVariant operator[](const String &key) const { return (*this)[std::string(key.c_str())]; }
+    JsonVariant operator[](int index) const
+    {
+        if (node && node->type == JsonNode::ARRAY && index >= 0 && (size_t)index < node->items.size())
+            return JsonVariant(node->items[index]);
+        return JsonVariant();
+    }
+    bool containsKey(const std::string &key) const { return node && node->find(key) != nullptr; }
+    bool containsKey(const char *key) const { return containsKey(std::string(key)); }
+    bool containsKey(const String &key) const { return containsKey(std::string(key.c_str())); }
+
+    template <typename T>
+    JsonVariant &operator=(const T &value)
+    {
+        set(value);
+        return *this;
+    }
+    JsonVariant &operator=(const JsonVariant &other)
+    {
+        JsonNodePtr target = ensure();
+        *target = other.node ? *other.node : JsonNode();
+        return *this;
+    }
+    JsonVariant(const JsonVariant &) = default;
+
+    template <typename T>
+    bool set(const T &value)
+    {
+        JsonNodePtr target = ensure();
+        assign(*target, value);
+        return true;
+    }
+
+    template <typename T>
+    T as() const;
+
+    template <typename T, typename = typename std::enable_if<!std::is_base_of<JsonVariant, T>::value>::type>
+    operator T() const { return as<T>(); }
+
+    template <typename T>
+    T to();
+
+    template <typename T>
+    bool add(const T &value)
+    {
+        JsonNodePtr item = addNode();
+        assign(*item, value);
+        return true;
+    }
+
+    JsonArray createNestedArray() const;
+    JsonObject createNestedObject() const;
+    JsonArray createNestedArray(const char *key) const;
+    JsonObject createNestedObject(const char *key) const;
+
+    // Range-for over array elements
+    class Iterator
+    {
+    public:
+        Iterator(const JsonNodePtr &node, size_t index) : node(node), index(index) {}
+        JsonVariant operator*() const { return JsonVariant(node->items[index]); }
+        Iterator &operator++()
+        {
+            index++;
+            return *this;
+        }
+        bool operator!=(const Iterator &other) const { return index != other.index; }
+
+    private:
+        JsonNodePtr node;
+        size_t index;
+    };
+    Iterator begin() const { return Iterator(node, 0); }
+    Iterator end() const { return Iterator(node, node && node->type == JsonNode::ARRAY ? node->items.size() : 0); }
+
+    const JsonNodePtr &raw() const { return node; }
+
+protected:
+    JsonNodePtr node;
+    JsonNodePtr parent; // Set by operator[] so a missing member can be created on assignment
+    std::string key;
+
+    JsonNodePtr ensure()
+    {
+        if (!node)
+        {
+            node = std::make_shared<JsonNode>();
+            if (parent)
+            {
+                if (parent->type != JsonNode::OBJECT)
+                    parent->reset(JsonNode::OBJECT);
+                parent->members.emplace_back(key, node);
+            }
+        }
+        return node;
+    }
+    JsonNodePtr addNode() const
+    {
+        JsonNodePtr item = std::make_shared<JsonNode>();
+        if (node)
+        {
+            if (node->type != JsonNode::ARRAY)
+                node->reset(JsonNode::ARRAY);
+            node->items.push_back(item);
+        }
+        return item;
+    }
+
+    static void assign(JsonNode &target, bool value)
+    {
+        target.reset(JsonNode::BOOLEAN);
+        target.boolean = value;
+    }
+    static void assign(JsonNode &target, const char *value)
+    {
+        target.reset(value ? JsonNode::STRING : JsonNode::NUL);
+        target.text = value ? value : "";
+    }
+    static void assign(JsonNode &target, const std::string &value) { assign(target, value.c_str()); }
+    static void assign(JsonNode &target, const String &value) { assign(target, value.c_str()); }
+    template <size_t N>
+    static void assign(JsonNode &target, const char (&value)[N]) { assign(target, (const char *)value); }
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value>::type assign(JsonNode &target, T value)
+    {
+        target.reset(JsonNode::INTEGER);
+        target.integer = (long long)value;
+    }
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value>::type assign(JsonNode &target, T value)
+    {
+        target.reset(JsonNode::FLOAT);
+        target.number = value;
+    }
+};
+
+class JsonArray : public JsonVariant
+{
+public:
+    JsonArray() {}
+    JsonArray(const JsonVariant &v) : JsonVariant(v.raw() && v.raw()->type == JsonNode::ARRAY ? v.raw() : nullptr) {}
+};
+class JsonObject : public JsonVariant
+{
+public:
+    JsonObject() {}
+    JsonObject(const JsonVariant &v) : JsonVariant(v.raw() && v.raw()->type == JsonNode::OBJECT ? v.raw() : nullptr) {}
+};
+typedef JsonVariant JsonVariantConst;
+typedef JsonArray JsonArrayConst;
+typedef JsonObject JsonObjectConst;
+
+// --- Conversions ---
+
+template <typename T, typename Enable = void>
+struct JsonConverter
+{
+    static T from(const JsonNodePtr &node) { return T(JsonVariant(node)); } // JsonArray / JsonObject / JsonVariant
+};
+template <typename T>
+struct JsonConverter<T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>::type>
+{
+    static T from(const JsonNodePtr &node)
+    {
+        if (!node)
+            return T();
+        switch (node->type)
+        {
+        case JsonNode::INTEGER:
+            return (T)node->integer;
+        case JsonNode::FLOAT:
+            return (T)node->number;
+        case JsonNode::BOOLEAN:
+            return (T)node->boolean;
+        default:
+            return T();
+        }
+    }
+};
+template <>
+struct JsonConverter<bool>
+{
+    static bool from(const JsonNodePtr &node)
+    {
+        return node && (node->type == JsonNode::BOOLEAN ? node->boolean : (node->type == JsonNode::INTEGER && node->integer != 0));
+    }
+};
+template <>
+struct JsonConverter<const char *>
+{
+    static const char *from(const JsonNodePtr &node) { return node && node->type == JsonNode::STRING ? node->text.c_str() : nullptr; }
+};
+template <>
+struct JsonConverter<String>
+{
+    static String from(const JsonNodePtr &node) { return String(JsonConverter<const char *>::from(node)); }
+};
+template <>
+struct JsonConverter<std::string>
+{
+    static std::string from(const JsonNodePtr &node)
+    {
+        const char *s = JsonConverter<const char *>::from(node);
+        return s ? s : "";
+    }
+};
+
+template <typename T>
+T JsonVariant::as() const { return JsonConverter<T>::from(node); }
+
+template <typename T>
+T JsonVariant::to()
+{
+    JsonNodePtr target = ensure();
+    target->reset(std::is_same<T, JsonArray>::value ? JsonNode::ARRAY : (std::is_same<T, JsonObject>::value ? JsonNode::OBJECT : JsonNode::NUL));
+    return T(JsonVariant(target));
+}
+
+inline JsonArray JsonVariant::createNestedArray() const
+{
+    JsonNodePtr item = addNode();
+    item->type = JsonNode::ARRAY;
+    return JsonArray(JsonVariant(item));
+}
+inline JsonObject JsonVariant::createNestedObject() const
+{
+    JsonNodePtr item = addNode();
+    item->type = JsonNode::OBJECT;
+    return JsonObject(JsonVariant(item));
+}
+inline JsonArray JsonVariant::createNestedArray(const char *name) const
+{
+    JsonVariant member = (*this)[name];
+    return member.to<JsonArray>();
+}
+inline JsonObject JsonVariant::createNestedObject(const char *name) const
+{
+    JsonVariant member = (*this)[name];
+    return member.to<JsonObject>();
+}
+
+// --- Documents ---
+
+class JsonDocument : public JsonVariant
+{
+public:
+    explicit JsonDocument(size_t capacity) : JsonVariant(std::make_shared<JsonNode>()), capacityBytes(capacity) {}
+    JsonDocument(const JsonDocument &) = delete;
+    JsonDocument &operator=(const JsonDocument &) = delete;
+
+    void clear() { node->reset(JsonNode::NUL); }
+    size_t capacity() const { return capacityBytes; }
+    size_t memoryUsage() const { return 0; }
+    bool overflowed() const { return false; }
+    void shrinkToFit() {}
+    void garbageCollect() {}
+
+    template <typename T>
+    JsonDocument &operator=(const T &value)
+    {
+        set(value);
+        return *this;
+    }
+
+private:
+    size_t capacityBytes;
+};
+
+class DynamicJsonDocument : public JsonDocument
+{
+public:
+    explicit DynamicJsonDocument(size_t capacity) : JsonDocument(capacity) {}
+};
+
+template <size_t N>
+class StaticJsonDocument : public JsonDocument
+{
+public:
+    StaticJsonDocument() : JsonDocument(N) {}
+};
+
+#define JSON_OBJECT_SIZE(n) (16 * (n))
+#define JSON_ARRAY_SIZE(n) (16 * (n))
+
+// --- Parsing ---
+
+class DeserializationError
+{
+public:
+    enum Code
+    {
+        Ok,
+        EmptyInput,
+        IncompleteInput,
+        InvalidInput,
+        NoMemory,
+        TooDeep
+    };
+    DeserializationError(Code code = Ok) : errorCode(code) {}
+    explicit operator bool() const { return errorCode != Ok; }
+    bool operator==(Code code) const { return errorCode == code; }
+    Code code() const { return errorCode; }
+    const char *c_str() const
+    {
+        static const char *names[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"};
+        return names[errorCode];
+    }
+
+private:
+    Code errorCode;
+};
+
+class JsonParser
+{
+public:
+    JsonParser(const std::string &text) : text(text), pos(0) {}
+
+    DeserializationError parse(JsonNode &out)
+    {
+        skipSpace();
+        if (pos >= text.size())
+            return DeserializationError::EmptyInput;
+        DeserializationError::Code code = value(out, 0);
+        return code;
+    }
+
+private:
+    const std::string &text;
+    size_t pos;
+
+    void skipSpace()
+    {
+        while (pos < text.size() && isspace((unsigned char)text[pos]))
+            pos++;
+    }
+    DeserializationError::Code value(JsonNode &out, int depth)
+    {
+        if (depth > 20)
+            return DeserializationError::TooDeep;
+        skipSpace();
+        if (pos >= text.size())
+            return DeserializationError::IncompleteInput;
+        char c = text[pos];
+        if (c == '{')
+        {
+            out.reset(JsonNode::OBJECT);
+            pos++;
+            skipSpace();
+            if (pos < text.size() && text[pos] == '}')
+            {
+                pos++;
+                return DeserializationError::Ok;
+            }
+            while (true)
+            {
+                skipSpace();
+                std::string name;
+                DeserializationError::Code code = string(name);
+                if (code != DeserializationError::Ok)
+                    return code;
+                skipSpace();
+                if (pos >= text.size() || text[pos] != ':')
+                    return pos >= text.size() ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+                pos++;
+                JsonNodePtr member = std::make_shared<JsonNode>();
+                code = value(*member, depth + 1);
+                if (code != DeserializationError::Ok)
+                    return code;
+                out.members.emplace_back(name, member);
+                skipSpace();
+                if (pos >= text.size())
+                    return DeserializationError::IncompleteInput;
+                if (text[pos] == ',')
+                {
+                    pos++;
+                    continue;
+                }
+                if (text[pos] == '}')
+                {
+                    pos++;
+                    return DeserializationError::Ok;
+                }
+                return DeserializationError::InvalidInput;
+            }
+        }
+        if (c == '[')
+        {
+            out.reset(JsonNode::ARRAY);
+            pos++;
+            skipSpace();
+            if (pos < text.size() && text[pos] == ']')
+            {
+                pos++;
+                return DeserializationError::Ok;
+            }
+            while (true)
+            {
+                JsonNodePtr item = std::make_shared<JsonNode>();
+                DeserializationError::Code code = value(*item, depth + 1);
+                if (code != DeserializationError::Ok)
+                    return code;
+                out.items.push_back(item);
+                skipSpace();
+                if (pos >= text.size())
+                    return DeserializationError::IncompleteInput;
+                if (text[pos] == ',')
+                {
+                    pos++;
+                    continue;
+                }
+                if (text[pos] == ']')
+                {
+                    pos++;
+                    return DeserializationError::Ok;
+                }
+                return DeserializationError::InvalidInput;
+            }
+        }
+        if (c == '"')
+        {
+            out.reset(JsonNode::STRING);
+            return string(out.text);
+        }
+        if (text.compare(pos, 4, "true") == 0 || text.compare(pos, 5, "false") == 0)
+        {
+            out.reset(JsonNode::BOOLEAN);
+            out.boolean = text[pos] == 't';
+            pos += out.boolean ? 4 : 5;
+            return DeserializationError::Ok;
+        }
+        if (text.compare(pos, 4, "null") == 0)
+        {
+            out.reset(JsonNode::NUL);
+            pos += 4;
+            return DeserializationError::Ok;
+        }
+        const char *start = text.c_str() + pos;
+        char *end;
+        double number = strtod(start, &end);
+        if (end == start)
+            return DeserializationError::InvalidInput;
+        std::string literal(start, end - start);
+        pos += end - start;
+        if (literal.find_first_of(".eE") == std::string::npos)
+        {
+            out.reset(JsonNode::INTEGER);
+            out.integer = strtoll(literal.c_str(), nullptr, 10);
+        }
+        else
+        {
+            out.reset(JsonNode::FLOAT);
+            out.number = number;
+        }
+        return DeserializationError::Ok;
+    }
+    DeserializationError::Code string(std::string &out)
+    {
+        if (pos >= text.size())
+            return DeserializationError::IncompleteInput;
+        if (text[pos] != '"')
+            return DeserializationError::InvalidInput;
+        pos++;
+        while (pos < text.size())
+        {
+            char c = text[pos++];
+            if (c == '"')
+                return DeserializationError::Ok;
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size())
+                break;
+            char escape = text[pos++];
+            switch (escape)
+            {
+            case 'n':
+                out += '\n';
+                break;
+            case 't':
+                out += '\t';
+                break;
+            case 'r':
+                out += '\r';
+                break;
+            case 'b':
+                out += '\b';
+                break;
+            case 'f':
+                out += '\f';
+                break;
+            case 'u':
+            {
+                if (pos + 4 > text.size())
+                    return DeserializationError::IncompleteInput;
+                unsigned code = (unsigned)strtoul(text.substr(pos, 4).c_str(), nullptr, 16);
+                pos += 4;
+                if (code >= 0xD800 && code < 0xDC00 && text.compare(pos, 2, "\\u") == 0)
+                {
+                    unsigned low = (unsigned)strtoul(text.substr(pos + 2, 4).c_str(), nullptr, 16);
+                    pos += 6;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, code);
+                break;
+            }
+            default:
+                out += escape;
+                break;
+            }
+        }
+        return DeserializationError::IncompleteInput;
+    }
+    static void appendUtf8(std::string &out, unsigned code)
+    {
+        if (code < 0x80)
+        {
+            out += (char)code;
+        }
+        else if (code < 0x800)
+        {
+            out += (char)(0xC0 | (code >> 6));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+        else if (code < 0x10000)
+        {
+            out += (char)(0xE0 | (code >> 12));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            out += (char)(0xF0 | (code >> 18));
+            out += (char)(0x80 | ((code >> 12) & 0x3F));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+    }
+};
+
+inline DeserializationError deserializeJsonText(JsonDocument &doc, const std::string &text)
+{
+    JsonNode root;
+    DeserializationError error = JsonParser(text).parse(root);
+    doc.clear();
+    if (!error)
+        *doc.raw() = root;
+    return error;
+}
+inline DeserializationError deserializeJson(JsonDocument &doc, const char *text) { return deserializeJsonText(doc, text ? text : ""); }
+inline DeserializationError deserializeJson(JsonDocument &doc, const String &text) { return deserializeJsonText(doc, text.c_str()); }
+// Streams (File): reads the remaining bytes
+template <typename Stream>
+DeserializationError deserializeJson(JsonDocument &doc, Stream &input)
+{
+    std::string text;
+    for (int c = input.read(); c >= 0; c = input.read())
+        text += (char)c;
+    return deserializeJsonText(doc, text);
+}
+
+// --- Serialization ---
+
+inline void serializeJsonNode(const JsonNode &node, std::string &out)
+{
+    char buf[32];
+    switch (node.type)
+    {
+    case JsonNode::NUL:
+        out += "null";
+        break;
+    case JsonNode::BOOLEAN:
+        out += node.boolean ? "true" : "false";
+        break;
+    case JsonNode::INTEGER:
+        snprintf(buf, sizeof(buf), "%lld", node.integer);
+        out += buf;
+        break;
+    case JsonNode::FLOAT:
+        snprintf(buf, sizeof(buf), "%.9g", node.number);
+        out += buf;
+        break;
+    case JsonNode::STRING:
+        out += '"';
+        for (char c : node.text)
+        {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            if (c == '\n')
+            {
+                out += "\\n";
+                continue;
+            }
+            out += c;
+        }
+        out += '"';
+        break;
+    case JsonNode::ARRAY:
+        out += '[';
+        for (size_t i = 0; i < node.items.size(); i++)
+        {
+            if (i)
+                out += ',';
+            serializeJsonNode(*node.items[i], out);
+        }
+        out += ']';
+        break;
+    case JsonNode::OBJECT:
+        out += '{';
+        for (size_t i = 0; i < node.members.size(); i++)
+        {
+            if (i)
+                out += ',';
+            JsonNode name;
+            name.type = JsonNode::STRING;
+            name.text = node.members[i].first;
+            serializeJsonNode(name, out);
+            out += ':';
+            serializeJsonNode(*node.members[i].second, out);
+        }
+        out += '}';
+        break;
+    }
+}
+
+inline size_t measureJson(const JsonVariant &source)
+{
+    std::string out;
+    if (source.raw())
+        serializeJsonNode(*source.raw(), out);
+    return out.size();
+}
+inline size_t serializeJson(const JsonVariant &source, String &output)
+{
+    std::string out;
+    if (source.raw())
+        serializeJsonNode(*source.raw(), out);
+    output = out.c_str();
+    return out.size();
+}
+// Print (File, Serial)
+template <typename Output>
+size_t serializeJson(const JsonVariant &source, Output &output)
+{
+    std::string out;
+    if (source.raw())
+        serializeJsonNode(*source.raw(), out);
+    return output.write((const uint8_t *)out.data(), out.size());
+}
+
+#endif // HOST_BENCH_ARDUINOJSON_H
@@ -0,0 +1,202 @@
+// Thin host-side stand-in for the Arduino FS File: a shared handle (copies refer to the same open
+// file, as on the device) over a stdio FILE* or a directory listing. Keeps the same per-byte
+// read()/peek()/available() calls the viewers use on device.
+#ifndef HOST_BENCH_FS_H
+#define HOST_BENCH_FS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#include "Arduino.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+
+enum SeekMode
+{
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+class File : public Print
+{
+public:
+    File() {}
+
+    // hostPath: path on the host; name: the path the firmware asked for (defaults to hostPath)
+    explicit File(const char *hostPath, const char *mode = FILE_READ, const char *name = nullptr)
+    {
+        std::shared_ptr<Handle> h = std::make_shared<Handle>();
+        h->path = name ? name : hostPath;
+        size_t slash = h->path.find_last_of('/');
+        h->name = slash == std::string::npos ? h->path : h->path.substr(slash + 1);
+        struct stat info;
+        bool exists = stat(hostPath, &info) == 0;
+        if (exists && S_ISDIR(info.st_mode))
+        {
+            if (strcmp(mode, FILE_READ) != 0)
+            {
+                return;
+            }
+            h->directory = true;
+            h->hostPath = hostPath;
+            if (DIR *dir = opendir(hostPath))
+            {
+                while (struct dirent *entry = readdir(dir))
+                {
+                    if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+                    {
+                        h->entries.push_back(entry->d_name);
+                    }
+                }
+                closedir(dir);
+            }
+            std::sort(h->entries.begin(), h->entries.end()); // Deterministic order (FAT order on the device)
+            handle = h;
+            return;
+        }
+        // "r+" (update in place) is passed through to fopen on the device as well
+        const char *stdioMode = strcmp(mode, FILE_WRITE) == 0 ? "w+b"
+                                : strcmp(mode, FILE_APPEND) == 0 ? "a+b"
+                                : strcmp(mode, "r+") == 0       ? "r+b"
+                                                                : "rb";
+        h->fp = fopen(hostPath, stdioMode);
+        if (h->fp)
+        {
+            fseek(h->fp, 0, SEEK_END);
+            h->size = (size_t)ftell(h->fp);
+            fseek(h->fp, 0, strcmp(mode, FILE_APPEND) == 0 ? SEEK_END : SEEK_SET);
+            handle = h;
+        }
+    }
+
+    explicit operator bool() const { return handle && (handle->fp || handle->directory); }
+
+    int available() { return fp() ? (int)(size() - position()) : 0; }
+    int read() { return fp() ? getc(fp()) : -1; }
+    int peek()
+    {
+        if (!fp())
+            return -1;
+        int c = getc(fp());
+        if (c != EOF)
+            ungetc(c, fp());
+        return c;
+    }
+    size_t read(uint8_t *buf, size_t len) { return fp() ? fread(buf, 1, len, fp()) : 0; }
+    size_t readBytes(char *buf, size_t len) { return read((uint8_t *)buf, len); }
+    String readString()
+    {
+        std::string out;
+        for (int c = read(); c >= 0; c = read())
+            out += (char)c;
+        return String(out);
+    }
+    String readStringUntil(char terminator)
+    {
+        std::string out;
+        for (int c = read(); c >= 0 && c != terminator; c = read())
+            out += (char)c;
+        return String(out);
+    }
+
+    using Print::write;
+    size_t write(const uint8_t *buf, size_t len) override
+    {
+        if (!fp())
+            return 0;
+        size_t written = fwrite(buf, 1, len, fp());
+        handle->size = std::max(handle->size, position());
+        return written;
+    }
+    void flush()
+    {
+        if (fp())
+            fflush(fp());
+    }
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet)
+    {
+        static const int whence[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+        return fp() && fseek(fp(), (long)pos, whence[mode]) == 0;
+    }
+    size_t position() const { return fp() ? (size_t)ftell(fp()) : 0; }
+    size_t size() const { return fp() ? handle->size : 0; }
+    void close()
+    {
+        if (handle)
+        {
+            handle->close();
+            handle.reset();
+        }
+    }
+
+    const char *name() const { return handle ? handle->name.c_str() : ""; }
+    const char *path() const { return handle ? handle->path.c_str() : ""; }
+    bool isDirectory() const { return handle && handle->directory; }
+    File openNextFile(const char *mode = FILE_READ)
+    {
+        if (!isDirectory() || handle->nextEntry >= handle->entries.size())
+        {
+            return File();
+        }
+        const std::string &entry = handle->entries[handle->nextEntry++];
+        std::string base = handle->path == "/" ? "" : handle->path;
+        return File((handle->hostPath + "/" + entry).c_str(), mode, (base + "/" + entry).c_str());
+    }
+    void rewindDirectory()
+    {
+        if (isDirectory())
+            handle->nextEntry = 0;
+    }
+
+private:
+    struct Handle
+    {
+        FILE *fp = nullptr;
+        size_t size = 0;
+        bool directory = false;
+        std::string hostPath;
+        std::string path;
+        std::string name;
+        std::vector<std::string> entries;
+        size_t nextEntry = 0;
+
+        void close()
+        {
+            if (fp)
+            {
+                fclose(fp);
+                fp = nullptr;
+            }
+            directory = false;
+        }
+        ~Handle() { close(); }
+    };
+    std::shared_ptr<Handle> handle;
+
+    FILE *fp() const { return handle ? handle->fp : nullptr; }
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
+
+#endif // HOST_BENCH_FS_H
@@ -0,0 +1,62 @@
+// Host stand-in for the SD library: the card is a directory on the host (SD.setRoot()),
+// so the firmware's absolute paths ("/font_data/...", "/comic/...") map to files under it.
+#ifndef HOST_BENCH_SD_H
+#define HOST_BENCH_SD_H
+
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "FS.h"
+#include "SPI.h"
+
+#define CARD_NONE 0
+#define CARD_SD 2
+
+class SDFS
+{
+public:
+    void setRoot(const char *dir) { root = dir; }
+    bool begin(uint8_t cs = 0, SPIClass &spi = defaultSpi(), uint32_t frequency = 4000000)
+    {
+        (void)cs, (void)spi, (void)frequency;
+        struct stat info;
+        return stat(root.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    }
+    uint8_t cardType() { return CARD_SD; }
+    uint64_t cardSize() { return 4ull << 30; }
+    uint64_t totalBytes() { return cardSize(); }
+    uint64_t usedBytes() { return 0; }
+
+    File open(const char *path, const char *mode = FILE_READ) { return File(host(path).c_str(), mode, path); }
+    File open(const String &path, const char *mode = FILE_READ) { return open(path.c_str(), mode); }
+    bool exists(const char *path)
+    {
+        struct stat info;
+        return stat(host(path).c_str(), &info) == 0;
+    }
+    bool exists(const String &path) { return exists(path.c_str()); }
+    bool remove(const char *path) { return ::remove(host(path).c_str()) == 0; }
+    bool remove(const String &path) { return remove(path.c_str()); }
+    bool rename(const char *from, const char *to) { return ::rename(host(from).c_str(), host(to).c_str()) == 0; }
+    bool rename(const String &from, const String &to) { return rename(from.c_str(), to.c_str()); }
+    bool mkdir(const char *path) { return ::mkdir(host(path).c_str(), 0755) == 0; }
+    bool mkdir(const String &path) { return mkdir(path.c_str()); }
+    bool rmdir(const char *path) { return ::rmdir(host(path).c_str()) == 0; }
+    bool rmdir(const String &path) { return rmdir(path.c_str()); }
+
+private:
+    std::string root = ".";
+
+    std::string host(const char *path) const { return root + (path[0] == '/' ? "" : "/") + path; }
+    static SPIClass &defaultSpi()
+    {
+        static SPIClass spi;
+        return spi;
+    }
+};
+
+inline SDFS SD;
+
+#endif // HOST_BENCH_SD_H
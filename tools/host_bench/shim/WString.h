@@ -0,0 +1,2 @@
+// Host stand-in: String lives in Arduino.h
+#include "Arduino.h"
@@ -0,0 +1,27 @@
+// Host stand-in for the touch controller: never touched (host tools inject touches into the pages directly).
+#ifndef HOST_BENCH_XPT2046_H
+#define HOST_BENCH_XPT2046_H
+
+#include "Arduino.h"
+#include "SPI.h"
+
+class TS_Point
+{
+public:
+    int16_t x = 0, y = 0, z = 0;
+};
+
+class XPT2046_Touchscreen
+{
+public:
+    XPT2046_Touchscreen(uint8_t cs, uint8_t irq = 255) { (void)cs, (void)irq; }
+    bool begin(SPIClass &) { return true; }
+    bool begin() { return true; }
+    TS_Point getPoint() { return TS_Point(); }
+    bool touched() { return false; }
+    bool tirqTouched() { return false; }
+    void setRotation(uint8_t) {}
+    volatile bool isrWake = false;
+};
+
+#endif // HOST_BENCH_XPT2046_H
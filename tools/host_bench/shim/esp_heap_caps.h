@@ -0,0 +1,24 @@
+// Host stand-in for the ESP-IDF heap API: plain malloc, and a fixed heap picture
+// (no PSRAM, 160 KB free internal RAM) so MemoryBudget sizes its caches the same way on every run.
+#ifndef HOST_BENCH_ESP_HEAP_CAPS_H
+#define HOST_BENCH_ESP_HEAP_CAPS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+inline void *heap_caps_malloc(size_t size, uint32_t caps) { return (caps & MALLOC_CAP_SPIRAM) ? nullptr : malloc(size); }
+inline void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) { return (caps & MALLOC_CAP_SPIRAM) ? nullptr : calloc(n, size); }
+inline void heap_caps_free(void *ptr) { free(ptr); }
+inline size_t heap_caps_get_free_size(uint32_t caps) { return (caps & MALLOC_CAP_SPIRAM) ? 0 : 160 * 1024; }
+inline size_t heap_caps_get_largest_free_block(uint32_t caps) { return (caps & MALLOC_CAP_SPIRAM) ? 0 : 110 * 1024; }
+inline size_t heap_caps_get_minimum_free_size(uint32_t caps) { return heap_caps_get_free_size(caps); }
+inline size_t heap_caps_get_total_size(uint32_t caps) { return (caps & MALLOC_CAP_SPIRAM) ? 0 : 320 * 1024; }
+
+#endif // HOST_BENCH_ESP_HEAP_CAPS_H
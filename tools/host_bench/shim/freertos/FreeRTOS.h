@@ -0,0 +1,35 @@
+// Host stand-in for FreeRTOS: the host tools run single-threaded on the "loop task"
+// (JobSystem::begin() is never called, so jobs execute synchronously on submit).
+#ifndef HOST_BENCH_FREERTOS_H
+#define HOST_BENCH_FREERTOS_H
+
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xffffffffu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portTICK_PERIOD_MS 1
+#define portYIELD_FROM_ISR(...) \
+    do                          \
+    {                           \
+    } while (0)
+#define tskNO_AFFINITY 0x7fffffff
+
+typedef struct
+{
+    int unused;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) (void)(mux)
+#define portEXIT_CRITICAL(mux) (void)(mux)
+#define portENTER_CRITICAL_ISR(mux) (void)(mux)
+#define portEXIT_CRITICAL_ISR(mux) (void)(mux)
+
+#endif // HOST_BENCH_FREERTOS_H
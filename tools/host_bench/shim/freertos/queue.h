@@ -0,0 +1,49 @@
+// Host stand-in for FreeRTOS queues: a bounded FIFO of fixed-size items; never blocks.
+#ifndef HOST_BENCH_FREERTOS_QUEUE_H
+#define HOST_BENCH_FREERTOS_QUEUE_H
+
+#include <cstring>
+#include <deque>
+#include <vector>
+#include "FreeRTOS.h"
+
+struct HostQueue
+{
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+};
+typedef HostQueue *QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    return new HostQueue{length, itemSize, {}};
+}
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t)
+{
+    if (queue->items.size() >= queue->length)
+    {
+        return pdFALSE;
+    }
+    const uint8_t *bytes = static_cast<const uint8_t *>(item);
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    return pdTRUE;
+}
+inline BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *)
+{
+    return xQueueSend(queue, item, 0);
+}
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t)
+{
+    if (queue->items.empty())
+    {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    return pdTRUE;
+}
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) { return (UBaseType_t)queue->items.size(); }
+inline void vQueueDelete(QueueHandle_t queue) { delete queue; }
+
+#endif // HOST_BENCH_FREERTOS_QUEUE_H
@@ -0,0 +1,49 @@
+// Host stand-in for FreeRTOS semaphores: with a single task every mutex take succeeds;
+// counting semaphores keep their count but never block.
+#ifndef HOST_BENCH_FREERTOS_SEMPHR_H
+#define HOST_BENCH_FREERTOS_SEMPHR_H
+
+#include "queue.h"
+
+struct HostSemaphore
+{
+    UBaseType_t count;
+    UBaseType_t max;
+    bool mutex;
+};
+typedef HostSemaphore *SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new HostSemaphore{1, 1, true}; }
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return new HostSemaphore{1, 1, true}; }
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return new HostSemaphore{0, 1, false}; }
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial)
+{
+    return new HostSemaphore{initial, max, false};
+}
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t)
+{
+    if (sem->mutex)
+    {
+        return pdTRUE;
+    }
+    if (sem->count == 0)
+    {
+        return pdFALSE;
+    }
+    sem->count--;
+    return pdTRUE;
+}
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    if (!sem->mutex && sem->count < sem->max)
+    {
+        sem->count++;
+    }
+    return pdTRUE;
+}
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *) { return xSemaphoreGive(sem); }
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks) { return xSemaphoreTake(sem, ticks); }
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) { return xSemaphoreGive(sem); }
+inline void vSemaphoreDelete(SemaphoreHandle_t sem) { delete sem; }
+
+#endif // HOST_BENCH_FREERTOS_SEMPHR_H
@@ -0,0 +1,26 @@
+// Host stand-in for FreeRTOS tasks: one task (the caller), no task creation, notifications never block.
+#ifndef HOST_BENCH_FREERTOS_TASK_H
+#define HOST_BENCH_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    static int loopTask;
+    return &loopTask;
+}
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *, UBaseType_t, TaskHandle_t *, BaseType_t)
+{
+    return pdFAIL;
+}
+inline void vTaskDelete(TaskHandle_t) {}
+inline void vTaskDelay(TickType_t) {}
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+inline BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t *) {}
+inline BaseType_t xPortGetCoreID() { return 1; }
+
+#endif // HOST_BENCH_FREERTOS_TASK_H
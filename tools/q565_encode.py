@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+"""Encode comic images as Q565 (lossless QOI-style RGB565 strips) for the comic viewer.
+
+The file format and the op codes are documented in src/core/q565.h. Every group of --group-rows rows is an
+independent restart point, so the viewer decodes any scroll position without the rows above it.
+
+  q565_encode.py comic_dir            convert comic_dir/1.bmp, 2.bmp, ... to 1.q565, 2.q565, ... in place
+  q565_encode.py page.bmp -o out/     convert single images (the output keeps the base name)
+
+The header starts with "Q565" and the format version (VERSION); the viewer rejects files written for another
+version, which must be re-encoded. It also records the page background (--background, paper white by default),
+the bounding box of everything that is not background, and the runs of at least --min-blank-rows rows that
+are pure background.
+The viewer crops the margins to the box and skips the blank runs without reading or decoding them. Scans
+with paper noise can pass --blank-threshold: rows within that distance of the background (per RGB565
+component) are written as pure background, which makes them blank runs (lossy for those rows only).
+
+24-bit BMP is read directly; other formats (PNG, JPEG, ...) need Pillow. Pixels are reduced to RGB565 the
+same way the firmware converts BMP rows, so a converted BMP decodes to exactly the pixels the viewer showed
+before. The comic viewer prefers N.q565 over N.bmp, so the BMP files can be deleted after converting.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+MAGIC = b"Q565"
+VERSION = 2  # Q565Decoder::VERSION; version 1 files (no version field, 12-byte header) must be re-encoded
+HEADER_BYTES = 26
+WHITE = 0xFFFF
+MAX_BLANK_RUNS = 64  # Q565Decoder::MAX_BLANK_RUNS
+
+
+def rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def read_bmp(path):
+    """Return (width, height, rows of RGB565 values, top row first) for an uncompressed 24-bit BMP, else None."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < 54 or data[:2] != b"BM":
+        return None
+    data_offset = struct.unpack_from("<I", data, 10)[0]
+    width, height, _, bpp, compression = struct.unpack_from("<iiHHI", data, 18)
+    if bpp != 24 or compression != 0 or width <= 0:
+        return None
+    top_down = height < 0
+    height = abs(height)
+    stride = (width * 3 + 3) & ~3
+    rows = []
+    for y in range(height):
+        file_row = y if top_down else height - 1 - y
+        start = data_offset + file_row * stride
+        row = data[start:start + width * 3]
+        rows.append([rgb565(row[i + 2], row[i + 1], row[i]) for i in range(0, width * 3, 3)])
+    return width, height, rows
+
+
+def read_image(path):
+    image = read_bmp(path)
+    if image:
+        return image
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit("%s: only 24-bit BMP can be read without Pillow" % path)
+    with Image.open(path) as img:
+        img = img.convert("RGB")
+        width, height = img.size
+        pixels = list(img.getdata())
+    rows = [[rgb565(*pixels[y * width + x]) for x in range(width)] for y in range(height)]
+    return width, height, rows
+
+
+def color_hash(p):
+    return ((p >> 11) * 3 + ((p >> 5) & 0x3F) * 5 + (p & 0x1F) * 7) & 0x3F
+
+
+def wrap(delta, bits):
+    """Signed difference modulo 2**bits, in [-2**(bits-1), 2**(bits-1))."""
+    half = 1 << (bits - 1)
+    return ((delta + half) & ((1 << bits) - 1)) - half
+
+
+def encode_group(rows):
+    out = bytearray()
+    index = [0] * 64
+    prev = WHITE
+    run = 0
+
+    def flush_run():
+        nonlocal run
+        while run > 0:
+            if run >= 63:
+                n = min(run, 63 + 255)
+                out.append(0xFF)
+                out.append(n - 63)
+            else:
+                n = run
+                out.append(0xC0 | (n - 1))
+            run -= n
+
+    for row in rows:
+        for px in row:
+            if px == prev:
+                run += 1
+                continue
+            flush_run()
+            h = color_hash(px)
+            if index[h] == px:
+                out.append(h)
+            else:
+                dr = wrap((px >> 11) - (prev >> 11), 5)
+                dg = wrap(((px >> 5) & 0x3F) - ((prev >> 5) & 0x3F), 6)
+                db = wrap((px & 0x1F) - (prev & 0x1F), 5)
+                half = dg >> 1
+                if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+                    out.append(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2))
+                elif -8 <= dr - half <= 7 and -8 <= db - half <= 7:
+                    out.append(0x80 | (dg + 32))
+                    out.append(((dr - half + 8) << 4) | (db - half + 8))
+                else:
+                    out.append(0xFE)
+                    out += struct.pack("<H", px)
+            index[h] = px
+            prev = px
+    flush_run()  # runs never cross a restart point
+    return out
+
+
+def near(px, background, threshold):
+    return (abs((px >> 11) - (background >> 11)) <= threshold and
+            abs(((px >> 5) & 0x3F) - ((background >> 5) & 0x3F)) <= threshold and
+            abs((px & 0x1F) - (background & 0x1F)) <= threshold)
+
+
+def clean_blank_rows(rows, background, threshold):
+    """Rewrite rows that are within threshold of the background as pure background (threshold 0: unchanged)."""
+    if threshold <= 0:
+        return rows
+    return [[background] * len(row) if all(near(px, background, threshold) for px in row) else row for row in rows]
+
+
+def content_box(width, rows, background):
+    """(left, top, right, bottom) of the pixels that are not background, right/bottom exclusive; zeros if none."""
+    left, top, right, bottom = width, len(rows), 0, 0
+    for y, row in enumerate(rows):
+        inked = [x for x, px in enumerate(row) if px != background]
+        if inked:
+            left, right = min(left, inked[0]), max(right, inked[-1] + 1)
+            top, bottom = min(top, y), y + 1
+    return (left, top, right, bottom) if right > 0 else (0, 0, 0, 0)
+
+
+def blank_runs(rows, background, min_rows):
+    """(first, count) runs of at least min_rows pure background rows; only the longest MAX_BLANK_RUNS are kept."""
+    runs = []
+    start = None
+    for y, row in enumerate(rows + [None]):
+        blank = row is not None and all(px == background for px in row)
+        if blank and start is None:
+            start = y
+        elif not blank and start is not None:
+            if y - start >= min_rows:
+                runs.append((start, y - start))
+            start = None
+    runs = sorted(runs, key=lambda run: -run[1])[:MAX_BLANK_RUNS]
+    return sorted(runs)
+
+
+def encode(width, height, rows, group_rows, background=WHITE, min_blank_rows=4):
+    if width > 0xFFFF or height > 0xFFFF:
+        raise ValueError("image too large for Q565 (%dx%d)" % (width, height))
+    groups = (height + group_rows - 1) // group_rows
+    runs = blank_runs(rows, background, min_blank_rows)
+    body = bytearray()
+    offsets = []
+    data_start = HEADER_BYTES + 4 * groups + 4 * len(runs)
+    for g in range(groups):
+        offsets.append(data_start + len(body))
+        body += encode_group(rows[g * group_rows:(g + 1) * group_rows])
+    header = MAGIC + struct.pack("<HHHHHH", VERSION, width, height, group_rows, groups, background)
+    header += struct.pack("<4HH", *content_box(width, rows, background), len(runs))
+    table = b"".join(struct.pack("<HH", first, count) for first, count in runs)
+    return header + struct.pack("<%dI" % groups, *offsets) + table + bytes(body)
+
+
+def read_header(data):
+    """Header fields of an encoded file as a dict; raises ValueError for other formats and versions."""
+    if len(data) < HEADER_BYTES or data[:4] != MAGIC:
+        raise ValueError("not a Q565 file")
+    version, = struct.unpack_from("<H", data, 4)
+    if version != VERSION:
+        raise ValueError("Q565 version %d, this encoder writes version %d" % (version, VERSION))
+    fields = struct.unpack_from("<5H4HH", data, 6)
+    names = ("width", "height", "group_rows", "groups", "background", "left", "top", "right", "bottom", "blank_runs")
+    return dict(zip(names, fields))
+
+
+def convert(src, dst, group_rows, background=WHITE, min_blank_rows=4, blank_threshold=0):
+    width, height, rows = read_image(src)
+    rows = clean_blank_rows(rows, background, blank_threshold)
+    data = encode(width, height, rows, group_rows, background, min_blank_rows)
+    with open(dst, "wb") as f:
+        f.write(data)
+    raw = width * height * 3
+    h = read_header(data)
+    print("%s: %dx%d, %d -> %d bytes (%.1f%% of 24-bit), content %d,%d-%d,%d, %d blank runs" %
+          (dst, width, height, os.path.getsize(src), len(data), 100.0 * len(data) / raw,
+           h["left"], h["top"], h["right"], h["bottom"], h["blank_runs"]))
+    return len(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("inputs", nargs="+", help="comic directories (N.bmp files) or image files")
+    parser.add_argument("-o", "--out", help="output directory for image files (default: next to the input)")
+    parser.add_argument("--group-rows", type=int, default=16, help="rows per restart point (default 16)")
+    parser.add_argument("--background", type=lambda v: int(v, 16), default=WHITE,
+                        help="page background as RGB565 hex (default FFFF, white)")
+    parser.add_argument("--min-blank-rows", type=int, default=4, help="shortest blank run worth indexing (default 4)")
+    parser.add_argument("--blank-threshold", type=int, default=0,
+                        help="treat rows within this RGB565 distance of the background as blank (default 0, lossless)")
+    args = parser.parse_args()
+    if not 1 <= args.group_rows <= 0xFFFF:
+        parser.error("--group-rows must be in 1..65535")
+    if not 0 <= args.background <= 0xFFFF:
+        parser.error("--background must be an RGB565 value (0..FFFF)")
+    if args.min_blank_rows < 1:
+        parser.error("--min-blank-rows must be at least 1")
+    options = (args.group_rows, args.background, args.min_blank_rows, args.blank_threshold)
+
+    for path in args.inputs:
+        if os.path.isdir(path):
+            names = sorted((n for n in os.listdir(path) if re.fullmatch(r"\d+\.bmp", n, re.IGNORECASE)),
+                           key=lambda n: int(n.split(".")[0]))
+            if not names:
+                print("%s: no N.bmp images" % path, file=sys.stderr)
+            for name in names:
+                convert(os.path.join(path, name), os.path.join(path, name.split(".")[0] + ".q565"), *options)
+        else:
+            out_dir = args.out or os.path.dirname(path) or "."
+            os.makedirs(out_dir, exist_ok=True)
+            base = os.path.splitext(os.path.basename(path))[0]
+            convert(path, os.path.join(out_dir, base + ".q565"), *options)
+
+
+if __name__ == "__main__":
+    main()